@@ -0,0 +1,624 @@
+/*
+    DAO query benchmark on a synthetic catalog.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "easylogging++.h"
+
+#include "../src/squawkconfig.h"
+#include "../src/squawkserver.h"
+#include "../src/upnpcontentdirectorydao.h"
+#include "../src/db/sqlite3connection.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+/*
+ * Usage: bench_dao [--database FILE] [--regenerate] [--tracks N] [--albums N] [--artists N] [--photos N]
+ *                  [--movies N] [--iterations N] [--page N] [--seed N] [squawk options]
+ *
+ * The catalog is written straight into the schema when the database does not exist, later runs
+ * reuse it. Every case calls a DAO entry point the way the content directory modules do and
+ * reports the latency percentiles, the rows returned and the statements prepared per call.
+ * The other options are passed to SquawkConfig, e.g. --catalog-snapshot true or --commit-batch 1.
+ */
+
+namespace squawk {
+namespace bench {
+
+/* the size of the generated catalog. */
+struct Catalog {
+    size_t tracks;
+    size_t albums;
+    size_t artists;
+    size_t photos;
+    size_t movies;
+    unsigned seed;
+};
+
+/* the objects used as arguments of the cases, read from the database. */
+struct Ids {
+    std::vector< int64_t > folders;
+    std::vector< int64_t > albums;
+    std::vector< int64_t > photo_albums;
+    std::vector< int64_t > tracks;
+    std::vector< std::string > artists;
+    std::vector< std::string > series;
+    /* path and mtime of the sampled tracks */
+    std::vector< std::pair< std::string, unsigned long > > files;
+};
+
+/* a row of tbl_cds_object. */
+struct Object {
+    int cls;
+    int64_t parent_id;
+    std::string title, path, mime_type;
+    int64_t size, mtime, year, track, disc;
+    std::string contributor, artist, genre, album, series_title;
+    int64_t season, episode;
+};
+
+static const std::vector< std::string > SYLLABLES {
+    "ka", "lo", "mi", "ra", "ne", "to", "su", "vi", "da", "el", "an", "or", "us", "be", "ji", "po", "qu", "ze", "ha", "fy"
+};
+static const std::vector< std::string > GENRES {
+    "Rock", "Jazz", "Classical", "Pop", "Electronic", "Hip-Hop", "Folk", "Blues", "Metal", "Soundtrack"
+};
+
+inline std::string word ( std::mt19937 & rng ) {
+    std::string word_;
+    const size_t syllables_ = 2 + rng() % 2;
+
+    for ( size_t i = 0; i < syllables_; ++i ) {
+        word_ += SYLLABLES[ rng() % SYLLABLES.size() ];
+    }
+
+    word_[0] = static_cast< char > ( std::toupper ( word_[0] ) );
+    return word_;
+}
+
+/* one to max words, sometimes with a leading article for the sort keys. */
+inline std::string words ( std::mt19937 & rng, const size_t max ) {
+    std::string words_ = ( rng() % 10 == 0 ? "The " : "" );
+    const size_t count_ = 1 + rng() % max;
+
+    for ( size_t i = 0; i < count_; ++i ) {
+        words_ += ( i == 0 ? "" : " " ) + word ( rng );
+    }
+
+    return words_;
+}
+
+inline std::string clean_name ( const std::string & name ) {
+    std::string clean_;
+
+    for ( auto & c : name ) {
+        if ( std::isalnum ( static_cast< unsigned char > ( c ) ) ) {
+            clean_ += static_cast< char > ( std::tolower ( c ) );
+        }
+    }
+
+    return clean_;
+}
+
+inline int64_t epoch_year ( const int year ) {
+    return static_cast< int64_t > ( year - 1970 ) * 31556952;
+}
+
+inline double percentile ( std::vector< double > & values, const double p ) {
+    if ( values.empty() ) { return 0; }
+
+    size_t index_ = std::min ( values.size() - 1, static_cast< size_t > ( p * values.size() ) );
+    std::nth_element ( values.begin(), values.begin() + index_, values.end() );
+    return values[ index_ ];
+}
+
+/* write the catalog in one transaction with the sort keys like the writer, the triggers fill the counters and the search index. */
+inline void generate ( const std::string & path, const Catalog & catalog ) {
+    const auto start_ = std::chrono::steady_clock::now();
+    std::mt19937 rng_ ( catalog.seed );
+    const int64_t now_ = std::chrono::duration_cast< std::chrono::seconds > ( std::chrono::system_clock::now().time_since_epoch() ).count();
+
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection > ( path );
+    db_->exec ( "PRAGMA auto_vacuum=INCREMENTAL;" );
+    db_->exec ( "PRAGMA journal_mode=WAL;" );
+    UpnpContentDirectoryDao::migrate ( db_ );
+    db_->exec ( "PRAGMA synchronous=OFF;" );
+    db_->exec ( "BEGIN;" );
+
+    db::db_statement_ptr object_stmt_ = db_->prepareStatement (
+            "insert into tbl_cds_object( cls, parent_id, title, path, mime_type, size, mtime, year, track, disc, contributor, artist, "
+            "genre, album, series_title, season, episode, object_update_id, import, timestamp, title_sort, artist_sort, album_sort ) "
+            "values( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 0, 1, ?, ?, ?, ? )" );
+    db::db_statement_ptr resource_stmt_ = db_->prepareStatement (
+            "insert into tbl_cds_resource( ref_obj, protocol_info, path, bitrate, bits_per_sample, dlna_profile, duration, mime_type, "
+            "nr_audio_channels, resolution, sample_frequency, size ) values( ?, '', ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+    db::db_statement_ptr uri_stmt_ = db_->prepareStatement (
+            "insert into tbl_cds_album_art_uri( ref_obj, path, uri, profile ) values( ?, ?, 'URI', 'JPEG_TN' )" );
+    db::db_statement_ptr artist_stmt_ = db_->prepareStatement (
+            "insert into tbl_cds_artist( clean_name, name, import, name_sort ) values( ?, ?, 1, ? )" );
+
+    size_t rows_ = 0;
+    auto insert_ = [&] ( const Object & o ) -> int64_t {
+        int index_ = 0;
+        object_stmt_->bind_int ( ++index_, o.cls );
+        object_stmt_->bind_int64 ( ++index_, o.parent_id );
+        object_stmt_->bind_text ( ++index_, o.title );
+        object_stmt_->bind_text ( ++index_, o.path );
+        object_stmt_->bind_text ( ++index_, o.mime_type );
+        object_stmt_->bind_int64 ( ++index_, o.size );
+        object_stmt_->bind_int64 ( ++index_, o.mtime );
+        object_stmt_->bind_int64 ( ++index_, o.year );
+        object_stmt_->bind_int64 ( ++index_, o.track );
+        object_stmt_->bind_int64 ( ++index_, o.disc );
+        object_stmt_->bind_text ( ++index_, o.contributor );
+        object_stmt_->bind_text ( ++index_, o.artist );
+        object_stmt_->bind_text ( ++index_, o.genre );
+        object_stmt_->bind_text ( ++index_, o.album );
+        object_stmt_->bind_text ( ++index_, o.series_title );
+        object_stmt_->bind_int64 ( ++index_, o.season );
+        object_stmt_->bind_int64 ( ++index_, o.episode );
+        object_stmt_->bind_int64 ( ++index_, now_ );
+        object_stmt_->bind_text ( ++index_, commons::text::sort_key ( o.title ) );
+        object_stmt_->bind_text ( ++index_, commons::text::sort_key ( o.artist ) );
+        object_stmt_->bind_text ( ++index_, commons::text::sort_key ( o.album ) );
+        object_stmt_->insert();
+        object_stmt_->reset();
+
+        if ( ++rows_ % 100000 == 0 ) {
+            std::cerr << "\r" << rows_ << " objects" << std::flush;
+        }
+
+        return static_cast< int64_t > ( db_->last_insert_rowid() );
+    };
+    auto resource_ = [&] ( const int64_t ref_obj, const std::string & path, const int bitrate, const int duration,
+    const std::string & mime_type, const std::string & resolution, const int64_t size ) {
+        int index_ = 0;
+        resource_stmt_->bind_int64 ( ++index_, ref_obj );
+        resource_stmt_->bind_text ( ++index_, path );
+        resource_stmt_->bind_int ( ++index_, bitrate );
+        resource_stmt_->bind_int ( ++index_, ( bitrate == 0 ? 0 : 16 ) );
+        resource_stmt_->bind_text ( ++index_, "" );
+        resource_stmt_->bind_int ( ++index_, duration );
+        resource_stmt_->bind_text ( ++index_, mime_type );
+        resource_stmt_->bind_int ( ++index_, ( bitrate == 0 ? 0 : 2 ) );
+        resource_stmt_->bind_text ( ++index_, resolution );
+        resource_stmt_->bind_int ( ++index_, ( bitrate == 0 ? 0 : 44100 ) );
+        resource_stmt_->bind_int64 ( ++index_, size );
+        resource_stmt_->insert();
+        resource_stmt_->reset();
+    };
+    auto album_art_uri_ = [&] ( const int64_t ref_obj, const std::string & path ) {
+        uri_stmt_->bind_int64 ( 1, ref_obj );
+        uri_stmt_->bind_text ( 2, path );
+        uri_stmt_->insert();
+        uri_stmt_->reset();
+    };
+    auto folder_ = [&] ( const int cls, const int64_t parent_id, const std::string & title, const std::string & path ) {
+        Object o_ = Object();
+        o_.cls = cls;
+        o_.parent_id = parent_id;
+        o_.title = title;
+        o_.path = path;
+        o_.mtime = now_;
+        return insert_ ( o_ );
+    };
+
+    const int64_t music_ = folder_ ( didl::objectContainer, 0, "music", "/bench/music" );
+    const int64_t photos_ = folder_ ( didl::objectContainer, 0, "photos", "/bench/photos" );
+    const int64_t movies_ = folder_ ( didl::objectContainer, 0, "movies", "/bench/movies" );
+
+    //unique artist names, the folders are created with the first album.
+    std::vector< std::string > artists_;
+    std::set< std::string > clean_names_;
+
+    while ( artists_.size() < catalog.artists ) {
+        std::string name_ = words ( rng_, 2 );
+
+        if ( clean_names_.insert ( clean_name ( name_ ) ).second ) {
+            artist_stmt_->bind_text ( 1, clean_name ( name_ ) );
+            artist_stmt_->bind_text ( 2, name_ );
+            artist_stmt_->bind_text ( 3, commons::text::sort_key ( name_ ) );
+            artist_stmt_->insert();
+            artist_stmt_->reset();
+            artists_.push_back ( name_ );
+        }
+    }
+
+    //few artists have many albums.
+    std::vector< int64_t > folders_ ( artists_.size(), 0 );
+    std::vector< Object > albums_;
+    std::vector< int64_t > album_ids_;
+    std::uniform_real_distribution< double > uniform_ ( 0, 1 );
+
+    for ( size_t i = 0; i < catalog.albums && ! artists_.empty(); ++i ) {
+        const size_t artist_ = std::min ( artists_.size() - 1, static_cast< size_t > ( std::pow ( uniform_ ( rng_ ), 2 ) * artists_.size() ) );
+
+        if ( folders_[ artist_ ] == 0 ) {
+            folders_[ artist_ ] = folder_ ( didl::objectContainer, music_, artists_[ artist_ ], "/bench/music/" + clean_name ( artists_[ artist_ ] ) );
+        }
+
+        Object o_ = Object();
+        o_.cls = didl::objectContainerAlbumMusicAlbum;
+        o_.parent_id = folders_[ artist_ ];
+        o_.title = words ( rng_, 3 );
+        o_.path = "/bench/music/" + clean_name ( artists_[ artist_ ] ) + "/" + std::to_string ( i );
+        o_.mtime = now_ - static_cast< int64_t > ( rng_() % ( 10 * 365 * 86400 ) );
+        o_.year = epoch_year ( 1960 + rng_() % 60 );
+        o_.artist = clean_name ( artists_[ artist_ ] );
+        o_.contributor = ( rng_() % 5 == 0 ? clean_name ( artists_[ rng_() % artists_.size() ] ) : "" );
+        o_.genre = GENRES[ rng_() % GENRES.size() ];
+        album_ids_.push_back ( insert_ ( o_ ) );
+        album_art_uri_ ( album_ids_.back(), o_.path + "/cover.jpg" );
+        albums_.push_back ( o_ );
+    }
+
+    //the tracks are spread over the albums, the track number counts the rounds.
+    for ( size_t i = 0; i < catalog.tracks && ! albums_.empty(); ++i ) {
+        const Object & album_ = albums_[ i % albums_.size() ];
+        const bool flac_ = ( rng_() % 10 < 7 );
+
+        Object o_ = Object();
+        o_.cls = didl::objectItemAudioItemMusicTrack;
+        o_.parent_id = album_ids_[ i % albums_.size() ];
+        o_.track = static_cast< int64_t > ( i / albums_.size() + 1 );
+        o_.disc = 1;
+        o_.title = words ( rng_, 4 );
+        o_.path = album_.path + "/" + std::to_string ( o_.track ) + ( flac_ ? ".flac" : ".mp3" );
+        o_.mime_type = ( flac_ ? "audio/flac" : "audio/mpeg" );
+        o_.size = 3000000 + rng_() % 30000000;
+        o_.mtime = album_.mtime;
+        o_.year = album_.year;
+        o_.artist = album_.artist;
+        o_.contributor = album_.contributor;
+        o_.genre = album_.genre;
+        o_.album = album_.title;
+        const int64_t id_ = insert_ ( o_ );
+        resource_ ( id_, o_.path, ( flac_ ? 900000 : 320000 ), 120 + rng_() % 400, o_.mime_type, "", o_.size );
+    }
+
+    //a photo album for every hundred photos, with a thumbnail and the original.
+    const size_t photo_albums_count_ = ( catalog.photos == 0 ? 0 : std::max< size_t > ( 1, catalog.photos / 100 ) );
+    std::vector< int64_t > photo_albums_;
+
+    for ( size_t i = 0; i < photo_albums_count_; ++i ) {
+        photo_albums_.push_back ( folder_ ( didl::objectContainerAlbumPhotoAlbum, photos_, words ( rng_, 3 ), "/bench/photos/" + std::to_string ( i ) ) );
+        album_art_uri_ ( photo_albums_.back(), "/bench/photos/" + std::to_string ( i ) + "/cover.jpg" );
+    }
+
+    for ( size_t i = 0; i < catalog.photos; ++i ) {
+        Object o_ = Object();
+        o_.cls = didl::objectItemImageItemPhoto;
+        o_.parent_id = photo_albums_[ i % photo_albums_.size() ];
+        o_.title = "IMG_" + std::to_string ( i );
+        o_.path = "/bench/photos/" + std::to_string ( i % photo_albums_.size() ) + "/IMG_" + std::to_string ( i ) + ".jpg";
+        o_.mime_type = "image/jpeg";
+        o_.size = 2000000 + rng_() % 6000000;
+        o_.mtime = now_ - static_cast< int64_t > ( rng_() % ( 10 * 365 * 86400 ) );
+        const int64_t id_ = insert_ ( o_ );
+        resource_ ( id_, "/tmp/Resource/" + std::to_string ( id_ ) + ".jpg", 0, 0, "image/jpeg", "160x160", 8000 );
+        resource_ ( id_, o_.path, 0, 0, "image/jpeg", "4000x3000", o_.size );
+    }
+
+    //half of the movies are episodes of series with ten episodes.
+    for ( size_t i = 0; i < catalog.movies; ++i ) {
+        const bool episode_ = ( i < catalog.movies / 2 );
+
+        Object o_ = Object();
+        o_.cls = didl::objectItemVideoItemMovie;
+        o_.parent_id = movies_;
+        o_.title = words ( rng_, 3 );
+        o_.path = "/bench/movies/" + std::to_string ( i ) + ".mkv";
+        o_.mime_type = "video/x-matroska";
+        o_.size = 700000000 + rng_() % 4000000000U;
+        o_.mtime = now_ - static_cast< int64_t > ( rng_() % ( 10 * 365 * 86400 ) );
+        o_.series_title = ( episode_ ? "Series " + std::to_string ( i / 10 ) : "" );
+        o_.season = ( episode_ ? 1 : 0 );
+        o_.episode = ( episode_ ? static_cast< int64_t > ( i % 10 + 1 ) : 0 );
+        const int64_t id_ = insert_ ( o_ );
+        resource_ ( id_, o_.path, 5000000, 2400 + rng_() % 4800, o_.mime_type, "1920x1080", o_.size );
+    }
+
+    db_->exec ( "COMMIT;" );
+    db_->exec ( "ANALYZE;" );
+
+    std::cerr << "\r";
+    std::cout << "generated:         " << rows_ << " objects, " << artists_.size() << " artists in " <<
+              std::chrono::duration_cast< std::chrono::seconds > ( std::chrono::steady_clock::now() - start_ ).count() << "s" << std::endl;
+}
+
+/* read the arguments of the cases, the files are a sample of about samples tracks. */
+inline Ids load ( db::db_connection_ptr db, const size_t samples ) {
+    Ids ids_;
+    auto integers_ = [&db] ( const std::string & query, std::vector< int64_t > & values ) {
+        db::db_statement_ptr stmt_ = db->prepareStatement ( query );
+
+        while ( stmt_->step() ) { values.push_back ( stmt_->get_int64 ( 0 ) ); }
+    };
+    auto strings_ = [&db] ( const std::string & query, std::vector< std::string > & values ) {
+        db::db_statement_ptr stmt_ = db->prepareStatement ( query );
+
+        while ( stmt_->step() ) { values.push_back ( stmt_->get_string ( 0 ) ); }
+    };
+
+    integers_ ( "select ROWID from tbl_cds_object where cls = 1 and parent_id = "
+                "( select ROWID from tbl_cds_object where path = '/bench/music' )", ids_.folders );
+    integers_ ( "select ROWID from tbl_cds_object where cls = 2", ids_.albums );
+    integers_ ( "select ROWID from tbl_cds_object where cls = 9", ids_.photo_albums );
+    strings_ ( "select clean_name from tbl_cds_artist", ids_.artists );
+    strings_ ( "select distinct series_title from tbl_cds_object where series_title != ''", ids_.series );
+
+    db::db_statement_ptr count_ = db->prepareStatement ( "select value from tbl_cds_counter where name = 'cls:5'" );
+    const size_t tracks_ = ( count_->step() ? static_cast< size_t > ( count_->get_int64 ( 0 ) ) : 0 );
+    count_.reset();
+
+    db::db_statement_ptr stmt_ = db->prepareStatement ( "select ROWID, path, mtime from tbl_cds_object where cls = 5 and ROWID % ? = 0" );
+    stmt_->bind_int64 ( 1, std::max< size_t > ( 1, tracks_ / std::max< size_t > ( 1, samples ) ) );
+
+    while ( stmt_->step() ) {
+        ids_.tracks.push_back ( stmt_->get_int64 ( 0 ) );
+        ids_.files.push_back ( std::make_pair ( stmt_->get_string ( 1 ), static_cast< unsigned long > ( stmt_->get_int64 ( 2 ) ) ) );
+    }
+
+    return ids_;
+}
+
+/* call op iterations times, op gets the iteration and returns the number of rows. */
+inline void measure ( const std::string & name, const size_t iterations, std::function< size_t ( const size_t ) > op ) {
+    db::db_pool_ptr pool_ = SquawkServer::instance()->db_pool();
+    std::vector< double > latency_;
+    latency_.reserve ( iterations );
+    size_t rows_ = 0;
+
+    const db::Sqlite3ConnectionPool::Stats before_ = pool_->stats();
+
+    for ( size_t i = 0; i < iterations; ++i ) {
+        auto start_ = std::chrono::steady_clock::now();
+        rows_ += op ( i );
+        latency_.push_back ( std::chrono::duration< double, std::micro > ( std::chrono::steady_clock::now() - start_ ).count() );
+    }
+
+    const db::Sqlite3ConnectionPool::Stats after_ = pool_->stats();
+    const size_t queries_ = ( after_.statement_hits + after_.statement_misses ) - ( before_.statement_hits + before_.statement_misses );
+
+    double mean_ = 0;
+
+    for ( auto & l : latency_ ) { mean_ += l; }
+
+    mean_ = ( latency_.empty() ? 0 : mean_ / latency_.size() );
+
+    std::cout << std::left << std::setw ( 30 ) << name << std::right << std::fixed << std::setprecision ( 1 )
+              << std::setw ( 8 ) << iterations
+              << std::setw ( 11 ) << mean_
+              << std::setw ( 11 ) << percentile ( latency_, 0.50 )
+              << std::setw ( 11 ) << percentile ( latency_, 0.90 )
+              << std::setw ( 11 ) << percentile ( latency_, 0.99 )
+              << std::setw ( 11 ) << percentile ( latency_, 1.0 )
+              << std::setw ( 9 ) << ( iterations == 0 ? 0.0 : static_cast< double > ( rows_ ) / iterations )
+              << std::setw ( 9 ) << ( iterations == 0 ? 0.0 : static_cast< double > ( queries_ ) / iterations ) << std::endl;
+}
+
+inline void run ( const Ids & ids, const size_t iterations, const size_t page, const unsigned seed ) {
+    std::shared_ptr< UpnpContentDirectoryDao > dao_ = SquawkServer::instance()->dao();
+    //every case draws the same arguments in every run.
+    std::mt19937 rng_;
+    auto pick_ = [&rng_] ( const size_t size ) { return ( size == 0 ? 0 : rng_() % size ); };
+    auto reset_ = [&rng_, seed]() { rng_.seed ( seed ); };
+
+    const std::map< std::string, std::string > album_children_ {
+        { "cls", std::to_string ( didl::objectContainer ) + ", " + std::to_string ( didl::objectItemAudioItemMusicTrack ) }
+    };
+    auto by_artist_ = [] ( const std::string & artist ) {
+        return std::map< std::string, std::string > ( { { "artist", artist }, { "contributor", artist } } );
+    };
+
+    std::cout << std::left << std::setw ( 30 ) << "case" << std::right << std::setw ( 8 ) << "calls" << std::setw ( 11 ) << "mean(us)"
+              << std::setw ( 11 ) << "p50(us)" << std::setw ( 11 ) << "p90(us)" << std::setw ( 11 ) << "p99(us)"
+              << std::setw ( 11 ) << "max(us)" << std::setw ( 9 ) << "rows" << std::setw ( 9 ) << "queries" << std::endl;
+
+    /* ----------- reads ----------- */
+    reset_();
+    measure ( "object<DidlMusicTrack>", ( ids.tracks.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        dao_->object< didl::DidlMusicTrack > ( ids.tracks[ pick_ ( ids.tracks.size() ) ] );
+        return size_t ( 1 );
+    } );
+    reset_();
+    measure ( "children album tracks", ( ids.albums.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        return dao_->children< didl::DidlObject > ( ids.albums[ pick_ ( ids.albums.size() ) ], 0, page, album_children_,
+                std::make_pair ( "track, cls, title", "asc" ) ).size();
+    } );
+    reset_();
+    measure ( "children artist folder", ( ids.folders.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        return dao_->children< didl::DidlObject > ( ids.folders[ pick_ ( ids.folders.size() ) ], 0, page ).size();
+    } );
+    reset_();
+    measure ( "children photo album", ( ids.photo_albums.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        return dao_->children< didl::DidlPhoto > ( ids.photo_albums[ pick_ ( ids.photo_albums.size() ) ], 0, page ).size();
+    } );
+    reset_();
+    measure ( "childrenCount album tracks", ( ids.albums.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        dao_->childrenCount ( didl::object, ids.albums[ pick_ ( ids.albums.size() ) ], album_children_ );
+        return size_t ( 1 );
+    } );
+    reset_();
+    measure ( "objects albums random page", iterations, [&] ( const size_t ) {
+        return dao_->objects< didl::DidlContainerAlbum > ( pick_ ( ids.albums.size() ), page ).size();
+    } );
+    measure ( "objects albums next page", iterations, [&] ( const size_t i ) {
+        return dao_->objects< didl::DidlContainerAlbum > ( ( i * page ) % std::max< size_t > ( 1, ids.albums.size() ), page ).size();
+    } );
+    reset_();
+    measure ( "objects new albums", iterations, [&] ( const size_t ) {
+        return dao_->objects< didl::DidlContainerAlbum > ( pick_ ( 10 ) * page, page, std::map< std::string, std::string >(),
+                std::make_pair ( "mtime", "desc" ) ).size();
+    } );
+    reset_();
+    measure ( "objects albums of artist", ( ids.artists.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        return dao_->objects< didl::DidlContainerAlbum > ( 0, page, by_artist_ ( ids.artists[ pick_ ( ids.artists.size() ) ] ) ).size();
+    } );
+    reset_();
+    measure ( "objects movies of series", ( ids.series.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        return dao_->objects< didl::DidlMovie > ( 0, page, std::map< std::string, std::string > (
+                    { { "series_title", ids.series[ pick_ ( ids.series.size() ) ] } } ) ).size();
+    } );
+    measure ( "objectsCount albums", iterations, [&] ( const size_t ) {
+        dao_->objectsCount ( didl::objectContainerAlbumMusicAlbum );
+        return size_t ( 1 );
+    } );
+    reset_();
+    measure ( "objectsCount albums of artist", ( ids.artists.empty() ? 0 : iterations ), [&] ( const size_t ) {
+        dao_->objectsCount ( didl::objectContainerAlbumMusicAlbum, by_artist_ ( ids.artists[ pick_ ( ids.artists.size() ) ] ) );
+        return size_t ( 1 );
+    } );
+    reset_();
+    measure ( "artists random page", iterations, [&] ( const size_t ) {
+        return dao_->artists ( pick_ ( ids.artists.size() ), page, std::map< std::string, std::string >(), std::make_pair ( "name", "asc" ) ).size();
+    } );
+    reset_();
+    measure ( "series random page", iterations, [&] ( const size_t ) {
+        return dao_->series ( pick_ ( ids.series.size() ), page ).size();
+    } );
+    measure ( "statistics", iterations, [&] ( const size_t ) {
+        dao_->statistics();
+        return size_t ( 1 );
+    } );
+
+    /* ----------- writes, like a rescan of unchanged files ----------- */
+    measure ( "touch", ( ids.files.empty() ? 0 : iterations ), [&] ( const size_t i ) {
+        return static_cast< size_t > ( dao_->touch ( ids.files[ i % ids.files.size() ].first, ids.files[ i % ids.files.size() ].second ) );
+    } );
+
+    std::vector< didl::DidlMusicTrack > tracks_;
+
+    for ( size_t i = 0; i < std::min ( iterations, ids.tracks.size() ); ++i ) {
+        tracks_.push_back ( dao_->object< didl::DidlMusicTrack > ( ids.tracks[i] ) );
+    }
+
+    measure ( "save DidlMusicTrack", ( tracks_.empty() ? 0 : iterations ), [&] ( const size_t i ) {
+        dao_->save ( tracks_[ i % tracks_.size() ] );
+        return size_t ( 1 );
+    } );
+    measure ( "flush", 1, [&] ( const size_t ) {
+        dao_->flush();
+        return size_t ( 0 );
+    } );
+}
+}//namespace bench
+}//namespace squawk
+
+int main ( int argc, char **argv ) {
+    std::string database_ = ( boost::filesystem::temp_directory_path() / "squawk-bench.db" ).string();
+    squawk::bench::Catalog catalog_ { 1000000, 80000, 30000, 200000, 10000, 42 };
+    size_t iterations_ = 1000, page_ = 25;
+    bool regenerate_ = false;
+    std::vector< std::string > options_;
+
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg_ = argv[i];
+
+        if ( arg_ == "--regenerate" ) {
+            regenerate_ = true;
+
+        } else if ( arg_ == "--database" && i + 1 < argc ) {
+            database_ = argv[++i];
+
+        } else if ( arg_ == "--tracks" && i + 1 < argc ) {
+            catalog_.tracks = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--albums" && i + 1 < argc ) {
+            catalog_.albums = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--artists" && i + 1 < argc ) {
+            catalog_.artists = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--photos" && i + 1 < argc ) {
+            catalog_.photos = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--movies" && i + 1 < argc ) {
+            catalog_.movies = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--iterations" && i + 1 < argc ) {
+            iterations_ = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--page" && i + 1 < argc ) {
+            page_ = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--seed" && i + 1 < argc ) {
+            catalog_.seed = static_cast< unsigned > ( std::stoul ( argv[++i] ) );
+
+        } else { options_.push_back ( arg_ ); }
+    }
+
+    el::Configurations log_conf_;
+    log_conf_.setGlobally ( el::ConfigurationType::Enabled, "false" );
+    log_conf_.set ( el::Level::Error, el::ConfigurationType::Enabled, "true" );
+    log_conf_.setGlobally ( el::ConfigurationType::ToFile, "false" );
+    el::Loggers::reconfigureAllLoggers ( log_conf_ );
+
+    if ( regenerate_ ) {
+        for ( auto & suffix : { "", "-wal", "-shm" } ) {
+            boost::filesystem::remove ( database_ + suffix );
+        }
+    }
+
+    std::cout << "database:          " << database_ << std::endl;
+
+    if ( ! boost::filesystem::exists ( database_ ) ) {
+        squawk::bench::generate ( database_, catalog_ );
+    }
+
+    //the maintenance runs only when scheduled, the options of the command line come last.
+    const std::string tmp_ = boost::filesystem::temp_directory_path().string();
+    std::vector< std::string > args_ { "bench_dao", "--config-file", tmp_ + "/squawk-bench.xml", "--media-directory", tmp_,
+                                       "--http-docroot", tmp_, "--http-bower", tmp_, "--http-ip", "127.0.0.1", "--local-address", "127.0.0.1",
+                                       "--database-file", database_, "--tmp-directory", tmp_, "--maintenance-interval", "0"
+                                     };
+    args_.insert ( args_.end(), options_.begin(), options_.end() );
+    std::vector< const char* > av_;
+
+    for ( auto & arg : args_ ) { av_.push_back ( arg.c_str() ); }
+
+    squawk::SquawkConfig * config_ = new squawk::SquawkConfig();
+
+    if ( ! config_->parse ( static_cast< int > ( av_.size() ), av_.data() ) || ! config_->validate() ) {
+        return 1;
+    }
+
+    squawk::SquawkServer::instance()->open ( config_ );
+    const squawk::bench::Ids ids_ = squawk::bench::load ( squawk::SquawkServer::instance()->db_reader(), iterations_ );
+    std::cout << "catalog:           " << ids_.albums.size() << " albums, " << ids_.artists.size() << " artists, " <<
+              ids_.photo_albums.size() << " photo albums, " << ids_.series.size() << " series" << std::endl;
+    std::cout << "catalog snapshot:  " << ( config_->catalogSnapshot() ? "true" : "false" ) << std::endl;
+
+    squawk::bench::run ( ids_, iterations_, page_, catalog_.seed );
+
+    db::Sqlite3ObjectCache::Stats cache_ = squawk::SquawkServer::instance()->dao()->objectCacheStats();
+    std::cout << "object cache:      " << cache_.hits << " hits, " << cache_.misses << " misses, " << cache_.entries << " entries" << std::endl;
+    return 0;
+}
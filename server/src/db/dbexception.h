@@ -20,6 +20,7 @@
 #define DATABASE_H
 
 #include <exception>
+#include <string>
 
 namespace db {
 /**
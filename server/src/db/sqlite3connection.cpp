@@ -21,26 +21,53 @@
 
 namespace db {
 
-Sqlite3Connection::Sqlite3Connection ( const std::string & path ) {
+const int Sqlite3Connection::BUSY_TIMEOUT = 5000;
+const size_t Sqlite3Connection::STATEMENT_CACHE_SIZE = 128;
+
+Sqlite3Connection::Sqlite3Connection ( const std::string & path, const bool read_only ) {
 	sqlite3 * db;
-	int res = sqlite3_open ( path.c_str(), &db );
+    //the writer is shared by the writer thread and the threads reading their own changes.
+	int res = sqlite3_open_v2 ( path.c_str(), &db,
+                                ( read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX ), nullptr );
 
 	if ( res != SQLITE_OK ) {
 		throw DbException ( res, sqlite3_errmsg ( db ) );
 	}
 
+    sqlite3_busy_timeout ( db, BUSY_TIMEOUT );
+
     _db = std::unique_ptr< sqlite3, std::function<void ( sqlite3* ) > > ( db, [] ( sqlite3 * db ) {
 		sqlite3_close ( db );
 	} );
 }
 Sqlite3Connection::~Sqlite3Connection() {
-    for ( auto stmt_list : _stmt_pool ) {
-		for ( auto stmt : stmt_list.second ) {
+    for ( auto & stmt_list : _stmt_pool ) {
+		for ( auto stmt : stmt_list.second.statements ) {
 			delete stmt;
 		}
 	}
     _stmt_pool.clear();
 }
+void Sqlite3Connection::create_function ( const std::string & name, std::string ( *function ) ( const std::string & ) ) {
+    int res = sqlite3_create_function_v2 ( _db.get(), name.c_str(), 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                           reinterpret_cast< void * > ( function ),
+    [] ( sqlite3_context * context, int, sqlite3_value ** values ) {
+        if ( sqlite3_value_type ( values[0] ) == SQLITE_NULL ) {
+            sqlite3_result_null ( context );
+            return;
+        }
+
+        std::string ( *function_ ) ( const std::string & ) =
+            reinterpret_cast< std::string ( * ) ( const std::string & ) > ( sqlite3_user_data ( context ) );
+        const char * text_ = reinterpret_cast< const char * > ( sqlite3_value_text ( values[0] ) );
+        const std::string result_ = function_ ( std::string ( text_, sqlite3_value_bytes ( values[0] ) ) );
+        sqlite3_result_text ( context, result_.c_str(), result_.size(), SQLITE_TRANSIENT );
+    }, nullptr, nullptr, nullptr );
+
+    if ( res != SQLITE_OK ) {
+        throw DbException ( res, sqlite3_errmsg ( _db.get() ) );
+    }
+}
 int Sqlite3Connection::exec ( const std::string & query ) {
     return sqlite3_exec ( _db.get(), query.c_str(), NULL, NULL, NULL );
 }
@@ -49,16 +76,19 @@ db_statement_ptr Sqlite3Connection::prepareStatement ( const std::string & state
 	Sqlite3Statement * stmt = nullptr;
 
 	// search an existing statement
-    if ( _stmt_pool.find ( statement ) != _stmt_pool.end() &&
-            _stmt_pool[statement].size() != 0 ) {
+    auto cached_ = _stmt_pool.find ( statement );
+
+    if ( cached_ != _stmt_pool.end() && cached_->second.statements.size() != 0 ) {
 
-        stmt = _stmt_pool[statement].back();
-        _stmt_pool[statement].pop_back();
+        stmt = cached_->second.statements.back();
+        cached_->second.statements.pop_back();
+        _stmt_lru.splice ( _stmt_lru.begin(), _stmt_lru, cached_->second.lru );
+        ++_stats.hits;
 
     // create new statement
 	}  else {
 		sqlite3_stmt * sqlite3_statement;
-        int res = sqlite3_prepare ( _db.get(), statement.c_str(), -1, &sqlite3_statement, 0 );
+        int res = sqlite3_prepare_v2 ( _db.get(), statement.c_str(), -1, &sqlite3_statement, 0 );
 
 		if ( SQLITE_OK != res ) {
             throw DbException ( res, sqlite3_errmsg ( _db.get() ) );
@@ -68,6 +98,7 @@ db_statement_ptr Sqlite3Connection::prepareStatement ( const std::string & state
             sqlite3_finalize ( sqlite3_statement );
 		} );
         stmt = new Sqlite3Statement ( _db, std::move ( sqlite3_statement_ ), statement );
+        ++_stats.misses;
 	}
 
     return std::shared_ptr< Sqlite3Statement > ( stmt, std::bind ( &Sqlite3Connection::_release_statement, this, std::placeholders::_1 ) );
@@ -75,7 +106,31 @@ db_statement_ptr Sqlite3Connection::prepareStatement ( const std::string & state
 void Sqlite3Connection::_release_statement ( Sqlite3Statement * statement ) {
     std::lock_guard<std::mutex> lck ( _db_mtx );
 	statement->reset();
-    _stmt_pool[statement->statement()].push_back ( statement );
+    auto cached_ = _stmt_pool.find ( statement->statement() );
+
+    if ( cached_ == _stmt_pool.end() ) {
+        _stmt_lru.push_front ( statement->statement() );
+        cached_ = _stmt_pool.insert ( std::make_pair ( statement->statement(), CachedStatements { {}, _stmt_lru.begin() } ) ).first;
+
+        //finalize the idle statements of the least recently used text.
+        if ( _stmt_pool.size() > STATEMENT_CACHE_SIZE ) {
+            auto evicted_ = _stmt_pool.find ( _stmt_lru.back() );
+
+            for ( auto stmt : evicted_->second.statements ) {
+                delete stmt;
+                ++_stats.evictions;
+            }
+
+            _stmt_pool.erase ( evicted_ );
+            _stmt_lru.pop_back();
+        }
+    }
+
+    cached_->second.statements.push_back ( statement );
+}
+Sqlite3Connection::Stats Sqlite3Connection::stats() {
+    std::lock_guard<std::mutex> lck ( _db_mtx );
+    return _stats;
 }
 unsigned long Sqlite3Connection::last_insert_rowid() {
     return sqlite3_last_insert_rowid ( _db.get() );
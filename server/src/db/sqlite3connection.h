@@ -17,6 +17,7 @@
 #ifndef SQLITE3CONNECTION_H
 #define SQLITE3CONNECTION_H
 
+#include <list>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -31,8 +32,22 @@ namespace db {
 /** \brief Connection implementation for SQLite. */
 class Sqlite3Connection {
 public:
+    /** \brief statement cache statistics */
+    struct Stats {
+        /** prepared statements taken from the cache */
+        size_t hits;
+        /** statements compiled */
+        size_t misses;
+        /** statements finalized to bound the cache */
+        size_t evictions;
+    };
 
-    Sqlite3Connection ( const std::string & path );
+    /**
+     * \brief Open the database.
+     * \param path the database file.
+     * \param read_only open the database read-only.
+     */
+    Sqlite3Connection ( const std::string & path, const bool read_only = false );
     Sqlite3Connection ( const Sqlite3Connection& other ) = delete;
     Sqlite3Connection& operator= ( const Sqlite3Connection& ) = delete;
     ~Sqlite3Connection();
@@ -57,14 +72,40 @@ public:
      */
     int last_changes_count();
 
+    /**
+     * \brief Register a deterministic text function for the sql statements of this connection.
+     * <p>NULL arguments return NULL, the function is not called.</p>
+     * \param name the sql function name.
+     * \param function the function.
+     * \throws DbException
+     */
+    void create_function ( const std::string & name, std::string ( *function ) ( const std::string & ) );
+
+    /** \brief get the statement cache statistics. */
+    Stats stats();
+
+    /** maximal number of distinct statements kept in the cache */
+    static const size_t STATEMENT_CACHE_SIZE;
+
 private:
+    /** time in milliseconds to wait for a locked database */
+    static const int BUSY_TIMEOUT;
+
     sqlite3_ptr _db;
     std::mutex _db_mtx;
-    std::map< std::string, std::vector< Sqlite3Statement * > > _stmt_pool;
+    struct CachedStatements {
+        std::vector< Sqlite3Statement * > statements;
+        std::list< std::string >::iterator lru;
+    };
+    std::map< std::string, CachedStatements > _stmt_pool;
+    /** the statement texts, the most recently used first */
+    std::list< std::string > _stmt_lru;
+    Stats _stats { 0, 0, 0 };
 
     /** \brief Release a statement. */
     void _release_statement ( Sqlite3Statement * statement );
 };
 typedef std::shared_ptr< Sqlite3Connection > ptr_connection;
+typedef std::shared_ptr< Sqlite3Connection > db_connection_ptr;
 } //namespace db
 #endif // SQLITE3CONNECTION_H
@@ -0,0 +1,167 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+#include "sqlite3connectionpool.h"
+
+namespace db {
+
+const size_t Sqlite3ConnectionPool::DEFAULT_READERS = 4;
+
+Sqlite3ConnectionPool::Sqlite3ConnectionPool ( const std::string & path, const size_t max_readers ) :
+    _path ( path ), _max_readers ( path == ":memory:" ? 0 : max_readers ),
+    _writer ( std::make_shared< Sqlite3Connection > ( path ) ), _transaction_open ( false ) {
+
+    //applies to new databases only, the free pages are returned by Sqlite3Maintenance.
+    _writer->exec ( "PRAGMA auto_vacuum=INCREMENTAL;" );
+
+    if ( _max_readers > 0 ) {
+        _writer->exec ( "PRAGMA journal_mode=WAL;" );
+        _writer->exec ( "PRAGMA synchronous=NORMAL;" );
+    }
+}
+
+db_connection_ptr Sqlite3ConnectionPool::reader() {
+    //the readers checked out by this thread.
+    static thread_local std::map< const Sqlite3ConnectionPool*, std::weak_ptr< Sqlite3Connection > > leases_;
+
+    if ( _max_readers == 0 || in_transaction() ) {
+        return _writer;
+    }
+
+    db_connection_ptr lease_ = leases_[ this ].lock();
+
+    if ( lease_ ) {
+        return lease_;
+    }
+
+    std::unique_lock< std::mutex > lck ( _mtx );
+    ++_stats.checkouts;
+
+    if ( _free_readers.empty() && _readers.size() < _max_readers ) {
+        _readers.push_back ( std::unique_ptr< Sqlite3Connection > ( new Sqlite3Connection ( _path, true ) ) );
+        _free_readers.push_back ( _readers.back().get() );
+        ++_stats.readers;
+    }
+
+    if ( _free_readers.empty() ) {
+        auto start_ = std::chrono::steady_clock::now();
+        _cv.wait ( lck, [this] { return ! _free_readers.empty(); } );
+        const size_t wait_us_ = std::chrono::duration_cast< std::chrono::microseconds > (
+                                    std::chrono::steady_clock::now() - start_ ).count();
+        ++_stats.waits;
+        _stats.wait_time_us += wait_us_;
+
+        if ( wait_us_ > _stats.max_wait_us ) {
+            _stats.max_wait_us = wait_us_;
+        }
+    }
+
+    Sqlite3Connection * connection_ = _free_readers.back();
+    _free_readers.pop_back();
+    lck.unlock();
+
+    lease_ = db_connection_ptr ( connection_, std::bind ( &Sqlite3ConnectionPool::_release, this, std::placeholders::_1 ) );
+    leases_[ this ] = lease_;
+    return lease_;
+}
+
+void Sqlite3ConnectionPool::begin_transaction() {
+    const int res_ = _writer->exec ( "BEGIN;" );
+
+    if ( res_ != SQLITE_OK ) {
+        throw DbException ( res_, sqlite3_errstr ( res_ ) );
+    }
+
+    join_transaction ( std::this_thread::get_id() );
+}
+
+void Sqlite3ConnectionPool::join_transaction ( const std::thread::id & thread ) {
+    std::lock_guard< std::mutex > lck ( _transaction_mtx );
+
+    if ( std::find ( _transaction_threads.begin(), _transaction_threads.end(), thread ) == _transaction_threads.end() ) {
+        _transaction_threads.push_back ( thread );
+    }
+
+    _transaction_open.store ( true );
+}
+
+void Sqlite3ConnectionPool::end_transaction() {
+    //the readers switch after the commit, the transaction stays open when it fails.
+    const int res_ = _writer->exec ( "END;" );
+
+    if ( res_ != SQLITE_OK ) {
+        throw DbException ( res_, sqlite3_errstr ( res_ ) );
+    }
+
+    _clear_transaction();
+}
+
+void Sqlite3ConnectionPool::rollback_transaction() {
+    const int res_ = _writer->exec ( "ROLLBACK;" );
+    _clear_transaction();
+
+    if ( res_ != SQLITE_OK ) {
+        throw DbException ( res_, sqlite3_errstr ( res_ ) );
+    }
+}
+
+void Sqlite3ConnectionPool::_clear_transaction() {
+    std::lock_guard< std::mutex > lck ( _transaction_mtx );
+    _transaction_threads.clear();
+    _transaction_open.store ( false );
+}
+
+bool Sqlite3ConnectionPool::in_transaction() {
+    if ( ! _transaction_open.load() ) {
+        return false;
+    }
+
+    std::lock_guard< std::mutex > lck ( _transaction_mtx );
+    return std::find ( _transaction_threads.begin(), _transaction_threads.end(), std::this_thread::get_id() ) != _transaction_threads.end();
+}
+
+Sqlite3ConnectionPool::Stats Sqlite3ConnectionPool::stats() {
+    std::lock_guard< std::mutex > lck ( _mtx );
+    Stats stats_ = _stats;
+
+    auto add_ = [&stats_] ( Sqlite3Connection * connection ) {
+        Sqlite3Connection::Stats connection_stats_ = connection->stats();
+        stats_.statement_hits += connection_stats_.hits;
+        stats_.statement_misses += connection_stats_.misses;
+        stats_.statement_evictions += connection_stats_.evictions;
+    };
+
+    add_ ( _writer.get() );
+
+    for ( auto & reader : _readers ) {
+        add_ ( reader.get() );
+    }
+
+    return stats_;
+}
+
+void Sqlite3ConnectionPool::_release ( Sqlite3Connection * connection ) {
+    {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        _free_readers.push_back ( connection );
+    }
+    _cv.notify_one();
+}
+} //namespace db
@@ -0,0 +1,127 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3CONNECTIONPOOL_H
+#define SQLITE3CONNECTIONPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sqlite3connection.h"
+
+namespace db {
+
+/**
+ * \brief Connection pool with one writer and several read-only connections in WAL mode.
+ *
+ * <p>Readers do not block the writer and see the last committed state of the database. A
+ * reader is checked out for the lifetime of the returned pointer. Nested checkouts on the
+ * same thread return the same connection. The thread owning the open write transaction
+ * gets the writer for its reads, so it sees its own uncommitted changes.</p>
+ */
+class Sqlite3ConnectionPool {
+public:
+    /** \brief pool statistics */
+    struct Stats {
+        /** number of reader checkouts */
+        size_t checkouts;
+        /** checkouts that had to wait for a free reader */
+        size_t waits;
+        /** total wait time in microseconds */
+        size_t wait_time_us;
+        /** longest wait time in microseconds */
+        size_t max_wait_us;
+        /** number of read-only connections opened */
+        size_t readers;
+        /** prepared statements taken from the statement caches */
+        size_t statement_hits;
+        /** statements compiled */
+        size_t statement_misses;
+        /** statements finalized to bound the statement caches */
+        size_t statement_evictions;
+    };
+
+    /**
+     * \brief Create the pool.
+     * \param path the database file.
+     * \param max_readers maximal number of read-only connections. 0 routes all reads to the writer.
+     */
+    Sqlite3ConnectionPool ( const std::string & path, const size_t max_readers = DEFAULT_READERS );
+    Sqlite3ConnectionPool ( const Sqlite3ConnectionPool& ) = delete;
+    Sqlite3ConnectionPool& operator= ( const Sqlite3ConnectionPool& ) = delete;
+    ~Sqlite3ConnectionPool() {}
+
+    /** \brief the writer connection. */
+    db_connection_ptr writer() const { return _writer; }
+    /**
+     * \brief check out a read-only connection.
+     * <p>Blocks until a reader is free when all readers are checked out.</p>
+     */
+    db_connection_ptr reader();
+
+    /**
+     * \brief begin the write transaction, reads of the calling thread use the writer until it ends.
+     * \throws DbException
+     */
+    void begin_transaction();
+    /** \brief reads of the thread use the writer until the transaction ends, it sees the changes made for it. */
+    void join_transaction ( const std::thread::id & thread );
+    /**
+     * \brief commit the write transaction.
+     * \throws DbException the transaction stays open.
+     */
+    void end_transaction();
+    /**
+     * \brief roll back the write transaction, the readers switch back in any case.
+     * \throws DbException
+     */
+    void rollback_transaction();
+    /** \brief the calling thread takes part in the write transaction. */
+    bool in_transaction();
+
+    /** \brief get the statistics. */
+    Stats stats();
+
+    /** default number of read-only connections */
+    static const size_t DEFAULT_READERS;
+
+private:
+    const std::string _path;
+    const size_t _max_readers;
+
+    db_connection_ptr _writer;
+    /* the threads reading through the writer, the first one owns the transaction. */
+    std::atomic< bool > _transaction_open;
+    std::mutex _transaction_mtx;
+    std::vector< std::thread::id > _transaction_threads;
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::vector< std::unique_ptr< Sqlite3Connection > > _readers;
+    std::vector< Sqlite3Connection * > _free_readers;
+    Stats _stats { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    void _release ( Sqlite3Connection * connection );
+    void _clear_transaction();
+};
+typedef std::shared_ptr< Sqlite3ConnectionPool > db_pool_ptr;
+} //namespace db
+#endif // SQLITE3CONNECTIONPOOL_H
@@ -21,10 +21,13 @@
 namespace db {
 
 db_connection_ptr Sqlite3Database::connection ( const std::string & path ) {
+    return pool ( path )->writer();
+}
+db_pool_ptr Sqlite3Database::pool ( const std::string & path ) {
 	std::lock_guard<std::mutex> lck ( mtx_ );
 
 	if ( connections_.find ( path ) == connections_.end() ) {
-        connections_[ path ] = std::shared_ptr< Sqlite3Connection > ( new Sqlite3Connection ( path ) );
+        connections_[ path ] = std::make_shared< Sqlite3ConnectionPool > ( path );
 	}
 
 	return connections_[ path ];
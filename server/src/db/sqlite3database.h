@@ -20,11 +20,10 @@
 #define SQLITE3DATABASE_H
 
 #include "sqlite3connection.h"
+#include "sqlite3connectionpool.h"
 
 namespace db {
 
-typedef std::shared_ptr< Sqlite3Connection > db_connection_ptr;
-
 /** @brief The Sqlite3 database manager class. */
 class Sqlite3Database {
 public:
@@ -37,13 +36,15 @@ public:
 		return instance;
 	}
 
-    /** \brief Create a connection to the database */
+    /** \brief Get the writer connection to the database */
 	db_connection_ptr connection ( const std::string & path );
+    /** \brief Get the connection pool of the database */
+    db_pool_ptr pool ( const std::string & path );
 
 private:
     Sqlite3Database() = default;
 
-	std::map< std::string, db_connection_ptr > connections_;
+	std::map< std::string, db_pool_ptr > connections_;
 	std::mutex mtx_;
 };
 } //db
@@ -0,0 +1,133 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <boost/algorithm/string.hpp>
+
+#include "sqlite3keysetcache.h"
+
+namespace db {
+
+const size_t Sqlite3KeysetCache::DEFAULT_QUERIES = 64;
+const size_t Sqlite3KeysetCache::DEFAULT_CHECKPOINTS = 256;
+
+void Sqlite3KeysetCache::select ( Sqlite3QueryBuilder & query, const std::string & column, const std::string & rowid, const size_t count ) {
+    if ( seekable ( column, count ) ) {
+        query << ", ";
+        query.column ( column );
+
+        if ( ! rowid.empty() ) {
+            query << ", ";
+            query.column ( rowid );
+        }
+    }
+}
+
+void Sqlite3KeysetCache::clear() {
+    std::lock_guard< std::mutex > lck ( _mtx );
+    _queries.clear();
+    _lru.clear();
+    ++_generation;
+}
+
+Sqlite3KeysetCache::Stats Sqlite3KeysetCache::stats() {
+    std::lock_guard< std::mutex > lck ( _mtx );
+    return _stats;
+}
+
+size_t Sqlite3KeysetCache::generation() {
+    std::lock_guard< std::mutex > lck ( _mtx );
+    return _generation;
+}
+
+bool Sqlite3KeysetCache::find ( const std::string & query, const size_t start_index, size_t & offset, Keyset & keyset ) {
+    std::lock_guard< std::mutex > lck ( _mtx );
+    auto query_ = _queries.find ( query );
+
+    if ( query_ != _queries.end() ) {
+        _lru.splice ( _lru.begin(), _lru, query_->second.lru );
+        //the nearest checkpoint at or before the start index.
+        auto checkpoint_ = query_->second.offsets.upper_bound ( start_index );
+
+        if ( checkpoint_ != query_->second.offsets.begin() ) {
+            --checkpoint_;
+            offset = checkpoint_->first;
+            keyset = checkpoint_->second;
+            ++_stats.seeks;
+            return true;
+        }
+    }
+
+    ++_stats.scans;
+    return false;
+}
+
+void Sqlite3KeysetCache::put ( const std::string & query, const size_t generation, const size_t offset, const Keyset & keyset ) {
+    std::lock_guard< std::mutex > lck ( _mtx );
+
+    if ( generation != _generation ) {
+        return; //the data changed while the page was read.
+    }
+
+    auto query_ = _queries.find ( query );
+
+    if ( query_ == _queries.end() ) {
+        if ( _queries.size() >= _max_queries ) {
+            _queries.erase ( _lru.back() );
+            _lru.pop_back();
+        }
+
+        _lru.push_front ( query );
+        query_ = _queries.insert ( std::make_pair ( query, Checkpoints { std::map< size_t, Keyset >(), _lru.begin() } ) ).first;
+
+    } else { _lru.splice ( _lru.begin(), _lru, query_->second.lru ); }
+
+    std::map< size_t, Keyset > & offsets_ = query_->second.offsets;
+
+    if ( offsets_.find ( offset ) == offsets_.end() && offsets_.size() >= _max_checkpoints ) {
+        //the first pages are cheap to read with the offset.
+        offsets_.erase ( offsets_.begin() );
+    }
+
+    offsets_[ offset ] = keyset;
+    ++_stats.checkpoints;
+}
+
+void Sqlite3KeysetCache::seek ( Sqlite3QueryBuilder & query, const std::string & column, const std::string & direction,
+                                const std::string & rowid, const Keyset & keyset ) {
+    const bool desc_ = boost::algorithm::to_lower_copy ( direction ) == "desc";
+    query << " and ( ";
+
+    if ( rowid.empty() ) {
+        query.column ( column ) << ( desc_ ? " < " : " > " );
+        query.value ( keyset.key );
+
+    } else {
+        query << "( ";
+        query.column ( column ) << ", ";
+        query.column ( rowid ) << " ) " << ( desc_ ? "<" : ">" ) << " ( ";
+        query.value ( keyset.key ) << ", ";
+        query.value ( keyset.rowid ) << " )";
+    }
+
+    //NULL keys are sorted first, in descending order they follow the checkpoint.
+    if ( desc_ ) {
+        query << " or ";
+        query.column ( column ) << " is null";
+    }
+
+    query << " )";
+}
+} //namespace db
@@ -0,0 +1,179 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3KEYSETCACHE_H
+#define SQLITE3KEYSETCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "sqlite3connection.h"
+#include "sqlite3querybuilder.h"
+
+namespace db {
+
+/**
+ * \brief Keyset pagination for sorted queries.
+ *
+ * <p>A page with limit ?, ? makes SQLite step over all rows before the start index. The cache keeps
+ * the position after the last row of every page read: the sort key and the ROWID of the row at the
+ * offset. The next request at or after this offset continues with "(key, ROWID) > (?, ?)" from the
+ * nearest checkpoint and only skips the rows between the checkpoint and the start index.</p>
+ *
+ * <p>The checkpoints are hints: clear() drops them when the data changes, a request without a
+ * checkpoint reads the page with the offset.</p>
+ */
+class Sqlite3KeysetCache {
+public:
+    /** \brief position after a row of the result. */
+    struct Keyset {
+        /** the sort key of the row */
+        std::string key;
+        /** the ROWID of the row */
+        int64_t rowid;
+    };
+
+    /** \brief cache statistics */
+    struct Stats {
+        /** pages read from a checkpoint */
+        size_t seeks;
+        /** pages read with the offset */
+        size_t scans;
+        /** checkpoints stored */
+        size_t checkpoints;
+    };
+
+    /**
+     * \brief Create the cache.
+     * \param max_queries number of queries with checkpoints, the least recently used query is dropped.
+     * \param max_checkpoints number of checkpoints per query, the smallest offset is dropped.
+     */
+    explicit Sqlite3KeysetCache ( const size_t max_queries = DEFAULT_QUERIES, const size_t max_checkpoints = DEFAULT_CHECKPOINTS ) :
+        _max_queries ( max_queries ), _max_checkpoints ( max_checkpoints ) {}
+    Sqlite3KeysetCache ( const Sqlite3KeysetCache& ) = delete;
+    Sqlite3KeysetCache& operator= ( const Sqlite3KeysetCache& ) = delete;
+    ~Sqlite3KeysetCache() {}
+
+    /** \brief a query can seek when it is sorted by one column and reads a page. */
+    static bool seekable ( const std::string & column, const size_t count ) {
+        return count > 0 && ! column.empty() && column.find ( ',' ) == std::string::npos;
+    }
+
+    /**
+     * \brief append the sort key and the tiebreak column to the select list when the query can seek.
+     * \param query the query after the selected columns.
+     * \param column the sort column.
+     * \param rowid the unique tiebreak column, empty when the sort key is unique.
+     * \param count the page size.
+     */
+    static void select ( Sqlite3QueryBuilder & query, const std::string & column, const std::string & rowid, const size_t count );
+
+    /**
+     * \brief read the page.
+     * <p>Appends the keyset condition, the order by and the limit clause to the query. The query
+     * must end with a where clause, the selected columns must end with the columns from select().
+     * read is called for every row of the page.</p>
+     * \throws DbException
+     */
+    template< typename F >
+    void page ( db_connection_ptr db, Sqlite3QueryBuilder & query, const std::string & column, const std::string & direction,
+                const std::string & rowid, const size_t start_index, const size_t result_count, F read ) {
+
+        if ( ! seekable ( column, result_count ) ) {
+            query.order_by ( column, direction );
+            query.limit ( start_index, result_count );
+            db_statement_ptr stmt_ = query.prepare ( db );
+
+            while ( stmt_->step() ) {
+                read ( stmt_.get() );
+            }
+
+            return;
+        }
+
+        const std::string key_ = query.key() + '\x1f' + column + ' ' + direction + ' ' + rowid;
+        const size_t generation_ = generation();
+        size_t offset_ = 0;
+        Keyset keyset_;
+
+        if ( start_index > 0 && find ( key_, start_index, offset_, keyset_ ) ) {
+            seek ( query, column, direction, rowid, keyset_ );
+        }
+
+        query.order_by ( column, direction );
+
+        if ( ! rowid.empty() ) {
+            query << ", ";
+            query.column ( rowid ) << " " << direction;
+        }
+
+        query.limit ( start_index - offset_, result_count );
+        db_statement_ptr stmt_ = query.prepare ( db );
+        const int key_index_ = stmt_->column_count() - ( rowid.empty() ? 1 : 2 );
+        size_t rows_ = 0;
+        bool last_null_ = true;
+
+        while ( stmt_->step() ) {
+            read ( stmt_.get() );
+            ++rows_;
+
+            if ( ! ( last_null_ = stmt_->is_null ( key_index_ ) ) ) {
+                stmt_->get_text ( key_index_, keyset_.key );
+                keyset_.rowid = ( rowid.empty() ? 0 : stmt_->get_int64 ( key_index_ + 1 ) );
+            }
+        }
+
+        //NULL keys can not be compared, the next page of such a query reads with the offset.
+        if ( rows_ > 0 && ! last_null_ ) {
+            put ( key_, generation_, start_index + rows_, keyset_ );
+        }
+    }
+
+    /** \brief drop all checkpoints, pages read before are not stored. */
+    void clear();
+    /** \brief get the statistics. */
+    Stats stats();
+
+    /** default number of queries */
+    static const size_t DEFAULT_QUERIES;
+    /** default number of checkpoints per query */
+    static const size_t DEFAULT_CHECKPOINTS;
+
+private:
+    const size_t _max_queries, _max_checkpoints;
+
+    std::mutex _mtx;
+    struct Checkpoints {
+        std::map< size_t, Keyset > offsets;
+        std::list< std::string >::iterator lru;
+    };
+    std::map< std::string, Checkpoints > _queries;
+    /** the query keys, the most recently used first */
+    std::list< std::string > _lru;
+    size_t _generation = 0;
+    Stats _stats { 0, 0, 0 };
+
+    size_t generation();
+    bool find ( const std::string & query, const size_t start_index, size_t & offset, Keyset & keyset );
+    void put ( const std::string & query, const size_t generation, const size_t offset, const Keyset & keyset );
+    static void seek ( Sqlite3QueryBuilder & query, const std::string & column, const std::string & direction,
+                       const std::string & rowid, const Keyset & keyset );
+};
+} //namespace db
+#endif // SQLITE3KEYSETCACHE_H
@@ -0,0 +1,224 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "sqlite3maintenance.h"
+
+namespace db {
+
+const std::chrono::minutes Sqlite3Maintenance::DEFAULT_INTERVAL ( 24 * 60 );
+const std::chrono::milliseconds Sqlite3Maintenance::DEFAULT_BUDGET ( 10000 );
+
+Sqlite3Maintenance::Sqlite3Maintenance ( db_writer_ptr writer, const std::vector< std::string > & queries, const std::chrono::minutes interval,
+        const std::chrono::milliseconds budget, std::function< void ( const Report& ) > done ) :
+    _writer ( writer ), _queries ( queries ), _interval ( interval ), _budget ( budget ), _done ( done ) {
+    _thread = std::thread ( &Sqlite3Maintenance::_run, this );
+}
+
+Sqlite3Maintenance::~Sqlite3Maintenance() {
+    {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        _stop = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+}
+
+void Sqlite3Maintenance::schedule() {
+    {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        _scheduled = true;
+    }
+    _cv.notify_one();
+}
+
+Sqlite3Maintenance::Stats Sqlite3Maintenance::stats() {
+    std::lock_guard< std::mutex > lck ( _stats_mtx );
+    return _stats;
+}
+
+Sqlite3Maintenance::Report Sqlite3Maintenance::run ( const bool analyze ) {
+    const auto start_ = std::chrono::steady_clock::now();
+    const auto deadline_ = start_ + _budget;
+    const std::vector< std::string > & queries_ = _queries;
+    Report report_ { analyze, 0, 0, 0, 0, 0, 0, 0, {}, false, 0, "" };
+
+    const std::map< std::string, std::string > plans_ = _writer->submit ( [&queries_] ( db_connection_ptr db ) {
+        return _plans ( db, queries_ );
+    }, true ).get();
+    Size size_ = _writer->submit ( &Sqlite3Maintenance::_size, true ).get();
+    report_.page_size = size_.page_size;
+    report_.pages_before = size_.pages;
+    report_.free_pages_before = size_.free_pages;
+
+    //the planner statistics, ANALYZE samples the indexes.
+    _writer->submit ( [analyze] ( db_connection_ptr db ) {
+        _step ( db, "PRAGMA analysis_limit = " + std::to_string ( ANALYSIS_LIMIT ) + ";" );
+        _step ( db, ( analyze ? "ANALYZE;" : "PRAGMA optimize;" ) );
+    }, true ).get();
+
+    //one step at a time, the queued writes run in between.
+    if ( size_.auto_vacuum == 2 ) {
+        while ( size_.free_pages > 0 && std::chrono::steady_clock::now() < deadline_ ) {
+            const size_t pages_ = size_.pages;
+            size_ = _writer->submit ( [] ( db_connection_ptr db ) {
+                _step ( db, "PRAGMA incremental_vacuum( " + std::to_string ( VACUUM_PAGES ) + " );" );
+                return _size ( db );
+            }, true ).get();
+
+            if ( size_.pages >= pages_ ) {
+                break;
+            }
+
+            report_.vacuumed_pages += pages_ - size_.pages;
+        }
+
+        report_.truncated = ( size_.free_pages > 0 && std::chrono::steady_clock::now() >= deadline_ );
+    }
+
+    if ( std::chrono::steady_clock::now() < deadline_ ) {
+        //busy, frames in the WAL, frames checkpointed. -1 when the database is not in WAL mode.
+        const std::vector< int64_t > checkpoint_ = _writer->submit ( [] ( db_connection_ptr db ) {
+            return _step ( db, "PRAGMA wal_checkpoint( PASSIVE );" );
+        }, true ).get();
+
+        if ( checkpoint_.size() == 3 && checkpoint_[2] > 0 ) {
+            report_.checkpointed_frames = checkpoint_[2];
+        }
+
+    } else { report_.truncated = true; }
+
+    size_ = _writer->submit ( &Sqlite3Maintenance::_size, true ).get();
+    report_.pages_after = size_.pages;
+    report_.free_pages_after = size_.free_pages;
+
+    const std::map< std::string, std::string > new_plans_ = _writer->submit ( [&queries_] ( db_connection_ptr db ) {
+        return _plans ( db, queries_ );
+    }, true ).get();
+
+    for ( auto & plan : new_plans_ ) {
+        auto old_plan_ = plans_.find ( plan.first );
+
+        if ( old_plan_ != plans_.end() && old_plan_->second != plan.second ) {
+            report_.plans.push_back ( std::make_tuple ( plan.first, old_plan_->second, plan.second ) );
+        }
+    }
+
+    report_.duration_ms = std::chrono::duration_cast< std::chrono::milliseconds > ( std::chrono::steady_clock::now() - start_ ).count();
+    {
+        std::lock_guard< std::mutex > lck ( _stats_mtx );
+        ++_stats.runs;
+
+        if ( report_.truncated ) {
+            ++_stats.truncated_runs;
+        }
+
+        _stats.vacuumed_pages += report_.vacuumed_pages;
+        _stats.checkpointed_frames += report_.checkpointed_frames;
+        _stats.plan_changes += report_.plans.size();
+        _stats.bytes = report_.pages_after * report_.page_size;
+        _stats.last_run_ms = report_.duration_ms;
+    }
+    return report_;
+}
+
+void Sqlite3Maintenance::_run() {
+    std::unique_lock< std::mutex > lck ( _mtx );
+    auto next_ = std::chrono::steady_clock::now() + _interval;
+    auto ready_ = [this] { return _scheduled || _stop; };
+
+    while ( true ) {
+        if ( _interval.count() == 0 ) {
+            _cv.wait ( lck, ready_ );
+
+        } else { _cv.wait_until ( lck, next_, ready_ ); }
+
+        if ( _stop ) {
+            break;
+        }
+
+        if ( ! _scheduled && std::chrono::steady_clock::now() < next_ ) {
+            continue;
+        }
+
+        const bool analyze_ = _scheduled;
+        _scheduled = false;
+        lck.unlock();
+
+        Report report_;
+
+        try {
+            report_ = run ( analyze_ );
+
+        } catch ( DbException & e ) {
+            report_ = Report { analyze_, 0, 0, 0, 0, 0, 0, 0, {}, true, 0, e.what() };
+        }
+
+        if ( _done ) {
+            _done ( report_ );
+        }
+
+        lck.lock();
+        next_ = std::chrono::steady_clock::now() + _interval;
+    }
+}
+
+Sqlite3Maintenance::Size Sqlite3Maintenance::_size ( db_connection_ptr db ) {
+    Size size_ { 0, 0, 0, 0 };
+    size_.auto_vacuum = static_cast< int > ( _step ( db, "PRAGMA auto_vacuum;" ).front() );
+    size_.page_size = _step ( db, "PRAGMA page_size;" ).front();
+    size_.pages = _step ( db, "PRAGMA page_count;" ).front();
+    size_.free_pages = _step ( db, "PRAGMA freelist_count;" ).front();
+    return size_;
+}
+
+std::map< std::string, std::string > Sqlite3Maintenance::_plans ( db_connection_ptr db, const std::vector< std::string > & queries ) {
+    std::map< std::string, std::string > plans_;
+
+    for ( auto & query : queries ) {
+        std::string plan_;
+        db_statement_ptr stmt_ = db->prepareStatement ( "EXPLAIN QUERY PLAN " + query );
+
+        while ( stmt_->step() ) {
+            plan_ += ( plan_.empty() ? "" : "; " ) + stmt_->get_string ( 3 );
+        }
+
+        plans_[ query ] = plan_;
+    }
+
+    return plans_;
+}
+
+std::vector< int64_t > Sqlite3Maintenance::_step ( db_connection_ptr db, const std::string & statement ) {
+    std::vector< int64_t > row_;
+    db_statement_ptr stmt_ = db->prepareStatement ( statement );
+
+    bool first_ = true;
+
+    while ( stmt_->step() ) {
+        for ( int i = 0; first_ && i < stmt_->column_count(); ++i ) {
+            row_.push_back ( stmt_->get_int64 ( i ) );
+        }
+
+        first_ = false;
+    }
+
+    if ( row_.empty() ) {
+        row_.push_back ( 0 );
+    }
+
+    return row_;
+}
+} //namespace db
@@ -0,0 +1,157 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3MAINTENANCE_H
+#define SQLITE3MAINTENANCE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "dbexception.h"
+#include "sqlite3writer.h"
+
+namespace db {
+
+/**
+ * \brief Background maintenance of the database.
+ *
+ * <p>The maintenance thread runs after schedule() and every interval. It refreshes the planner
+ * statistics, returns the free pages to the file system with incremental vacuum and checkpoints
+ * the WAL. Every step is an autocommit operation of the writer, queued writes run in between.
+ * ANALYZE reads at most ANALYSIS_LIMIT rows per index, the vacuum and the checkpoint are skipped
+ * when the time budget is used up.</p>
+ *
+ * <p>Incremental vacuum needs <code>auto_vacuum=INCREMENTAL</code>, which the connection pool sets
+ * for new databases. Older files keep their free pages until they are vacuumed once.</p>
+ */
+class Sqlite3Maintenance {
+public:
+    /** \brief the result of one run */
+    struct Report {
+        /** ANALYZE was run, otherwise PRAGMA optimize */
+        bool analyze;
+        size_t page_size;
+        size_t pages_before;
+        size_t pages_after;
+        size_t free_pages_before;
+        size_t free_pages_after;
+        /** pages removed from the file by incremental vacuum */
+        size_t vacuumed_pages;
+        /** WAL frames written to the database */
+        size_t checkpointed_frames;
+        /** the watched queries with a new plan: query, old plan, new plan */
+        std::vector< std::tuple< std::string, std::string, std::string > > plans;
+        /** steps were skipped because the budget was used up */
+        bool truncated;
+        size_t duration_ms;
+        /** the message of the exception which stopped the run */
+        std::string error;
+    };
+
+    /** \brief maintenance statistics */
+    struct Stats {
+        size_t runs;
+        /** runs stopped by the budget */
+        size_t truncated_runs;
+        size_t vacuumed_pages;
+        size_t checkpointed_frames;
+        size_t plan_changes;
+        /** size of the database after the last run */
+        size_t bytes;
+        /** duration of the last run in milliseconds */
+        size_t last_run_ms;
+    };
+
+    /**
+     * \brief Start the maintenance thread.
+     * \param writer the writer executing the steps.
+     * \param queries the queries whose plans are compared before and after the run.
+     * \param interval time between the scheduled runs, 0 runs only after schedule().
+     * \param budget maximal duration of a run.
+     * \param done called by the maintenance thread with the report of every run.
+     */
+    Sqlite3Maintenance ( db_writer_ptr writer, const std::vector< std::string > & queries,
+                         const std::chrono::minutes interval = DEFAULT_INTERVAL,
+                         const std::chrono::milliseconds budget = DEFAULT_BUDGET,
+                         std::function< void ( const Report& ) > done = std::function< void ( const Report& ) >() );
+    Sqlite3Maintenance ( const Sqlite3Maintenance& ) = delete;
+    Sqlite3Maintenance& operator= ( const Sqlite3Maintenance& ) = delete;
+    /** \brief stop the maintenance thread, a running run is finished. */
+    ~Sqlite3Maintenance();
+
+    /** \brief run the maintenance with ANALYZE in the maintenance thread, after an import changed many rows. */
+    void schedule();
+    /**
+     * \brief run the maintenance in the calling thread.
+     * \param analyze run ANALYZE, otherwise PRAGMA optimize analyzes the tables with outdated statistics.
+     * \throws DbException
+     */
+    Report run ( const bool analyze );
+
+    /** \brief get the statistics. */
+    Stats stats();
+
+    /** default time between the scheduled runs */
+    static const std::chrono::minutes DEFAULT_INTERVAL;
+    /** default maximal duration of a run */
+    static const std::chrono::milliseconds DEFAULT_BUDGET;
+    /** rows read per index by ANALYZE */
+    static const int ANALYSIS_LIMIT = 1000;
+    /** pages freed by one incremental vacuum operation */
+    static const int VACUUM_PAGES = 1024;
+
+private:
+    struct Size {
+        int auto_vacuum;
+        size_t page_size;
+        size_t pages;
+        size_t free_pages;
+    };
+
+    db_writer_ptr _writer;
+    const std::vector< std::string > _queries;
+    const std::chrono::minutes _interval;
+    const std::chrono::milliseconds _budget;
+    std::function< void ( const Report& ) > _done;
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _scheduled = false;
+    bool _stop = false;
+
+    std::mutex _stats_mtx;
+    Stats _stats { 0, 0, 0, 0, 0, 0, 0 };
+
+    std::thread _thread;
+
+    void _run();
+    static Size _size ( db_connection_ptr db );
+    /* the query plans, the details of EXPLAIN QUERY PLAN separated by "; ". */
+    static std::map< std::string, std::string > _plans ( db_connection_ptr db, const std::vector< std::string > & queries );
+    /* step the statement to the end, returns the first row of integers. */
+    static std::vector< int64_t > _step ( db_connection_ptr db, const std::string & statement );
+};
+typedef std::shared_ptr< Sqlite3Maintenance > db_maintenance_ptr;
+} //namespace db
+#endif // SQLITE3MAINTENANCE_H
@@ -0,0 +1,123 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <iterator>
+
+#include "sqlite3objectcache.h"
+
+namespace db {
+
+const size_t Sqlite3ObjectCache::DEFAULT_BYTES = 16 * 1024 * 1024;
+const size_t Sqlite3ObjectCache::DEFAULT_SHARDS = 16;
+
+Sqlite3ObjectCache::Sqlite3ObjectCache ( const size_t max_bytes, const size_t shards ) :
+    _max_shard_bytes ( max_bytes / ( shards == 0 ? 1 : shards ) ) {
+    for ( size_t i = 0; i < ( shards == 0 ? 1 : shards ); ++i ) {
+        _shards.push_back ( std::unique_ptr< Shard > ( new Shard() ) );
+    }
+}
+
+void Sqlite3ObjectCache::erase ( const int64_t id ) {
+    Shard & shard_ = _shard ( id );
+    std::lock_guard< std::mutex > lck ( shard_.mtx );
+    //the objects read before are not stored.
+    ++_generation;
+    auto id_ = shard_.entries.find ( id );
+
+    if ( id_ != shard_.entries.end() ) {
+        std::vector< std::list< Entry >::iterator > entries_;
+
+        for ( auto & entry : id_->second ) {
+            entries_.push_back ( entry.second );
+        }
+
+        for ( auto & entry : entries_ ) {
+            _remove ( shard_, entry );
+        }
+    }
+}
+
+void Sqlite3ObjectCache::clear() {
+    ++_generation;
+
+    for ( auto & shard : _shards ) {
+        std::lock_guard< std::mutex > lck ( shard->mtx );
+        shard->lru.clear();
+        shard->entries.clear();
+        shard->stats.entries = 0;
+        shard->stats.bytes = 0;
+    }
+}
+
+Sqlite3ObjectCache::Stats Sqlite3ObjectCache::stats() {
+    Stats stats_ { 0, 0, 0, 0, 0 };
+
+    for ( auto & shard : _shards ) {
+        std::lock_guard< std::mutex > lck ( shard->mtx );
+        stats_.hits += shard->stats.hits;
+        stats_.misses += shard->stats.misses;
+        stats_.evictions += shard->stats.evictions;
+        stats_.entries += shard->stats.entries;
+        stats_.bytes += shard->stats.bytes;
+    }
+
+    return stats_;
+}
+
+void Sqlite3ObjectCache::_put ( const size_t generation, const int64_t id, const std::type_index & type,
+                                std::shared_ptr< const void > object, const size_t bytes ) {
+    if ( bytes > _max_shard_bytes ) {
+        return;
+    }
+
+    Shard & shard_ = _shard ( id );
+    std::lock_guard< std::mutex > lck ( shard_.mtx );
+
+    if ( generation != _generation.load() ) {
+        return; //the object changed while it was read.
+    }
+
+    auto & types_ = shard_.entries[ id ];
+    auto entry_ = types_.find ( type );
+
+    if ( entry_ != types_.end() ) {
+        _remove ( shard_, entry_->second );
+    }
+
+    shard_.lru.push_front ( Entry { id, type, object, bytes } );
+    shard_.entries[ id ][ type ] = shard_.lru.begin();
+    ++shard_.stats.entries;
+    shard_.stats.bytes += bytes;
+
+    while ( shard_.stats.bytes > _max_shard_bytes ) {
+        _remove ( shard_, std::prev ( shard_.lru.end() ) );
+        ++shard_.stats.evictions;
+    }
+}
+
+void Sqlite3ObjectCache::_remove ( Shard & shard, std::list< Entry >::iterator entry ) {
+    auto id_ = shard.entries.find ( entry->id );
+    id_->second.erase ( entry->type );
+
+    if ( id_->second.empty() ) {
+        shard.entries.erase ( id_ );
+    }
+
+    --shard.stats.entries;
+    shard.stats.bytes -= entry->bytes;
+    shard.lru.erase ( entry );
+}
+} //namespace db
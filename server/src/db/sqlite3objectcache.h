@@ -0,0 +1,141 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3OBJECTCACHE_H
+#define SQLITE3OBJECTCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <vector>
+
+namespace db {
+
+/**
+ * \brief Size bounded LRU cache of the objects read from the database.
+ *
+ * <p>The objects are stored by type and id. The cache is split in shards by id, every shard
+ * has its own lock, LRU list and share of the size limit. The size of an object is estimated
+ * by the caller.</p>
+ *
+ * <p>erase() and clear() change the generation. An object read before the change is
+ * not stored, put() gets the generation from before the read.</p>
+ */
+class Sqlite3ObjectCache {
+public:
+    /** \brief cache statistics */
+    struct Stats {
+        /** objects found */
+        size_t hits;
+        /** objects not found */
+        size_t misses;
+        /** objects dropped to stay in the size limit */
+        size_t evictions;
+        /** objects in the cache */
+        size_t entries;
+        /** estimated size of the objects in the cache */
+        size_t bytes;
+    };
+
+    /**
+     * \brief Create the cache.
+     * \param max_bytes size limit of the cache.
+     * \param shards number of shards.
+     */
+    explicit Sqlite3ObjectCache ( const size_t max_bytes = DEFAULT_BYTES, const size_t shards = DEFAULT_SHARDS );
+    Sqlite3ObjectCache ( const Sqlite3ObjectCache& ) = delete;
+    Sqlite3ObjectCache& operator= ( const Sqlite3ObjectCache& ) = delete;
+    ~Sqlite3ObjectCache() {}
+
+    /** \brief get the cached object of type T, nullptr when the object is not in the cache. */
+    template< typename T >
+    std::shared_ptr< const T > find ( const int64_t id ) {
+        Shard & shard_ = _shard ( id );
+        std::lock_guard< std::mutex > lck ( shard_.mtx );
+        auto id_ = shard_.entries.find ( id );
+
+        if ( id_ != shard_.entries.end() ) {
+            auto entry_ = id_->second.find ( std::type_index ( typeid ( T ) ) );
+
+            if ( entry_ != id_->second.end() ) {
+                shard_.lru.splice ( shard_.lru.begin(), shard_.lru, entry_->second );
+                ++shard_.stats.hits;
+                return std::static_pointer_cast< const T > ( entry_->second->object );
+            }
+        }
+
+        ++shard_.stats.misses;
+        return nullptr;
+    }
+
+    /**
+     * \brief store the object.
+     * \param generation the generation before the object was read.
+     * \param id the object id.
+     * \param o the object.
+     * \param bytes estimated size of the object.
+     */
+    template< typename T >
+    void put ( const size_t generation, const int64_t id, const T & o, const size_t bytes ) {
+        _put ( generation, id, std::type_index ( typeid ( T ) ), std::make_shared< const T > ( o ), bytes );
+    }
+
+    /** \brief drop the object with the id of all types. */
+    void erase ( const int64_t id );
+    /** \brief drop all objects. */
+    void clear();
+    /** \brief the generation, read before the object is read from the database. */
+    size_t generation() const { return _generation.load(); }
+    /** \brief get the statistics. */
+    Stats stats();
+
+    /** default size limit */
+    static const size_t DEFAULT_BYTES;
+    /** default number of shards */
+    static const size_t DEFAULT_SHARDS;
+
+private:
+    struct Entry {
+        int64_t id;
+        std::type_index type;
+        std::shared_ptr< const void > object;
+        size_t bytes;
+    };
+    struct Shard {
+        std::mutex mtx;
+        /** the entries, the most recently used first */
+        std::list< Entry > lru;
+        std::map< int64_t, std::map< std::type_index, std::list< Entry >::iterator > > entries;
+        Stats stats { 0, 0, 0, 0, 0 };
+    };
+
+    const size_t _max_shard_bytes;
+    std::vector< std::unique_ptr< Shard > > _shards;
+    std::atomic< size_t > _generation { 0 };
+
+    Shard & _shard ( const int64_t id ) {
+        return *_shards[ static_cast< uint64_t > ( id ) % _shards.size() ];
+    }
+    void _put ( const size_t generation, const int64_t id, const std::type_index & type,
+                std::shared_ptr< const void > object, const size_t bytes );
+    static void _remove ( Shard & shard, std::list< Entry >::iterator entry );
+};
+} //namespace db
+#endif // SQLITE3OBJECTCACHE_H
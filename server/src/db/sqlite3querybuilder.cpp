@@ -0,0 +1,141 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+
+#include <boost/algorithm/string.hpp>
+
+#include "sqlite3querybuilder.h"
+
+namespace db {
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::value ( const int64_t value ) {
+    _sql << "?";
+    _values.push_back ( Value { false, value, "" } );
+    return *this;
+}
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::value ( const std::string & value ) {
+    _sql << "?";
+    _values.push_back ( Value { true, 0, value } );
+    return *this;
+}
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::column ( const std::string & name ) {
+    if ( _columns.find ( name ) == _columns.end() ) {
+        throw DbException ( SQLITE_ERROR, "column not allowed: " + name );
+    }
+
+    _sql << name;
+    return *this;
+}
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::any_of ( const std::map< std::string, std::string > & filters, const std::string & skip ) {
+    bool is_first_ = true;
+
+    for ( auto & f : filters ) {
+        if ( f.first != skip ) {
+            if ( is_first_ ) { is_first_=false; }
+
+            else { _sql << " or "; }
+
+            column ( f.first );
+            _sql << "=";
+            value ( f.second );
+        }
+    }
+
+    return *this;
+}
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::order_by ( const std::string & columns, const std::string & direction ) {
+    if ( columns.empty() ) {
+        return *this;
+    }
+
+    std::vector< std::string > columns_;
+    boost::split ( columns_, columns, boost::is_any_of ( "," ) );
+    _sql << " order by ";
+    bool is_first_ = true;
+
+    for ( auto & c : columns_ ) {
+        //the column with its own direction or the direction of the clause.
+        std::vector< std::string > terms_;
+        const std::string column_ = boost::algorithm::trim_copy ( c );
+        boost::split ( terms_, column_, boost::is_any_of ( " \t" ), boost::token_compress_on );
+
+        if ( terms_.size() > 2 ) {
+            throw DbException ( SQLITE_ERROR, "sort column not allowed: " + column_ );
+        }
+
+        const std::string direction_ = boost::algorithm::to_lower_copy ( terms_.size() == 2 ? terms_[1] : direction );
+
+        if ( direction_ != "asc" && direction_ != "desc" ) {
+            throw DbException ( SQLITE_ERROR, "sort direction not allowed: " + ( terms_.size() == 2 ? terms_[1] : direction ) );
+        }
+
+        if ( is_first_ ) { is_first_=false; }
+
+        else { _sql << ", "; }
+
+        column ( terms_[0] );
+        _sql << " " << direction_;
+    }
+
+    return *this;
+}
+
+Sqlite3QueryBuilder & Sqlite3QueryBuilder::limit ( const int64_t start, const int64_t count ) {
+    if ( count > 0 ) {
+        _sql << " limit ";
+        value ( start );
+        _sql << ", ";
+        value ( count );
+    }
+
+    return *this;
+}
+
+std::string Sqlite3QueryBuilder::key() const {
+    std::stringstream key_;
+    key_ << _sql.str();
+
+    for ( auto & v : _values ) {
+        key_ << '\x1f';
+
+        if ( v.text ) {
+            key_ << "t" << v.str;
+
+        } else { key_ << "i" << v.integer; }
+    }
+
+    return key_.str();
+}
+
+db_statement_ptr Sqlite3QueryBuilder::prepare ( db_connection_ptr db ) const {
+    db_statement_ptr stmt_ = db->prepareStatement ( _sql.str() );
+    int index_ = 0;
+
+    for ( auto & v : _values ) {
+        if ( v.text ) {
+            stmt_->bind_text ( ++index_, v.str );
+
+        } else { stmt_->bind_int64 ( ++index_, v.integer ); }
+    }
+
+    return stmt_;
+}
+} //namespace db
@@ -0,0 +1,100 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3QUERYBUILDER_H
+#define SQLITE3QUERYBUILDER_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sqlite3connection.h"
+
+namespace db {
+
+/**
+ * \brief Build a statement with placeholders for the values.
+ *
+ * <p>Column names from filters and sort clauses are checked against the allowed columns, the
+ * values are bound when the statement is prepared. The same query with other values has the
+ * same statement text and the prepared statement is taken from the statement cache.</p>
+ */
+class Sqlite3QueryBuilder {
+public:
+    /**
+     * \brief Create the builder.
+     * \param columns the column names allowed in filters and sort clauses.
+     */
+    explicit Sqlite3QueryBuilder ( const std::set< std::string > & columns ) : _columns ( columns ) {}
+
+    /** \brief append trusted sql text. */
+    template< typename T >
+    Sqlite3QueryBuilder & operator<< ( const T & sql ) {
+        _sql << sql;
+        return *this;
+    }
+    /** \brief append a placeholder for the integer value. */
+    Sqlite3QueryBuilder & value ( const int64_t value );
+    /** \brief append a placeholder for the text value. */
+    Sqlite3QueryBuilder & value ( const std::string & value );
+    /**
+     * \brief append the column name.
+     * \throws DbException when the column is not allowed.
+     */
+    Sqlite3QueryBuilder & column ( const std::string & name );
+    /**
+     * \brief append "name=? or name=? ..." for the filters.
+     * \param filters the column names and values.
+     * \param skip filter name not added to the condition.
+     * \throws DbException when a column is not allowed.
+     */
+    Sqlite3QueryBuilder & any_of ( const std::map< std::string, std::string > & filters, const std::string & skip = "" );
+    /**
+     * \brief append the order by clause, nothing when the columns are empty.
+     * \param columns comma separated column names, a column may be followed by its own direction.
+     * \param direction asc or desc, the direction of the columns without direction.
+     * \throws DbException when a column or the direction is not allowed.
+     */
+    Sqlite3QueryBuilder & order_by ( const std::string & columns, const std::string & direction );
+    /** \brief append "limit ?, ?" when count is not 0. */
+    Sqlite3QueryBuilder & limit ( const int64_t start, const int64_t count );
+
+    /** \brief the statement text and the values, identifies the query for the keyset cache. */
+    std::string key() const;
+    /** \brief the statement text. */
+    std::string str() const { return _sql.str(); }
+    /**
+     * \brief prepare the statement and bind the values.
+     * \throws DbException
+     */
+    db_statement_ptr prepare ( db_connection_ptr db ) const;
+
+private:
+    struct Value {
+        bool text;
+        int64_t integer;
+        std::string str;
+    };
+
+    const std::set< std::string > & _columns;
+    std::stringstream _sql;
+    std::vector< Value > _values;
+};
+} //namespace db
+#endif // SQLITE3QUERYBUILDER_H
@@ -31,6 +31,20 @@ void Sqlite3Statement::bind_int ( const int & index, const int & value ) {
 		throw DbException ( res, std::string ( sqlite3_errmsg ( db_.get() ) ) );
 	}
 }
+void Sqlite3Statement::bind_int64 ( const int & index, const int64_t & value ) {
+	int res = sqlite3_bind_int64 ( stmt_.get(), index, value );
+
+	if ( res != SQLITE_OK ) {
+		throw DbException ( res, std::string ( sqlite3_errmsg ( db_.get() ) ) );
+	}
+}
+void Sqlite3Statement::bind_null ( const int & index ) {
+	int res = sqlite3_bind_null ( stmt_.get(), index );
+
+	if ( res != SQLITE_OK ) {
+		throw DbException ( res, std::string ( sqlite3_errmsg ( db_.get() ) ) );
+	}
+}
 void Sqlite3Statement::bind_text ( const int & index, const std::string & text ) {
     int res = sqlite3_bind_text ( stmt_.get(), index, text.c_str(), text.length(), SQLITE_TRANSIENT );
 
@@ -42,10 +56,27 @@ int Sqlite3Statement::get_int ( const int & position ) {
 	sqlite3_value* sql3_msgid = sqlite3_column_value ( stmt_.get(),position );
 	return sqlite3_value_int ( sql3_msgid );
 }
+int64_t Sqlite3Statement::get_int64 ( const int & position ) {
+	return sqlite3_column_int64 ( stmt_.get(), position );
+}
 std::string Sqlite3Statement::get_string ( const int & position ) {
+    std::string value;
+    get_text ( position, value );
+    return value;
+}
+void Sqlite3Statement::get_text ( const int & position, std::string & value ) {
     const unsigned char * text = sqlite3_column_text ( stmt_.get(),position );
-    if( text == nullptr ) return std::string();
-    else return std::string ( reinterpret_cast<const char*> ( text ) );
+    if( text == nullptr ) value.clear();
+    else value.assign ( reinterpret_cast<const char*> ( text ), sqlite3_column_bytes ( stmt_.get(), position ) );
+}
+bool Sqlite3Statement::is_null ( const int & position ) {
+	return sqlite3_column_type ( stmt_.get(), position ) == SQLITE_NULL;
+}
+bool Sqlite3Statement::is_integer ( const int & position ) {
+	return sqlite3_column_type ( stmt_.get(), position ) == SQLITE_INTEGER;
+}
+int Sqlite3Statement::column_count() {
+	return sqlite3_column_count ( stmt_.get() );
 }
 bool Sqlite3Statement::step() {
 	int step = sqlite3_step ( stmt_.get() );
@@ -19,6 +19,8 @@
 #ifndef SQLITE3STATEMENT_H
 #define SQLITE3STATEMENT_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -52,6 +54,19 @@ public:
 	 * \throws DAOException throws a DAOException
 	 */
 	void bind_int ( const int & index, const int & value );
+	/**
+	 * \brief Bind a 64 bit integer for a prepared statement.
+	 * \param index the index of the value
+	 * \param value the integer parameter
+	 * \throws DAOException throws a DAOException
+	 */
+	void bind_int64 ( const int & index, const int64_t & value );
+	/**
+	 * \brief Bind NULL for a prepared statement.
+	 * \param index the index of the value
+	 * \throws DAOException throws a DAOException
+	 */
+	void bind_null ( const int & index );
 	/**
 	 * \brief Bind text for a prepared statement.
 	 * \param index the index of the value
@@ -66,6 +81,12 @@ public:
 	 * \throws DAOException throws a DAOException
 	 */
 	int get_int ( const int & index );
+	/**
+	 * \brief  Get a 64 bit integer form a result set
+	 * \param index the index of the value
+	 * \return the integer value
+	 */
+	int64_t get_int64 ( const int & index );
 	/**
 	 * \brief Get a text from a result set.
 	 * \param index the index of the value
@@ -73,6 +94,29 @@ public:
 	 * \throws DAOException throws a DAOException
 	 */
 	std::string get_string ( const int & index );
+	/**
+	 * \brief Read a text from a result set into value.
+	 * <p>Uses the column size and reuses the capacity of value, NULL reads as empty string.</p>
+	 * \param index the index of the value
+	 * \param value the target string
+	 */
+	void get_text ( const int & index, std::string & value );
+	/**
+	 * \brief Check for a NULL value in the result set.
+	 * \param index the index of the value
+	 * \return true when the value is NULL
+	 */
+	bool is_null ( const int & index );
+	/**
+	 * \brief Check for an integer value in the result set.
+	 * \param index the index of the value
+	 * \return true when the value is stored as integer
+	 */
+	bool is_integer ( const int & index );
+	/**
+	 * \brief Get the number of columns in the result set.
+	 */
+	int column_count();
 	/**
 	 * \brief Step to the next result in the result set.
 	 * \return true when there is a next row, false otherwise.
@@ -0,0 +1,226 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <limits>
+
+#include "sqlite3writer.h"
+
+namespace db {
+
+const size_t Sqlite3Writer::DEFAULT_BATCH = 1000;
+const std::chrono::milliseconds Sqlite3Writer::DEFAULT_INTERVAL ( 500 );
+
+Sqlite3Writer::Sqlite3Writer ( db_pool_ptr pool, const size_t batch, const std::chrono::milliseconds interval, std::function< void() > committed ) :
+    _pool ( pool ), _batch ( batch == 0 ? std::numeric_limits< size_t >::max() : batch ), _interval ( interval ), _committed ( committed ),
+    _head ( new Operation ( std::function< void ( db_connection_ptr ) >(), nullptr ) ), _tail ( _head.load() ) {
+    _thread = std::thread ( &Sqlite3Writer::_run, this );
+}
+
+Sqlite3Writer::~Sqlite3Writer() {
+    {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        _stop.store ( true );
+    }
+    _cv.notify_one();
+    _thread.join();
+    delete _tail;
+}
+
+std::future< void > Sqlite3Writer::flush() {
+    flush_ptr flushed_ = std::make_shared< std::promise< void > >();
+    std::future< void > future_ = flushed_->get_future();
+    _push ( new Operation ( std::function< void ( db_connection_ptr ) >(), flushed_ ) );
+    return future_;
+}
+
+Sqlite3Writer::Stats Sqlite3Writer::stats() {
+    std::lock_guard< std::mutex > lck ( _stats_mtx );
+    Stats stats_ = _stats;
+    stats_.queue_depth = _depth.load();
+    stats_.max_queue_depth = _max_depth.load();
+    return stats_;
+}
+
+void Sqlite3Writer::_push ( Operation * operation ) {
+    Operation * prev_ = _head.exchange ( operation );
+    prev_->next.store ( operation );
+    const size_t depth_ = ++_depth;
+    size_t max_depth_ = _max_depth.load();
+
+    while ( depth_ > max_depth_ && ! _max_depth.compare_exchange_weak ( max_depth_, depth_ ) ) {}
+
+    if ( _sleeping.load() ) {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        _cv.notify_one();
+    }
+}
+
+bool Sqlite3Writer::_pop ( Task & task ) {
+    Operation * next_ = _tail->next.load();
+
+    if ( next_ == nullptr ) {
+        return false;
+    }
+
+    //the popped node is the new stub of the queue.
+    task = std::move ( next_->task );
+    delete _tail;
+    _tail = next_;
+    --_depth;
+    return true;
+}
+
+void Sqlite3Writer::_wait ( const std::chrono::steady_clock::time_point & deadline ) {
+    std::unique_lock< std::mutex > lck ( _mtx );
+    _sleeping.store ( true );
+    auto ready_ = [this] { return _depth.load() > 0 || _stop.load(); };
+
+    if ( deadline == std::chrono::steady_clock::time_point::max() ) {
+        _cv.wait ( lck, ready_ );
+
+    } else { _cv.wait_until ( lck, deadline, ready_ ); }
+
+    _sleeping.store ( false );
+}
+
+void Sqlite3Writer::_run() {
+    db_connection_ptr db_ = _pool->writer();
+    std::vector< flush_ptr > flushed_;
+    bool open_ = false;
+    size_t operations_ = 0;
+    std::chrono::steady_clock::time_point deadline_;
+
+    while ( true ) {
+        Task task_;
+
+        if ( ! _pop ( task_ ) ) {
+            if ( _depth.load() > 0 ) {
+                //a producer is linking its node.
+                std::this_thread::yield();
+
+            } else if ( open_ && ( _stop.load() || std::chrono::steady_clock::now() >= deadline_ ) ) {
+                _commit ( operations_, flushed_ );
+                open_ = false;
+
+            } else if ( _stop.load() ) {
+                break;
+
+            } else { _wait ( open_ ? deadline_ : std::chrono::steady_clock::time_point::max() ); }
+
+            continue;
+        }
+
+        if ( task_.flushed ) {
+            flushed_.push_back ( task_.flushed );
+
+            if ( open_ ) {
+                _commit ( operations_, flushed_ );
+                open_ = false;
+
+            } else { _commit ( 0, flushed_ ); }
+
+            continue;
+        }
+
+        if ( task_.autocommit ) {
+            if ( open_ ) {
+                _commit ( operations_, flushed_ );
+                open_ = false;
+            }
+
+            task_.run ( db_ );
+            continue;
+        }
+
+        if ( ! open_ ) {
+            try {
+                _pool->begin_transaction();
+                open_ = true;
+                operations_ = 0;
+                deadline_ = std::chrono::steady_clock::now() + _interval;
+
+            } catch ( DbException & ) {
+                //the operation runs in autocommit mode.
+            }
+        }
+
+        if ( open_ ) {
+            _pool->join_transaction ( task_.thread );
+        }
+
+        //packaged tasks store the exception in the future.
+        task_.run ( db_ );
+
+        if ( open_ && ( ++operations_ >= _batch || std::chrono::steady_clock::now() >= deadline_ ) ) {
+            _commit ( operations_, flushed_ );
+            open_ = false;
+        }
+    }
+}
+
+void Sqlite3Writer::_commit ( const size_t operations, std::vector< flush_ptr > & flushed ) {
+    auto start_ = std::chrono::steady_clock::now();
+
+    if ( operations > 0 ) {
+        try {
+            _pool->end_transaction();
+
+        } catch ( ... ) {
+            //the changes are lost, the next flush reports the failure.
+            _error = std::current_exception();
+
+            try {
+                _pool->rollback_transaction();
+
+            } catch ( DbException & ) {}
+        }
+
+        const size_t commit_us_ = std::chrono::duration_cast< std::chrono::microseconds > (
+                                      std::chrono::steady_clock::now() - start_ ).count();
+        {
+            std::lock_guard< std::mutex > lck ( _stats_mtx );
+            _stats.operations += operations;
+            ++_stats.commits;
+            _stats.commit_time_us += commit_us_;
+
+            if ( commit_us_ > _stats.max_commit_us ) {
+                _stats.max_commit_us = commit_us_;
+            }
+
+            if ( operations > _stats.max_batch ) {
+                _stats.max_batch = operations;
+            }
+        }
+
+        if ( _committed ) {
+            _committed();
+        }
+    }
+
+    for ( auto & f : flushed ) {
+        if ( _error ) {
+            f->set_exception ( _error );
+
+        } else { f->set_value(); }
+    }
+
+    if ( ! flushed.empty() ) {
+        _error = std::exception_ptr();
+    }
+
+    flushed.clear();
+}
+} //namespace db
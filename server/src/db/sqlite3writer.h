@@ -0,0 +1,160 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SQLITE3WRITER_H
+#define SQLITE3WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "dbexception.h"
+#include "sqlite3connectionpool.h"
+
+namespace db {
+
+/**
+ * \brief Single writer thread with group commit.
+ *
+ * <p>Any thread can submit write operations. The operations are queued in a lock-free
+ * queue and executed in order by the writer thread on the writer connection of the pool.
+ * The writer runs the operations in one transaction and commits after batch operations,
+ * after the interval or when flush() is called.</p>
+ *
+ * <p>The future of an operation is ready when the operation was executed, the changes are
+ * durable after the next commit. Until then the submitting thread reads through the
+ * writer connection and sees its own changes.</p>
+ */
+class Sqlite3Writer {
+public:
+    /** \brief writer statistics */
+    struct Stats {
+        /** operations executed */
+        size_t operations;
+        /** transactions committed */
+        size_t commits;
+        /** operations in the queue */
+        size_t queue_depth;
+        /** longest queue */
+        size_t max_queue_depth;
+        /** most operations in one commit */
+        size_t max_batch;
+        /** total commit time in microseconds */
+        size_t commit_time_us;
+        /** longest commit in microseconds */
+        size_t max_commit_us;
+    };
+
+    /**
+     * \brief Start the writer thread.
+     * \param pool the connection pool.
+     * \param batch maximal number of operations per commit, 0 for no limit.
+     * \param interval maximal time between the first operation and the commit.
+     * \param committed called by the writer thread after every commit.
+     */
+    Sqlite3Writer ( db_pool_ptr pool, const size_t batch = DEFAULT_BATCH,
+                    const std::chrono::milliseconds interval = DEFAULT_INTERVAL,
+                    std::function< void() > committed = std::function< void() >() );
+    Sqlite3Writer ( const Sqlite3Writer& ) = delete;
+    Sqlite3Writer& operator= ( const Sqlite3Writer& ) = delete;
+    /** \brief execute and commit the queued operations and stop the writer thread. */
+    ~Sqlite3Writer();
+
+    /**
+     * \brief queue the operation.
+     * <p>op is called with the writer connection, the future gets the result or the exception of op.</p>
+     * <p>With autocommit the open transaction is committed first and op runs outside of a transaction,
+     * for statements like <code>PRAGMA wal_checkpoint</code> which can not run in one.</p>
+     */
+    template< typename F >
+    std::future< typename std::result_of< F ( db_connection_ptr ) >::type > submit ( F op, const bool autocommit = false ) {
+        typedef typename std::result_of< F ( db_connection_ptr ) >::type result_t;
+        auto task_ = std::make_shared< std::packaged_task< result_t ( db_connection_ptr ) > > ( std::move ( op ) );
+        std::future< result_t > future_ = task_->get_future();
+        _push ( new Operation ( [task_] ( db_connection_ptr db ) { ( *task_ ) ( db ); }, nullptr, autocommit ) );
+        return future_;
+    }
+
+    /**
+     * \brief commit the open transaction, ready when the operations submitted before are durable.
+     * <p>The future gets the DbException of a failed commit since the last flush, the changes of
+     * that transaction are rolled back.</p>
+     */
+    std::future< void > flush();
+
+    /** \brief get the statistics. */
+    Stats stats();
+
+    /** default number of operations per commit */
+    static const size_t DEFAULT_BATCH;
+    /** default commit interval */
+    static const std::chrono::milliseconds DEFAULT_INTERVAL;
+
+private:
+    typedef std::shared_ptr< std::promise< void > > flush_ptr;
+
+    /* the queued operation, a flush request when flushed is set. */
+    struct Task {
+        std::function< void ( db_connection_ptr ) > run;
+        flush_ptr flushed;
+        std::thread::id thread;
+        bool autocommit;
+    };
+    struct Operation {
+        Operation ( std::function< void ( db_connection_ptr ) > run, flush_ptr flushed, const bool autocommit = false ) :
+            task { std::move ( run ), std::move ( flushed ), std::this_thread::get_id(), autocommit }, next ( nullptr ) {}
+        Task task;
+        std::atomic< Operation* > next;
+    };
+
+    db_pool_ptr _pool;
+    const size_t _batch;
+    const std::chrono::milliseconds _interval;
+    std::function< void() > _committed;
+
+    /* MPSC queue: producers exchange the head, the writer thread follows the next pointers from the tail. */
+    std::atomic< Operation* > _head;
+    Operation * _tail;
+    std::atomic< size_t > _depth { 0 }, _max_depth { 0 };
+
+    std::atomic< bool > _stop { false };
+    std::atomic< bool > _sleeping { false };
+    std::mutex _mtx;
+    std::condition_variable _cv;
+
+    std::mutex _stats_mtx;
+    Stats _stats { 0, 0, 0, 0, 0, 0, 0 };
+    /* the failed commit, reported to the next flush. used by the writer thread only. */
+    std::exception_ptr _error;
+
+    std::thread _thread;
+
+    void _push ( Operation * operation );
+    bool _pop ( Task & task );
+    void _wait ( const std::chrono::steady_clock::time_point & deadline );
+    void _run();
+    void _commit ( const size_t operations, std::vector< flush_ptr > & flushed );
+};
+typedef std::shared_ptr< Sqlite3Writer > db_writer_ptr;
+} //namespace db
+#endif // SQLITE3WRITER_H
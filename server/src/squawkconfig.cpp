@@ -46,6 +46,11 @@ const std::string SquawkConfig::HELP_TEXT = "Options description: \n" \
 "\t--local-address arg      multicast local IP\n" \
 "\t--multicast-address arg  multicast address\n" \
 "\t--multicast-port arg     multicast port\n " \
+"\t--commit-batch arg       writes per database commit.\n" \
+"\t--commit-interval arg    maximal delay of a database commit in milliseconds.\n" \
+"\t--catalog-snapshot arg   answer browse requests from an in-memory copy of the catalog (true|false).\n" \
+"\t--maintenance-interval arg minutes between the database maintenance runs, 0 only after scans.\n" \
+"\t--import-workers arg     threads probing the media files, 0 for one per core.\n" \
 "\t--cover-names arg        names to use as cover (without extension)\n ";
 
 std::string SquawkConfig::name() {
@@ -95,7 +100,24 @@ std::string SquawkConfig::uuid() {
     return store[ CONFIG_UUID ].front();
 }
 std::list< std::string > SquawkConfig::coverNames() {
-    return store[ CONFIG_COVER_NAMES];
+    //called by the import workers, do not insert the key.
+    auto cover_names_ = store.find( CONFIG_COVER_NAMES );
+    return ( cover_names_ != store.end() ? cover_names_->second : std::list< std::string >() );
+}
+size_t SquawkConfig::commitBatch() {
+    return std::stoul( store[ CONFIG_COMMIT_BATCH ].front() );
+}
+size_t SquawkConfig::commitInterval() {
+    return std::stoul( store[ CONFIG_COMMIT_INTERVAL ].front() );
+}
+bool SquawkConfig::catalogSnapshot() {
+    return store[ CONFIG_CATALOG_SNAPSHOT ].front() == "true";
+}
+size_t SquawkConfig::maintenanceInterval() {
+    return std::stoul( store[ CONFIG_MAINTENANCE_INTERVAL ].front() );
+}
+size_t SquawkConfig::importWorkers() {
+    return std::stoul( store[ CONFIG_IMPORT_WORKERS ].front() );
 }
 
 bool SquawkConfig::validate() {
@@ -131,6 +153,16 @@ bool SquawkConfig::validate() {
         setValue(CONFIG_MULTICAST_PORT, "1900");
     } if(store.find( CONFIG_HTTP_PORT ) == store.end()) {
         setValue(CONFIG_HTTP_PORT, "8080");
+    } if(store.find( CONFIG_COMMIT_BATCH ) == store.end()) {
+        setValue(CONFIG_COMMIT_BATCH, "1000");
+    } if(store.find( CONFIG_COMMIT_INTERVAL ) == store.end()) {
+        setValue(CONFIG_COMMIT_INTERVAL, "500");
+    } if(store.find( CONFIG_CATALOG_SNAPSHOT ) == store.end()) {
+        setValue(CONFIG_CATALOG_SNAPSHOT, "false");
+    } if(store.find( CONFIG_MAINTENANCE_INTERVAL ) == store.end()) {
+        setValue(CONFIG_MAINTENANCE_INTERVAL, "1440");
+    } if(store.find( CONFIG_IMPORT_WORKERS ) == store.end()) {
+        setValue(CONFIG_IMPORT_WORKERS, "0");
     } if(store.find( CONFIG_UUID ) == store.end()) {
         uuid_t out;
         uuid_generate_random((unsigned char *)&out);
@@ -232,6 +264,16 @@ bool SquawkConfig::parse(int ac, const char* av[]) {
                 setValue(CONFIG_MULTICAST_ADDRESS, std::string(av[++i]));
             } else if(std::string(av[i]) == std::string("--multicast-port")) {
                 setValue(CONFIG_MULTICAST_PORT, std::string(av[++i]));
+            } else if(std::string(av[i]) == std::string("--commit-batch")) {
+                setValue(CONFIG_COMMIT_BATCH, std::string(av[++i]));
+            } else if(std::string(av[i]) == std::string("--commit-interval")) {
+                setValue(CONFIG_COMMIT_INTERVAL, std::string(av[++i]));
+            } else if(std::string(av[i]) == std::string("--catalog-snapshot")) {
+                setValue(CONFIG_CATALOG_SNAPSHOT, std::string(av[++i]));
+            } else if(std::string(av[i]) == std::string("--maintenance-interval")) {
+                setValue(CONFIG_MAINTENANCE_INTERVAL, std::string(av[++i]));
+            } else if(std::string(av[i]) == std::string("--import-workers")) {
+                setValue(CONFIG_IMPORT_WORKERS, std::string(av[++i]));
             } else if(std::string(av[i]) == std::string("--cover-names")) {
                 typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
                 tokenizer tok{ std::string( av[++i] ) };
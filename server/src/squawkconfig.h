@@ -62,6 +62,16 @@ public:
     std::string uuid();
     /** @brief the cover name*/
     std::list< std::string > coverNames();
+    /** @brief the number of writes per database commit */
+    size_t commitBatch();
+    /** @brief the maximal time between a write and its commit in milliseconds */
+    size_t commitInterval();
+    /** @brief answer the browse requests from the in-memory catalog snapshot */
+    bool catalogSnapshot();
+    /** @brief minutes between the database maintenance runs */
+    size_t maintenanceInterval();
+    /** @brief the number of media import workers, 0 for one per core */
+    size_t importWorkers();
 
     std::map< std::string, std::list< std::string > > getMap() const {
         return store;
@@ -153,6 +163,11 @@ private:
     std::string CONFIG_HTTP_DOCROOT = "http-docroot";
     std::string CONFIG_HTTP_BOWER = "http-bower";
     std::string CONFIG_SERVER_NAME = "server-name";
+    std::string CONFIG_COMMIT_BATCH = "commit-batch";
+    std::string CONFIG_COMMIT_INTERVAL = "commit-interval";
+    std::string CONFIG_CATALOG_SNAPSHOT = "catalog-snapshot";
+    std::string CONFIG_MAINTENANCE_INTERVAL = "maintenance-interval";
+    std::string CONFIG_IMPORT_WORKERS = "import-workers";
 };
 typedef std::shared_ptr< SquawkConfig > ptr_squawk_config;
 }
@@ -48,12 +48,20 @@
 
 namespace squawk {
 
-void SquawkServer::start( squawk::SquawkConfig * squawk_config ) {
+void SquawkServer::open( squawk::SquawkConfig * squawk_config ) {
 
     _squawk_config = std::shared_ptr< squawk::SquawkConfig >(squawk_config);
 
-    /** Create the Server **/
     _upnp_cds_dao = std::shared_ptr< squawk::UpnpContentDirectoryDao >( new squawk::UpnpContentDirectoryDao() );
+    if( squawk_config->catalogSnapshot() ) {
+        _upnp_cds_dao->publishSnapshot();
+    }
+}
+
+void SquawkServer::start( squawk::SquawkConfig * squawk_config ) {
+
+    /** Create the Server **/
+    open( squawk_config );
     _upnp_file_parser = std::shared_ptr< squawk::UpnpContentDirectoryParser >( new squawk::UpnpContentDirectoryParser() );
 
 
@@ -74,7 +82,7 @@ void SquawkServer::start( squawk::SquawkConfig * squawk_config ) {
     web_server->register_servlet( std::unique_ptr< http::HttpServlet >( new squawk::UpnpConnectionManager( "/ctl/ConnectionMgr" ) ) );
     web_server->register_servlet( std::unique_ptr< http::HttpServlet >( new squawk::UpnpXmlDescription( "/rootDesc.xml" ) ) );
     web_server->register_servlet( std::unique_ptr< http::HttpServlet >(
-        new squawk::UpnpContentDirectoryApi( "/api/(upnp/device|upnp/event|album|artist|track|browse|statistic)/?(\\d*)?") ) );
+        new squawk::UpnpContentDirectoryApi( "/api/(upnp/device|upnp/event|upnp/ssdp|album|artist|track|browse|statistic|db/pool|db/writer|db/objects|search|db/snapshot|db/maintenance)/?(\\d*)?") ) );
     web_server->register_servlet( std::unique_ptr< http::HttpServlet >(
         new squawk::UpnpMediaServlet( "/(video|audio|image|cover|albumArtUri|resource)/(\\d*).(flac|mp3|avi|mp4|mkv|mpeg|mov|wmv|jpg)" ) ) );
     web_server->register_servlet( std::unique_ptr< http::HttpServlet >(
@@ -127,21 +135,11 @@ bool SquawkServer::import_media_directory() {
 }
 
 void SquawkServer::cleanup_upnp_devices() {
-    while ( _ssdp_devices_thread_run ) { {
-            std::lock_guard<std::mutex> _ssdp_devices_guard( _ssdp_devices_mutex );
-
-            auto iter_ = _ssdp_devices.begin();
-            auto end_iter_ = _ssdp_devices.end();
-            while( iter_ != end_iter_ ) {
-                if ( iter_->second.timeout() ) {
-                    CLOG(INFO, "upnp") << "(Device Timeout) :" << iter_->second.friendlyName();
-                    _ssdp_devices.erase( iter_++ );
-                } else {
-                    ++iter_;
-                }
-            }//while iter ssdp devices
-        }//context for the mutex
-        std::this_thread::sleep_for ( std::chrono::milliseconds ( 5000 ) );
+    while ( _ssdp_devices_thread_run ) {
+        for ( auto & device : _ssdp_devices.expire() ) {
+            CLOG(INFO, "upnp") << "(Device Timeout) :" << device.friendlyName();
+        }
+        std::this_thread::sleep_for ( std::chrono::milliseconds ( SSDP_DEVICES_EXPIRE_INTERVAL ) );
     }//while forever
 }
 
@@ -165,29 +163,25 @@ void SquawkServer::ssdp_event( ssdp::SSDP_EVENT_TYPE type, std::string, ssdp::Ss
 
     if( device.nt == ssdp::NS_ROOT_DEVICE ) {
         if( type == ssdp::SSDP_EVENT_TYPE::BYE ) {
-            if( _ssdp_devices.find( _rootdevice_usn ) != _ssdp_devices.end() ) {
-                CLOG(INFO, "upnp") << "rootdevice (bye) " << _ssdp_devices[ _rootdevice_usn ].friendlyName();
-                std::lock_guard<std::mutex> _ssdp_devices_guard( _ssdp_devices_mutex );
-                _ssdp_devices.erase( _ssdp_devices.find( _rootdevice_usn ) );
+            UpnpDeviceRegistry::device_map_ptr devices_ = _ssdp_devices.snapshot();
+            auto iter_ = devices_->find( _rootdevice_usn );
+            if( iter_ != devices_->end() ) {
+                CLOG(INFO, "upnp") << "rootdevice (bye) " << iter_->second.friendlyName();
             }
-        } else if( _ssdp_devices.find( _rootdevice_usn ) != _ssdp_devices.end() ) {
-            //update timestamp
+            _ssdp_devices.erase( _rootdevice_usn );
+
+        } else if( _ssdp_devices.touch( _rootdevice_usn, device.cache_control ) ) {
+            //timestamp updated
             if( squawk::SUAWK_SERVER_DEBUG ) {
-                CLOG(DEBUG, "upnp") << "rootdevice (reanc) " << _ssdp_devices[ _rootdevice_usn ].friendlyName();
+                CLOG(DEBUG, "upnp") << "rootdevice (reanc) " << _rootdevice_usn;
             }
-            _ssdp_devices[ _rootdevice_usn ].touch();
 
         } else {
-            //create new rootdevice
+            //create new rootdevice, the description is loaded without holding the registry lock.
             try {
                 upnp::UpnpDevice device_ = upnp::deviceDescription( device );
-                device_.touch();
-                device_.timeout( device.cache_control );
-
                 CLOG(INFO, "upnp") << "rootdevice (anc) " << device_.friendlyName();
-
-                std::lock_guard<std::mutex> _ssdp_devices_guard( _ssdp_devices_mutex );
-                _ssdp_devices[ _rootdevice_usn ] = device_;
+                _ssdp_devices.insert( _rootdevice_usn, device_, device.cache_control );
 
             } catch( commons::xml::XmlException & ex ) {
                 CLOG(ERROR, "upnp") << "XML Parse Exception (" << ex.code() << ") " << ex.what();
@@ -21,6 +21,7 @@
 #define SQUAWKSERVER_H
 
 #include "squawkconfig.h"
+#include "upnpdeviceregistry.h"
 #include "../../ssdpcpp/src/ssdpserverimpl.h"
 
 namespace squawk {
@@ -48,6 +49,11 @@ class SquawkServer {
      */
     void start( squawk::SquawkConfig * squawk_config );
 
+    /**
+     * @brief Open the database and the content directory dao without the network services.
+     */
+    void open( squawk::SquawkConfig * squawk_config );
+
     /**
      * @brief Stop the Server.
      */
@@ -55,12 +61,25 @@ class SquawkServer {
 
     squawk::ptr_squawk_config config() const { return _squawk_config; }
     std::shared_ptr< squawk::UpnpContentDirectoryDao > dao() const { return _upnp_cds_dao; }
+    /** @brief the writer connection. */
     db::db_connection_ptr db() const {
         return db::Sqlite3Database::instance().connection( _squawk_config->databaseFile() );
     }
+    /** @brief a read-only connection, see db::Sqlite3ConnectionPool::reader(). */
+    db::db_connection_ptr db_reader() const {
+        return db_pool()->reader();
+    }
+    db::db_pool_ptr db_pool() const {
+        return db::Sqlite3Database::instance().pool( _squawk_config->databaseFile() );
+    }
 
-    std::map< std::string, upnp::UpnpDevice > upnp_devices () {
-        return _ssdp_devices;
+    /** @brief snapshot of the discovered upnp devices. */
+    UpnpDeviceRegistry::device_map_ptr upnp_devices () const {
+        return _ssdp_devices.snapshot();
+    }
+    /** @brief statistics of the SSDP NOTIFY duplicate suppression. */
+    ssdp::SsdpDuplicateCache::Stats ssdp_stats () const {
+        return ( _ssdp_server ? _ssdp_server->duplicate_stats() : ssdp::SsdpDuplicateCache::Stats { 0, 0, 0 } );
     }
 
     bool import_media_directory();
@@ -71,8 +90,10 @@ class SquawkServer {
     void cleanup_upnp_devices();
     void ssdp_event( ssdp::SSDP_EVENT_TYPE, std::string, ssdp::SsdpEvent device );
 
-    std::map< std::string, upnp::UpnpDevice > _ssdp_devices;
-    std::mutex _ssdp_devices_mutex;
+    /** interval of the device expiry thread in milliseconds. */
+    static const size_t SSDP_DEVICES_EXPIRE_INTERVAL = 1000;
+
+    UpnpDeviceRegistry _ssdp_devices;
     std::unique_ptr<std::thread> _ssdp_devices_thread;
     bool _ssdp_devices_thread_run = true;
 
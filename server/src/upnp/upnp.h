@@ -27,6 +27,10 @@ namespace upnp {
      * @brief XML UPNP Connection Manager NAMESPACE
      */
     const static std::string XML_NS_UPNP_CMS = "urn:schemas-upnp-org:service:ConnectionManager:1";
+    /**
+     * @brief XML UPNP Control NAMESPACE
+     */
+    const static std::string XML_NS_UPNP_CONTROL = "urn:schemas-upnp-org:control-1-0";
 
     /** @brief upnp:class:object.container */
     const static std::string UPNP_CLASS_CONTAINER = "object.container";
@@ -43,6 +47,12 @@ namespace upnp {
     const static  std::string START_INDEX = "StartingIndex";
     /** @brief Requested Count Parameter */
     const static std::string REQUESTED_COUNT = "RequestedCount";
+    /** @brief Sort Criteria Parameter */
+    const static std::string SORT_CRITERIA = "SortCriteria";
+    /** @brief Search Container Parameter */
+    const static std::string CONTAINER_ID = "ContainerID";
+    /** @brief Search Criteria Parameter */
+    const static std::string SEARCH_CRITERIA = "SearchCriteria";
 
     /**
      * @brief XML SOAP Encoding Namespace
@@ -64,6 +74,7 @@ namespace upnp {
  * Error Codes:
  * 1 Can not parse Upnp SOAP Envelope
  * 2 Unknown UPNP command
+ * 708 Unsupported or invalid search criteria
  * 3
  * 4
  * 5
@@ -91,7 +102,7 @@ class UpnpContentDirectoryRequest {
 public:
 
     /** The Reqquest Types */
-    enum TYPE { BROWSE, PROTOCOL_INFO, X_FEATURE_LIST };
+    enum TYPE { BROWSE, SEARCH, SEARCH_CAPABILITIES, SORT_CAPABILITIES, PROTOCOL_INFO, X_FEATURE_LIST };
     /**
      * @brief UpnpContentDirectoryRequest
      * @param type
@@ -168,6 +179,19 @@ inline UpnpContentDirectoryRequest parseRequest( std::string request ) {
                     request.addValue( prop.name(), prop.content() );
                 }
                 return request;
+            } else if( upnp_command[0].ns() == XML_NS_UPNP_CDS && upnp_command[0].name() == "Search" ) {
+                UpnpContentDirectoryRequest request( UpnpContentDirectoryRequest::SEARCH );
+                std::vector< commons::xml::Node > upnp_props = upnp_command[0].children();
+                for( auto prop : upnp_props ) {
+                    request.addValue( prop.name(), prop.content() );
+                }
+                return request;
+            } else if( upnp_command[0].ns() == XML_NS_UPNP_CDS && upnp_command[0].name() == "GetSearchCapabilities" ) {
+                return UpnpContentDirectoryRequest( UpnpContentDirectoryRequest::SEARCH_CAPABILITIES );
+
+            } else if( upnp_command[0].ns() == XML_NS_UPNP_CDS && upnp_command[0].name() == "GetSortCapabilities" ) {
+                return UpnpContentDirectoryRequest( UpnpContentDirectoryRequest::SORT_CAPABILITIES );
+
             } else if( upnp_command[0].ns() == XML_NS_UPNP_CMS && upnp_command[0].name() == "GetProtocolInfo" ) {
                 UpnpContentDirectoryRequest request( UpnpContentDirectoryRequest::PROTOCOL_INFO );
                 return request;
@@ -188,6 +212,30 @@ inline UpnpContentDirectoryRequest parseRequest( std::string request ) {
     }
 };
 
+/**
+ * @brief write the SOAP fault of a failed action.
+ * <p>The fault is sent with HTTP status 500.</p>
+ * @param xmlWriter the response writer
+ * @param code the UPnPError errorCode
+ * @param description the UPnPError errorDescription
+ */
+inline void fault( commons::xml::XMLWriter * xmlWriter, const int code, const std::string & description ) {
+    commons::xml::Node envelope_node = xmlWriter->element( "Envelope" );
+    xmlWriter->ns( envelope_node, XML_NS_SOAP, "s", true );
+    xmlWriter->attribute( envelope_node, XML_NS_SOAP, "encodingStyle", "http://schemas.xmlsoap.org/soap/encoding/" );
+
+    commons::xml::Node body_node = xmlWriter->element( envelope_node, XML_NS_SOAP, "Body" );
+    commons::xml::Node fault_node = xmlWriter->element( body_node, XML_NS_SOAP, "Fault" );
+    xmlWriter->element( fault_node, "", "faultcode", "s:Client" );
+    xmlWriter->element( fault_node, "", "faultstring", "UPnPError" );
+    commons::xml::Node detail_node = xmlWriter->element( fault_node, "", "detail" );
+
+    commons::xml::Node error_node = xmlWriter->element( detail_node, "", "UPnPError" );
+    xmlWriter->ns( error_node, XML_NS_UPNP_CONTROL );
+    xmlWriter->element( error_node, "", "errorCode", std::to_string( code ) );
+    xmlWriter->element( error_node, "", "errorDescription", description );
+}
+
 /**
  * @brief The Icon struct
  */
@@ -0,0 +1,448 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <set>
+
+#include "upnpcatalogsnapshot.h"
+#include "didl.h"
+
+namespace squawk {
+
+const UpnpCatalogSnapshot::position_t UpnpCatalogSnapshot::npos = std::numeric_limits< UpnpCatalogSnapshot::position_t >::max();
+
+int64_t UpnpCatalogSnapshot::Row::get_int64 ( const int & index ) const {
+    const int column_ = _column ( index );
+
+    if ( column_ < 0 || _table.columns[ column_ ].nulls[ _position ] ) {
+        return 0;
+    }
+
+    const Table::Column & values_ = _table.columns[ column_ ];
+
+    if ( values_.text ) {
+        return std::strtoll ( _snapshot._strings[ values_.strings[ _position ] ].c_str(), nullptr, 10 );
+    }
+
+    if ( ! values_.others.empty() ) {
+        auto other_ = values_.others.find ( _position );
+
+        if ( other_ != values_.others.end() ) {
+            return std::strtoll ( _snapshot._strings[ other_->second ].c_str(), nullptr, 10 );
+        }
+    }
+
+    return values_.integers[ _position ];
+}
+
+void UpnpCatalogSnapshot::Row::get_text ( const int & index, std::string & value ) const {
+    const int column_ = _column ( index );
+
+    if ( column_ < 0 || _table.columns[ column_ ].nulls[ _position ] ) {
+        value.clear();
+        return;
+    }
+
+    const Table::Column & values_ = _table.columns[ column_ ];
+
+    if ( values_.text ) {
+        value = _snapshot._strings[ values_.strings[ _position ] ];
+        return;
+    }
+
+    if ( ! values_.others.empty() ) {
+        auto other_ = values_.others.find ( _position );
+
+        if ( other_ != values_.others.end() ) {
+            value = _snapshot._strings[ other_->second ];
+            return;
+        }
+    }
+
+    value = std::to_string ( values_.integers[ _position ] );
+}
+
+bool UpnpCatalogSnapshot::Row::is_null ( const int & index ) const {
+    const int column_ = _column ( index );
+    return column_ < 0 || _table.columns[ column_ ].nulls[ _position ];
+}
+
+int UpnpCatalogSnapshot::Row::_column ( const int & index ) const {
+    if ( _columns != nullptr ) {
+        return ( index >= 0 && static_cast< size_t > ( index ) < _columns->size() ? ( *_columns )[ index ] : -1 );
+    }
+
+    return ( index >= 0 && static_cast< size_t > ( index ) < _table.columns.size() ? index : -1 );
+}
+
+int UpnpCatalogSnapshot::Table::column ( const std::string & name ) const {
+    for ( size_t i = 0; i < columns.size(); ++i ) {
+        if ( columns[ i ].name == name ) {
+            return static_cast< int > ( i );
+        }
+    }
+
+    return -1;
+}
+
+size_t UpnpCatalogSnapshot::Table::bytes() const {
+    size_t bytes_ = 0;
+
+    for ( auto & column : columns ) {
+        bytes_ += sizeof ( Column ) + column.integers.capacity() * sizeof ( int64_t ) + column.strings.capacity() * sizeof ( uint32_t ) +
+                  column.nulls.capacity() / 8 + column.others.size() * ( sizeof ( position_t ) + sizeof ( uint32_t ) + 2 * sizeof ( void* ) );
+    }
+
+    return bytes_;
+}
+
+UpnpCatalogSnapshot::UpnpCatalogSnapshot ( db::db_connection_ptr db, const size_t generation ) : _generation ( generation ) {
+    std::unordered_map< std::string, uint32_t > ids_;
+    _intern ( "", ids_ );
+
+    //a savepoint is a deferred transaction, or nests when the reader is the writer in a transaction.
+    int res_ = db->exec ( "SAVEPOINT snapshot;" );
+
+    if ( res_ != SQLITE_OK ) {
+        throw db::DbException ( res_, sqlite3_errstr ( res_ ) );
+    }
+
+    try {
+        _read ( db, ids_ );
+
+    } catch ( ... ) {
+        db->exec ( "ROLLBACK TO snapshot; RELEASE snapshot;" );
+        throw;
+    }
+
+    res_ = db->exec ( "RELEASE snapshot;" );
+
+    if ( res_ != SQLITE_OK ) {
+        throw db::DbException ( res_, sqlite3_errstr ( res_ ) );
+    }
+}
+
+void UpnpCatalogSnapshot::_read ( db::db_connection_ptr db, std::unordered_map< std::string, uint32_t > & ids ) {
+    //the ROWID is read by name, the sort keys are only used to sort.
+    std::vector< std::string > columns_ { "ROWID" };
+    db::db_statement_ptr stmt_ = db->prepareStatement ( "PRAGMA table_info( tbl_cds_object )" );
+
+    while ( stmt_->step() ) {
+        const std::string name_ = stmt_->get_string ( 1 );
+
+        if ( name_ != "id" && ! ( name_.size() > 5 && name_.compare ( name_.size() - 5, 5, "_sort" ) == 0 ) ) {
+            columns_.push_back ( name_ );
+        }
+    }
+
+    stmt_.reset();
+
+    std::vector< std::string > titles_;
+    std::vector< bool > title_nulls_;
+    _load ( db, _objects, "tbl_cds_object", columns_, ", title_sort from tbl_cds_object order by ROWID", ids,
+    [&titles_, &title_nulls_, &columns_] ( db::Sqlite3Statement * stmt ) {
+        const int index_ = static_cast< int > ( columns_.size() );
+        title_nulls_.push_back ( stmt->is_null ( index_ ) );
+        titles_.push_back ( stmt->get_string ( index_ ) );
+    } );
+
+    _cls_column = _objects.column ( "cls" );
+    _parent_column = _objects.column ( "parent_id" );
+    _mtime_column = _objects.column ( "mtime" );
+
+    if ( _cls_column < 0 || _parent_column < 0 || _mtime_column < 0 ) {
+        throw db::DbException ( SQLITE_ERROR, "tbl_cds_object without cls, parent_id or mtime." );
+    }
+
+    _load ( db, _resources, "tbl_cds_resource", { "ROWID", "ref_obj", "protocol_info", "path", "bitrate", "bits_per_sample", "color_depth",
+            "dlna_profile", "duration", "framerate", "mime_type", "nr_audio_channels", "resolution", "sample_frequency", "size"
+                                                }, "from tbl_cds_resource order by ref_obj, ROWID", ids, nullptr );
+    _load ( db, _album_art_uris, "tbl_cds_album_art_uri", { "ROWID", "ref_obj", "path", "uri", "profile" },
+            "from tbl_cds_album_art_uri order by ref_obj, ROWID", ids, nullptr );
+    //the albums of the artist are counted like in UpnpContentDirectoryDao::artists.
+    _load ( db, _artists, "tbl_cds_artist", { "ROWID", "name", "clean_name", "import",
+            "( select count(*) from tbl_cds_object where cls = " + std::to_string ( didl::objectContainerAlbumMusicAlbum ) +
+            " and ( artist = tbl_cds_artist.clean_name or publisher = tbl_cds_artist.clean_name ) )"
+                                            }, "from tbl_cds_artist order by name_sort, ROWID", ids, nullptr );
+
+    _sort ( titles_, title_nulls_ );
+    _resource_offsets = _offsets ( _resources );
+    _album_art_uri_offsets = _offsets ( _album_art_uris );
+
+    for ( position_t i = 0; i < _artists.rows; ++i ) {
+        _artist_order.push_back ( i );
+    }
+}
+
+UpnpCatalogSnapshot::Stats UpnpCatalogSnapshot::stats() const {
+    size_t bytes_ = sizeof ( UpnpCatalogSnapshot ) + _objects.bytes() + _resources.bytes() + _album_art_uris.bytes() + _artists.bytes() +
+                    _strings.capacity() * sizeof ( std::string ) +
+                    ( _children.capacity() + _parent_offsets.capacity() + _class_offsets.capacity() + _resource_offsets.capacity() +
+                      _album_art_uri_offsets.capacity() + _artist_order.capacity() ) * sizeof ( position_t ) +
+                    _parents.capacity() * sizeof ( int64_t ) + _classes.capacity() * sizeof ( int );
+
+    for ( auto & order : _orders ) {
+        bytes_ += order.capacity() * sizeof ( position_t );
+    }
+
+    for ( auto & str : _strings ) {
+        //short strings are stored in the string object.
+        if ( str.capacity() > 15 ) {
+            bytes_ += str.capacity() + 1;
+        }
+    }
+
+    return Stats { _generation, _objects.rows, _resources.rows, _album_art_uris.rows, _artists.rows, _strings.size(), bytes_ };
+}
+
+std::vector< int > UpnpCatalogSnapshot::objectColumns ( const std::string & select ) const {
+    std::vector< int > columns_;
+    size_t start_ = 0;
+
+    while ( start_ <= select.size() ) {
+        size_t end_ = select.find ( ',', start_ );
+
+        if ( end_ == std::string::npos ) {
+            end_ = select.size();
+        }
+
+        const size_t first_ = select.find_first_not_of ( ' ', start_ );
+        const size_t last_ = select.find_last_not_of ( ' ', end_ - 1 );
+        columns_.push_back ( first_ < end_ && last_ != std::string::npos && last_ >= first_ ?
+                             _objects.column ( select.substr ( first_, last_ - first_ + 1 ) ) : -1 );
+        start_ = end_ + 1;
+    }
+
+    return columns_;
+}
+
+UpnpCatalogSnapshot::position_t UpnpCatalogSnapshot::find ( const int64_t id ) const {
+    const std::vector< int64_t > & rowids_ = _objects.columns[ 0 ].integers;
+    auto position_ = std::lower_bound ( rowids_.begin(), rowids_.end(), id );
+    return ( position_ != rowids_.end() && *position_ == id ? static_cast< position_t > ( position_ - rowids_.begin() ) : npos );
+}
+
+int UpnpCatalogSnapshot::cls ( const position_t position ) const {
+    return static_cast< int > ( _objects.columns[ _cls_column ].integers[ position ] );
+}
+
+UpnpCatalogSnapshot::range_t UpnpCatalogSnapshot::children ( const int64_t parent ) const {
+    auto parent_ = std::lower_bound ( _parents.begin(), _parents.end(), parent );
+
+    if ( parent_ == _parents.end() || *parent_ != parent ) {
+        return range_t ( nullptr, nullptr );
+    }
+
+    const size_t index_ = parent_ - _parents.begin();
+    return _range ( _children, _parent_offsets[ index_ ], _parent_offsets[ index_ + 1 ] );
+}
+
+UpnpCatalogSnapshot::range_t UpnpCatalogSnapshot::objects ( const int cls, const ORDER order ) const {
+    auto cls_ = std::lower_bound ( _classes.begin(), _classes.end(), cls );
+
+    if ( cls_ == _classes.end() || *cls_ != cls ) {
+        return range_t ( nullptr, nullptr );
+    }
+
+    const size_t index_ = cls_ - _classes.begin();
+    return _range ( _orders[ order ], _class_offsets[ index_ ], _class_offsets[ index_ + 1 ] );
+}
+
+UpnpCatalogSnapshot::range_t UpnpCatalogSnapshot::artists() const {
+    return _range ( _artist_order, 0, _artist_order.size() );
+}
+
+UpnpCatalogSnapshot::rows_t UpnpCatalogSnapshot::resources ( const position_t position ) const {
+    const std::vector< int64_t > & refs_ = _resources.columns[ 1 ].integers;
+    const position_t begin_ = _resource_offsets[ position ];
+    //rows of deleted objects can follow the rows of the object.
+    auto end_ = std::upper_bound ( refs_.begin() + begin_, refs_.begin() + _resource_offsets[ position + 1 ],
+                                   _objects.columns[ 0 ].integers[ position ] );
+    return rows_t ( begin_, static_cast< position_t > ( end_ - refs_.begin() ) );
+}
+
+UpnpCatalogSnapshot::rows_t UpnpCatalogSnapshot::albumArtUris ( const position_t position ) const {
+    const std::vector< int64_t > & refs_ = _album_art_uris.columns[ 1 ].integers;
+    const position_t begin_ = _album_art_uri_offsets[ position ];
+    auto end_ = std::upper_bound ( refs_.begin() + begin_, refs_.begin() + _album_art_uri_offsets[ position + 1 ],
+                                   _objects.columns[ 0 ].integers[ position ] );
+    return rows_t ( begin_, static_cast< position_t > ( end_ - refs_.begin() ) );
+}
+
+void UpnpCatalogSnapshot::_load ( db::db_connection_ptr db, Table & table, const std::string & name, const std::vector< std::string > & columns,
+                                  const std::string & from, std::unordered_map< std::string, uint32_t > & ids,
+                                  std::function< void ( db::Sqlite3Statement * ) > read ) {
+    //columns without integer affinity, the ROWID and the expressions are integers.
+    std::set< std::string > texts_;
+    db::db_statement_ptr stmt_ = db->prepareStatement ( "PRAGMA table_info( " + name + " )" );
+
+    while ( stmt_->step() ) {
+        std::string type_ = stmt_->get_string ( 2 );
+        std::transform ( type_.begin(), type_.end(), type_.begin(), ::toupper );
+
+        if ( type_.find ( "INT" ) == std::string::npos ) {
+            texts_.insert ( stmt_->get_string ( 1 ) );
+        }
+    }
+
+    stmt_.reset();
+    std::string query_ = "select ";
+
+    for ( auto & column : columns ) {
+        table.columns.push_back ( Table::Column() );
+        table.columns.back().name = column;
+        table.columns.back().text = ( texts_.find ( column ) != texts_.end() );
+        query_ += ( &column == &columns.front() ? "" : ", " ) + column;
+    }
+
+    stmt_ = db->prepareStatement ( query_ + " " + from );
+    std::string text_;
+
+    while ( stmt_->step() ) {
+        const position_t row_ = static_cast< position_t > ( table.rows );
+
+        for ( size_t i = 0; i < table.columns.size(); ++i ) {
+            Table::Column & column_ = table.columns[ i ];
+            const int index_ = static_cast< int > ( i );
+            const bool null_ = stmt_->is_null ( index_ );
+            column_.nulls.push_back ( null_ );
+
+            if ( column_.text ) {
+                if ( ! null_ ) { stmt_->get_text ( index_, text_ ); }
+
+                column_.strings.push_back ( null_ ? 0 : _intern ( text_, ids ) );
+
+            } else if ( null_ || stmt_->is_integer ( index_ ) ) {
+                column_.integers.push_back ( null_ ? 0 : stmt_->get_int64 ( index_ ) );
+
+            } else {
+                //real and text values in a column with integer affinity.
+                stmt_->get_text ( index_, text_ );
+                column_.integers.push_back ( 0 );
+                column_.others[ row_ ] = _intern ( text_, ids );
+            }
+        }
+
+        if ( read ) {
+            read ( stmt_.get() );
+        }
+
+        ++table.rows;
+    }
+
+    for ( auto & column : table.columns ) {
+        column.integers.shrink_to_fit();
+        column.strings.shrink_to_fit();
+    }
+}
+
+uint32_t UpnpCatalogSnapshot::_intern ( const std::string & value, std::unordered_map< std::string, uint32_t > & ids ) {
+    auto id_ = ids.find ( value );
+
+    if ( id_ != ids.end() ) {
+        return id_->second;
+    }
+
+    const uint32_t new_id_ = static_cast< uint32_t > ( _strings.size() );
+    _strings.push_back ( value );
+    ids.emplace ( value, new_id_ );
+    return new_id_;
+}
+
+std::vector< UpnpCatalogSnapshot::position_t > UpnpCatalogSnapshot::_offsets ( const Table & table ) const {
+    const std::vector< int64_t > & rowids_ = _objects.columns[ 0 ].integers;
+    const std::vector< int64_t > & refs_ = table.columns[ 1 ].integers;
+    std::vector< position_t > offsets_ ( _objects.rows + 1 );
+    position_t row_ = 0;
+
+    for ( size_t i = 0; i < _objects.rows; ++i ) {
+        while ( row_ < table.rows && refs_[ row_ ] < rowids_[ i ] ) { ++row_; }
+
+        offsets_[ i ] = row_;
+    }
+
+    offsets_[ _objects.rows ] = static_cast< position_t > ( table.rows );
+    return offsets_;
+}
+
+void UpnpCatalogSnapshot::_sort ( const std::vector< std::string > & titles, const std::vector< bool > & nulls ) {
+    const std::vector< int64_t > & cls_ = _objects.columns[ _cls_column ].integers;
+    const std::vector< int64_t > & parents_ = _objects.columns[ _parent_column ].integers;
+    const std::vector< int64_t > & mtimes_ = _objects.columns[ _mtime_column ].integers;
+    //the positions are in ROWID order, the position is the tiebreak. NULL sorts first like in sqlite.
+    auto title_ = [&titles, &nulls] ( const position_t a, const position_t b ) {
+        if ( nulls[ a ] != nulls[ b ] ) { return nulls[ a ] ? -1 : 1; }
+
+        return titles[ a ].compare ( titles[ b ] );
+    };
+
+    std::vector< position_t > positions_ ( _objects.rows );
+
+    for ( position_t i = 0; i < _objects.rows; ++i ) {
+        positions_[ i ] = i;
+    }
+
+    _children = positions_;
+    std::sort ( _children.begin(), _children.end(), [&] ( const position_t a, const position_t b ) {
+        if ( parents_[ a ] != parents_[ b ] ) { return parents_[ a ] < parents_[ b ]; }
+
+        const int compare_ = title_ ( a, b );
+        return ( compare_ != 0 ? compare_ < 0 : a < b );
+    } );
+
+    for ( position_t i = 0; i < _children.size(); ++i ) {
+        if ( _parents.empty() || _parents.back() != parents_[ _children[ i ] ] ) {
+            _parents.push_back ( parents_[ _children[ i ] ] );
+            _parent_offsets.push_back ( i );
+        }
+    }
+
+    _parent_offsets.push_back ( static_cast< position_t > ( _children.size() ) );
+
+    _orders[ ROWID ] = positions_;
+    std::stable_sort ( _orders[ ROWID ].begin(), _orders[ ROWID ].end(), [&cls_] ( const position_t a, const position_t b ) {
+        return cls_[ a ] < cls_[ b ];
+    } );
+    _orders[ TITLE ] = positions_;
+    std::sort ( _orders[ TITLE ].begin(), _orders[ TITLE ].end(), [&] ( const position_t a, const position_t b ) {
+        if ( cls_[ a ] != cls_[ b ] ) { return cls_[ a ] < cls_[ b ]; }
+
+        const int compare_ = title_ ( a, b );
+        return ( compare_ != 0 ? compare_ < 0 : a < b );
+    } );
+    _orders[ MTIME ] = std::move ( positions_ );
+    std::sort ( _orders[ MTIME ].begin(), _orders[ MTIME ].end(), [&] ( const position_t a, const position_t b ) {
+        if ( cls_[ a ] != cls_[ b ] ) { return cls_[ a ] < cls_[ b ]; }
+
+        if ( mtimes_[ a ] != mtimes_[ b ] ) { return mtimes_[ a ] < mtimes_[ b ]; }
+
+        return a < b;
+    } );
+
+    //the classes have the same offsets in all orders.
+    for ( position_t i = 0; i < _orders[ ROWID ].size(); ++i ) {
+        if ( _classes.empty() || _classes.back() != cls_[ _orders[ ROWID ][ i ] ] ) {
+            _classes.push_back ( static_cast< int > ( cls_[ _orders[ ROWID ][ i ] ] ) );
+            _class_offsets.push_back ( i );
+        }
+    }
+
+    _class_offsets.push_back ( static_cast< position_t > ( _orders[ ROWID ].size() ) );
+}
+}//namespace squawk
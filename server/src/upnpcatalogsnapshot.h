@@ -0,0 +1,206 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#ifndef UPNPCATALOGSNAPSHOT_H
+#define UPNPCATALOGSNAPSHOT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "db/sqlite3connection.h"
+
+namespace squawk {
+
+/**
+ * \brief Immutable in-memory copy of the catalog.
+ *
+ * <p>The objects, resources, album art uris and artists are stored column by column, the text
+ * values are interned in one string table. The children of every container are presorted by
+ * title, the objects of every class by ROWID, title and mtime and the artists by name.</p>
+ *
+ * <p>The snapshot is read in one transaction and never changed, it can be shared by all threads
+ * without a lock. It shows the catalog of the generation it was built for.</p>
+ */
+class UpnpCatalogSnapshot {
+    class Table;
+public:
+    /** the position of a row in its table */
+    typedef uint32_t position_t;
+    /** positions in sort order */
+    typedef std::pair< const position_t*, const position_t* > range_t;
+    /** rows [first, second) of a table */
+    typedef std::pair< position_t, position_t > rows_t;
+
+    /** the presorted orders of the objects of a class */
+    enum ORDER { ROWID, TITLE, MTIME };
+
+    /** \brief size of the snapshot */
+    struct Stats {
+        /** generation of the catalog */
+        size_t generation;
+        size_t objects;
+        size_t resources;
+        size_t album_art_uris;
+        size_t artists;
+        /** interned strings */
+        size_t strings;
+        /** estimated memory of the snapshot */
+        size_t bytes;
+    };
+
+    /**
+     * \brief a row of a table, read with the getters of db::Sqlite3Statement.
+     * <p>The index is mapped to the column of the table, unknown columns read as NULL.</p>
+     */
+    class Row {
+    public:
+        Row ( const UpnpCatalogSnapshot & snapshot, const Table & table, const std::vector< int > * columns, const position_t position ) :
+            _snapshot ( snapshot ), _table ( table ), _columns ( columns ), _position ( position ) {}
+
+        int get_int ( const int & index ) const { return static_cast< int > ( get_int64 ( index ) ); }
+        int64_t get_int64 ( const int & index ) const;
+        std::string get_string ( const int & index ) const {
+            std::string value_;
+            get_text ( index, value_ );
+            return value_;
+        }
+        void get_text ( const int & index, std::string & value ) const;
+        bool is_null ( const int & index ) const;
+
+    private:
+        const UpnpCatalogSnapshot & _snapshot;
+        const Table & _table;
+        const std::vector< int > * _columns;
+        const position_t _position;
+
+        int _column ( const int & index ) const;
+    };
+
+    /**
+     * \brief read the catalog in one transaction.
+     * \param db the reader connection.
+     * \param generation the catalog generation before the read.
+     * \throws db::DbException
+     */
+    UpnpCatalogSnapshot ( db::db_connection_ptr db, const size_t generation );
+    UpnpCatalogSnapshot ( const UpnpCatalogSnapshot& ) = delete;
+    UpnpCatalogSnapshot& operator= ( const UpnpCatalogSnapshot& ) = delete;
+    ~UpnpCatalogSnapshot() {}
+
+    /** \brief the catalog generation of the snapshot. */
+    size_t generation() const { return _generation; }
+    /** \brief get the size of the snapshot. */
+    Stats stats() const;
+
+    /** \brief the table columns of the comma separated select list, -1 for unknown columns. */
+    std::vector< int > objectColumns ( const std::string & select ) const;
+    /** \brief the position of the object, npos when the object does not exist. */
+    position_t find ( const int64_t id ) const;
+    /** \brief the class of the object. */
+    int cls ( const position_t position ) const;
+    /** \brief read the object with the columns from objectColumns(). */
+    Row object ( const position_t position, const std::vector< int > & columns ) const {
+        return Row ( *this, _objects, &columns, position );
+    }
+
+    /** \brief the children of the container sorted by title. */
+    range_t children ( const int64_t parent ) const;
+    /** \brief the objects of the class in the sort order, the class must not be didl::object. */
+    range_t objects ( const int cls, const ORDER order ) const;
+    /** \brief the artists sorted by name. */
+    range_t artists() const;
+
+    /**
+     * \brief read the artist: ROWID, name, clean_name, import and the number of albums.
+     */
+    Row artist ( const position_t position ) const {
+        return Row ( *this, _artists, nullptr, position );
+    }
+    /** \brief the resource rows of the object. */
+    rows_t resources ( const position_t position ) const;
+    /** \brief read the resource in the columns of read_resource(). */
+    Row resource ( const position_t row ) const {
+        return Row ( *this, _resources, nullptr, row );
+    }
+    /** \brief the album art uri rows of the object. */
+    rows_t albumArtUris ( const position_t position ) const;
+    /** \brief read the album art uri in the columns of read_album_art_uri(). */
+    Row albumArtUri ( const position_t row ) const {
+        return Row ( *this, _album_art_uris, nullptr, row );
+    }
+
+    /** the position of a missing object */
+    static const position_t npos;
+
+private:
+    /* a table stored by column. */
+    class Table {
+    public:
+        struct Column {
+            std::string name;
+            /* declared as text, the values are string ids. */
+            bool text;
+            std::vector< int64_t > integers;
+            std::vector< uint32_t > strings;
+            std::vector< bool > nulls;
+            /* text and real values of an integer column. */
+            std::unordered_map< position_t, uint32_t > others;
+        };
+        std::vector< Column > columns;
+        size_t rows = 0;
+
+        /* the index of the column, -1 when the table has no such column. */
+        int column ( const std::string & name ) const;
+        size_t bytes() const;
+    };
+
+    size_t _generation;
+    Table _objects, _resources, _album_art_uris, _artists;
+    std::vector< std::string > _strings;
+
+    /* the children sorted by parent, title and ROWID. the children of _parents[i] start at _parent_offsets[i]. */
+    std::vector< position_t > _children;
+    std::vector< int64_t > _parents;
+    std::vector< position_t > _parent_offsets;
+    /* the objects sorted by class and ORDER. the objects of _classes[i] start at _class_offsets[i]. */
+    std::vector< position_t > _orders[3];
+    std::vector< int > _classes;
+    std::vector< position_t > _class_offsets;
+    /* the rows of the object at position p are [offsets[p], offsets[p + 1]). */
+    std::vector< position_t > _resource_offsets, _album_art_uri_offsets;
+    std::vector< position_t > _artist_order;
+    int _cls_column, _parent_column, _mtime_column;
+
+    /* read the tables, called by the constructor in the open savepoint. */
+    void _read ( db::db_connection_ptr db, std::unordered_map< std::string, uint32_t > & ids );
+    /* load the columns in select order, the text columns are found in the declared types of the table.
+       read gets the statement of every row for the columns selected in from. */
+    void _load ( db::db_connection_ptr db, Table & table, const std::string & name, const std::vector< std::string > & columns,
+                 const std::string & from, std::unordered_map< std::string, uint32_t > & ids,
+                 std::function< void ( db::Sqlite3Statement * ) > read );
+    uint32_t _intern ( const std::string & value, std::unordered_map< std::string, uint32_t > & ids );
+    /* the row offsets of the objects in a table sorted by ref_obj. */
+    std::vector< position_t > _offsets ( const Table & table ) const;
+    void _sort ( const std::vector< std::string > & titles, const std::vector< bool > & nulls );
+    static range_t _range ( const std::vector< position_t > & order, const position_t begin, const position_t end ) {
+        return range_t ( order.data() + begin, order.data() + end );
+    }
+};
+}//namespace squawk
+#endif // UPNPCATALOGSNAPSHOT_H
@@ -15,11 +15,29 @@
 */
 
 #include "upnpcontentdirectory.h"
+#include "upnpcontentdirectorydao.h"
+#include "upnpsearchcriteria.h"
 
 #include "db/dbexception.h"
 
 namespace squawk {
 
+namespace {
+/* write the search results with the class of the object. */
+struct SearchElements {
+    didl::DidlXmlWriter & writer;
+
+    template< typename T >
+    typename std::enable_if< std::is_base_of< didl::DidlContainer, T >::value >::type operator() ( T & container ) {
+        writer.container ( "/file/{}", "/file/{}", container );
+    }
+    template< typename T >
+    typename std::enable_if< std::is_base_of< didl::DidlItem, T >::value >::type operator() ( T & item ) {
+        writer.write ( "/file/{}", "/file/{}", http_uri ( "resource/{0}.{1}" ), item );
+    }
+};
+}
+
 void UpnpContentDirectory::registerContentDirectoryModule ( std::unique_ptr< ContentDirectoryModule > module ) {
     _modules.push_back ( std::move ( module ) );
 }
@@ -127,6 +145,37 @@ void UpnpContentDirectory::do_post ( http::HttpRequest & request, http::HttpResp
                 response.set_mime_type ( http::mime::XML );
                 response.status ( http::http_status::OK );
 
+            } else if ( upnp_command.type == upnp::UpnpContentDirectoryRequest::SEARCH ) {
+
+                try {
+                    commons::xml::XMLWriter xmlWriter;
+                    search ( &xmlWriter, &upnp_command );
+
+                    response <<  xmlWriter.str();
+                    response.set_mime_type ( http::mime::XML );
+                    response.status ( http::http_status::OK );
+
+                } catch ( upnp::UpnpException & ex ) {
+                    //the control point gets the UPnPError, e.g. 708 for invalid search criteria.
+                    CLOG(ERROR, "upnp") << "Search error: " << ex.code() << ":" << ex.what();
+                    commons::xml::XMLWriter xmlWriter;
+                    upnp::fault ( &xmlWriter, ex.code(), ex.what() );
+
+                    response <<  xmlWriter.str();
+                    response.set_mime_type ( http::mime::XML );
+                    response.status ( http::http_status::INTERNAL_SERVER_ERROR );
+                }
+
+            } else if ( upnp_command.type == upnp::UpnpContentDirectoryRequest::SEARCH_CAPABILITIES ||
+                        upnp_command.type == upnp::UpnpContentDirectoryRequest::SORT_CAPABILITIES ) {
+
+                commons::xml::XMLWriter xmlWriter;
+                capabilities ( &xmlWriter, &upnp_command );
+
+                response <<  xmlWriter.str();
+                response.set_mime_type ( http::mime::XML );
+                response.status ( http::http_status::OK );
+
             } else if ( upnp_command.type == upnp::UpnpContentDirectoryRequest::X_FEATURE_LIST ) {
 
                 CLOG(DEBUG, "upnp") << "X_GetFeatureList: " << request << "\n" << upnp_command; //TODO remove
@@ -190,7 +239,7 @@ void UpnpContentDirectory::do_post ( http::HttpRequest & request, http::HttpResp
         }
 }
 
-void UpnpContentDirectory::browse ( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command ) {
+commons::xml::Node UpnpContentDirectory::envelope ( commons::xml::XMLWriter * xmlWriter, const std::string & response ) {
 
     commons::xml::Node envelope_node = xmlWriter->element ( "Envelope" );
     xmlWriter->ns ( envelope_node, upnp::XML_NS_SOAP, "s", true );
@@ -200,8 +249,28 @@ void UpnpContentDirectory::browse ( commons::xml::XMLWriter * xmlWriter, upnp::U
     xmlWriter->attribute ( envelope_node, upnp::XML_NS_SOAP, "encodingStyle", "http://schemas.xmlsoap.org/soap/encoding/" );
 
     commons::xml::Node body_node = xmlWriter->element ( envelope_node, upnp::XML_NS_SOAP, "Body" );
-    commons::xml::Node response_node = xmlWriter->element ( body_node, "", "BrowseResponse", "" );
+    commons::xml::Node response_node = xmlWriter->element ( body_node, "", response, "" );
     xmlWriter->ns ( response_node, upnp::XML_NS_UPNP_CDS, "u", true );
+    return response_node;
+}
+
+void UpnpContentDirectory::result ( commons::xml::XMLWriter * xmlWriter, const commons::xml::Node & response_node, const std::string & didl,
+                                    const size_t number_returned, const size_t total_matches ) {
+
+    commons::xml::Node result_node = xmlWriter->element ( response_node, "", "Result", didl );
+    xmlWriter->attribute ( result_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:string" );
+
+    commons::xml::Node nr_node = xmlWriter->element ( response_node, "", "NumberReturned", std::to_string ( number_returned ) );
+    xmlWriter->attribute ( nr_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
+    commons::xml::Node tm_node = xmlWriter->element ( response_node, "", "TotalMatches", std::to_string ( total_matches ) );
+    xmlWriter->attribute ( tm_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
+    commons::xml::Node uid_node = xmlWriter->element ( response_node, "", "UpdateID", "1" ); //TODO
+    xmlWriter->attribute ( uid_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
+}
+
+void UpnpContentDirectory::browse ( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command ) {
+
+    commons::xml::Node response_node = envelope ( xmlWriter, "BrowseResponse" );
 
     commons::xml::XMLWriter didlWriter;
     std::tuple< size_t, size_t > res_;
@@ -265,14 +334,54 @@ void UpnpContentDirectory::browse ( commons::xml::XMLWriter * xmlWriter, upnp::U
         CLOG(ERROR, "upnp") << "Browse unknown command (" << upnp_command->getValue ( "BrowseFlag" ) << ")";
     }
 
-    commons::xml::Node result_node = xmlWriter->element ( response_node, "", "Result", didlWriter.str() );
-    xmlWriter->attribute ( result_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:string" );
+    result ( xmlWriter, response_node, didlWriter.str(), std::get< 0 > ( res_ ), std::get< 1 > ( res_ ) );
+}
 
-    commons::xml::Node nr_node = xmlWriter->element ( response_node, "", "NumberReturned", std::to_string ( std::get< 0 > ( res_ ) ) );
-    xmlWriter->attribute ( nr_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
-    commons::xml::Node tm_node = xmlWriter->element ( response_node, "", "TotalMatches", std::to_string ( std::get< 1 > ( res_ ) ) );
-    xmlWriter->attribute ( tm_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
-    commons::xml::Node uid_node = xmlWriter->element ( response_node, "", "UpdateID", "1" ); //TODO
-    xmlWriter->attribute ( uid_node, upnp::XML_NS_SCHEMA_INSTANCE, "type", "xsd:int" );
+void UpnpContentDirectory::search ( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command ) {
+
+    UpnpSearchCriteria criteria_ ( upnp_command->getValue ( upnp::SEARCH_CRITERIA ) );
+    commons::xml::Node response_node = envelope ( xmlWriter, "SearchResponse" );
+
+    //the objects below the container with the number at the end of the id, all objects for the root and the virtual containers.
+    std::string container_id_ = upnp_command->getValue ( upnp::CONTAINER_ID );
+    container_id_ = container_id_.substr ( container_id_.rfind ( "/" ) + 1 );
+    const size_t container_ = ( ! container_id_.empty() && container_id_.size() < 19 &&
+                                container_id_.find_first_not_of ( "0123456789" ) == std::string::npos ? std::stoull ( container_id_ ) : 0 );
+
+    size_t start_index_ = std::stoi ( upnp_command->getValue ( upnp::START_INDEX ) );
+    size_t request_count_ = std::stoi ( upnp_command->getValue ( upnp::REQUESTED_COUNT ) );
+
+    if ( request_count_ == 0 ) { request_count_ = 128; }
+
+    auto dao = SquawkServer::instance()->dao();
+    commons::xml::XMLWriter didlWriter;
+    didl::DidlXmlWriter didl_element ( &didlWriter );
+
+    //the objects of the other classes are not written and not counted.
+    SearchElements elements_ { didl_element };
+    const size_t returned_ = dao->visitSearchObjects< didl::DidlContainer, didl::DidlContainerAlbum, didl::DidlContainerPhotoAlbum,
+                             didl::DidlItem, didl::DidlPhoto, didl::DidlMusicTrack, didl::DidlMovie > (
+                                 criteria_, container_, start_index_, request_count_, elements_,
+                                 UpnpContentDirectoryDao::sortCriteria ( upnp_command->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
+
+    //the count is only queried when the first page is not the whole result.
+    const size_t total_matches_ = ( start_index_ == 0 && returned_ < request_count_ ? returned_ :
+                                    dao->searchCount ( criteria_, container_, UpnpContentDirectoryDao::classes< didl::DidlContainer,
+                                            didl::DidlContainerAlbum, didl::DidlContainerPhotoAlbum, didl::DidlItem, didl::DidlPhoto,
+                                            didl::DidlMusicTrack, didl::DidlMovie >() ) );
+
+    result ( xmlWriter, response_node, didlWriter.str(), returned_, total_matches_ );
+}
+
+void UpnpContentDirectory::capabilities ( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command ) {
+
+    if ( upnp_command->type == upnp::UpnpContentDirectoryRequest::SEARCH_CAPABILITIES ) {
+        commons::xml::Node response_node = envelope ( xmlWriter, "GetSearchCapabilitiesResponse" );
+        xmlWriter->element ( response_node, "", "SearchCaps", UpnpSearchCriteria::capabilities() );
+
+    } else {
+        commons::xml::Node response_node = envelope ( xmlWriter, "GetSortCapabilitiesResponse" );
+        xmlWriter->element ( response_node, "", "SortCaps", UpnpContentDirectoryDao::sortCapabilities() );
+    }
 }
 }//namespace squawk
@@ -109,6 +109,13 @@ private:
     std::list< std::unique_ptr< ContentDirectoryModule > > _modules;
 
     void browse( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command );
+    void search( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command );
+    void capabilities( commons::xml::XMLWriter * xmlWriter, upnp::UpnpContentDirectoryRequest * upnp_command );
+    /* write the SOAP envelope and return the response element. */
+    static commons::xml::Node envelope( commons::xml::XMLWriter * xmlWriter, const std::string & response );
+    /* write the Result, NumberReturned, TotalMatches and UpdateID elements. */
+    static void result( commons::xml::XMLWriter * xmlWriter, const commons::xml::Node & response_node, const std::string & didl,
+                        const size_t number_returned, const size_t total_matches );
     void notify( std::list< int > update_ids );
 };
 }//namespace squawk
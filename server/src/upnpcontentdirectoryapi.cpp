@@ -37,14 +37,16 @@ void UpnpContentDirectoryApi::do_get ( http::HttpRequest & request, http::HttpRe
         } else if ( command == "image" ) {
 
         } else if ( command == "track" ) {
-            std::list< didl::DidlMusicTrack > track_list_ = SquawkServer::instance()->dao()->children<didl::DidlMusicTrack> ( id, 0, 200 );
-            didl::serializer< std::list< didl::DidlMusicTrack > >::serialize ( response, track_list_, attributes_ );
+            response << "[";
+            SquawkServer::instance()->dao()->visitChildren<didl::DidlMusicTrack> ( id, 0, 200,
+                    JsonElements< didl::DidlMusicTrack > { response, attributes_, true } );
+            response << "]";
 
         } else if ( command == "browse" ) {
-            response << "{\"objects_count\": " << SquawkServer::instance()->dao()->childrenCount( didl::object, id ) << ",\"objects\": ";
-            std::list< didl::DidlObject > objects_ = SquawkServer::instance()->dao()->children<didl::DidlObject > ( id, page, limit );
-            didl::serializer< std::list< didl::DidlObject > >::serialize ( response, objects_, attributes_ );
-            response << "}";
+            response << "{\"objects_count\": " << SquawkServer::instance()->dao()->childrenCount( didl::object, id ) << ",\"objects\": [";
+            SquawkServer::instance()->dao()->visitChildren<didl::DidlObject > ( id, page, limit,
+                    JsonElements< didl::DidlObject > { response, attributes_, true } );
+            response << "]}";
         }
 
     } else if ( match ( request.uri(), &command ) ) {
@@ -79,16 +81,23 @@ void UpnpContentDirectoryApi::do_get ( http::HttpRequest & request, http::HttpRe
 //            }
 
             if ( command == "artist" ) {
-                std::list< didl::DidlContainerArtist > artists_ = SquawkServer::instance()->dao()->artists ( page, limit, filters_, sort_ );
-                response << "{artists_count=100, artists=";
-                didl::serializer< std::list< didl::DidlContainerArtist > >::serialize ( response, artists_, attributes_ );
-                response << "}";
+                response << "{artists_count=100, artists=[";
+                SquawkServer::instance()->dao()->visitArtists ( page, limit,
+                        JsonElements< didl::DidlContainerArtist > { response, attributes_, true }, filters_, sort_ );
+                response << "]}";
 
             } else if ( command == "album" ) {
-                std::list< didl::DidlContainerAlbum > albums_ = SquawkServer::instance()->dao()->objects<didl::DidlContainerAlbum> ( page, limit, filters_, sort_ );
-                response << "{\"albums_count\": " << SquawkServer::instance()->dao()->objectsCount ( didl::objectContainerAlbumMusicAlbum, filters_ ) << ",\"albums\": ";
-                didl::serializer< std::list< didl::DidlContainerAlbum > >::serialize ( response, albums_, attributes_ );
-                response << "}";
+                response << "{\"albums_count\": " << SquawkServer::instance()->dao()->objectsCount ( didl::objectContainerAlbumMusicAlbum, filters_ ) << ",\"albums\": [";
+                SquawkServer::instance()->dao()->visitObjects<didl::DidlContainerAlbum> ( page, limit,
+                        JsonElements< didl::DidlContainerAlbum > { response, attributes_, true }, filters_, sort_ );
+                response << "]}";
+
+            } else if ( command == "search" ) {
+                const std::string text_ = ( request.containsAttribute ( "query" ) ? request.attribute ( "query" ) : "" );
+                response << "{\"objects_count\": " << SquawkServer::instance()->dao()->searchCount ( didl::object, text_, filters_ ) << ",\"objects\": [";
+                SquawkServer::instance()->dao()->visitSearch<didl::DidlObject> ( text_, page, limit,
+                        JsonElements< didl::DidlObject > { response, attributes_, true }, filters_ );
+                response << "]}";
 
             } else if ( command == "video" ) {
 
@@ -98,15 +107,51 @@ void UpnpContentDirectoryApi::do_get ( http::HttpRequest & request, http::HttpRe
                 didl::DidlStatistics statistic_ = SquawkServer::instance()->dao()->statistics();
                 didl::serializer< didl::DidlStatistics >::serialize ( response, statistic_, attributes_ );
 
+            } else if ( command == "db/pool" ) {
+                db::Sqlite3ConnectionPool::Stats stats_ = SquawkServer::instance()->db_pool()->stats();
+                response << "{\"checkouts\":" << stats_.checkouts << ",\"waits\":" << stats_.waits <<
+                         ",\"wait_time_us\":" << stats_.wait_time_us << ",\"max_wait_us\":" << stats_.max_wait_us <<
+                         ",\"readers\":" << stats_.readers <<
+                         ",\"statement_hits\":" << stats_.statement_hits << ",\"statement_misses\":" << stats_.statement_misses <<
+                         ",\"statement_evictions\":" << stats_.statement_evictions << "}";
+
+            } else if ( command == "db/writer" ) {
+                db::Sqlite3Writer::Stats stats_ = SquawkServer::instance()->dao()->writerStats();
+                response << "{\"operations\":" << stats_.operations << ",\"commits\":" << stats_.commits <<
+                         ",\"queue_depth\":" << stats_.queue_depth << ",\"max_queue_depth\":" << stats_.max_queue_depth <<
+                         ",\"max_batch\":" << stats_.max_batch <<
+                         ",\"commit_time_us\":" << stats_.commit_time_us << ",\"max_commit_us\":" << stats_.max_commit_us << "}";
+
+            } else if ( command == "db/objects" ) {
+                db::Sqlite3ObjectCache::Stats stats_ = SquawkServer::instance()->dao()->objectCacheStats();
+                response << "{\"hits\":" << stats_.hits << ",\"misses\":" << stats_.misses << ",\"evictions\":" << stats_.evictions <<
+                         ",\"entries\":" << stats_.entries << ",\"bytes\":" << stats_.bytes << "}";
+
+            } else if ( command == "db/snapshot" ) {
+                UpnpCatalogSnapshot::Stats stats_ = SquawkServer::instance()->dao()->snapshotStats();
+                response << "{\"generation\":" << stats_.generation << ",\"objects\":" << stats_.objects <<
+                         ",\"resources\":" << stats_.resources << ",\"album_art_uris\":" << stats_.album_art_uris <<
+                         ",\"artists\":" << stats_.artists << ",\"strings\":" << stats_.strings << ",\"bytes\":" << stats_.bytes << "}";
+
+            } else if ( command == "db/maintenance" ) {
+                db::Sqlite3Maintenance::Stats stats_ = SquawkServer::instance()->dao()->maintenanceStats();
+                response << "{\"runs\":" << stats_.runs << ",\"truncated_runs\":" << stats_.truncated_runs <<
+                         ",\"vacuumed_pages\":" << stats_.vacuumed_pages << ",\"checkpointed_frames\":" << stats_.checkpointed_frames <<
+                         ",\"plan_changes\":" << stats_.plan_changes << ",\"bytes\":" << stats_.bytes << ",\"last_run_ms\":" << stats_.last_run_ms << "}";
+
+            } else if ( command == "upnp/ssdp" ) {
+                ssdp::SsdpDuplicateCache::Stats stats_ = SquawkServer::instance()->ssdp_stats();
+                response << "{\"lookups\":" << stats_.lookups << ",\"hits\":" << stats_.hits << ",\"drops\":" << stats_.drops << "}";
+
             } else if ( command == "upnp/device" ) {
-                std::map< std::string, upnp::UpnpDevice > devices = SquawkServer::instance()->upnp_devices();
+                UpnpDeviceRegistry::device_map_ptr devices = SquawkServer::instance()->upnp_devices();
 
                 response << "[";
                 bool first_device = true;
 
-                for ( auto & event : devices ) {
+                for ( auto & event : *devices ) {
                     try {
-                        upnp::UpnpDevice & device = event.second;
+                        const upnp::UpnpDevice & device = event.second;
 
                         if ( first_device ) { first_device = false; }
 
@@ -13,6 +13,21 @@ public:
     virtual void do_get ( http::HttpRequest & request, http::HttpResponse & response ) override;
 
 private:
+    /* visitor writing the objects as the comma separated elements of a json array. */
+    template< typename T >
+    struct JsonElements {
+        http::HttpResponse & response;
+        const std::list< std::string > & attributes;
+        bool first;
+        void operator() ( T & o ) {
+            if ( first ) { first = false; }
+
+            else { response << ","; }
+
+            didl::serializer< T >::serialize ( response, o, attributes );
+        }
+    };
+
     FRIEND_TEST ( UpnpContentDirectoryTest, TestAttributes );
     static std::list< std::string > parse_attributes ( const std::string & str );
     FRIEND_TEST ( UpnpContentDirectoryTest, TestFilter );
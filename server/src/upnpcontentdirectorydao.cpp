@@ -16,84 +16,662 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <chrono>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
 #include "upnpcontentdirectorydao.h"
 #include "upnpcontentdirectoryparser.h"
 #include "squawkserver.h"
+#include "utils/sortkey.h"
 
 namespace squawk {
 
-/* CONSTRUCTOR */
-UpnpContentDirectoryDao::UpnpContentDirectoryDao() : _db ( SquawkServer::instance()->db() ) {
+/* SCHEMA */
+const std::set< std::string > UpnpContentDirectoryDao::OBJECT_COLUMNS {
+    "ROWID", "cls", "parent_id", "size", "title", "path", "mime_type", "mtime", "rating", "year", "track", "disc", "isbn",
+    "playback_count", "object_update_id", "contributor", "artist", "author", "publisher", "genre", "album", "comment",
+    "series_title", "season", "episode", "dlna_profile", "last_playback_time", "import", "timestamp", "child_count",
+    "title_sort", "artist_sort", "album_sort"
+};
+const std::set< std::string > UpnpContentDirectoryDao::ARTIST_COLUMNS { "ROWID", "clean_name", "name", "import", "name_sort" };
+const std::map< std::string, std::string > UpnpContentDirectoryDao::OBJECT_SORT_KEYS {
+    { "title", "title_sort" }, { "artist", "artist_sort" }, { "album", "album_sort" }
+};
+const std::map< std::string, std::string > UpnpContentDirectoryDao::SORT_CRITERIA {
+    { "dc:title", "title" }, { "dc:creator", "artist" }, { "upnp:artist", "artist" }, { "upnp:album", "album" },
+    { "dc:date", "year" }, { "upnp:originalTrackNumber", "track" }
+};
+const std::map< std::string, std::string > UpnpContentDirectoryDao::ARTIST_SORT_KEYS { { "title", "name_sort" }, { "name", "name_sort" } };
+const std::vector< std::string > UpnpContentDirectoryDao::QUERY_PLANS {
+    "select ROWID, object_update_id from tbl_cds_object where path = ?",
+    "select cls, ROWID, parent_id, title from tbl_cds_object where parent_id = ? order by title_sort asc, ROWID asc limit ?, ?",
+    "select cls, ROWID, parent_id, title from tbl_cds_object where parent_id = ? and cls = ? order by title_sort asc, ROWID asc limit ?, ?",
+    "select cls, ROWID, parent_id, title from tbl_cds_object where cls = ? order by title_sort asc, ROWID asc limit ?, ?",
+    "select cls, ROWID, parent_id, title from tbl_cds_object where cls = ? order by mtime desc, ROWID desc limit ?, ?",
+    "select cls, ROWID, parent_id, title from tbl_cds_object where cls = ? and ( artist = ? or contributor = ? ) order by title_sort asc, ROWID asc limit ?, ?",
+    "select ROWID, name, clean_name, import from tbl_cds_artist WHERE 1 order by name_sort asc, ROWID asc limit ?, ?",
+    "select count(*) from tbl_cds_object where cls=? and (artist = ? or publisher=?)",
+    "select distinct series_title from tbl_cds_object where series_title!='' order by series_title asc limit ?, ?",
+    "update tbl_cds_object SET timestamp=? where path=? and mtime=?",
+    "select ROWID, ref_obj, path from tbl_cds_resource where ref_obj IN ( ?, ? )",
+};
+const std::map< std::string, UpnpCatalogSnapshot::ORDER > UpnpContentDirectoryDao::SNAPSHOT_ORDERS {
+    { "ROWID", UpnpCatalogSnapshot::ROWID }, { "title", UpnpCatalogSnapshot::TITLE }, { "mtime", UpnpCatalogSnapshot::MTIME }
+};
+
+const std::vector< std::list< std::string > > UpnpContentDirectoryDao::MIGRATIONS {
+    /* version 1: tables */ {
+        "CREATE TABLE IF NOT EXISTS tbl_cds_object( cls, parent_id, size, title, path, mime_type, mtime, rating, year, track, disc, isbn, playback_count, object_update_id, contributor, artist, author, publisher, genre, album, comment, series_title, season, episode, dlna_profile, last_playback_time, import, timestamp );",
+        "CREATE UNIQUE INDEX IF NOT EXISTS UniqueIndexObjectPath ON tbl_cds_object(path);",
+        "CREATE TABLE IF NOT EXISTS tbl_cds_artist( clean_name, name, import );",
+        "CREATE UNIQUE INDEX IF NOT EXISTS UniqueIndexArtistCleanName ON tbl_cds_artist(clean_name);",
+        "CREATE TABLE IF NOT EXISTS tbl_cds_resource( ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type, nr_audio_channels, resolution, sample_frequency, size );",
+        "CREATE INDEX IF NOT EXISTS UniqueIndexResourceRef ON tbl_cds_resource(ref_obj);",
+        "CREATE TABLE IF NOT EXISTS tbl_cds_album_art_uri( ref_obj, path, uri, profile);",
+        "CREATE INDEX IF NOT EXISTS UniqueIndexAlbumArtUriRef ON tbl_cds_album_art_uri(ref_obj);",
+    },
+    /* version 2: indexes for browse, list and sweep queries */ {
+        "CREATE INDEX IF NOT EXISTS IndexObjectParentClsTitle ON tbl_cds_object(parent_id, cls, title);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectClsTitle ON tbl_cds_object(cls, title);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectClsMtime ON tbl_cds_object(cls, mtime);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectClsArtist ON tbl_cds_object(cls, artist);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectClsContributor ON tbl_cds_object(cls, contributor);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectClsPublisher ON tbl_cds_object(cls, publisher);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectSeriesTitle ON tbl_cds_object(series_title);",
+        "CREATE INDEX IF NOT EXISTS IndexObjectTimestamp ON tbl_cds_object(timestamp);",
+        "CREATE INDEX IF NOT EXISTS IndexArtistName ON tbl_cds_artist(name);",
+        "CREATE INDEX IF NOT EXISTS IndexResourceMimeType ON tbl_cds_resource(mime_type);",
+    },
+    /* version 3: typed columns, the rows are copied with their ROWID and the numbers converted */ {
+        "CREATE TABLE tbl_cds_object_v3( id INTEGER PRIMARY KEY, cls INTEGER, parent_id INTEGER, size INTEGER, title TEXT, path TEXT, "
+        "mime_type TEXT, mtime INTEGER, rating INTEGER, year INTEGER, track INTEGER, disc INTEGER, isbn TEXT, playback_count INTEGER, "
+        "object_update_id INTEGER, contributor TEXT, artist TEXT, author TEXT, publisher TEXT, genre TEXT, album TEXT, comment TEXT, "
+        "series_title TEXT, season INTEGER, episode INTEGER, dlna_profile TEXT, last_playback_time INTEGER, import INTEGER, timestamp INTEGER );",
+        "INSERT INTO tbl_cds_object_v3 SELECT ROWID, CAST(cls AS INTEGER), CAST(parent_id AS INTEGER), CAST(size AS INTEGER), title, path, "
+        "mime_type, CAST(mtime AS INTEGER), CAST(rating AS INTEGER), CAST(year AS INTEGER), CAST(track AS INTEGER), CAST(disc AS INTEGER), isbn, "
+        "CAST(playback_count AS INTEGER), CAST(object_update_id AS INTEGER), contributor, artist, author, publisher, genre, album, comment, "
+        "series_title, CAST(season AS INTEGER), CAST(episode AS INTEGER), dlna_profile, CAST(last_playback_time AS INTEGER), "
+        "CAST(import AS INTEGER), CAST(timestamp AS INTEGER) FROM tbl_cds_object;",
+        "DROP TABLE tbl_cds_object;",
+        "ALTER TABLE tbl_cds_object_v3 RENAME TO tbl_cds_object;",
+        "CREATE UNIQUE INDEX UniqueIndexObjectPath ON tbl_cds_object(path);",
+        "CREATE INDEX IndexObjectParentClsTitle ON tbl_cds_object(parent_id, cls, title);",
+        "CREATE INDEX IndexObjectClsTitle ON tbl_cds_object(cls, title);",
+        "CREATE INDEX IndexObjectClsMtime ON tbl_cds_object(cls, mtime);",
+        "CREATE INDEX IndexObjectClsArtist ON tbl_cds_object(cls, artist);",
+        "CREATE INDEX IndexObjectClsContributor ON tbl_cds_object(cls, contributor);",
+        "CREATE INDEX IndexObjectClsPublisher ON tbl_cds_object(cls, publisher);",
+        "CREATE INDEX IndexObjectSeriesTitle ON tbl_cds_object(series_title);",
+        "CREATE INDEX IndexObjectTimestamp ON tbl_cds_object(timestamp);",
+        "CREATE INDEX IndexObjectSize ON tbl_cds_object(size);",
+
+        "CREATE TABLE tbl_cds_artist_v3( id INTEGER PRIMARY KEY, clean_name TEXT, name TEXT, import INTEGER );",
+        "INSERT INTO tbl_cds_artist_v3 SELECT ROWID, clean_name, name, CAST(import AS INTEGER) FROM tbl_cds_artist;",
+        "DROP TABLE tbl_cds_artist;",
+        "ALTER TABLE tbl_cds_artist_v3 RENAME TO tbl_cds_artist;",
+        "CREATE UNIQUE INDEX UniqueIndexArtistCleanName ON tbl_cds_artist(clean_name);",
+        "CREATE INDEX IndexArtistName ON tbl_cds_artist(name);",
+
+        "CREATE TABLE tbl_cds_resource_v3( id INTEGER PRIMARY KEY, ref_obj INTEGER, protocol_info TEXT, path TEXT, bitrate INTEGER, "
+        "bits_per_sample INTEGER, color_depth INTEGER, dlna_profile TEXT, duration INTEGER, framerate INTEGER, mime_type TEXT, "
+        "nr_audio_channels INTEGER, resolution TEXT, sample_frequency INTEGER, size INTEGER );",
+        "INSERT INTO tbl_cds_resource_v3 SELECT ROWID, CAST(ref_obj AS INTEGER), protocol_info, path, CAST(NULLIF(bitrate, '') AS INTEGER), "
+        "CAST(NULLIF(bits_per_sample, '') AS INTEGER), CAST(NULLIF(color_depth, '') AS INTEGER), dlna_profile, CAST(NULLIF(duration, '') AS INTEGER), "
+        "CAST(NULLIF(framerate, '') AS INTEGER), mime_type, CAST(NULLIF(nr_audio_channels, '') AS INTEGER), resolution, "
+        "CAST(NULLIF(sample_frequency, '') AS INTEGER), CAST(size AS INTEGER) FROM tbl_cds_resource;",
+        "DROP TABLE tbl_cds_resource;",
+        "ALTER TABLE tbl_cds_resource_v3 RENAME TO tbl_cds_resource;",
+        "CREATE INDEX UniqueIndexResourceRef ON tbl_cds_resource(ref_obj);",
+        "CREATE INDEX IndexResourceMimeType ON tbl_cds_resource(mime_type);",
+
+        "CREATE TABLE tbl_cds_album_art_uri_v3( id INTEGER PRIMARY KEY, ref_obj INTEGER, path TEXT, uri TEXT, profile TEXT );",
+        "INSERT INTO tbl_cds_album_art_uri_v3 SELECT ROWID, CAST(ref_obj AS INTEGER), path, uri, profile FROM tbl_cds_album_art_uri;",
+        "DROP TABLE tbl_cds_album_art_uri;",
+        "ALTER TABLE tbl_cds_album_art_uri_v3 RENAME TO tbl_cds_album_art_uri;",
+        "CREATE INDEX UniqueIndexAlbumArtUriRef ON tbl_cds_album_art_uri(ref_obj);",
+    },
+    /* version 4: child count of the containers, music albums (cls=2) count the music tracks (cls=5) only */ {
+        "ALTER TABLE tbl_cds_object ADD COLUMN child_count INTEGER NOT NULL DEFAULT 0;",
+        "UPDATE tbl_cds_object SET child_count = ( SELECT count(*) FROM tbl_cds_object AS child "
+        "WHERE child.parent_id = tbl_cds_object.ROWID AND ( tbl_cds_object.cls != 2 OR child.cls = 5 ) );",
+        "CREATE TRIGGER TriggerObjectInsertChildCount AFTER INSERT ON tbl_cds_object BEGIN "
+        "UPDATE tbl_cds_object SET child_count = child_count + 1 WHERE ROWID = NEW.parent_id AND ( cls != 2 OR NEW.cls = 5 ); END;",
+        "CREATE TRIGGER TriggerObjectDeleteChildCount AFTER DELETE ON tbl_cds_object BEGIN "
+        "UPDATE tbl_cds_object SET child_count = child_count - 1 WHERE ROWID = OLD.parent_id AND ( cls != 2 OR OLD.cls = 5 ); END;",
+        "CREATE TRIGGER TriggerObjectUpdateChildCount AFTER UPDATE OF parent_id, cls ON tbl_cds_object "
+        "WHEN OLD.parent_id IS NOT NEW.parent_id OR OLD.cls IS NOT NEW.cls BEGIN "
+        "UPDATE tbl_cds_object SET child_count = child_count - 1 WHERE ROWID = OLD.parent_id AND ( cls != 2 OR OLD.cls = 5 ); "
+        "UPDATE tbl_cds_object SET child_count = child_count + 1 WHERE ROWID = NEW.parent_id AND ( cls != 2 OR NEW.cls = 5 ); END;",
+    },
+    /* version 5: sort keys for titles, artists and albums, created with the sort_key() function of the migration */ {
+        "ALTER TABLE tbl_cds_object ADD COLUMN title_sort TEXT;",
+        "ALTER TABLE tbl_cds_object ADD COLUMN artist_sort TEXT;",
+        "ALTER TABLE tbl_cds_object ADD COLUMN album_sort TEXT;",
+        "UPDATE tbl_cds_object SET title_sort = sort_key(title), artist_sort = sort_key(artist), album_sort = sort_key(album);",
+        "ALTER TABLE tbl_cds_artist ADD COLUMN name_sort TEXT;",
+        "UPDATE tbl_cds_artist SET name_sort = sort_key(name);",
+        "DROP INDEX IndexObjectParentClsTitle;",
+        "DROP INDEX IndexObjectClsTitle;",
+        "CREATE INDEX IndexObjectParentTitleSort ON tbl_cds_object(parent_id, title_sort);",
+        "CREATE INDEX IndexObjectClsTitleSort ON tbl_cds_object(cls, title_sort);",
+        "CREATE INDEX IndexObjectClsArtistSort ON tbl_cds_object(cls, artist_sort);",
+        "CREATE INDEX IndexObjectClsAlbumSort ON tbl_cds_object(cls, album_sort);",
+        "CREATE INDEX IndexArtistNameSort ON tbl_cds_artist(name_sort);",
+        "CREATE TRIGGER TriggerObjectInsertSortKeys AFTER INSERT ON tbl_cds_object BEGIN "
+        "UPDATE tbl_cds_object SET title_sort = sort_key(NEW.title), artist_sort = sort_key(NEW.artist), album_sort = sort_key(NEW.album) "
+        "WHERE ROWID = NEW.ROWID; END;",
+        "CREATE TRIGGER TriggerObjectUpdateSortKeys AFTER UPDATE OF title, artist, album ON tbl_cds_object BEGIN "
+        "UPDATE tbl_cds_object SET title_sort = sort_key(NEW.title), artist_sort = sort_key(NEW.artist), album_sort = sort_key(NEW.album) "
+        "WHERE ROWID = NEW.ROWID; END;",
+        "CREATE TRIGGER TriggerArtistInsertSortKey AFTER INSERT ON tbl_cds_artist BEGIN "
+        "UPDATE tbl_cds_artist SET name_sort = sort_key(NEW.name) WHERE ROWID = NEW.ROWID; END;",
+        "CREATE TRIGGER TriggerArtistUpdateSortKey AFTER UPDATE OF name ON tbl_cds_artist BEGIN "
+        "UPDATE tbl_cds_artist SET name_sort = sort_key(NEW.name) WHERE ROWID = NEW.ROWID; END;",
+    },
+    /* version 6: counters for the root containers and the statistics, maintained by triggers in the transaction of the change.
+       cls:<cls> objects by class, root objects with parent 0, artists, series distinct series titles, mime:<type> resources by mime type.
+       the counter rows are created with NOT EXISTS, the update of an upsert replaces OR IGNORE with its own conflict policy. */ {
+        "CREATE TABLE tbl_cds_counter( name TEXT PRIMARY KEY, value INTEGER NOT NULL DEFAULT 0 ) WITHOUT ROWID;",
+        "INSERT INTO tbl_cds_counter( name, value ) SELECT 'cls:' || cls, count(*) FROM tbl_cds_object GROUP BY cls;",
+        "INSERT INTO tbl_cds_counter( name, value ) SELECT 'root', count(*) FROM tbl_cds_object WHERE parent_id = 0;",
+        "INSERT INTO tbl_cds_counter( name, value ) SELECT 'artists', count(*) FROM tbl_cds_artist;",
+        "INSERT INTO tbl_cds_counter( name, value ) SELECT 'series', count(distinct series_title) FROM tbl_cds_object WHERE series_title != '';",
+        "INSERT INTO tbl_cds_counter( name, value ) SELECT 'mime:' || mime_type, count(*) FROM tbl_cds_resource WHERE mime_type IS NOT NULL GROUP BY mime_type;",
+        "CREATE TRIGGER TriggerObjectInsertCounters AFTER INSERT ON tbl_cds_object BEGIN "
+        "INSERT INTO tbl_cds_counter( name ) SELECT 'cls:' || NEW.cls WHERE NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_counter WHERE name = 'cls:' || NEW.cls ); "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'cls:' || NEW.cls; "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'root' AND NEW.parent_id = 0; "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'series' AND NEW.series_title != '' AND NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_object WHERE series_title = NEW.series_title AND ROWID != NEW.ROWID ); END;",
+        "CREATE TRIGGER TriggerObjectDeleteCounters AFTER DELETE ON tbl_cds_object BEGIN "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'cls:' || OLD.cls; "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'root' AND OLD.parent_id = 0; "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'series' AND OLD.series_title != '' AND NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_object WHERE series_title = OLD.series_title ); END;",
+        "CREATE TRIGGER TriggerObjectUpdateCounters AFTER UPDATE OF cls, parent_id, series_title ON tbl_cds_object "
+        "WHEN OLD.cls IS NOT NEW.cls OR OLD.parent_id IS NOT NEW.parent_id OR OLD.series_title IS NOT NEW.series_title BEGIN "
+        "INSERT INTO tbl_cds_counter( name ) SELECT 'cls:' || NEW.cls WHERE NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_counter WHERE name = 'cls:' || NEW.cls ); "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'cls:' || OLD.cls; "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'cls:' || NEW.cls; "
+        "UPDATE tbl_cds_counter SET value = value - ( OLD.parent_id = 0 ) + ( NEW.parent_id = 0 ) WHERE name = 'root'; "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'series' AND OLD.series_title IS NOT NEW.series_title "
+        "AND OLD.series_title != '' AND NOT EXISTS ( SELECT 1 FROM tbl_cds_object WHERE series_title = OLD.series_title ); "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'series' AND OLD.series_title IS NOT NEW.series_title "
+        "AND NEW.series_title != '' AND NOT EXISTS ( SELECT 1 FROM tbl_cds_object WHERE series_title = NEW.series_title AND ROWID != NEW.ROWID ); END;",
+        "CREATE TRIGGER TriggerArtistInsertCounters AFTER INSERT ON tbl_cds_artist BEGIN "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'artists'; END;",
+        "CREATE TRIGGER TriggerArtistDeleteCounters AFTER DELETE ON tbl_cds_artist BEGIN "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'artists'; END;",
+        "CREATE TRIGGER TriggerResourceInsertCounters AFTER INSERT ON tbl_cds_resource WHEN NEW.mime_type IS NOT NULL BEGIN "
+        "INSERT INTO tbl_cds_counter( name ) SELECT 'mime:' || NEW.mime_type WHERE NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_counter WHERE name = 'mime:' || NEW.mime_type ); "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'mime:' || NEW.mime_type; END;",
+        "CREATE TRIGGER TriggerResourceDeleteCounters AFTER DELETE ON tbl_cds_resource WHEN OLD.mime_type IS NOT NULL BEGIN "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'mime:' || OLD.mime_type; END;",
+        "CREATE TRIGGER TriggerResourceUpdateCounters AFTER UPDATE OF mime_type ON tbl_cds_resource "
+        "WHEN OLD.mime_type IS NOT NEW.mime_type BEGIN "
+        "INSERT INTO tbl_cds_counter( name ) SELECT 'mime:' || NEW.mime_type WHERE NEW.mime_type IS NOT NULL AND NOT EXISTS ( "
+        "SELECT 1 FROM tbl_cds_counter WHERE name = 'mime:' || NEW.mime_type ); "
+        "UPDATE tbl_cds_counter SET value = value - 1 WHERE name = 'mime:' || OLD.mime_type; "
+        "UPDATE tbl_cds_counter SET value = value + 1 WHERE name = 'mime:' || NEW.mime_type; END;",
+    },
+    /* version 7: resources and album art uris are unique per object and path, the import writes them with upserts */ {
+        "DELETE FROM tbl_cds_resource WHERE ROWID NOT IN ( SELECT max(ROWID) FROM tbl_cds_resource GROUP BY ref_obj, path );",
+        "DROP INDEX UniqueIndexResourceRef;",
+        "CREATE UNIQUE INDEX UniqueIndexResourceRefPath ON tbl_cds_resource(ref_obj, path);",
+        "DELETE FROM tbl_cds_album_art_uri WHERE ROWID NOT IN ( SELECT max(ROWID) FROM tbl_cds_album_art_uri GROUP BY ref_obj, path );",
+        "DROP INDEX UniqueIndexAlbumArtUriRef;",
+        "CREATE UNIQUE INDEX UniqueIndexAlbumArtUriRefPath ON tbl_cds_album_art_uri(ref_obj, path);",
+    },
+    /* version 8: full text index of the objects, the contributor is the composer, isbn, author and publisher describe the books.
+       the index reads the text from tbl_cds_object and is changed by the triggers. */ {
+        "CREATE VIRTUAL TABLE tbl_cds_search USING fts5( title, artist, album, genre, contributor, series_title, isbn, author, publisher, "
+        "content='tbl_cds_object', content_rowid='id', tokenize='unicode61 remove_diacritics 2', prefix='2 3' );",
+        "INSERT INTO tbl_cds_search( tbl_cds_search, rank ) VALUES( 'rank', 'bm25( 10.0, 5.0, 5.0, 1.0, 2.0, 5.0, 1.0, 2.0, 1.0 )' );",
+        "INSERT INTO tbl_cds_search( tbl_cds_search ) VALUES( 'rebuild' );",
+        "CREATE TRIGGER TriggerObjectInsertSearch AFTER INSERT ON tbl_cds_object BEGIN "
+        "INSERT INTO tbl_cds_search( rowid, title, artist, album, genre, contributor, series_title, isbn, author, publisher ) "
+        "VALUES( NEW.id, NEW.title, NEW.artist, NEW.album, NEW.genre, NEW.contributor, "
+        "NEW.series_title, NEW.isbn, NEW.author, NEW.publisher ); END;",
+        "CREATE TRIGGER TriggerObjectDeleteSearch AFTER DELETE ON tbl_cds_object BEGIN "
+        "INSERT INTO tbl_cds_search( tbl_cds_search, rowid, title, artist, album, genre, contributor, series_title, isbn, author, publisher ) "
+        "VALUES( 'delete', OLD.id, OLD.title, OLD.artist, OLD.album, OLD.genre, OLD.contributor, "
+        "OLD.series_title, OLD.isbn, OLD.author, OLD.publisher ); END;",
+        "CREATE TRIGGER TriggerObjectUpdateSearch AFTER UPDATE OF title, artist, album, genre, contributor, series_title, isbn, author, publisher ON tbl_cds_object "
+        "WHEN OLD.title IS NOT NEW.title OR OLD.artist IS NOT NEW.artist OR OLD.album IS NOT NEW.album OR "
+        "OLD.genre IS NOT NEW.genre OR OLD.contributor IS NOT NEW.contributor OR OLD.series_title IS NOT NEW.series_title OR "
+        "OLD.isbn IS NOT NEW.isbn OR OLD.author IS NOT NEW.author OR OLD.publisher IS NOT NEW.publisher BEGIN "
+        "INSERT INTO tbl_cds_search( tbl_cds_search, rowid, title, artist, album, genre, contributor, series_title, isbn, author, publisher ) "
+        "VALUES( 'delete', OLD.id, OLD.title, OLD.artist, OLD.album, OLD.genre, OLD.contributor, "
+        "OLD.series_title, OLD.isbn, OLD.author, OLD.publisher ); "
+        "INSERT INTO tbl_cds_search( rowid, title, artist, album, genre, contributor, series_title, isbn, author, publisher ) "
+        "VALUES( NEW.id, NEW.title, NEW.artist, NEW.album, NEW.genre, NEW.contributor, "
+        "NEW.series_title, NEW.isbn, NEW.author, NEW.publisher ); END;",
+    },
+    /* version 9: the SortCriteria by date and track number read in index order. */ {
+        "CREATE INDEX IndexObjectClsYear ON tbl_cds_object(cls, year);",
+        "CREATE INDEX IndexObjectParentTrack ON tbl_cds_object(parent_id, track);",
+    },
+    /* version 10: the sort keys are bound with the row by the writer, sort_key() is only registered for the migration. */ {
+        "DROP TRIGGER TriggerObjectInsertSortKeys;",
+        "DROP TRIGGER TriggerObjectUpdateSortKeys;",
+        "DROP TRIGGER TriggerArtistInsertSortKey;",
+        "DROP TRIGGER TriggerArtistUpdateSortKey;",
+    },
+};
+
+std::string UpnpContentDirectoryDao::_sort_keys ( const std::string & columns, const std::map< std::string, std::string > & keys ) {
+    std::vector< std::string > columns_;
+    boost::split ( columns_, columns, boost::is_any_of ( "," ) );
+    std::string sort_keys_;
+
+    for ( auto & column : columns_ ) {
+        //the direction of the column is kept.
+        const std::string column_ = boost::algorithm::trim_copy ( column );
+        const size_t end_ = column_.find_first_of ( " \t" );
+        auto key_ = keys.find ( column_.substr ( 0, end_ ) );
+
+        if ( ! sort_keys_.empty() ) { sort_keys_ += ", "; }
+
+        sort_keys_ += ( key_ == keys.end() ? column_ : key_->second + ( end_ == std::string::npos ? "" : column_.substr ( end_ ) ) );
+    }
+
+    return sort_keys_;
+}
+
+std::pair< std::string, std::string > UpnpContentDirectoryDao::sortCriteria ( const std::string & criteria,
+        const std::pair< std::string, std::string > & fallback ) {
+    std::vector< std::string > properties_;
+    boost::split ( properties_, criteria, boost::is_any_of ( "," ) );
+    std::vector< std::pair< std::string, std::string > > columns_;
+
+    for ( auto & property : properties_ ) {
+        std::string property_ = boost::algorithm::trim_copy ( property );
+        std::string direction_ = "asc";
+
+        if ( ! property_.empty() && ( property_[0] == '+' || property_[0] == '-' ) ) {
+            direction_ = ( property_[0] == '-' ? "desc" : "asc" );
+            property_ = boost::algorithm::trim_copy ( property_.substr ( 1 ) );
+        }
+
+        auto column_ = SORT_CRITERIA.find ( property_ );
+
+        if ( column_ != SORT_CRITERIA.end() ) {
+            columns_.push_back ( std::make_pair ( column_->second, direction_ ) );
+
+        } else if ( ! property_.empty() ) {
+            LOG ( DEBUG ) << "sort property without index ignored: " << property_;
+        }
+    }
+
+    if ( columns_.empty() ) {
+        return fallback;
+    }
+
+    const bool same_direction_ = std::all_of ( columns_.begin(), columns_.end(), [&columns_] ( const std::pair< std::string, std::string > & c ) {
+        return c.second == columns_.front().second;
+    } );
+    std::vector< std::string > sort_;
+
+    for ( auto & column : columns_ ) {
+        sort_.push_back ( same_direction_ ? column.first : column.first + " " + column.second );
+    }
+
+    return std::make_pair ( boost::algorithm::join ( sort_, ", " ), columns_.front().second );
+}
+
+std::string UpnpContentDirectoryDao::sortCapabilities() {
+    std::vector< std::string > properties_;
+
+    for ( auto & property : SORT_CRITERIA ) {
+        properties_.push_back ( property.first );
+    }
+
+    return boost::algorithm::join ( properties_, "," );
+}
+
+int UpnpContentDirectoryDao::migrate ( db::db_connection_ptr db ) {
+    //the sort keys of the existing rows are created by the migration.
+    db->create_function ( "sort_key", &commons::text::sort_key );
+
+    int version_ = 0;
+    db::db_statement_ptr stmt_version_ = db->prepareStatement ( "PRAGMA user_version;" );
+
+    if ( stmt_version_->step() ) {
+        version_ = stmt_version_->get_int ( 0 );
+    }
+
+    stmt_version_.reset();
 
-    //create tables if they dont exist
-    for ( auto & stmt : CREATE_STATEMENTS ) {
-        LOG ( TRACE ) << "create table:" << stmt;
+    for ( size_t i = version_; i < MIGRATIONS.size(); ++i ) {
+        LOG ( INFO ) << "migrate database schema to version " << ( i + 1 );
+        db->exec ( "BEGIN;" );
 
         try {
-            _db->prepareStatement ( stmt )->step();
+            for ( auto & stmt : MIGRATIONS[i] ) {
+                LOG ( TRACE ) << "migrate:" << stmt;
+                db->prepareStatement ( stmt )->step();
+            }
+
+            db->prepareStatement ( "PRAGMA user_version = " + std::to_string ( i + 1 ) + ";" )->step();
 
         } catch ( db::DbException & e ) {
-            LOG ( FATAL ) << "Create table, Exception:" << e.code() << "-> " << e.what();
-            throw upnp::UpnpException ( e.code(), "DbException: " +  std::string ( e.what() ) );
+            db->exec ( "ROLLBACK;" );
+            throw;
         }
+
+        db->exec ( "COMMIT;" );
+        version_ = i + 1;
     }
+
+    return version_;
 }
 
-/* TRANSACTION */
-void UpnpContentDirectoryDao::startTransaction() {
+/* CONSTRUCTOR */
+UpnpContentDirectoryDao::UpnpContentDirectoryDao() : _db_pool ( SquawkServer::instance()->db_pool() ) {
     try {
-        _db->exec ( "BEGIN;" );
+        migrate ( _db_pool->writer() );
 
     } catch ( db::DbException & e ) {
-        LOG ( FATAL ) << "Create statements, Exception:" << e.code() << "-> " << e.what();
+        LOG ( FATAL ) << "Migrate schema, Exception:" << e.code() << "-> " << e.what();
         throw upnp::UpnpException ( e.code(), "DbException: " +  std::string ( e.what() ) );
     }
+
+    //the readers see the changes after the commit.
+    _writer = std::make_shared< db::Sqlite3Writer > ( _db_pool, SquawkServer::instance()->config()->commitBatch(),
+              std::chrono::milliseconds ( SquawkServer::instance()->config()->commitInterval() ), [this]() { _committed(); } );
+    _maintenance = std::make_shared< db::Sqlite3Maintenance > ( _writer, QUERY_PLANS,
+                   std::chrono::minutes ( SquawkServer::instance()->config()->maintenanceInterval() ),
+                   db::Sqlite3Maintenance::DEFAULT_BUDGET, &UpnpContentDirectoryDao::_maintained );
+}
+
+void UpnpContentDirectoryDao::_maintained ( const db::Sqlite3Maintenance::Report & report ) {
+    if ( ! report.error.empty() ) {
+        LOG ( ERROR ) << "maintenance, Exception:" << report.error;
+        return;
+    }
+
+    LOG ( INFO ) << "maintenance: " << ( report.analyze ? "analyze" : "optimize" ) <<
+                 ", bytes=" << report.pages_before * report.page_size << "->" << report.pages_after * report.page_size <<
+                 ", free_pages=" << report.free_pages_before << "->" << report.free_pages_after <<
+                 ", vacuumed_pages=" << report.vacuumed_pages << ", checkpointed_frames=" << report.checkpointed_frames <<
+                 ( report.truncated ? ", stopped by the time budget" : "" ) << " in " << report.duration_ms << "ms";
+
+    for ( auto & plan : report.plans ) {
+        LOG ( INFO ) << "maintenance: query plan changed: " << std::get< 0 > ( plan ) <<
+                     "\n  before: " << std::get< 1 > ( plan ) << "\n  after:  " << std::get< 2 > ( plan );
+    }
 }
-void UpnpContentDirectoryDao::endTransaction() {
+
+/* TRANSACTION */
+void UpnpContentDirectoryDao::flush() {
     try {
-        _db->exec ( "END;" );
+        _writer->flush().get();
 
     } catch ( db::DbException & e ) {
-        LOG ( FATAL ) << "Create statements, Exception:" << e.code() << "-> " << e.what();
+        LOG ( FATAL ) << "Commit, Exception:" << e.code() << "-> " << e.what();
         throw upnp::UpnpException ( e.code(), "DbException: " +  std::string ( e.what() ) );
     }
 }
 
+/* CATALOG SNAPSHOT */
+bool UpnpContentDirectoryDao::publishSnapshot() {
+    const auto start_ = std::chrono::steady_clock::now();
+    const size_t generation_ = _generation.load();
+
+    try {
+        std::shared_ptr< const UpnpCatalogSnapshot > snapshot_ = std::make_shared< const UpnpCatalogSnapshot > ( _db_pool->reader(), generation_ );
+
+        if ( generation_ != _generation.load() ) {
+            LOG ( INFO ) << "snapshot: the catalog changed while the snapshot was read.";
+            return false;
+        }
+
+        std::atomic_store ( &_snapshot, snapshot_ );
+        const UpnpCatalogSnapshot::Stats stats_ = snapshot_->stats();
+        LOG ( INFO ) << "snapshot: generation=" << stats_.generation << ", objects=" << stats_.objects << ", resources=" << stats_.resources <<
+                     ", album_art_uris=" << stats_.album_art_uris << ", artists=" << stats_.artists << ", strings=" << stats_.strings <<
+                     ", bytes=" << stats_.bytes << " in " <<
+                     std::chrono::duration_cast< std::chrono::milliseconds > ( std::chrono::steady_clock::now() - start_ ).count() << "ms";
+        return true;
+
+    } catch ( db::DbException & e ) {
+        LOG ( ERROR ) << "Snapshot, Exception:" << e.code() << "-> " << e.what();
+        return false;
+    }
+}
+
+UpnpCatalogSnapshot::Stats UpnpContentDirectoryDao::snapshotStats() const {
+    std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
+    return ( catalog_ ? catalog_->stats() : UpnpCatalogSnapshot::Stats { 0, 0, 0, 0, 0, 0, 0 } );
+}
+
 /* SWEEP DATABASE */
-void UpnpContentDirectoryDao::sweep ( long mtime ) {
+UpnpContentDirectoryDao::SweepStats UpnpContentDirectoryDao::sweep ( long mtime, const size_t batch ) {
     LOG ( TRACE ) << mtime;
 
-    db::db_statement_ptr stmt = _db->prepareStatement ( "delete from tbl_cds_object where timestamp < ?" );
-    stmt->bind_int ( 1, mtime );
-    stmt->update();
+    SweepStats stats_ { 0, 0, 0, 0, 0, 0 };
+    std::list< std::string > files_;
+    const std::vector< std::string > directories_ { SquawkServer::instance()->config()->tmpDirectory() + "/Resource/",
+            SquawkServer::instance()->config()->tmpDirectory() + "/AlbumArtUri/" };
+
+    try {
+        //every batch is a short write operation, the writer interleaves them with the other writes.
+        size_t swept_ = 0;
+
+        do {
+            swept_ = _write ( [mtime, batch, &directories_, &stats_, &files_] ( db::db_connection_ptr db_ ) {
+                return _sweep_objects ( db_, mtime, batch, directories_, stats_, files_ );
+            } );
+        } while ( swept_ == batch );
 
-//        squawk::db::db_statement_ptr stmt_delete_album = _db->prepareStatement ( squawk::sql::DELETE_ALBUM );
-//        stmt_delete_album->update();
+        do {
+            swept_ = _write ( [batch, &stats_] ( db::db_connection_ptr db_ ) { return _sweep_artists ( db_, batch, stats_ ); } );
+        } while ( swept_ == batch );
 
-//        squawk::db::db_statement_ptr stmt_orphan_artist_mappings = _db->prepareStatement ( squawk::sql::DELETE_ORPHAN_ARTIST_MAPPINGS );
-//        stmt_orphan_artist_mappings->update();
+        //remove the cached files when the rows are gone.
+        flush();
+        _objects.clear();
 
-//        squawk::db::db_statement_ptr stmt_orphan_artist = _db->prepareStatement ( squawk::sql::DELETE_ORPHAN_ARTIST );
-//        stmt_orphan_artist->update();
+    } catch ( db::DbException & e ) {
+        LOG ( ERROR ) << "Sweep, Exception:" << e.code() << "-> " << e.what();
+        throw upnp::UpnpException ( e.code(), "DbException: " +  std::string ( e.what() ) );
+    }
+
+    _remove_files ( files_, stats_ );
+    LOG ( INFO ) << "sweep: objects=" << stats_.objects << ", resources=" << stats_.resources << ", album_art_uris=" << stats_.album_art_uris <<
+                 ", artists=" << stats_.artists << ", files=" << stats_.files << ", bytes=" << stats_.bytes;
+    return stats_;
+}
+
+size_t UpnpContentDirectoryDao::_sweep_objects ( db::db_connection_ptr db, const long mtime, const size_t batch,
+        const std::vector< std::string > & directories, SweepStats & stats, std::list< std::string > & files ) {
+    static const std::string batch_ = "( select ROWID from tbl_cds_object where timestamp < ?1 order by timestamp, ROWID limit ?2 )";
+    auto stmt_ = [&db, mtime, batch] ( const std::string & query ) {
+        db::db_statement_ptr stmt_ = db->prepareStatement ( query );
+        stmt_->bind_int64 ( 1, mtime );
+        stmt_->bind_int64 ( 2, batch );
+        return stmt_;
+    };
+
+    //the generated previews and album art of the objects in the cache directories.
+    std::list< std::string > cached_;
+    db::db_statement_ptr stmt_files_ = stmt_ ( "select path from tbl_cds_resource where ref_obj in " + batch_ +
+                                       " union select path from tbl_cds_album_art_uri where ref_obj in " + batch_ );
+
+    while ( stmt_files_->step() ) {
+        const std::string path_ = stmt_files_->get_string ( 0 );
+
+        for ( auto & directory : directories ) {
+            if ( boost::algorithm::starts_with ( path_, directory ) ) {
+                cached_.push_back ( path_ );
+            }
+        }
+    }
+
+    stmt_files_.reset();
+
+    stmt_ ( "delete from tbl_cds_resource where ref_obj in " + batch_ )->update();
+    stats.resources += db->last_changes_count();
+    stmt_ ( "delete from tbl_cds_album_art_uri where ref_obj in " + batch_ )->update();
+    stats.album_art_uris += db->last_changes_count();
+    stmt_ ( "delete from tbl_cds_object where ROWID in " + batch_ )->update();
+    const size_t objects_ = db->last_changes_count();
+    stats.objects += objects_;
+
+    //keep the files still used by other rows.
+    db::db_statement_ptr stmt_used_ = db->prepareStatement ( "select exists( select 1 from tbl_cds_resource where path = ?1 ) "
+                                      "or exists( select 1 from tbl_cds_album_art_uri where path = ?1 )" );
+
+    for ( auto & path : cached_ ) {
+        stmt_used_->bind_text ( 1, path );
+
+        if ( stmt_used_->step() && stmt_used_->get_int ( 0 ) == 0 ) {
+            files.push_back ( path );
+        }
+
+        stmt_used_->reset();
+    }
+
+    return objects_;
+}
+
+size_t UpnpContentDirectoryDao::_sweep_artists ( db::db_connection_ptr db, const size_t batch, SweepStats & stats ) {
+    //the artists are referenced by the clean name in the artist and contributor of the albums and tracks.
+    db::db_statement_ptr stmt_ = db->prepareStatement (
+                                     "delete from tbl_cds_artist where ROWID in ( select ROWID from tbl_cds_artist where "
+                                     "not exists( select 1 from tbl_cds_object where cls in ( 2, 5, 9 ) and artist = tbl_cds_artist.clean_name ) and "
+                                     "not exists( select 1 from tbl_cds_object where cls in ( 2, 5, 9 ) and contributor = tbl_cds_artist.clean_name ) limit ? )" );
+    stmt_->bind_int64 ( 1, batch );
+    stmt_->update();
+    const size_t artists_ = db->last_changes_count();
+    stats.artists += artists_;
+    return artists_;
+}
+
+void UpnpContentDirectoryDao::_remove_files ( const std::list< std::string > & files, SweepStats & stats ) {
+    for ( auto & file : files ) {
+        boost::system::error_code ec_;
+        const boost::uintmax_t size_ = boost::filesystem::file_size ( file, ec_ );
+
+        if ( !ec_ && boost::filesystem::remove ( file, ec_ ) ) {
+            ++stats.files;
+            stats.bytes += size_;
+
+        } else if ( ec_ ) {
+            LOG ( WARNING ) << "sweep: can not remove " << file << ": " << ec_.message();
+        }
+    }
+}
+
+/* COUNTERS */
+void UpnpContentDirectoryDao::_changed() {
+    ++_generation;
+    _keysets.clear();
+    //the snapshot is outdated, release the memory until the next one is published.
+    std::atomic_store ( &_snapshot, std::shared_ptr< const UpnpCatalogSnapshot >() );
+}
+
+void UpnpContentDirectoryDao::_invalidate ( const int64_t id ) {
+    std::lock_guard< std::mutex > lck ( _pending_mtx );
+    _objects.erase ( id );
+    _pending.insert ( id );
+}
+
+void UpnpContentDirectoryDao::_committed() {
+    std::set< int64_t > pending_;
+    {
+        std::lock_guard< std::mutex > lck ( _pending_mtx );
+        pending_.swap ( _pending );
+    }
+
+    //readers may have stored the objects from before the commit.
+    for ( auto & id : pending_ ) {
+        _objects.erase ( id );
+    }
+
+    _changed();
+}
+
+std::map< std::string, size_t > UpnpContentDirectoryDao::_load_counters ( db::db_connection_ptr db ) {
+    std::map< std::string, size_t > counters_;
+    db::db_statement_ptr stmt_counters_ = db->prepareStatement ( "select name, value from tbl_cds_counter" );
+
+    while ( stmt_counters_->step() ) {
+        const int64_t value_ = stmt_counters_->get_int64 ( 1 );
+        counters_[ stmt_counters_->get_string ( 0 ) ] = ( value_ > 0 ? value_ : 0 );
+    }
+
+    return counters_;
+}
+
+std::map< std::string, size_t > UpnpContentDirectoryDao::_counters() const {
+    std::lock_guard< std::mutex > lck ( _counters_mtx );
+    //read the generation first, a change during the load reloads with the next call.
+    const size_t generation_ = _generation.load();
+
+    if ( _counters_generation != generation_ ) {
+        _counter_values = _load_counters ( _db_pool->reader() );
+        _counters_generation = generation_;
+    }
+
+    return _counter_values;
+}
+
+size_t UpnpContentDirectoryDao::_counter ( const std::string & name ) const {
+    std::map< std::string, size_t > counters_ = _counters();
+    auto counter_ = counters_.find ( name );
+    return ( counter_ == counters_.end() ? 0 : counter_->second );
 }
 
 size_t UpnpContentDirectoryDao::objectsCount ( didl::DIDL_CLASS cls, std::map< std::string, std::string > filters ) {
     LOG ( TRACE ) << didl::className ( cls );
 
+    if ( filters.empty() ) {
+        return _counter ( "cls:" + std::to_string ( cls ) );
+    }
+
+    db::db_connection_ptr db_ = _db_pool->reader();
+
     size_t result_count = 0;
-    std::stringstream query_string_;
-    query_string_ << "select count(*) from tbl_cds_object where cls = ?";
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+    query_ << "select count(*) from tbl_cds_object where cls = ";
+    query_.value ( cls );
+    parse_filters ( query_, filters );
 
-    if ( ! filters.empty() ) {
-        query_string_ << " AND (";
-        parse_attributes ( query_string_, filters );
-        query_string_ << ")";
+    LOG(TRACE) << "Execute query (objectsCount): " << query_.str();
+
+    db::db_statement_ptr stmt_objects_ = query_.prepare ( db_ );
+
+    while ( stmt_objects_->step() ) {
+        result_count = stmt_objects_->get_int ( 0 );
+    }
+
+    return result_count;
+}
+
+size_t UpnpContentDirectoryDao::searchCount ( didl::DIDL_CLASS cls, const std::string & text, std::map< std::string, std::string > filters ) const {
+    LOG ( TRACE ) << "SearchCount<" << didl::className ( cls ) << ">::" << text;
+
+    size_t result_count = 0;
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+
+    if ( ! _search_query ( query_, text ) ) {
+        return result_count;
     }
 
-    LOG(TRACE) << "Execute query (objectsCount): " << query_string_.str();
+    query_ << " select count(*) from hits, tbl_cds_object where tbl_cds_object.ROWID = hits.hit";
+    parse_class ( cls, " and ", query_, filters );
+    parse_filters ( query_, filters );
 
-    db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
-    stmt_objects_->bind_int ( 1, cls );
+    LOG ( TRACE ) << "Execute query (searchCount): " << query_.str();
+
+    db::db_connection_ptr db_ = _db_pool->reader();
+    db::db_statement_ptr stmt_objects_ = query_.prepare ( db_ );
 
     while ( stmt_objects_->step() ) {
         result_count = stmt_objects_->get_int ( 0 );
@@ -102,19 +680,51 @@ size_t UpnpContentDirectoryDao::objectsCount ( didl::DIDL_CLASS cls, std::map< s
     return result_count;
 }
 
-size_t UpnpContentDirectoryDao::childrenCount ( didl::DIDL_CLASS cls, const size_t & parent, std::map< std::string, std::string > filters ) {
-    LOG ( TRACE ) << "ChildrenCount<" << didl::className ( cls ) << ">::parent=" << parent;
+std::string UpnpContentDirectoryDao::_search_match ( const std::string & text ) {
+    std::vector< std::string > words_;
+    boost::split ( words_, text, boost::is_any_of ( " \t\r\n" ), boost::token_compress_on );
+    std::string match_;
+
+    for ( auto & word : words_ ) {
+        //the quotes keep the fts5 operators in the text as words.
+        const std::string word_ = boost::algorithm::erase_all_copy ( word, "\"" );
+
+        if ( word_.empty() ) { continue; }
+
+        if ( ! match_.empty() ) { match_ += " "; }
+
+        match_ += "\"" + word_ + "\"*";
+    }
+
+    return match_;
+}
+
+bool UpnpContentDirectoryDao::_search_query ( db::Sqlite3QueryBuilder & query, const std::string & text ) {
+    const std::string match_ = _search_match ( text );
+
+    if ( match_.empty() ) {
+        return false;
+    }
+
+    query << "with hits( hit, score ) as ( select rowid, rank from tbl_cds_search where tbl_cds_search match ";
+    query.value ( match_ );
+    query << " )";
+    return true;
+}
+
+size_t UpnpContentDirectoryDao::searchCount ( const UpnpSearchCriteria & criteria, const size_t container,
+        const std::vector< didl::DIDL_CLASS > & classes ) const {
+    LOG ( TRACE ) << "SearchCount::" << container;
 
     size_t result_count = 0;
-    std::stringstream query_string_;
-    query_string_ << "select count(*) from tbl_cds_object where parent_id = ? ";
-    parse_class ( cls, " and ", query_string_, filters );
-    parse_filters ( query_string_, filters );
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+    query_ << "select count(*) from tbl_cds_object where ";
+    _search_where ( query_, criteria, container, classes );
 
-    LOG ( TRACE ) << "Execute query (childrenCount): " << query_string_.str();
+    LOG ( TRACE ) << "Execute query (searchCount): " << query_.str();
 
-    db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
-    stmt_objects_->bind_int ( 1, parent );
+    db::db_connection_ptr db_ = _db_pool->reader();
+    db::db_statement_ptr stmt_objects_ = query_.prepare ( db_ );
 
     while ( stmt_objects_->step() ) {
         result_count = stmt_objects_->get_int ( 0 );
@@ -123,73 +733,126 @@ size_t UpnpContentDirectoryDao::childrenCount ( didl::DIDL_CLASS cls, const size
     return result_count;
 }
 
-didl::DidlStatistics UpnpContentDirectoryDao::statistics() {
+void UpnpContentDirectoryDao::_search_where ( db::Sqlite3QueryBuilder & query, const UpnpSearchCriteria & criteria, const size_t container,
+        const std::vector< didl::DIDL_CLASS > & classes ) {
+    if ( ! classes.empty() ) {
+        query << "cls in ( ";
 
-    int albums_count_, artist_count_;
-    std::map< std::string, int> audiofile_types_;
-    std::map< std::string, int > file_types_;
+        for ( size_t i = 0; i < classes.size(); ++i ) {
+            query << ( i > 0 ? ", " : "" ) << static_cast< int > ( classes[i] );
+        }
 
-    try {
-        //Get the Albums Count
-        db::db_statement_ptr stmt_albums = _db->prepareStatement ( "select count(*) from tbl_cds_object where cls=2" );
+        query << " ) and ";
+    }
 
-        while ( stmt_albums->step() ) {
-            albums_count_ = stmt_albums->get_int ( 0 );
-        }
+    if ( container != 0 ) {
+        query << "ROWID in ( with recursive tree( id ) as ( select ";
+        query.value ( static_cast< int64_t > ( container ) );
+        query << " union all select tbl_cds_object.ROWID from tbl_cds_object, tree where tbl_cds_object.parent_id = tree.id ) "
+                 "select id from tree ) and ";
+    }
 
-        //Get the Artist Count
-        db::db_statement_ptr stmt_artists = _db->prepareStatement ( "select count(*) from tbl_cds_artist" );
+    criteria.where ( query );
+}
 
-        while ( stmt_artists->step() ) {
-            artist_count_ = stmt_artists->get_int ( 0 );
-        }
+size_t UpnpContentDirectoryDao::childrenCount ( didl::DIDL_CLASS cls, const size_t & parent, std::map< std::string, std::string > filters ) {
+    LOG ( TRACE ) << "ChildrenCount<" << didl::className ( cls ) << ">::parent=" << parent;
 
-        //Get the Files Count
-        db::db_statement_ptr stmt_audiofiles = _db->prepareStatement ( "select mime_type, count(mime_type) from tbl_cds_resource GROUP BY mime_type" );
+    if ( cls == didl::object && parent == 0 && filters.empty() ) {
+        return _counter ( "root" );
+    }
+
+    std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
 
-        while ( stmt_audiofiles->step() ) {
-            audiofile_types_[ stmt_audiofiles->get_string ( 0 ) ] = stmt_audiofiles->get_int ( 1 );
+    if ( catalog_ && filters.empty() ) {
+        const UpnpCatalogSnapshot::range_t children_ = catalog_->children ( parent );
+
+        if ( cls == didl::object ) {
+            return children_.second - children_.first;
         }
 
-        //Get the Files Count
-        db::db_statement_ptr stmt_type = _db->prepareStatement ( "select cls, count(cls) from tbl_cds_object where cls > 0 GROUP BY cls" );
+        return std::count_if ( children_.first, children_.second, [&catalog_, cls] ( const UpnpCatalogSnapshot::position_t position ) {
+            return catalog_->cls ( position ) == cls;
+        } );
+    }
+
+    db::db_connection_ptr db_ = _db_pool->reader();
+
+    size_t result_count = 0;
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+    query_ << "select count(*) from tbl_cds_object where parent_id = ";
+    query_.value ( parent );
+    parse_class ( cls, " and ", query_, filters );
+    parse_filters ( query_, filters );
 
-        while ( stmt_type->step() ) {
-            std::string type_ = "TEXT";
+    LOG ( TRACE ) << "Execute query (childrenCount): " << query_.str();
 
-            switch ( stmt_type->get_int ( 0 ) ) {
-            case didl::objectContainer:
-                type_ = "FOLDER";
-                break;
+    db::db_statement_ptr stmt_objects_ = query_.prepare ( db_ );
 
-            case didl::objectContainerAlbumMusicAlbum:
-                type_ = "ALBUM";
-                continue;
+    while ( stmt_objects_->step() ) {
+        result_count = stmt_objects_->get_int ( 0 );
+    }
+
+    return result_count;
+}
+
+didl::DidlStatistics UpnpContentDirectoryDao::statistics() {
+    std::map< std::string, int> audiofile_types_;
+    std::map< std::string, int > file_types_;
 
-            case didl::objectContainerPersonMusicArtist:
-                type_ = "ARTIST";
+    try {
+        const std::map< std::string, size_t > counters_ = _counters();
+        auto counter_ = [&counters_] ( const std::string & name ) -> int {
+            auto value_ = counters_.find ( name );
+            return ( value_ == counters_.end() ? 0 : value_->second );
+        };
+
+        for ( auto & c : counters_ ) {
+            if ( c.second == 0 ) {
                 continue;
 
-            case didl::objectItem:
-                type_ = "ITEM";
-                break;
+            } else if ( c.first.compare ( 0, 5, "mime:" ) == 0 ) {
+                //Get the Files Count
+                audiofile_types_[ c.first.substr ( 5 ) ] = c.second;
 
-            case didl::objectItemAudioItemMusicTrack:
-                type_ = "AUDIO_TRACK";
-                break;
+            } else if ( c.first.compare ( 0, 4, "cls:" ) == 0 ) {
+                //Get the Files Count
+                std::string type_ = "TEXT";
 
-            case didl::objectItemImageItemPhoto:
-                type_ = "IMAGE";
-                break;
+                switch ( std::stoi ( c.first.substr ( 4 ) ) ) {
+                case didl::object:
+                case didl::objectContainerAlbumMusicAlbum:
+                case didl::objectContainerPersonMusicArtist:
+                    continue;
 
-            case didl::objectItemVideoItemMovie:
-                type_ = "MOVIE";
-                break;
-            }
+                case didl::objectContainer:
+                    type_ = "FOLDER";
+                    break;
 
-            file_types_[ type_ ] = stmt_type->get_int ( 1 );
+                case didl::objectItem:
+                    type_ = "ITEM";
+                    break;
+
+                case didl::objectItemAudioItemMusicTrack:
+                    type_ = "AUDIO_TRACK";
+                    break;
+
+                case didl::objectItemImageItemPhoto:
+                    type_ = "IMAGE";
+                    break;
+
+                case didl::objectItemVideoItemMovie:
+                    type_ = "MOVIE";
+                    break;
+                }
+
+                file_types_[ type_ ] = c.second;
+            }
         }
 
+        return didl::DidlStatistics ( counter_ ( "cls:" + std::to_string ( didl::objectContainerAlbumMusicAlbum ) ),
+                                      counter_ ( "artists" ), audiofile_types_, file_types_ );
+
     } catch ( db::DbException & e ) {
         LOG ( FATAL ) << "Can not get statistic, Exception:" << e.code() << "-> " << e.what();
         throw;
@@ -198,18 +861,17 @@ didl::DidlStatistics UpnpContentDirectoryDao::statistics() {
         LOG ( FATAL ) << "Other Excpeption in get_statistic.";
         throw;
     }
-
-    return didl::DidlStatistics ( albums_count_, artist_count_, audiofile_types_, file_types_ );
 }
 
 /* ARTIST OBJECT */
 didl::DidlContainerArtist UpnpContentDirectoryDao::artist ( const std::string & name ) {
+    db::db_connection_ptr db_ = _db_pool->reader();
     std::string clean_name_ = UpnpContentDirectoryParser::_clean_name ( name );
 
     try {
         LOG ( TRACE ) << "Artist:" << clean_name_;
 
-        db::db_statement_ptr stmt_artist_ = _db->prepareStatement (
+        db::db_statement_ptr stmt_artist_ = db_->prepareStatement (
                                                 "select ROWID, name, clean_name, import from tbl_cds_artist where ROWID = ?" );
         stmt_artist_->bind_text ( 1, clean_name_ );
 
@@ -231,35 +893,58 @@ didl::DidlContainerArtist UpnpContentDirectoryDao::artist ( const std::string &
 }
 std::list< didl::DidlContainerArtist > UpnpContentDirectoryDao::artists ( const size_t & start_index, const size_t & result_count,
         std::map< std::string, std::string > filters, std::pair< std::string, std::string > sort ) const {
+    std::list< didl::DidlContainerArtist > artist_list_;
+    visitArtists ( start_index, result_count, [&artist_list_] ( didl::DidlContainerArtist & artist ) {
+        artist_list_.push_back ( std::move ( artist ) );
+    }, filters, sort );
+    return artist_list_;
+}
 
-    try {
-        LOG ( TRACE ) << "Artists:" << start_index << ", " << result_count << ")";
+size_t UpnpContentDirectoryDao::visitArtists ( const size_t & start_index, const size_t & result_count,
+        std::function< void ( didl::DidlContainerArtist & ) > visitor,
+        std::map< std::string, std::string > filters, std::pair< std::string, std::string > sort ) const {
+    LOG ( TRACE ) << "Artists:" << start_index << ", " << result_count << ")";
+
+    std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
+
+    if ( catalog_ && filters.empty() && ( sort.first == "name" || sort.first == "title" ) && ( sort.second == "asc" || sort.second == "desc" ) ) {
+        const UpnpCatalogSnapshot::range_t artists_ = catalog_->artists();
+        const size_t size_ = artists_.second - artists_.first;
+        size_t count_ = 0;
+
+        for ( size_t i = ( result_count > 0 ? std::min ( start_index, size_ ) : 0 ); i < size_ && ( result_count == 0 || count_ < result_count ); ++i ) {
+            UpnpCatalogSnapshot::Row row_ = catalog_->artist ( sort.second == "desc" ? artists_.first[ size_ - i - 1 ] : artists_.first[ i ] );
+            didl::DidlContainerArtist artist_ ( row_.get_int ( 0 ) /*ROWID*/, 0 /*parent_id*/, row_.get_string ( 1 ) /* title,*/, "" /*path*/,
+                                                0 /*mtime*/, 0 /*object_update_id*/, row_.get_int ( 4 ) /*child_count*/,
+                                                row_.get_string ( 2 ) /*clean_name*/, row_.get_int ( 3 ) /*import*/ );
+            visitor ( artist_ );
+            ++count_;
+        }
 
-        std::stringstream query_string_;
-        query_string_ << "select ROWID, name, clean_name, import from tbl_cds_artist";
+        return count_;
+    }
 
-        if ( ! filters.empty() ) {
-            query_string_ << " WHERE ";
-            parse_attributes ( query_string_, filters );
-        }
+    db::db_connection_ptr db_ = _db_pool->reader();
 
-        query_string_ << " order by " << sort.first << " " << sort.second;
+    try {
 
-        if ( result_count > 0 ) {
-            query_string_ << " limit ?, ? ";
-        }
+        db::Sqlite3QueryBuilder query_ ( ARTIST_COLUMNS );
+        const std::string sort_ = _sort_keys ( sort.first, ARTIST_SORT_KEYS );
+        query_ << "select ROWID, name, clean_name, import";
+        db::Sqlite3KeysetCache::select ( query_, sort_, "ROWID", result_count );
+        query_ << " from tbl_cds_artist WHERE ";
 
-        db::db_statement_ptr stmt_artists_ = _db->prepareStatement ( query_string_.str() );
+        if ( ! filters.empty() ) {
+            query_ << "( ";
+            parse_attributes ( query_, filters );
+            query_ << " )";
 
-        if ( result_count > 0 ) {
-            stmt_artists_->bind_int ( 1, start_index );
-            stmt_artists_->bind_int ( 2, result_count );
-        }
+        } else { query_ << "1"; }
 
-        std::list< didl::DidlContainerArtist > artist_list_;
+        size_t count_ = 0;
 
-        while ( stmt_artists_->step() ) {
-            db::db_statement_ptr stmt_albums_artists_ = _db->prepareStatement (
+        _keysets.page ( db_, query_, sort_, sort.second, "ROWID", start_index, result_count, [&db_, &visitor, &count_] ( db::Sqlite3Statement * stmt_artists_ ) {
+            db::db_statement_ptr stmt_albums_artists_ = db_->prepareStatement (
                         "select count(*) from tbl_cds_object where cls=? and (artist = ? or publisher=?)" );
             stmt_albums_artists_->bind_int ( 1, didl::objectContainerAlbumMusicAlbum );
             stmt_albums_artists_->bind_text ( 2, stmt_artists_->get_string ( 2 ) );
@@ -270,16 +955,18 @@ std::list< didl::DidlContainerArtist > UpnpContentDirectoryDao::artists ( const
                 albums_count_ = stmt_albums_artists_->get_int ( 0 );
             }
 
-            artist_list_.push_back (
-                didl::DidlContainerArtist ( stmt_artists_->get_int ( 0 ) /*ROWID*/, 0 /*parent_id*/,
-                                            stmt_artists_->get_string ( 1 ) /* title,*/,
-                                            "" /*path*/,
-                                            0 /*mtime*/, 0 /*object_update_id*/,
-                                            albums_count_ /*child_count*/, stmt_artists_->get_string ( 2 ) /*clean_name*/,
-                                            stmt_artists_->get_int ( 3 ) /*import*/ ) );
-        }
+            stmt_albums_artists_.reset();
+            didl::DidlContainerArtist artist_ ( stmt_artists_->get_int ( 0 ) /*ROWID*/, 0 /*parent_id*/,
+                                                stmt_artists_->get_string ( 1 ) /* title,*/,
+                                                "" /*path*/,
+                                                0 /*mtime*/, 0 /*object_update_id*/,
+                                                albums_count_ /*child_count*/, stmt_artists_->get_string ( 2 ) /*clean_name*/,
+                                                stmt_artists_->get_int ( 3 ) /*import*/ );
+            visitor ( artist_ );
+            ++count_;
+        } );
 
-        return artist_list_;
+        return count_;
 
     } catch ( db::DbException & e ) {
         LOG ( FATAL ) << "Get artists, Exception:" << e.code() << "-> " << e.what();
@@ -291,16 +978,22 @@ std::list< didl::DidlContainerArtist > UpnpContentDirectoryDao::artists ( const
 size_t UpnpContentDirectoryDao::artistsCount ( std::map< std::string, std::string > filters ) {
     LOG ( TRACE ) << "count artists";
 
+    if ( filters.empty() ) {
+        return _counter ( "artists" );
+    }
+
+    db::db_connection_ptr db_ = _db_pool->reader();
+
     try {
-        std::stringstream query_string_;
-        query_string_ << "select count(*) from tbl_cds_artist";
+        db::Sqlite3QueryBuilder query_ ( ARTIST_COLUMNS );
+        query_ << "select count(*) from tbl_cds_artist";
 
         if ( ! filters.empty() ) {
-            query_string_ << " WHERE ";
-            parse_attributes ( query_string_, filters );
+            query_ << " WHERE ";
+            parse_attributes ( query_, filters );
         }
 
-        db::db_statement_ptr stmt_artist_ = _db->prepareStatement ( query_string_.str() );
+        db::db_statement_ptr stmt_artist_ = query_.prepare ( db_ );
 
         if ( stmt_artist_->step() ) {
             return stmt_artist_->get_int ( 0 );
@@ -318,39 +1011,20 @@ didl::DidlContainerArtist UpnpContentDirectoryDao::save ( const didl::DidlContai
     LOG ( TRACE ) << "Save artist = id:" << artist.id() << ", " << artist.title();
 
     try {
-        size_t artist_id_  = 0;
-        db::db_statement_ptr stmt_artist_ = _db->prepareStatement ( "select ROWID from tbl_cds_artist where clean_name = ?" );
-        stmt_artist_->bind_text ( 1, artist.cleanName() );
-        db::db_statement_ptr stmt_ = nullptr;
-
-        if ( stmt_artist_->step() ) {
-            artist_id_ = stmt_artist_->get_int ( 0 );
-
-            stmt_ = _db->prepareStatement (
-                        "update tbl_cds_artist SET " \
-                        "name=?, clean_name=?, import=? "\
-                        "where ROWID = ?" );
-
-        } else {
-
-            stmt_ = _db->prepareStatement (
-                        "insert into tbl_cds_artist( "\
-                        "name, clean_name, import) "\
-                        "values (?,?,?)" );
-        }
-
-        stmt_->bind_text ( 1, artist.title() );
-        stmt_->bind_text ( 2, artist.cleanName() );
-        stmt_->bind_int ( 3, artist.import() );
-
-        // the id in the sql where clause
-        if ( artist_id_ > 0 )
-        { stmt_->bind_int ( 4, artist_id_ ); }
-
-        stmt_->update();
-
-        if ( artist_id_ == 0 )
-        { artist_id_ =  _db->last_insert_rowid(); }
+        const size_t artist_id_ = _write ( [&artist] ( db::db_connection_ptr db_ ) {
+            db::db_statement_ptr stmt_ = db_->prepareStatement (
+                                             "insert into tbl_cds_artist( "\
+                                             "name, clean_name, import, name_sort) "\
+                                             "values (?,?,?,?) "\
+                                             "on conflict( clean_name ) do update set name=excluded.name, import=excluded.import, "\
+                                             "name_sort=excluded.name_sort returning ROWID" );
+
+            stmt_->bind_text ( 1, artist.title() );
+            stmt_->bind_text ( 2, artist.cleanName() );
+            stmt_->bind_int ( 3, artist.import() );
+            stmt_->bind_text ( 4, commons::text::sort_key ( artist.title() ) );
+            return ( stmt_->step() ? stmt_->get_int64 ( 0 ) : 0 );
+        } );
 
         return ( didl::DidlContainerArtist ( artist_id_, 0, artist.title(), "", 0,
                                              0, 0, artist.cleanName(), artist.import() ) );
@@ -362,73 +1036,14 @@ didl::DidlContainerArtist UpnpContentDirectoryDao::save ( const didl::DidlContai
 }
 
 didl::DidlResource UpnpContentDirectoryDao::save ( const didl::DidlResource resource ) {
-    db::db_connection_ptr db_ = SquawkServer::instance()->db();
-
-    size_t resource_id_  = 0;
-    db::db_statement_ptr stmt_resource_ = db_->prepareStatement ( "select ROWID from tbl_cds_resource where ref_obj = ?" );
-    stmt_resource_->bind_int ( 1, resource.refObj() );
-    db::db_statement_ptr stmt = nullptr;
-
-    if ( stmt_resource_->step() ) {
-        resource_id_ = stmt_resource_->get_int ( 0 );
-
-        stmt = db_->prepareStatement (
-                   "update tbl_cds_resource SET " \
-                   "ref_obj=?, protocol_info=?, path=?, bitrate=?, bits_per_sample=?, color_depth=?, dlna_profile=?, duration=?, framerate=?, mime_type=?,"\
-                   "nr_audio_channels=?, resolution=?, sample_frequency=?, size=? "\
-                   "where ROWID = ?" );
-
-    } else {
-
-        stmt = db_->prepareStatement (
-                   "insert into tbl_cds_resource( "\
-                   "ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type, "\
-                   "nr_audio_channels, resolution, sample_frequency, size) "\
-                   "values (?,?,?,?,?,?,?,?,?,?,?,?,?,?)" );
-    }
-
-    stmt->bind_int ( 1, resource.refObj() );
-    stmt->bind_text ( 2, resource.protocolInfo() );
-    stmt->bind_text ( 3, resource.path() );
-
-    stmt->bind_text ( 4, ( resource.attributes().find ( didl::DidlResource::bitrate ) != resource.attributes().end() ?
-                           resource.attributes() [ didl::DidlResource::bitrate ] : 0 ) );
-
-    stmt->bind_text ( 5, ( resource.attributes().find ( didl::DidlResource::bitsPerSample ) != resource.attributes().end() ?
-                           resource.attributes() [ didl::DidlResource::bitsPerSample ] : 0 ) );
-
-    stmt->bind_text ( 6, ( resource.attributes().find ( didl::DidlResource::colorDepth ) != resource.attributes().end() ?
-                           resource.attributes() [ didl::DidlResource::colorDepth ] : 0 ) );
-
-    stmt->bind_text ( 7, resource.dlnaProfile() );
-
-    stmt->bind_text ( 8, ( resource.attributes().find ( didl::DidlResource::duration ) != resource.attributes().end() ?
-                           resource.attributes() [ didl::DidlResource::duration ] : 0 ) );
-
-    stmt->bind_text ( 9, ( resource.attributes().find ( didl::DidlResource::framerate ) != resource.attributes().end() ?
-                           resource.attributes() [ didl::DidlResource::framerate] : 0 ) );
-
-    stmt->bind_text ( 10, resource.mimeType() );
-
-    stmt->bind_text ( 11, ( resource.attributes().find ( didl::DidlResource::nrAudioChannels ) != resource.attributes().end() ?
-                            resource.attributes() [ didl::DidlResource::nrAudioChannels ] : 0 ) );
-
-    stmt->bind_text ( 12, ( resource.attributes().find ( didl::DidlResource::resolution ) != resource.attributes().end() ?
-                            resource.attributes() [ didl::DidlResource::resolution ] : "" ) );
-
-    stmt->bind_text ( 13, ( resource.attributes().find ( didl::DidlResource::sampleFrequency ) != resource.attributes().end() ?
-                            resource.attributes() [ didl::DidlResource::sampleFrequency ] : 0 ) );
-
-    stmt->bind_int ( 14, resource.size() );
-
-    // the id in the sql where clause
-    if ( resource_id_ > 0 )
-    { stmt->bind_int ( 15, resource_id_ ); }
-
-    stmt->update();
-
-    if ( resource_id_ == 0 )
-    { resource_id_ = SquawkServer::instance()->db()->last_insert_rowid(); }
+    const size_t resource_id_ = _write ( [&resource] ( db::db_connection_ptr db_ ) {
+        static const std::string query_ = upsert_statement ( "tbl_cds_resource", resource_columns(), 1 ) + " returning ROWID";
+        db::db_statement_ptr stmt = db_->prepareStatement ( query_ );
+        int index_ = 0;
+        bind_resource ( stmt.get(), index_, resource.refObj(), resource );
+        return ( stmt->step() ? stmt->get_int64 ( 0 ) : 0 );
+    } );
+    _invalidate ( resource.refObj() );
 
     return didl::DidlResource ( resource_id_, resource.refObj(), resource.size(), resource.uri(),
                                 resource.path(), resource.protocolInfo(), resource.dlnaProfile(),
@@ -437,35 +1052,41 @@ didl::DidlResource UpnpContentDirectoryDao::save ( const didl::DidlResource reso
 
 std::list< didl::DidlContainer > UpnpContentDirectoryDao::series ( const size_t & start_index, const size_t & result_count,
         std::map< std::string, std::string > filters, std::pair< std::string, std::string > sort ) const {
+    std::list< didl::DidlContainer > series_list_;
+    visitSeries ( start_index, result_count, [&series_list_] ( didl::DidlContainer & series ) {
+        series_list_.push_back ( std::move ( series ) );
+    }, filters, sort );
+    return series_list_;
+}
 
-    LOG ( TRACE ) << "series:" << start_index << ", " << result_count << ")";
-
-    std::stringstream query_string_;
-    query_string_ << "select distinct series_title from tbl_cds_object where series_title!='' ";
+size_t UpnpContentDirectoryDao::visitSeries ( const size_t & start_index, const size_t & result_count,
+        std::function< void ( didl::DidlContainer & ) > visitor,
+        std::map< std::string, std::string > filters, std::pair< std::string, std::string > sort ) const {
+    db::db_connection_ptr db_ = _db_pool->reader();
 
-    if ( ! filters.empty() ) {
-        query_string_ << " AND( ";
-        parse_attributes ( query_string_, filters );
-        query_string_ << " ) ";
-    }
+    LOG ( TRACE ) << "series:" << start_index << ", " << result_count << ")";
 
-    query_string_ << " order by " << sort.first << " " << sort.second;
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+    //the distinct titles are unique, the keyset needs no ROWID. other sort columns read with the offset.
+    const bool seek_ = ( sort.first == "series_title" );
+    query_ << "select distinct series_title";
 
-    if ( result_count > 0 ) {
-        query_string_ << " limit ?, ? ";
+    if ( seek_ ) {
+        db::Sqlite3KeysetCache::select ( query_, sort.first, "", result_count );
     }
 
-    db::db_statement_ptr stmt_series_ = _db->prepareStatement ( query_string_.str() );
+    query_ << " from tbl_cds_object where series_title!='' ";
 
-    if ( result_count > 0 ) {
-        stmt_series_->bind_int ( 1, start_index );
-        stmt_series_->bind_int ( 2, result_count );
+    if ( ! filters.empty() ) {
+        query_ << " AND( ";
+        parse_attributes ( query_, filters );
+        query_ << " ) ";
     }
 
-    std::list< didl::DidlContainer > series_list_;
+    size_t count_ = 0;
 
-    while ( stmt_series_->step() ) {
-        db::db_statement_ptr stmt_series_count_ = _db->prepareStatement (
+    auto read_ = [&db_, &visitor, &count_] ( db::Sqlite3Statement * stmt_series_ ) {
+        db::db_statement_ptr stmt_series_count_ = db_->prepareStatement (
                     "select count(*) from tbl_cds_object where series_title = ?" );
         stmt_series_count_->bind_text ( 1, stmt_series_->get_string ( 0 ) );
         int series_count_ = 0;
@@ -474,35 +1095,49 @@ std::list< didl::DidlContainer > UpnpContentDirectoryDao::series ( const size_t
             series_count_ = stmt_series_count_->get_int ( 0 );
         }
 
-        series_list_.push_back (
-            didl::DidlContainer ( 0 /*ROWID*/, 0 /*parent_id*/,
-                                  stmt_series_->get_string ( 0 ) /* title,*/,
-                                  "" /*path*/,
-                                  0 /*mtime*/, 0 /*object_update_id*/,
-                                  series_count_ /*child_count*/, true ) );
+        stmt_series_count_.reset();
+        didl::DidlContainer series_ ( 0 /*ROWID*/, 0 /*parent_id*/,
+                                      stmt_series_->get_string ( 0 ) /* title,*/,
+                                      "" /*path*/,
+                                      0 /*mtime*/, 0 /*object_update_id*/,
+                                      series_count_ /*child_count*/, true );
+        visitor ( series_ );
+        ++count_;
+    };
+
+    if ( seek_ ) {
+        _keysets.page ( db_, query_, sort.first, sort.second, "", start_index, result_count, read_ );
+
+    } else {
+        query_.order_by ( sort.first, sort.second );
+        query_.limit ( start_index, result_count );
+        db::db_statement_ptr stmt_series_ = query_.prepare ( db_ );
+
+        while ( stmt_series_->step() ) {
+            read_ ( stmt_series_.get() );
+        }
     }
 
-    return series_list_;
+    return count_;
 }
 
 size_t UpnpContentDirectoryDao::seriesCount ( std::map< std::string, std::string > filters ) const {
-
     LOG ( TRACE ) << "seriesCount:";
 
-    std::stringstream query_string_;
-
     if ( filters.empty() ) {
-        query_string_ << "select count(distinct series_title) from tbl_cds_object";
-
-    } else {
-        query_string_ << "select count(series_title) from tbl_cds_object";
-        query_string_ << " WHERE ";
-        parse_attributes ( query_string_, filters );
+        return _counter ( "series" );
     }
 
-    LOG(TRACE) << "Execute query (seriesCount): " << query_string_.str();
+    db::db_connection_ptr db_ = _db_pool->reader();
+
+    db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+    query_ << "select count(series_title) from tbl_cds_object";
+    query_ << " WHERE ";
+    parse_attributes ( query_, filters );
+
+    LOG(TRACE) << "Execute query (seriesCount): " << query_.str();
 
-    db::db_statement_ptr stmt_series_ = _db->prepareStatement ( query_string_.str() );
+    db::db_statement_ptr stmt_series_ = query_.prepare ( db_ );
 
     int result_ = 0;
 
@@ -518,16 +1153,17 @@ int UpnpContentDirectoryDao::touch ( const std::string & path, const unsigned lo
     LOG ( TRACE ) << "Touch record with path: " << path;
 
     try {
-        db::db_statement_ptr stmt_ = _db->prepareStatement (
-                                         "update tbl_cds_object SET timestamp=? where path=? and mtime=?" );
+        return _write ( [&path, mtime] ( db::db_connection_ptr db_ ) {
+            db::db_statement_ptr stmt_ = db_->prepareStatement (
+                                             "update tbl_cds_object SET timestamp=? where path=? and mtime=?" );
 
-        stmt_->bind_int ( 1, std::time ( 0 ) );
-        stmt_->bind_text ( 2, path );
-        stmt_->bind_int ( 3, mtime );
+            stmt_->bind_int64 ( 1, std::time ( 0 ) );
+            stmt_->bind_text ( 2, path );
+            stmt_->bind_int64 ( 3, mtime );
 
-        stmt_->update();
-        int last_changes_count_ = _db->last_changes_count();
-        return ( last_changes_count_ );
+            stmt_->update();
+            return db_->last_changes_count();
+        } );
 
     } catch ( db::DbException & e ) {
         LOG ( FATAL ) << "Touch file with path, Exception:" << e.code() << "-> " << e.what();
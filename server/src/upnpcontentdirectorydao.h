@@ -16,33 +16,66 @@
 #ifndef UPNPCONTENTDIRECTORYDAO_H
 #define UPNPCONTENTDIRECTORYDAO_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <boost/algorithm/string/join.hpp>
+
 #include "squawkserver.h"
+#include "upnpcatalogsnapshot.h"
+#include "upnpsearchcriteria.h"
+#include "utils/sortkey.h"
+#include "db/sqlite3keysetcache.h"
+#include "db/sqlite3maintenance.h"
+#include "db/sqlite3objectcache.h"
+#include "db/sqlite3querybuilder.h"
+#include "db/sqlite3writer.h"
 
 namespace squawk {
 
+/* the column of the struct member N, the member names are compared once per type. */
+template < typename S, typename N >
+struct SqlColumn {
+    typedef boost::fusion::extension::struct_member_name< S, N::value > name_t;
+
+    /* the column name, ROWID for the id. */
+    static inline const std::string & name() {
+        static const std::string name_ = ( std::strcmp ( name_t::call(), "_id" ) == 0 ?
+                                           std::string ( "ROWID" ) : std::string ( name_t::call() + 1 ) );
+        return name_;
+    }
+    /* the id and the child count (maintained by triggers) are only read. */
+    static inline bool read_only() {
+        static const bool read_only_ = ( std::strcmp ( name_t::call(), "_id" ) == 0 ||
+                                         std::strcmp ( name_t::call(), "_child_count" ) == 0 );
+        return read_only_;
+    }
+    /* the resources and album art uris are stored in their own tables. */
+    static inline bool skip() {
+        static const bool skip_ = ( std::strcmp ( name_t::call(), "_item_resource" ) == 0 ||
+                                    std::strcmp ( name_t::call(), "_album_art_uri" ) == 0 );
+        return skip_;
+    }
+};
+
 /* create the sql string */
 template < typename S, typename N >
 struct SqlParametersImpl {
 
-    typedef typename boost::fusion::result_of::value_at< S, N >::type current_t;
     typedef typename boost::mpl::next< N >::type next_t;
-    typedef boost::fusion::extension::struct_member_name< S, N::value > name_t;
+    typedef SqlColumn< S, N > column_t;
 
     template < typename Ostream >
     static inline void serialize ( Ostream& os, const bool include_id, const std::string & suffix ) {
-        std::string name_ = name_t::call();
-
-        if ( name_ != "_child_count" && name_ != "_item_resource" && name_ != "_album_art_uri" ) {
-            if ( name_ == "_id" ) {
-                if ( include_id ) {
-                    os << "ROWID" << suffix;
-                    Comma< S, N >::comma ( os );
-                }
-
-            } else {
-                os << name_.substr ( 1 ) << suffix;
-                Comma< S, N >::comma ( os );
-            }
+        if ( ! column_t::skip() && ( include_id || ! column_t::read_only() ) ) {
+            os << column_t::name() << suffix;
+            Comma< S, N >::comma ( os );
         }
 
         SqlParametersImpl< S, next_t >::serialize ( os, include_id, suffix );
@@ -50,22 +83,22 @@ struct SqlParametersImpl {
 
     template < typename Ostream >
     static inline void placeholders ( Ostream& os, const bool include_id ) {
-        std::string name_ = name_t::call();
+        if ( ! column_t::skip() && ( include_id || ! column_t::read_only() ) ) {
+            os << "?";
+            Comma< S, N >::comma ( os );
+        }
 
-        if ( name_ != "_child_count" && name_ != "_item_resource" && name_ != "_album_art_uri" ) {
-            if ( name_ == "_id" ) {
-                if ( include_id ) {
-                    os << "?";
-                    Comma< S, N >::comma ( os );
-                }
+        SqlParametersImpl< S, next_t >::placeholders ( os, include_id );
+    }
 
-            } else {
-                os << "?";
-                Comma< S, N >::comma ( os );
-            }
+    template < typename Ostream >
+    static inline void excluded ( Ostream& os ) {
+        if ( ! column_t::skip() && ! column_t::read_only() ) {
+            os << column_t::name() << "=excluded." << column_t::name();
+            Comma< S, N >::comma ( os );
         }
 
-        SqlParametersImpl< S, next_t >::placeholders ( os, include_id );
+        SqlParametersImpl< S, next_t >::excluded ( os );
     }
 };
 template < typename S >
@@ -75,6 +108,9 @@ struct SqlParametersImpl< S, typename boost::fusion::result_of::size< S >::type
 
     template < typename Ostream >
     static inline void placeholders ( Ostream&, const bool ) {}
+
+    template < typename Ostream >
+    static inline void excluded ( Ostream& ) {}
 };
 template < typename S >
 /**
@@ -82,27 +118,71 @@ template < typename S >
 */
 struct SqlParameters : SqlParametersImpl< S, boost::mpl::int_< 0 > > {};
 
+/**
+ * @brief the column lists of the didl type, created once and reused by all queries.
+ */
+template < typename S >
+struct SqlColumns {
+    /** @brief the select list with ROWID and child_count. */
+    static inline const std::string & select() {
+        static const std::string select_ = serialize ( true, "" );
+        return select_;
+    }
+    /** @brief the update list "column=?, ..." */
+    static inline const std::string & update() {
+        static const std::string update_ = serialize ( false, "=?" );
+        return update_;
+    }
+    /** @brief the insert list. */
+    static inline const std::string & insert() {
+        static const std::string insert_ = serialize ( false, "" );
+        return insert_;
+    }
+    /** @brief the placeholders for the insert list. */
+    static inline const std::string & placeholders() {
+        static const std::string placeholders_ = [] {
+            std::stringstream ss_;
+            SqlParameters< S >::placeholders ( ss_, false );
+            return ss_.str();
+        }();
+        return placeholders_;
+    }
+    /** @brief the upsert list "column=excluded.column, ..." */
+    static inline const std::string & excluded() {
+        static const std::string excluded_ = [] {
+            std::stringstream ss_;
+            SqlParameters< S >::excluded ( ss_ );
+            return ss_.str();
+        }();
+        return excluded_;
+    }
+private:
+    static std::string serialize ( const bool include_id, const std::string & suffix ) {
+        std::stringstream ss_;
+        SqlParameters< S >::serialize ( ss_, include_id, suffix );
+        return ss_.str();
+    }
+};
+
 
 /* write the sql values */
 template <typename BASE, typename T>
 struct DidlWriteType {
-    static inline void write ( db::Sqlite3Statement * stmt, const BASE&, const std::string & name, int & index, const T & value ) {
-        if ( name != "_id" && name != "_child_count" ) {
-            stmt->bind_int ( ++index, value );
-        }
+    static inline void write ( db::Sqlite3Statement * stmt, const BASE&, int & index, const T & value ) {
+        stmt->bind_int64 ( ++index, static_cast< int64_t > ( value ) );
     }
 };
 template <typename BASE>
 struct DidlWriteType<BASE, std::list<didl::DidlResource>> { //skip DidlResource
-    static inline void write ( db::Sqlite3Statement*, const BASE&, const std::string &, int &, const std::list<didl::DidlResource> & ) {}
+    static inline void write ( db::Sqlite3Statement*, const BASE&, int &, const std::list<didl::DidlResource> & ) {}
 };
 template <typename BASE>
 struct DidlWriteType<BASE, std::list<didl::DidlAlbumArtUri>> {
-    static inline void write ( db::Sqlite3Statement*, const BASE&, const std::string &, int &, const std::list<didl::DidlAlbumArtUri> & ) {}
+    static inline void write ( db::Sqlite3Statement*, const BASE&, int &, const std::list<didl::DidlAlbumArtUri> & ) {}
 };
 template <typename BASE>
 struct DidlWriteType<BASE, std::string> {
-    static inline void write ( db::Sqlite3Statement * stmt, const BASE&, const std::string &, int & index, const std::string & value ) {
+    static inline void write ( db::Sqlite3Statement * stmt, const BASE&, int & index, const std::string & value ) {
         stmt->bind_text ( ++index, value );
     }
 };
@@ -112,11 +192,13 @@ struct DidlBindWriteImpl {
 
     typedef typename boost::fusion::result_of::value_at< S, N >::type current_t;
     typedef typename boost::mpl::next< N >::type next_t;
-    typedef boost::fusion::extension::struct_member_name< S, N::value > name_t;
 
     template < typename Sqlite3Statement >
     static inline void bind ( Sqlite3Statement * stmt, int & index, S & base, const S & s ) {
-        DidlWriteType<S, current_t>::write ( stmt, base, name_t::call(), index, boost::fusion::at< N > ( s ) );
+        if ( ! SqlColumn< S, N >::read_only() ) {
+            DidlWriteType<S, current_t>::write ( stmt, base, index, boost::fusion::at< N > ( s ) );
+        }
+
         DidlBindWriteImpl< S, next_t >::bind ( stmt, index, base, s );
     }
 };
@@ -130,231 +212,235 @@ struct DidlBindWriteImpl< S, typename boost::fusion::result_of::size< S >::type
 template< typename S >
 struct DidlBindWrite : DidlBindWriteImpl< S, boost::mpl::int_< 0 > > {};
 
+/* bind a numeric resource attribute, NULL when the attribute is not set. */
+inline void bind_attribute ( db::Sqlite3Statement * stmt, const int index,
+                             const std::map< didl::DidlResource::UPNP_RES_ATTRIBUTES, std::string > & attributes,
+                             const didl::DidlResource::UPNP_RES_ATTRIBUTES attribute ) {
+    auto value_ = attributes.find ( attribute );
 
-template < typename T, class Enable = void > struct DidlBind {
-    static inline void bind ( const T & ) {}
-};
-
-template< typename T >
-struct DidlBind<T, typename std::enable_if<std::is_base_of<didl::DidlItem, T>::value>::type> {
-    static inline void bind ( const T & s ) {
+    if ( value_ == attributes.end() || value_->second.empty() ) {
+        stmt->bind_null ( index );
 
-        db::db_connection_ptr db_ = SquawkServer::instance()->db();
+    } else {
+        try {
+            stmt->bind_int64 ( index, std::stoll ( value_->second ) );
 
-        for ( auto & res : s.audioItemRes() ) {
-            size_t resource_id_  = 0;
-            db::db_statement_ptr stmt_resource_ = db_->prepareStatement ( "select ROWID from tbl_cds_resource where ref_obj = ?" );
-            stmt_resource_->bind_int ( 1, res.refObj() );
-            db::db_statement_ptr stmt = nullptr;
+        } catch ( std::logic_error & ) {
+            stmt->bind_text ( index, value_->second );
+        }
+    }
+}
 
-            if ( stmt_resource_->step() ) {
-                resource_id_ = stmt_resource_->get_int ( 0 );
 
-                stmt = db_->prepareStatement (
-                           "update tbl_cds_resource SET " \
-                           "ref_obj=?, protocol_info=?, path=?, bitrate=?, bits_per_sample=?, color_depth=?, dlna_profile=?, duration=?, framerate=?, mime_type=?,"\
-                           "nr_audio_channels=?, resolution=?, sample_frequency=?, size=? "\
-                           "where ROWID = ?" );
+/* rows bound to one multi-row upsert. */
+static const size_t UPSERT_ROWS = 32;
 
-            } else {
+/* insert the rows or update the rows with the same ref_obj and path. */
+inline std::string upsert_statement ( const std::string & table, const std::vector< std::string > & columns, const size_t rows ) {
+    std::stringstream ss_;
+    std::string placeholders_ = "(?";
 
-                stmt = db_->prepareStatement (
-                           "insert into tbl_cds_resource( "\
-                           "ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type, "\
-                           "nr_audio_channels, resolution, sample_frequency, size) "\
-                           "values (?,?,?,?,?,?,?,?,?,?,?,?,?,?)" );
-            }
+    for ( size_t i = 1; i < columns.size(); ++i ) {
+        placeholders_ += ",?";
+    }
 
-            stmt->bind_int ( 1, s.id() );
-            stmt->bind_text ( 2, res.protocolInfo() );
-            stmt->bind_text ( 3, res.path() );
+    placeholders_ += ")";
+    ss_ << "insert into " << table << "( " << boost::algorithm::join ( columns, ", " ) << " ) values ";
 
-            stmt->bind_text ( 4, ( res.attributes().find ( didl::DidlResource::bitrate ) != res.attributes().end() ?
-                                   res.attributes() [ didl::DidlResource::bitrate ] : 0 ) );
+    for ( size_t i = 0; i < rows; ++i ) {
+        ss_ << ( i == 0 ? "" : ", " ) << placeholders_;
+    }
 
-            stmt->bind_text ( 5, ( res.attributes().find ( didl::DidlResource::bitsPerSample ) != res.attributes().end() ?
-                                   res.attributes() [ didl::DidlResource::bitsPerSample ] : 0 ) );
+    ss_ << " on conflict( ref_obj, path ) do update set ";
+    bool first_ = true;
 
-            stmt->bind_text ( 6, ( res.attributes().find ( didl::DidlResource::colorDepth ) != res.attributes().end() ?
-                                   res.attributes() [ didl::DidlResource::colorDepth ] : 0 ) );
+    for ( auto & column : columns ) {
+        if ( column != "ref_obj" && column != "path" ) {
+            ss_ << ( first_ ? "" : ", " ) << column << "=excluded." << column;
+            first_ = false;
+        }
+    }
 
-            stmt->bind_text ( 7, res.dlnaProfile() );
+    return ss_.str();
+}
 
-            stmt->bind_text ( 8, ( res.attributes().find ( didl::DidlResource::duration ) != res.attributes().end() ?
-                                   res.attributes() [ didl::DidlResource::duration ] : 0 ) );
+/* write the rows in chunks of UPSERT_ROWS, bind is called with the statement, the parameter index and the row. */
+template< typename L, typename F >
+inline void upsert_rows ( db::db_connection_ptr db, const std::string & table, const std::vector< std::string > & columns, const L & rows, F bind ) {
+    auto row_ = rows.begin();
 
-            stmt->bind_text ( 9, ( res.attributes().find ( didl::DidlResource::framerate ) != res.attributes().end() ?
-                                   res.attributes() [ didl::DidlResource::framerate] : 0 ) );
+    while ( row_ != rows.end() ) {
+        const size_t count_ = std::min< size_t > ( UPSERT_ROWS, std::distance ( row_, rows.end() ) );
+        db::db_statement_ptr stmt_ = db->prepareStatement ( upsert_statement ( table, columns, count_ ) );
+        int index_ = 0;
 
-            stmt->bind_text ( 10, res.mimeType() );
+        for ( size_t i = 0; i < count_; ++i, ++row_ ) {
+            bind ( stmt_.get(), index_, *row_ );
+        }
 
-            stmt->bind_text ( 11, ( res.attributes().find ( didl::DidlResource::nrAudioChannels ) != res.attributes().end() ?
-                                    res.attributes() [ didl::DidlResource::nrAudioChannels ] : 0 ) );
+        stmt_->update();
+    }
+}
 
-            stmt->bind_text ( 12, ( res.attributes().find ( didl::DidlResource::resolution ) != res.attributes().end() ?
-                                    res.attributes() [ didl::DidlResource::resolution ] : "" ) );
+/* the resource columns in bind order. */
+inline const std::vector< std::string > & resource_columns() {
+    static const std::vector< std::string > columns_ { "ref_obj", "protocol_info", "path", "bitrate", "bits_per_sample", "color_depth",
+            "dlna_profile", "duration", "framerate", "mime_type", "nr_audio_channels", "resolution", "sample_frequency", "size" };
+    return columns_;
+}
 
-            stmt->bind_text ( 13, ( res.attributes().find ( didl::DidlResource::sampleFrequency ) != res.attributes().end() ?
-                                    res.attributes() [ didl::DidlResource::sampleFrequency ] : 0 ) );
+/* bind the resource after the parameter index. */
+inline void bind_resource ( db::Sqlite3Statement * stmt, int & index, const size_t ref_obj, const didl::DidlResource & res ) {
+    stmt->bind_int64 ( ++index, ref_obj );
+    stmt->bind_text ( ++index, res.protocolInfo() );
+    stmt->bind_text ( ++index, res.path() );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::bitrate );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::bitsPerSample );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::colorDepth );
+    stmt->bind_text ( ++index, res.dlnaProfile() );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::duration );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::framerate );
+    stmt->bind_text ( ++index, res.mimeType() );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::nrAudioChannels );
+    auto resolution_ = res.attributes().find ( didl::DidlResource::resolution );
+    stmt->bind_text ( ++index, ( resolution_ != res.attributes().end() ? resolution_->second : "" ) );
+    bind_attribute ( stmt, ++index, res.attributes(), didl::DidlResource::sampleFrequency );
+    stmt->bind_int64 ( ++index, res.size() );
+}
 
-            stmt->bind_int ( 14, res.size() );
+/* the sort keys of the title, artist and album columns written for T, see UpnpContentDirectoryDao::_upsert. */
+template < typename T, class Enable = void > struct DidlSortKeys {
+    static inline std::vector< std::string > columns() { return { "title_sort" }; }
+    static inline void bind ( db::Sqlite3Statement * stmt, int & index, const T & s ) {
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.title() ) );
+    }
+};
+template< typename T >
+struct DidlSortKeys<T, typename std::enable_if<std::is_base_of<didl::DidlContainerAlbum, T>::value ||
+                                               std::is_base_of<didl::DidlContainerPhotoAlbum, T>::value>::type> {
+    static inline std::vector< std::string > columns() { return { "title_sort", "artist_sort" }; }
+    static inline void bind ( db::Sqlite3Statement * stmt, int & index, const T & s ) {
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.title() ) );
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.artist() ) );
+    }
+};
+template< typename T >
+struct DidlSortKeys<T, typename std::enable_if<std::is_base_of<didl::DidlMusicTrack, T>::value>::type> {
+    static inline std::vector< std::string > columns() { return { "title_sort", "artist_sort", "album_sort" }; }
+    static inline void bind ( db::Sqlite3Statement * stmt, int & index, const T & s ) {
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.title() ) );
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.artist() ) );
+        stmt->bind_text ( ++index, commons::text::sort_key ( s.album() ) );
+    }
+};
 
-            // the id in the sql where clause
-            if ( resource_id_ > 0 )
-            { stmt->bind_int ( 15, resource_id_ ); }
+template < typename T, class Enable = void > struct DidlBind {
+    static inline void bind ( db::db_connection_ptr, const T & ) {}
+};
 
-            stmt->update();
-        }
+template< typename T >
+struct DidlBind<T, typename std::enable_if<std::is_base_of<didl::DidlItem, T>::value>::type> {
+    static inline void bind ( db::db_connection_ptr db, const T & s ) {
+        const size_t ref_obj_ = s.id();
+        upsert_rows ( db, "tbl_cds_resource", resource_columns(), s.audioItemRes(),
+        [ref_obj_] ( db::Sqlite3Statement * stmt, int & index, const didl::DidlResource & res ) {
+            bind_resource ( stmt, index, ref_obj_, res );
+        } );
     }
 };
 template<typename T>
 struct DidlBind<T, typename std::enable_if<std::is_base_of<didl::DidlContainerAlbum, T>::value>::type> {
-    static inline void bind ( const didl::DidlContainerAlbum & s ) {
-        for ( auto & album_art_uri : s.albumArtUri() ) {
-            size_t album_art_uri_id_  = 0;
-            db::db_statement_ptr stmt_album_art_uri_ = SquawkServer::instance()->db()->prepareStatement ( "select ROWID from tbl_cds_album_art_uri where ROWID = ?" );
-            stmt_album_art_uri_->bind_int ( 1, album_art_uri.id() );
-            db::db_statement_ptr stmt_ = nullptr;
-
-            if ( stmt_album_art_uri_->step() ) {
-                album_art_uri_id_ = stmt_album_art_uri_->get_int ( 0 );
-
-                stmt_ = SquawkServer::instance()->db()->prepareStatement (
-                            "update tbl_cds_album_art_uri SET " \
-                            "ref_obj=?, protocol_info?=, uri=?, bitrate=?, bits_per_sample=?, color_depth=?, dlna_profile=?, duration=?, framerate=?, mime_type=?,"\
-                            "nr_audio_channels=?, resolution=?, sample_frequency=?, size=? "\
-                            "where ROWID = ?" );
-
-            } else {
-
-                stmt_ = SquawkServer::instance()->db()->prepareStatement (
-                            "insert into tbl_cds_album_art_uri( "\
-                            "ref_obj, path, uri, profile) "\
-                            "values (?,?,?,?)" );
-            }
-
-            stmt_->bind_int ( 1, s.id() );
-            stmt_->bind_text ( 2, album_art_uri.path() );
-            stmt_->bind_text ( 3, album_art_uri.uri() );;
-            stmt_->bind_text ( 4, album_art_uri.profile() );
-
-            // the id in the sql where clause
-            if ( album_art_uri_id_ > 0 )
-            { stmt_->bind_int ( 5, album_art_uri_id_ ); }
-
-            stmt_->update();
-        }
+    static inline void bind ( db::db_connection_ptr db, const didl::DidlContainerAlbum & s ) {
+        static const std::vector< std::string > columns_ { "ref_obj", "path", "uri", "profile" };
+        const size_t ref_obj_ = s.id();
+        upsert_rows ( db, "tbl_cds_album_art_uri", columns_, s.albumArtUri(),
+        [ref_obj_] ( db::Sqlite3Statement * stmt, int & index, const didl::DidlAlbumArtUri & album_art_uri ) {
+            stmt->bind_int64 ( ++index, ref_obj_ );
+            stmt->bind_text ( ++index, album_art_uri.path() );
+            stmt->bind_text ( ++index, album_art_uri.uri() );
+            stmt->bind_text ( ++index, album_art_uri.profile() );
+        } );
     }
 };
 
-/* read the sql values */
+/* read the sql values, from a statement or a row of the catalog snapshot */
 template <typename BASE, typename T>
 struct DidlReadType {
-    static inline void read ( db::Sqlite3Statement * stmt, const BASE & base, const std::string & name, int & index, T & value ) {
-        if ( name != "_child_count" ) {
-            value = stmt->get_int ( index++ );
-
-        } else {
-            size_t result_count = 0;
-            std::stringstream query_string_;
-
-            if ( DidlType< BASE >::cls() == didl::objectContainerAlbumMusicAlbum ) {
-                query_string_ << "select count(*) from tbl_cds_object where cls = ? and parent_id = ?";
-
-            } else {
-                query_string_ << "select count(*) from tbl_cds_object where parent_id = ?";
-            }
-
-            db::db_statement_ptr stmt_objects_ = SquawkServer::instance()->db()->prepareStatement ( query_string_.str() );
-            int count_ = 0;
-
-            if (  DidlType< BASE >::cls() == didl::objectContainerAlbumMusicAlbum )
-            { stmt_objects_->bind_int ( ++count_, didl::objectItemAudioItemMusicTrack ); }
-
-            stmt_objects_->bind_int ( ++count_, base.id() );
-
-            while ( stmt_objects_->step() ) {
-                result_count = stmt_objects_->get_int ( 0 );
-            }
-
-            value = result_count;
-        }
+    template < typename Sqlite3Statement >
+    static inline void read ( Sqlite3Statement * stmt, const BASE&, int & index, T & value ) {
+        value = static_cast< T > ( stmt->get_int64 ( index++ ) );
     }
 };
 template <typename BASE>
 struct DidlReadType<BASE, didl::DIDL_CLASS> {
-    static inline void read ( db::Sqlite3Statement * stmt, const BASE&, const std::string &, int & index, didl::DIDL_CLASS & value ) {
+    template < typename Sqlite3Statement >
+    static inline void read ( Sqlite3Statement * stmt, const BASE&, int & index, didl::DIDL_CLASS & value ) {
         value = static_cast<didl::DIDL_CLASS> ( stmt->get_int ( index++ ) );
     }
 };
 template <typename BASE>
 struct DidlReadType<BASE, std::string> {
-    static inline void read ( db::Sqlite3Statement * stmt, const BASE&, const std::string &, int & index, std::string & value ) {
-        value = stmt->get_string ( index++ );
+    template < typename Sqlite3Statement >
+    static inline void read ( Sqlite3Statement * stmt, const BASE&, int & index, std::string & value ) {
+        stmt->get_text ( index++, value );
     }
 };
+/* the resources and album art uris are loaded for the result page, see UpnpContentDirectoryDao::_hydrate */
 template <typename BASE>
 struct DidlReadType<BASE, std::list<didl::DidlResource>> {
-    static inline void read ( db::Sqlite3Statement *, const BASE & base, const std::string &, int &, std::list<didl::DidlResource> & value ) {
-        db::db_statement_ptr stmt_resource = SquawkServer::instance()->db()->prepareStatement (
-                "select ROWID, ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type, "\
-                "       nr_audio_channels, resolution, sample_frequency, size from tbl_cds_resource where ref_obj = ?" );
-        stmt_resource->bind_int ( 1, base.id() );
-
-        value.clear();
-
-        while ( stmt_resource->step() ) {
-            value.push_back ( didl::DidlResource (
-                                  stmt_resource->get_int ( 0 ) /*ROWID*/,
-                                  stmt_resource->get_int ( 1 ) /*ref_id*/,
-                                  stmt_resource->get_int ( 14 ) /* size */,
-                                  "" /* uri */,
-                                  stmt_resource->get_string ( 3 ) /*path*/,
-                                  stmt_resource->get_string ( 2 ) /*protocol_info*/,
-                                  stmt_resource->get_string ( 7 ) /*dlna_profile*/,
-                                  stmt_resource->get_string ( 10 ) /*mime_type*/,
-
-            std::map< didl::DidlResource::UPNP_RES_ATTRIBUTES, std::string > ( {
-                { didl::DidlResource::bitrate, stmt_resource->get_string ( 4 ) /*bitrate*/ },
-                { didl::DidlResource::bitsPerSample, stmt_resource->get_string ( 5 ) /*bits_per_sample*/ },
-                { didl::DidlResource::colorDepth, stmt_resource->get_string ( 6 ) /*color_depth*/ },
-                { didl::DidlResource::duration, stmt_resource->get_string ( 8 ) /*duration*/ },
-                { didl::DidlResource::framerate, stmt_resource->get_string ( 9 ) /*framerate*/ },
-                { didl::DidlResource::nrAudioChannels, stmt_resource->get_string ( 11 ) /*nr_audio_channels*/ },
-                { didl::DidlResource::resolution, stmt_resource->get_string ( 12 ) /*resolution*/ },
-                { didl::DidlResource::sampleFrequency, stmt_resource->get_string ( 13 ) /*sample_frequency*/ }
-            } ) ) );
-        }
-    }
+    template < typename Sqlite3Statement >
+    static inline void read ( Sqlite3Statement *, const BASE&, int &, std::list<didl::DidlResource> & ) {}
 };
 template <typename BASE>
 struct DidlReadType<BASE, std::list<didl::DidlAlbumArtUri>> {
-    static inline void read ( db::Sqlite3Statement *, const BASE & base, const std::string &, int &, std::list<didl::DidlAlbumArtUri> & value ) {
-        db::db_statement_ptr stmt_album_art_uri_ = SquawkServer::instance()->db()->prepareStatement (
-                    "select ROWID, ref_obj, path, uri, profile from tbl_cds_album_art_uri where ref_obj = ?" );
-        stmt_album_art_uri_->bind_int ( 1, base.id() );
-
-        value.clear();
-
-        while ( stmt_album_art_uri_->step() ) {
-            value.push_back ( didl::DidlAlbumArtUri ( stmt_album_art_uri_->get_int ( 0 ) /*ROWID*/, stmt_album_art_uri_->get_int ( 1 ) /*object_ref*/,
-                              stmt_album_art_uri_->get_string ( 2 ) /* path,*/,
-                              stmt_album_art_uri_->get_string ( 3 ) /*uri*/,
-                              stmt_album_art_uri_->get_string ( 4 ) /*profile*/ ) );
-        }
-    }
+    template < typename Sqlite3Statement >
+    static inline void read ( Sqlite3Statement *, const BASE&, int &, std::list<didl::DidlAlbumArtUri> & ) {}
 };
 
+/* read the resource from the result row:
+   ROWID, ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type,
+   nr_audio_channels, resolution, sample_frequency, size */
+template < typename Sqlite3Statement >
+inline didl::DidlResource read_resource ( Sqlite3Statement * stmt ) {
+    return didl::DidlResource (
+               stmt->get_int ( 0 ) /*ROWID*/,
+               stmt->get_int ( 1 ) /*ref_id*/,
+               stmt->get_int64 ( 14 ) /* size */,
+               "" /* uri */,
+               stmt->get_string ( 3 ) /*path*/,
+               stmt->get_string ( 2 ) /*protocol_info*/,
+               stmt->get_string ( 7 ) /*dlna_profile*/,
+               stmt->get_string ( 10 ) /*mime_type*/,
+
+    std::map< didl::DidlResource::UPNP_RES_ATTRIBUTES, std::string > ( {
+        { didl::DidlResource::bitrate, stmt->get_string ( 4 ) /*bitrate*/ },
+        { didl::DidlResource::bitsPerSample, stmt->get_string ( 5 ) /*bits_per_sample*/ },
+        { didl::DidlResource::colorDepth, stmt->get_string ( 6 ) /*color_depth*/ },
+        { didl::DidlResource::duration, stmt->get_string ( 8 ) /*duration*/ },
+        { didl::DidlResource::framerate, stmt->get_string ( 9 ) /*framerate*/ },
+        { didl::DidlResource::nrAudioChannels, stmt->get_string ( 11 ) /*nr_audio_channels*/ },
+        { didl::DidlResource::resolution, stmt->get_string ( 12 ) /*resolution*/ },
+        { didl::DidlResource::sampleFrequency, stmt->get_string ( 13 ) /*sample_frequency*/ }
+    } ) );
+}
+/* read the album art uri from the result row: ROWID, ref_obj, path, uri, profile */
+template < typename Sqlite3Statement >
+inline didl::DidlAlbumArtUri read_album_art_uri ( Sqlite3Statement * stmt ) {
+    return didl::DidlAlbumArtUri ( stmt->get_int ( 0 ) /*ROWID*/, stmt->get_int ( 1 ) /*object_ref*/,
+                                   stmt->get_string ( 2 ) /* path,*/,
+                                   stmt->get_string ( 3 ) /*uri*/,
+                                   stmt->get_string ( 4 ) /*profile*/ );
+}
+
 template < typename S, typename N >
 struct DidlBindReadImpl {
 
     typedef typename boost::fusion::result_of::value_at< S, N >::type current_t;
     typedef typename boost::mpl::next< N >::type next_t;
-    typedef boost::fusion::extension::struct_member_name< S, N::value > name_t;
 
     template < typename Sqlite3Statement >
     static inline void bind ( Sqlite3Statement * stmt, int & index, S & base, S & s ) {
-        DidlReadType<S, current_t>::read ( stmt, s, name_t::call(), index, boost::fusion::at< N > ( s ) );
+        DidlReadType<S, current_t>::read ( stmt, s, index, boost::fusion::at< N > ( s ) );
         DidlBindReadImpl< S, next_t >::bind ( stmt, index, base, s );
     }
 };
@@ -368,21 +454,56 @@ struct DidlBindReadImpl< S, typename boost::fusion::result_of::size< S >::type >
 template < typename S >
 struct DidlBindRead : DidlBindReadImpl< S, boost::mpl::int_< 0 > >  {};
 
+/* estimated heap memory of the members, the weight of the object in the object cache. */
+inline size_t member_bytes ( const std::string & s ) { return s.capacity(); }
+inline size_t member_bytes ( const std::list< didl::DidlResource > & resources ) {
+    size_t bytes_ = 0;
 
-inline void parse_attributes ( std::stringstream & query_string, const std::map< std::string, std::string > & filters ) {
-    bool is_first_ = true;
+    for ( auto & resource : resources ) {
+        bytes_ += sizeof ( didl::DidlResource ) + resource.path().size() + resource.uri().size() + resource.attributes().size() * 64;
+    }
 
-    for ( auto & f : filters ) {
-        if ( f.first != "cls" ) {
-            if ( is_first_ ) { is_first_=false; }
+    return bytes_;
+}
+inline size_t member_bytes ( const std::list< didl::DidlAlbumArtUri > & uris ) {
+    size_t bytes_ = 0;
 
-            else { query_string << " or "; }
+    for ( auto & uri : uris ) {
+        bytes_ += sizeof ( didl::DidlAlbumArtUri ) + uri.path().size() + uri.uri().size();
+    }
 
-            query_string << f.first << "=\'" << f.second + "\' ";
-        }
+    return bytes_;
+}
+template < typename V >
+inline size_t member_bytes ( const V& ) { return 0; }
+
+template < typename S, typename N >
+struct DidlBytesImpl {
+    typedef typename boost::mpl::next< N >::type next_t;
+
+    static inline size_t bytes ( const S & s ) {
+        return member_bytes ( boost::fusion::at< N > ( s ) ) + DidlBytesImpl< S, next_t >::bytes ( s );
     }
 };
-inline void parse_filters ( std::stringstream & query_string, const std::map< std::string, std::string > & filters ) {
+
+template < typename S >
+struct DidlBytesImpl< S, typename boost::fusion::result_of::size< S >::type > {
+    static inline size_t bytes ( const S& ) { return 0; }
+};
+
+/**
+ * @brief estimated memory of the didl object.
+ */
+template < typename S >
+struct DidlBytes {
+    static inline size_t bytes ( const S & s ) { return sizeof ( S ) + DidlBytesImpl< S, boost::mpl::int_< 0 > >::bytes ( s ); }
+};
+
+
+inline void parse_attributes ( db::Sqlite3QueryBuilder & query, const std::map< std::string, std::string > & filters ) {
+    query.any_of ( filters, "cls" );
+};
+inline void parse_filters ( db::Sqlite3QueryBuilder & query, const std::map< std::string, std::string > & filters ) {
     bool has_filters_;
 
     if ( filters.empty() ) { has_filters_ = false; }
@@ -392,29 +513,35 @@ inline void parse_filters ( std::stringstream & query_string, const std::map< st
     else { has_filters_ = true; }
 
     if ( has_filters_ ) {
-        query_string << " AND (";
-        parse_attributes ( query_string, filters );
-        query_string << ")";
+        query << " AND (";
+        parse_attributes ( query, filters );
+        query << ")";
     }
 };
-inline void parse_class ( didl::DIDL_CLASS cls, const std::string & prefix, std::stringstream & query_string, std::map< std::string, std::string > filters ) {
+inline void parse_class ( didl::DIDL_CLASS cls, const std::string & prefix, db::Sqlite3QueryBuilder & query, std::map< std::string, std::string > filters ) {
     if ( cls != didl::object ) {
-        query_string << prefix << " cls = " << cls;
+        query << prefix << " cls = " << cls;
 
     } else if ( filters.find ( "cls" ) != filters.end() ) {
-        query_string << prefix << " (";
+        query << prefix << " (";
         boost::tokenizer<> classes_ ( filters["cls"] );
         bool first_ = true;
 
         for ( boost::tokenizer<>::iterator beg = classes_.begin(); beg != classes_.end(); ++beg ) {
             if ( first_ ) { first_=false; }
 
-            else { query_string << " OR "; }
+            else { query << " OR "; }
 
-            query_string << "cls = " << *beg;
+            try {
+                query << "cls = ";
+                query.value ( std::stoll ( *beg ) );
+
+            } catch ( std::logic_error & ) {
+                throw db::DbException ( SQLITE_MISMATCH, "invalid class: " + *beg );
+            }
         }
 
-        query_string << ") ";
+        query << ") ";
     }
 }
 
@@ -431,16 +558,52 @@ public:
     UpnpContentDirectoryDao& operator= ( UpnpContentDirectoryDao&& ) = delete;
     ~UpnpContentDirectoryDao() {}
 
-    /** @brief Start database transaction */
-    void startTransaction();
-    /** @brief End database transaction */
-    void endTransaction();
+    /** @brief wait until the writes are committed. */
+    void flush();
+    /** @brief the statistics of the database writer. */
+    db::Sqlite3Writer::Stats writerStats() const { return _writer->stats(); }
+    /** @brief the statistics of the object cache. */
+    db::Sqlite3ObjectCache::Stats objectCacheStats() const { return _objects.stats(); }
+    /** @brief the statistics of the database maintenance. */
+    db::Sqlite3Maintenance::Stats maintenanceStats() const { return _maintenance->stats(); }
+    /** @brief refresh the planner statistics and vacuum the database in the background, after an import. */
+    void maintain() { _maintenance->schedule(); }
+    /** @brief the catalog generation, changes with every write and commit. */
+    size_t generation() const { return _generation.load(); }
 
     /**
-     * @brief sweep all
-     * @param mtime
+     * @brief read the catalog snapshot and publish it to the readers.
+     * <p>Objects by id and the pages of children, objects and artists without filters are read
+     * from the snapshot until the catalog changes, the other queries always read from sqlite.</p>
+     * @return false when the catalog changed while the snapshot was read.
      */
-    void sweep ( long mtime );
+    bool publishSnapshot();
+    /** @brief the size of the current catalog snapshot, all zero when there is none. */
+    UpnpCatalogSnapshot::Stats snapshotStats() const;
+
+    /** @brief rows and cached files removed by the sweep. */
+    struct SweepStats {
+        size_t objects;
+        size_t resources;
+        size_t album_art_uris;
+        size_t artists;
+        size_t files;
+        size_t bytes;
+    };
+
+    /**
+     * @brief remove the objects not touched since mtime.
+     * <p>The objects are deleted in batches with their resources and album art uris, followed by the
+     * artists without albums or tracks. The generated previews and album art in the tmp directory are
+     * removed after the commit.</p>
+     * @param mtime the start time of the import.
+     * @param batch the number of objects deleted in one write operation.
+     * @return the removed rows and files.
+     */
+    SweepStats sweep ( long mtime, const size_t batch = SWEEP_BATCH );
+
+    /** default number of objects deleted in one write operation of the sweep */
+    static const size_t SWEEP_BATCH = 500;
 
     /**
      * Save the didl object
@@ -449,45 +612,11 @@ public:
     T save ( T o ) {
         LOG(TRACE) << "Save:" << o;
 
-        db::db_statement_ptr stmt_object_ = _db->prepareStatement ( "select ROWID, object_update_id from tbl_cds_object where path = ?" );
-        stmt_object_->bind_text ( 1, o.path() );
-
-        if ( stmt_object_->step() ) {
-            o._id = stmt_object_->get_int ( 0 );
-            //update row
-            std::stringstream query_string_;
-            query_string_ << "update tbl_cds_object SET ";
-            SqlParameters< T >::serialize ( query_string_, false, "=?" );
-            query_string_ << " where ROWID = ?";
-
-            LOG(TRACE) << "Save object, query_string = \"" << query_string_.str() << "\"";
-
-            db::db_statement_ptr stmt = _db->prepareStatement ( query_string_.str() );
-            int index_ = 0;
-            DidlBindWrite< T >::bind ( stmt.get(), index_, o, o );
-            stmt->bind_int ( ++index_, o._id );
-            stmt->update();
-
-        } else {
-            // insert row
-            std::stringstream query_string_;
-            query_string_ << "insert into tbl_cds_object( ";
-            SqlParameters< T >::serialize ( query_string_, false, "" );
-            query_string_ << " ) values( ";
-            SqlParameters< T >::placeholders ( query_string_, false );
-            query_string_ << " )";
-
-            LOG(TRACE) << "Update object, query_string = \"" << query_string_.str() << "\"";
-
-            db::db_statement_ptr stmt = _db->prepareStatement ( query_string_.str() );
-            int index_ = 0;
-            DidlBindWrite< T >::bind ( stmt.get(), index_, o, o );
-            stmt->insert();
-            o._id = _db->last_insert_rowid();
-        }
-
-        DidlBind< T >::bind ( o );
-        return o;
+        T saved_ = _write ( [o] ( db::db_connection_ptr db ) { return _upsert ( db, o ); } );
+        //the child count of the parent is changed by the triggers.
+        _invalidate ( saved_.id() );
+        _invalidate ( saved_.parentId() );
+        return saved_;
     }
 
     /**
@@ -497,20 +626,46 @@ public:
     T object ( const size_t & id ) {
         LOG(TRACE) << "Get_object:" << id;
 
+        const size_t generation_ = _objects.generation();
+        std::shared_ptr< const T > cached_ = _objects.find< T > ( id );
+
+        if ( cached_ ) {
+            return *cached_;
+        }
+
         T o;
+        std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
+
+        if ( catalog_ ) {
+            const UpnpCatalogSnapshot::position_t position_ = catalog_->find ( id );
+
+            if ( position_ != UpnpCatalogSnapshot::npos ) {
+                _read ( *catalog_, catalog_->objectColumns ( SqlColumns< T >::select() ), position_, o );
+            }
+
+            return o;
+        }
+
         std::stringstream query_string_;
-        query_string_ << "select ";
-        SqlParameters< T >::serialize ( query_string_, true, "" );
-        query_string_ << " from tbl_cds_object where ROWID = ?";
+        query_string_ << "select " << SqlColumns< T >::select() << " from tbl_cds_object where ROWID = ?";
 
         LOG(TRACE) << "Execute query (object): " << query_string_.str();
 
-        db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
+        db::db_connection_ptr db_ = _db_pool->reader();
+        db::db_statement_ptr stmt_objects_ = db_->prepareStatement ( query_string_.str() );
         stmt_objects_->bind_int ( 1, id );
+        bool found_ = false;
 
         while ( stmt_objects_->step() ) {
             int index_ = 0;
             DidlBindRead< T >::bind ( stmt_objects_.get(), index_, o, o );
+            found_ = true;
+        }
+
+        _hydrate ( db_, &o, &o + 1 );
+
+        if ( found_ ) {
+            _objects.put ( generation_, id, o, DidlBytes< T >::bytes ( o ) );
         }
 
         return o;
@@ -525,13 +680,12 @@ public:
 
         T o;
         std::stringstream query_string_;
-        query_string_ << "select ";
-        SqlParameters< T >::serialize ( query_string_, true, "" );
-        query_string_ << " from tbl_cds_object where path = ?";
+        query_string_ << "select " << SqlColumns< T >::select() << " from tbl_cds_object where path = ?";
 
         LOG(TRACE) << "Execute query (object): " << query_string_.str();
 
-        db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
+        db::db_connection_ptr db_ = _db_pool->reader();
+        db::db_statement_ptr stmt_objects_ = db_->prepareStatement ( query_string_.str() );
         stmt_objects_->bind_text ( 1, path );
 
         while ( stmt_objects_->step() ) {
@@ -539,6 +693,7 @@ public:
             DidlBindRead< T >::bind ( stmt_objects_.get(), index_, o, o );
         }
 
+        _hydrate ( db_, &o, &o + 1 );
         return o;
     }
 
@@ -546,42 +701,52 @@ public:
     std::list< T > children ( const size_t id, const size_t & start_index, const size_t & result_count,
                               std::map< std::string, std::string > filters = std::map< std::string, std::string >(),
                               std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
-
-        LOG(TRACE) << "Children<" << didl::className ( DidlType< T >::cls() ) <<
-                      ">::" << id << " (" << start_index << ", " << result_count << ")";
-
         std::list< T > object_list_;
+        visitChildren< T > ( id, start_index, result_count, [&object_list_] ( T & o ) {
+            object_list_.push_back ( std::move ( o ) );
+        }, filters, sort );
+        return object_list_;
+    }
 
-        std::stringstream query_string_;
-        query_string_ << "select ";
-        SqlParameters< T >::serialize ( query_string_, true, "" );
-        query_string_ << " from tbl_cds_object where parent_id = ? ";
-        parse_class ( DidlType< T >::cls(), " and ", query_string_, filters );
-        parse_filters ( query_string_, filters );
-        query_string_ << " order by " << sort.first << " " << sort.second;
-
-        if ( result_count > 0 ) {
-            query_string_ << " limit ?, ? ";
-        }
-
-        LOG(TRACE) << "Execute query (children): " << query_string_.str();
+    /**
+     * @brief hand the child objects to the visitor.
+     * <p>The rows are read from the open statement and hydrated HYDRATE_BATCH objects at a time,
+     * the page is never held in a list. The object is valid until the visitor returns.</p>
+     * @param visitor called with T& for every object.
+     * @return the number of objects visited.
+     */
+    template< typename T, typename V >
+    size_t visitChildren ( const size_t id, const size_t & start_index, const size_t & result_count, V visitor,
+                           std::map< std::string, std::string > filters = std::map< std::string, std::string >(),
+                           std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
 
-        db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
-        stmt_objects_->bind_int ( 1, id );
+        LOG(TRACE) << "Children<" << didl::className ( DidlType< T >::cls() ) <<
+                      ">::" << id << " (" << start_index << ", " << result_count << ")";
 
-        if ( result_count > 0 ) {
-            stmt_objects_->bind_int ( 2, start_index );
-            stmt_objects_->bind_int ( 3, result_count );
-        }
+        if ( filters.empty() && sort.first == "title" && ( sort.second == "asc" || sort.second == "desc" ) ) {
+            std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
 
-        while ( stmt_objects_->step() ) {
-            T item_;
-            int index_ = 0;
-            DidlBindRead< T >::bind ( stmt_objects_.get(), index_, item_, item_ );
-            object_list_.push_back ( item_ );
+            if ( catalog_ ) {
+                return _visit< T > ( *catalog_, catalog_->children ( id ), DidlType< T >::cls() != didl::object,
+                                     sort.second == "desc", start_index, result_count, visitor );
+            }
         }
 
-        return object_list_;
+        db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+        const std::string sort_ = _sort_keys ( sort.first, OBJECT_SORT_KEYS );
+        query_ << "select " << SqlColumns< T >::select();
+        db::Sqlite3KeysetCache::select ( query_, sort_, "ROWID", result_count );
+        query_ << " from tbl_cds_object where parent_id = ";
+        query_.value ( id );
+        parse_class ( DidlType< T >::cls(), " and ", query_, filters );
+        parse_filters ( query_, filters );
+
+        LOG(TRACE) << "Execute query (children): " << query_.str();
+
+        db::db_connection_ptr db_ = _db_pool->reader();
+        RowVisitor< T, V > rows_ ( db_, visitor );
+        _keysets.page ( db_, query_, sort_, sort.second, "ROWID", start_index, result_count, std::ref ( rows_ ) );
+        return rows_.flush();
     }
 
     /**
@@ -596,42 +761,231 @@ public:
     std::list< T > objects ( const size_t & start_index, const size_t & result_count,
                              std::map< std::string, std::string > filters = std::map< std::string, std::string >(),
                              std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
+        std::list< T > object_list_;
+        visitObjects< T > ( start_index, result_count, [&object_list_] ( T & o ) {
+            object_list_.push_back ( std::move ( o ) );
+        }, filters, sort );
+        return object_list_;
+    }
+
+    /**
+     * @brief hand the objects to the visitor, see visitChildren.
+     * @return the number of objects visited.
+     */
+    template< typename T, typename V >
+    size_t visitObjects ( const size_t & start_index, const size_t & result_count, V visitor,
+                          std::map< std::string, std::string > filters = std::map< std::string, std::string >(),
+                          std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
 
         LOG(TRACE) << "Objects<" << didl::className ( DidlType< T >::cls() ) <<
                       ">" << " (" << start_index << ", " << result_count << ")";
 
-        std::list< T > object_list_;
-        std::stringstream query_string_;
-        query_string_ << "select ";
-        SqlParameters< T >::serialize ( query_string_, true, "" );
-        query_string_ << " from tbl_cds_object where ";
-        parse_class ( DidlType< T >::cls(), "", query_string_, filters );
-        parse_filters ( query_string_, filters );
-        query_string_ << " order by " << sort.first << " " << sort.second;
+        auto order_ = SNAPSHOT_ORDERS.find ( sort.first );
 
-        if ( result_count > 0 ) {
-            query_string_ << " limit ?, ? ";
+        if ( filters.empty() && DidlType< T >::cls() != didl::object && order_ != SNAPSHOT_ORDERS.end() &&
+                ( sort.second == "asc" || sort.second == "desc" ) ) {
+            std::shared_ptr< const UpnpCatalogSnapshot > catalog_ = _catalog();
+
+            if ( catalog_ ) {
+                return _visit< T > ( *catalog_, catalog_->objects ( DidlType< T >::cls(), order_->second ), false,
+                                     sort.second == "desc", start_index, result_count, visitor );
+            }
         }
 
-        LOG(TRACE) << "Execute query (objects): " << query_string_.str();
+        db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+        const std::string sort_ = _sort_keys ( sort.first, OBJECT_SORT_KEYS );
+        query_ << "select " << SqlColumns< T >::select();
+        db::Sqlite3KeysetCache::select ( query_, sort_, "ROWID", result_count );
+        query_ << " from tbl_cds_object where ";
+        parse_class ( DidlType< T >::cls(), "", query_, filters );
+        parse_filters ( query_, filters );
 
-        db::db_statement_ptr stmt_objects_ = _db->prepareStatement ( query_string_.str() );
+        LOG(TRACE) << "Execute query (objects): " << query_.str();
 
-        if ( result_count > 0 ) {
-            stmt_objects_->bind_int ( 1, start_index );
-            stmt_objects_->bind_int ( 2, result_count );
+        db::db_connection_ptr db_ = _db_pool->reader();
+        RowVisitor< T, V > rows_ ( db_, visitor );
+        _keysets.page ( db_, query_, sort_, sort.second, "ROWID", start_index, result_count, std::ref ( rows_ ) );
+        return rows_.flush();
+    }
+
+    /**
+     * @brief find the objects by text.
+     * <p>Every word of the text matches the beginning of a word in the title, artist, album, genre,
+     * composer, series title, isbn, author or publisher. The objects are ranked by bm25, a match in
+     * the title ranks highest.</p>
+     */
+    template< typename T >
+    std::list< T > search ( const std::string & text, const size_t & start_index, const size_t & result_count,
+                            std::map< std::string, std::string > filters = std::map< std::string, std::string >() ) const {
+        std::list< T > object_list_;
+        visitSearch< T > ( text, start_index, result_count, [&object_list_] ( T & o ) {
+            object_list_.push_back ( std::move ( o ) );
+        }, filters );
+        return object_list_;
+    }
+
+    /**
+     * @brief hand the objects found by text to the visitor, see visitChildren.
+     * @return the number of objects visited.
+     */
+    template< typename T, typename V >
+    size_t visitSearch ( const std::string & text, const size_t & start_index, const size_t & result_count, V visitor,
+                         std::map< std::string, std::string > filters = std::map< std::string, std::string >() ) const {
+
+        LOG(TRACE) << "Search<" << didl::className ( DidlType< T >::cls() ) <<
+                      ">::" << text << " (" << start_index << ", " << result_count << ")";
+
+        db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+
+        if ( ! _search_query ( query_, text ) ) {
+            return 0;
         }
 
-        while ( stmt_objects_->step() ) {
-            T item_;
-            int index_ = 0;
-            DidlBindRead< T >::bind ( stmt_objects_.get(), index_, item_, item_ );
-            object_list_.push_back ( item_ );
+        query_ << " select " << SqlColumns< T >::select() << " from hits, tbl_cds_object where tbl_cds_object.ROWID = hits.hit";
+        parse_class ( DidlType< T >::cls(), " and ", query_, filters );
+        parse_filters ( query_, filters );
+        query_ << " order by hits.score, hits.hit";
+        query_.limit ( start_index, result_count );
+
+        LOG(TRACE) << "Execute query (search): " << query_.str();
+
+        db::db_connection_ptr db_ = _db_pool->reader();
+        RowVisitor< T, V > rows_ ( db_, visitor );
+        db::db_statement_ptr stmt_ = query_.prepare ( db_ );
+
+        while ( stmt_->step() ) {
+            rows_ ( stmt_.get() );
         }
 
+        stmt_.reset();
+        return rows_.flush();
+    }
+
+    /**
+     * @brief count the objects found by text.
+     * @param cls the type
+     * @param text the search text
+     * @param filters filter
+     * @return number of objects
+     */
+    size_t searchCount ( didl::DIDL_CLASS cls, const std::string & text,
+                         std::map< std::string, std::string > filters = std::map< std::string, std::string >() ) const;
+
+    /**
+     * @brief find the objects by the UPnP search criteria.
+     * @param criteria the parsed SearchCriteria.
+     * @param container search the objects below the container, 0 for all objects.
+     * @param start_index
+     * @param result_count
+     * @param sort
+     * @return the sorted objects.
+     */
+    template< typename T >
+    std::list< T > search ( const UpnpSearchCriteria & criteria, const size_t container,
+                            const size_t & start_index, const size_t & result_count,
+                            std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
+        std::list< T > object_list_;
+        visitSearch< T > ( criteria, container, start_index, result_count, [&object_list_] ( T & o ) {
+            object_list_.push_back ( std::move ( o ) );
+        }, sort );
         return object_list_;
     }
 
+    /**
+     * @brief hand the objects found by the UPnP search criteria to the visitor, see visitChildren.
+     * @return the number of objects visited.
+     */
+    template< typename T, typename V >
+    size_t visitSearch ( const UpnpSearchCriteria & criteria, const size_t container,
+                         const size_t & start_index, const size_t & result_count, V visitor,
+                         std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
+
+        LOG(TRACE) << "Search<" << didl::className ( DidlType< T >::cls() ) <<
+                      ">::" << container << " (" << start_index << ", " << result_count << ")";
+
+        db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+        query_ << "select " << SqlColumns< T >::select() << " from tbl_cds_object where ";
+        _search_where ( query_, criteria, container );
+        parse_class ( DidlType< T >::cls(), " and ", query_, std::map< std::string, std::string >() );
+        query_.order_by ( _sort_keys ( sort.first, OBJECT_SORT_KEYS ) + ", ROWID", sort.second );
+        query_.limit ( start_index, result_count );
+
+        LOG(TRACE) << "Execute query (search): " << query_.str();
+
+        db::db_connection_ptr db_ = _db_pool->reader();
+        RowVisitor< T, V > rows_ ( db_, visitor );
+        db::db_statement_ptr stmt_ = query_.prepare ( db_ );
+
+        while ( stmt_->step() ) {
+            rows_ ( stmt_.get() );
+        }
+
+        stmt_.reset();
+        return rows_.flush();
+    }
+
+    /**
+     * @brief hand the objects found by the UPnP search criteria to the visitor, each object with the type of its class.
+     * <p>Only the objects with the class of one of the types T are searched. The rows are read in one query
+     * with the columns of all types, the visitor is called in the order of the rows.</p>
+     * @return the number of objects visited.
+     */
+    template< typename... T, typename V >
+    size_t visitSearchObjects ( const UpnpSearchCriteria & criteria, const size_t container,
+                                const size_t & start_index, const size_t & result_count, V & visitor,
+                                std::pair< std::string, std::string > sort = std::pair< std::string, std::string > { "title", "asc" } ) const {
+
+        LOG(TRACE) << "SearchObjects::" << container << " (" << start_index << ", " << result_count << ")";
+
+        db::Sqlite3QueryBuilder query_ ( OBJECT_COLUMNS );
+        query_ << "select cls" << SearchRows< V, T... >::select() << " from tbl_cds_object where ";
+        _search_where ( query_, criteria, container, classes< T... >() );
+        query_.order_by ( _sort_keys ( sort.first, OBJECT_SORT_KEYS ) + ", ROWID", sort.second );
+        query_.limit ( start_index, result_count );
+
+        LOG(TRACE) << "Execute query (search): " << query_.str();
+
+        db::db_connection_ptr db_ = _db_pool->reader();
+        SearchRows< V, T... > rows_ ( visitor, 1 );
+        std::vector< std::function< void() > > order_;
+        db::db_statement_ptr stmt_ = query_.prepare ( db_ );
+
+        while ( stmt_->step() ) {
+            rows_.read ( stmt_.get(), stmt_->get_int ( 0 ), order_ );
+        }
+
+        stmt_.reset();
+        rows_.hydrate ( db_ );
+
+        for ( auto & visit : order_ ) {
+            visit();
+        }
+
+        return order_.size();
+    }
+
+    /** @brief the classes of the types, see visitSearchObjects and searchCount. */
+    template< typename T >
+    static std::vector< didl::DIDL_CLASS > classes() {
+        return std::vector< didl::DIDL_CLASS > { DidlType< T >::cls() };
+    }
+    template< typename T, typename N, typename... R >
+    static std::vector< didl::DIDL_CLASS > classes() {
+        std::vector< didl::DIDL_CLASS > classes_ = classes< N, R... >();
+        classes_.insert ( classes_.begin(), DidlType< T >::cls() );
+        return classes_;
+    }
+
+    /**
+     * @brief count the objects found by the UPnP search criteria.
+     * @param criteria the parsed SearchCriteria.
+     * @param container search the objects below the container, 0 for all objects.
+     * @param classes count only the objects of the classes, all objects when empty.
+     * @return number of objects
+     */
+    size_t searchCount ( const UpnpSearchCriteria & criteria, const size_t container,
+                         const std::vector< didl::DIDL_CLASS > & classes = std::vector< didl::DIDL_CLASS >() ) const;
+
     /**
      * @brief count total objects by type with filter.
      * @param cls the type
@@ -667,6 +1021,14 @@ public:
     std::list< didl::DidlContainerArtist > artists ( const size_t & start_index, const size_t & result_count,
             std::map< std::string, std::string > filters = std::map<std::string, std::string >(),
             std::pair< std::string, std::string > sort = std::pair<std::string, std::string > ( "title", "asc" ) ) const;
+    /**
+     * @brief hand the artists to the visitor while the rows are read.
+     * @return the number of artists visited.
+     */
+    size_t visitArtists ( const size_t & start_index, const size_t & result_count,
+                          std::function< void ( didl::DidlContainerArtist & ) > visitor,
+                          std::map< std::string, std::string > filters = std::map<std::string, std::string >(),
+                          std::pair< std::string, std::string > sort = std::pair<std::string, std::string > ( "title", "asc" ) ) const;
     /**
      * @brief save artist
      * @param artist
@@ -691,6 +1053,14 @@ public:
     std::list< didl::DidlContainer > series ( const size_t & start_index, const size_t & result_count,
             std::map< std::string, std::string > filters = std::map<std::string, std::string >(),
             std::pair< std::string, std::string > sort = std::pair<std::string, std::string > ( "series_title", "asc" ) ) const;
+    /**
+     * @brief hand the series to the visitor while the rows are read.
+     * @return the number of series visited.
+     */
+    size_t visitSeries ( const size_t & start_index, const size_t & result_count,
+                         std::function< void ( didl::DidlContainer & ) > visitor,
+                         std::map< std::string, std::string > filters = std::map<std::string, std::string >(),
+                         std::pair< std::string, std::string > sort = std::pair<std::string, std::string > ( "series_title", "asc" ) ) const;
 
     /**
      * @brief get list of series
@@ -705,19 +1075,366 @@ public:
      */
     int touch ( const std::string & path, const unsigned long mtime );
 
+    /**
+     * @brief map the UPnP SortCriteria to the sort columns.
+     * <p>The criteria are comma separated properties with + or - for the direction, for example
+     * <code>+dc:title,-dc:date</code>. Only the properties of indexed columns are sorted, the others
+     * are ignored. The fallback is returned when no property is left.</p>
+     * @param criteria the SortCriteria.
+     * @param fallback the sort of the container.
+     * @return the sort columns and the direction, columns with another direction carry their own.
+     */
+    static std::pair< std::string, std::string > sortCriteria ( const std::string & criteria, const std::pair< std::string, std::string > & fallback );
+    /** @brief the comma separated properties for GetSortCapabilities. */
+    static std::string sortCapabilities();
+
+    /**
+     * @brief apply the schema migrations.
+     * <p>The schema version is stored in <code>PRAGMA user_version</code>. Every migration
+     * with a higher version is applied in its own transaction.</p>
+     * @param db the writer connection.
+     * @return the schema version.
+     */
+    static int migrate ( db::db_connection_ptr db );
+
 private:
-    /* CREATE TABLES */
-    const std::list< std::string > CREATE_STATEMENTS {
-        "CREATE TABLE IF NOT EXISTS tbl_cds_object( cls, parent_id, size, title, path, mime_type, mtime, rating, year, track, disc, isbn, playback_count, object_update_id, contributor, artist, author, publisher, genre, album, comment, series_title, season, episode, dlna_profile, last_playback_time, import, timestamp );",
-        "CREATE UNIQUE INDEX IF NOT EXISTS UniqueIndexObjectPath ON tbl_cds_object(path);",
-        "CREATE TABLE IF NOT EXISTS tbl_cds_artist( clean_name, name, import );",
-        "CREATE UNIQUE INDEX IF NOT EXISTS UniqueIndexArtistCleanName ON tbl_cds_artist(clean_name);",
-        "CREATE TABLE IF NOT EXISTS tbl_cds_resource( ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, duration, framerate, mime_type, nr_audio_channels, resolution, sample_frequency, size );",
-        "CREATE INDEX IF NOT EXISTS UniqueIndexResourceRef ON tbl_cds_resource(ref_obj);",
-        "CREATE TABLE IF NOT EXISTS tbl_cds_album_art_uri( ref_obj, path, uri, profile);",
-        "CREATE INDEX IF NOT EXISTS UniqueIndexAlbumArtUriRef ON tbl_cds_album_art_uri(ref_obj);",
+    /* SCHEMA MIGRATIONS, the position in the list is the schema version. */
+    static const std::vector< std::list< std::string > > MIGRATIONS;
+    /* column names allowed in filters and sort clauses. */
+    static const std::set< std::string > OBJECT_COLUMNS, ARTIST_COLUMNS;
+    /* the UPnP properties with an index on their sort column. */
+    static const std::map< std::string, std::string > SORT_CRITERIA;
+    /* the sort key columns used to sort by the columns. */
+    static const std::map< std::string, std::string > OBJECT_SORT_KEYS, ARTIST_SORT_KEYS;
+    /* the sort columns of the presorted objects in the catalog snapshot. */
+    static const std::map< std::string, UpnpCatalogSnapshot::ORDER > SNAPSHOT_ORDERS;
+    /* replace the columns in the comma separated list with their sort keys. */
+    static std::string _sort_keys ( const std::string & columns, const std::map< std::string, std::string > & keys );
+    db::db_pool_ptr _db_pool;
+    /* checkpoints for the paged queries, cleared when the objects change. */
+    mutable db::Sqlite3KeysetCache _keysets;
+
+    /* the catalog generation. */
+    std::atomic< size_t > _generation { 1 };
+    /* copy of tbl_cds_counter, loaded again when the generation changed. */
+    mutable std::mutex _counters_mtx;
+    mutable std::map< std::string, size_t > _counter_values;
+    mutable size_t _counters_generation = 0;
+
+    /* hydrated objects read by id. */
+    mutable db::Sqlite3ObjectCache _objects;
+    /* ids written in the open transaction, dropped again from the object cache after the commit. */
+    std::mutex _pending_mtx;
+    std::set< int64_t > _pending;
+    /* the published catalog snapshot, loaded and stored with std::atomic_load and std::atomic_store. */
+    std::shared_ptr< const UpnpCatalogSnapshot > _snapshot;
+
+    /* the catalog snapshot when it shows the current generation. */
+    std::shared_ptr< const UpnpCatalogSnapshot > _catalog() const {
+        std::shared_ptr< const UpnpCatalogSnapshot > snapshot_ = std::atomic_load ( &_snapshot );
+        return ( snapshot_ && snapshot_->generation() == _generation.load() ? snapshot_ : nullptr );
+    }
+
+    /* the catalog changed, drop the cached checkpoints and counters. */
+    void _changed();
+    /* the object was written, drop it from the object cache now and after the commit. */
+    void _invalidate ( const int64_t id );
+    /* the writer committed the transaction. */
+    void _committed();
+    /* the writer thread, declared after the caches to stop before they are destroyed. */
+    db::db_writer_ptr _writer;
+    /* the maintenance thread, stops before the writer. */
+    db::db_maintenance_ptr _maintenance;
+    /* the browse queries, their plans are logged when the maintenance changes them. */
+    static const std::vector< std::string > QUERY_PLANS;
+    static void _maintained ( const db::Sqlite3Maintenance::Report & report );
+
+    /* execute the write operation in the writer thread and wait for the result. */
+    template< typename F >
+    typename std::result_of< F ( db::db_connection_ptr ) >::type _write ( F op ) {
+        auto result_ = _writer->submit ( op ).get();
+        _changed();
+        return result_;
+    }
+
+    /* insert the object or update the object with the same path, then write its resources. the sort keys are bound after the columns. */
+    template< typename T >
+    static T _upsert ( db::db_connection_ptr db, T o ) {
+        static const std::string query_ = [] {
+            std::string columns_, placeholders_, excluded_;
+
+            for ( auto & key : DidlSortKeys< T >::columns() ) {
+                columns_ += ", " + key;
+                placeholders_ += ", ?";
+                excluded_ += ", " + key + "=excluded." + key;
+            }
+
+            return "insert into tbl_cds_object( " + SqlColumns< T >::insert() + columns_ + " ) values( " +
+                   SqlColumns< T >::placeholders() + placeholders_ + " ) on conflict( path ) do update set " +
+                   SqlColumns< T >::excluded() + excluded_ + " returning ROWID";
+        }();
+
+        db::db_statement_ptr stmt_ = db->prepareStatement ( query_ );
+        int index_ = 0;
+        DidlBindWrite< T >::bind ( stmt_.get(), index_, o, o );
+        DidlSortKeys< T >::bind ( stmt_.get(), index_, o );
+
+        if ( stmt_->step() ) {
+            o._id = stmt_->get_int64 ( 0 );
+        }
+
+        stmt_.reset();
+        DidlBind< T >::bind ( db, o );
+        return o;
+    }
+    /* the fts5 query of the search text, every word is a quoted prefix. */
+    static std::string _search_match ( const std::string & text );
+    /* start the query with the ranked matches "with hits( hit, score )", false when the text has no words. */
+    static bool _search_query ( db::Sqlite3QueryBuilder & query, const std::string & text );
+    /* append the search criteria and the recursive condition for the objects below the container, only the classes when not empty. */
+    static void _search_where ( db::Sqlite3QueryBuilder & query, const UpnpSearchCriteria & criteria, const size_t container,
+                                const std::vector< didl::DIDL_CLASS > & classes = std::vector< didl::DIDL_CLASS >() );
+    static std::map< std::string, size_t > _load_counters ( db::db_connection_ptr db );
+    /* delete the next batch of swept objects, returns the number of objects. the unused cached files are added to files. */
+    static size_t _sweep_objects ( db::db_connection_ptr db, const long mtime, const size_t batch,
+                                   const std::vector< std::string > & directories, SweepStats & stats, std::list< std::string > & files );
+    /* delete the next batch of artists without albums or tracks. */
+    static size_t _sweep_artists ( db::db_connection_ptr db, const size_t batch, SweepStats & stats );
+    static void _remove_files ( const std::list< std::string > & files, SweepStats & stats );
+    std::map< std::string, size_t > _counters() const;
+    size_t _counter ( const std::string & name ) const;
+
+    /* number of object ids bound to one hydration query. */
+    static const size_t HYDRATE_BATCH = 128;
+
+    /* read the objects from the statement rows, hydrate HYDRATE_BATCH objects at once and hand them to the visitor. */
+    template< typename T, typename V >
+    class RowVisitor {
+    public:
+        RowVisitor ( db::db_connection_ptr db, V & visitor ) : _db ( db ), _visitor ( visitor ) {
+            _batch.reserve ( HYDRATE_BATCH );
+        }
+        void operator() ( db::Sqlite3Statement * stmt ) {
+            _batch.push_back ( T() );
+            int index_ = 0;
+            DidlBindRead< T >::bind ( stmt, index_, _batch.back(), _batch.back() );
+
+            if ( _batch.size() == HYDRATE_BATCH ) {
+                flush();
+            }
+        }
+        /* visit the remaining objects, returns the number of objects visited. */
+        size_t flush() {
+            _hydrate ( _db, _batch.begin(), _batch.end() );
+
+            for ( auto & object : _batch ) {
+                _visitor ( object );
+            }
+
+            _count += _batch.size();
+            _batch.clear();
+            return _count;
+        }
+    private:
+        db::db_connection_ptr _db;
+        V & _visitor;
+        std::vector< T > _batch;
+        size_t _count = 0;
+    };
+
+    /* read the search rows into the objects of the type of their class, the columns of each type follow the columns of the types before. */
+    template< typename V, typename... T >
+    class SearchRows {
+    public:
+        SearchRows ( V &, const int ) {}
+        static std::string select() { return ""; }
+        void read ( db::Sqlite3Statement *, const int, std::vector< std::function< void() > > & ) {}
+        void hydrate ( db::db_connection_ptr ) {}
+    };
+    template< typename V, typename T, typename... R >
+    class SearchRows< V, T, R... > : public SearchRows< V, R... > {
+    public:
+        SearchRows ( V & visitor, const int offset ) :
+            SearchRows< V, R... > ( visitor, offset + std::count ( SqlColumns< T >::select().begin(), SqlColumns< T >::select().end(), ',' ) + 1 ),
+            _visitor ( visitor ), _offset ( offset ) {}
+        static std::string select() {
+            return ", " + SqlColumns< T >::select() + SearchRows< V, R... >::select();
+        }
+        /* read the row when the class is the class of T, the visit is appended to the order. */
+        void read ( db::Sqlite3Statement * stmt, const int cls, std::vector< std::function< void() > > & order ) {
+            if ( cls != DidlType< T >::cls() ) {
+                SearchRows< V, R... >::read ( stmt, cls, order );
+                return;
+            }
+
+            _objects.push_back ( T() );
+            int index_ = _offset;
+            DidlBindRead< T >::bind ( stmt, index_, _objects.back(), _objects.back() );
+            const size_t position_ = _objects.size() - 1;
+            order.push_back ( [this, position_]() { _visitor ( _objects[ position_ ] ); } );
+        }
+        void hydrate ( db::db_connection_ptr db ) {
+            _hydrate ( db, _objects.begin(), _objects.end() );
+            SearchRows< V, R... >::hydrate ( db );
+        }
+    private:
+        V & _visitor;
+        const int _offset;
+        std::vector< T > _objects;
     };
-    db::db_connection_ptr _db;
+
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Hydrate );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, SortKeys );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Counters );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Upsert );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Sweep );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Search );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, SearchCriteria );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, SortCriteria );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, RowVisitor );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, SearchRows );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, Snapshot );
+    FRIEND_TEST ( TestUpnpContentDirectoryDao, QueryPlan );
+
+    /* read the object from the catalog snapshot with the columns of SqlColumns< T >::select(). */
+    template< typename T >
+    static void _read ( const UpnpCatalogSnapshot & catalog, const std::vector< int > & columns, const UpnpCatalogSnapshot::position_t position, T & o ) {
+        UpnpCatalogSnapshot::Row row_ = catalog.object ( position, columns );
+        int index_ = 0;
+        DidlBindRead< T >::bind ( &row_, index_, o, o );
+        _hydrate ( catalog, position, o );
+    }
+    /* hand the page of the presorted objects to the visitor. with filter the objects of other classes than T are skipped. */
+    template< typename T, typename V >
+    static size_t _visit ( const UpnpCatalogSnapshot & catalog, const UpnpCatalogSnapshot::range_t range, const bool filter, const bool reverse,
+                           const size_t start_index, const size_t result_count, V & visitor ) {
+        const std::vector< int > columns_ = catalog.objectColumns ( SqlColumns< T >::select() );
+        const size_t size_ = range.second - range.first;
+        //like the limit clause the start index is only used with a result count.
+        size_t skip_ = ( result_count > 0 ? start_index : 0 ), count_ = 0;
+
+        for ( size_t i = ( filter ? 0 : std::min ( skip_, size_ ) ); i < size_ && ( result_count == 0 || count_ < result_count ); ++i ) {
+            const UpnpCatalogSnapshot::position_t position_ = ( reverse ? range.first[ size_ - i - 1 ] : range.first[ i ] );
+
+            if ( filter && catalog.cls ( position_ ) != DidlType< T >::cls() ) {
+                continue;
+            }
+
+            if ( filter && skip_ > 0 ) {
+                --skip_;
+                continue;
+            }
+
+            T o;
+            _read ( catalog, columns_, position_, o );
+            visitor ( o );
+            ++count_;
+        }
+
+        return count_;
+    }
+
+    /* load the resources of the items. */
+    template< typename It >
+    static typename std::enable_if< std::is_base_of< didl::DidlItem, typename std::iterator_traits< It >::value_type >::value >::type
+    _hydrate ( db::db_connection_ptr db, It begin, It end ) {
+        static const std::string query_ = "select ROWID, ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, "
+                                          "duration, framerate, mime_type, nr_audio_channels, resolution, sample_frequency, size "
+                                          "from tbl_cds_resource where ref_obj IN " + _hydrate_placeholders();
+
+        _hydrate_batches ( db, query_, begin, end, [] ( db::Sqlite3Statement * stmt, typename std::iterator_traits< It >::value_type & o ) {
+            o._item_resource.push_back ( read_resource ( stmt ) );
+        } );
+    }
+    /* load the album art uris of the albums. */
+    template< typename It >
+    static typename std::enable_if< std::is_base_of< didl::DidlContainerAlbum, typename std::iterator_traits< It >::value_type >::value ||
+                             std::is_base_of< didl::DidlContainerPhotoAlbum, typename std::iterator_traits< It >::value_type >::value >::type
+    _hydrate ( db::db_connection_ptr db, It begin, It end ) {
+        static const std::string query_ = "select ROWID, ref_obj, path, uri, profile from tbl_cds_album_art_uri where ref_obj IN " + _hydrate_placeholders();
+
+        _hydrate_batches ( db, query_, begin, end, [] ( db::Sqlite3Statement * stmt, typename std::iterator_traits< It >::value_type & o ) {
+            o._album_art_uri.push_back ( read_album_art_uri ( stmt ) );
+        } );
+    }
+    /* nothing to load for the other types. */
+    template< typename It >
+    static typename std::enable_if< ! std::is_base_of< didl::DidlItem, typename std::iterator_traits< It >::value_type >::value &&
+                             ! std::is_base_of< didl::DidlContainerAlbum, typename std::iterator_traits< It >::value_type >::value &&
+                             ! std::is_base_of< didl::DidlContainerPhotoAlbum, typename std::iterator_traits< It >::value_type >::value >::type
+    _hydrate ( db::db_connection_ptr, It, It ) {}
+
+    /* load the resources of the item from the catalog snapshot. */
+    template< typename T >
+    static typename std::enable_if< std::is_base_of< didl::DidlItem, T >::value >::type
+    _hydrate ( const UpnpCatalogSnapshot & catalog, const UpnpCatalogSnapshot::position_t position, T & o ) {
+        const UpnpCatalogSnapshot::rows_t rows_ = catalog.resources ( position );
+
+        for ( UpnpCatalogSnapshot::position_t row = rows_.first; row < rows_.second; ++row ) {
+            UpnpCatalogSnapshot::Row resource_ = catalog.resource ( row );
+            o._item_resource.push_back ( read_resource ( &resource_ ) );
+        }
+    }
+    /* load the album art uris of the album from the catalog snapshot. */
+    template< typename T >
+    static typename std::enable_if< std::is_base_of< didl::DidlContainerAlbum, T >::value ||
+                             std::is_base_of< didl::DidlContainerPhotoAlbum, T >::value >::type
+    _hydrate ( const UpnpCatalogSnapshot & catalog, const UpnpCatalogSnapshot::position_t position, T & o ) {
+        const UpnpCatalogSnapshot::rows_t rows_ = catalog.albumArtUris ( position );
+
+        for ( UpnpCatalogSnapshot::position_t row = rows_.first; row < rows_.second; ++row ) {
+            UpnpCatalogSnapshot::Row album_art_uri_ = catalog.albumArtUri ( row );
+            o._album_art_uri.push_back ( read_album_art_uri ( &album_art_uri_ ) );
+        }
+    }
+    template< typename T >
+    static typename std::enable_if< ! std::is_base_of< didl::DidlItem, T >::value &&
+                             ! std::is_base_of< didl::DidlContainerAlbum, T >::value &&
+                             ! std::is_base_of< didl::DidlContainerPhotoAlbum, T >::value >::type
+    _hydrate ( const UpnpCatalogSnapshot &, const UpnpCatalogSnapshot::position_t, T & ) {}
+
+    /* run the query for HYDRATE_BATCH objects at once, the ref_obj is the second column of the result. */
+    template< typename It, typename F >
+    static void _hydrate_batches ( db::db_connection_ptr db, const std::string & query, It begin, It end, F read ) {
+        std::map< size_t, typename std::iterator_traits< It >::value_type * > objects_;
+
+        while ( begin != end ) {
+            objects_.clear();
+
+            for ( ; begin != end && objects_.size() < HYDRATE_BATCH; ++begin ) {
+                objects_[ begin->id() ] = & ( *begin );
+            }
+
+            db::db_statement_ptr stmt_ = db->prepareStatement ( query );
+            int index_ = 0;
+
+            for ( auto & object : objects_ ) {
+                stmt_->bind_int64 ( ++index_, object.first );
+            }
+
+            //unused placeholders, the statement text is the same for every batch.
+            while ( index_ < static_cast< int > ( HYDRATE_BATCH ) ) {
+                stmt_->bind_null ( ++index_ );
+            }
+
+            while ( stmt_->step() ) {
+                auto object_ = objects_.find ( stmt_->get_int64 ( 1 ) );
+
+                if ( object_ != objects_.end() ) {
+                    read ( stmt_.get(), *object_->second );
+                }
+            }
+        }
+    }
+    static std::string _hydrate_placeholders() {
+        std::string placeholders_ = "(";
+
+        for ( size_t i = 0; i < HYDRATE_BATCH; ++i ) {
+            placeholders_ += ( i == 0 ? "?" : ", ?" );
+        }
+
+        return placeholders_ + ")";
+    }
 };
 
 typedef std::shared_ptr< squawk::UpnpContentDirectoryDao > ptr_upnp_dao;
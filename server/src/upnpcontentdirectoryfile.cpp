@@ -42,9 +42,7 @@ std::tuple<size_t, size_t> UpnpContentDirectoryFile::parseNode ( didl::DidlXmlWr
     std::tuple<size_t, size_t> res_;
 
     auto dao = SquawkServer::instance()->dao();
-    std::list< didl::DidlObject > item_list_ = dao->children<didl::DidlObject> ( parent_id_, start_index_, request_count_ );
-
-    for ( auto & item__ : item_list_ ) {
+    const size_t returned_ = dao->visitChildren<didl::DidlObject> ( parent_id_, start_index_, request_count_, [&] ( didl::DidlObject & item__ ) {
         switch ( item__.cls() ) {
         case didl::objectContainer:
         { didl_element->container ( "/file/{}", "/file/{}", dao->object<didl::DidlContainer> ( item__.id() ) ); break; }
@@ -70,8 +68,9 @@ std::tuple<size_t, size_t> UpnpContentDirectoryFile::parseNode ( didl::DidlXmlWr
         default:
             break;
         }
-    }
+    }, std::map< std::string, std::string >(),
+    UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
 
-    return std::tuple<size_t, size_t> ( item_list_.size(), dao->childrenCount ( didl::object, parent_id_ ) );
+    return std::tuple<size_t, size_t> ( returned_, dao->childrenCount ( didl::object, parent_id_ ) );
 }
 }// namespace squawk
@@ -43,21 +43,20 @@ std::tuple<size_t, size_t> UpnpContentDirectoryImage::parseNode ( didl::DidlXmlW
     if ( request->contains ( upnp::OBJECT_ID ) &&
          request->getValue ( upnp::OBJECT_ID ) == "/images/" ) {
 
-        std::list< didl::DidlContainerPhotoAlbum > photo_album_list_ =
-            dao->objects<didl::DidlContainerPhotoAlbum> ( start_index_, request_count_ );
-        std::for_each ( photo_album_list_.begin(), photo_album_list_.end(), [&] ( didl::DidlContainerPhotoAlbum & a ) {
+        const size_t returned_ = dao->visitObjects<didl::DidlContainerPhotoAlbum> ( start_index_, request_count_, [&] ( didl::DidlContainerPhotoAlbum & a ) {
             didl_element->container ( "/images/{}", "/images/{}", http_uri ( "albumArtUri/{0}.jpg" ), a );
-        } );
-        res_ = std::tuple<size_t, size_t> ( photo_album_list_.size(), dao->objectsCount ( didl::objectContainerAlbumPhotoAlbum ) );
+        }, std::map< std::string, std::string >(),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->objectsCount ( didl::objectContainerAlbumPhotoAlbum ) );
 
     } else {
 
-        std::list< didl::DidlPhoto > photo_list_ =
-            dao->children<didl::DidlPhoto> ( ContentDirectoryModule::item_id ( request ), start_index_, request_count_ );
-        std::for_each ( photo_list_.begin(), photo_list_.end(), [&] ( didl::DidlPhoto & photo_ ) {
+        const size_t returned_ = dao->visitChildren<didl::DidlPhoto> ( ContentDirectoryModule::item_id ( request ), start_index_, request_count_,
+        [&] ( didl::DidlPhoto & photo_ ) {
             didl_element->write ( "/images/{}", "/images/{}", http_uri() + "resource/{0}.jpg", photo_ );
-        } );
-        res_ = std::tuple<size_t, size_t> ( photo_list_.size(),
+        }, std::map< std::string, std::string >(),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
+        res_ = std::tuple<size_t, size_t> ( returned_,
             dao->childrenCount ( didl::objectItemImageItemPhoto, ContentDirectoryModule::item_id ( request ) ) );
     }
 
@@ -42,13 +42,11 @@ std::tuple<size_t, size_t> UpnpContentDirectoryMusic::parseNode ( didl::DidlXmlW
     /* ----------- Artists ----------- */
     if ( request->getValue ( upnp::OBJECT_ID ) == "/music/artist" ) {
 
-        std::list< didl::DidlContainerArtist > artist_list_ =
-            dao->artists ( start_index_, request_count_, std::map< std::string, std::string >(), std::make_pair ( "name", "asc" ) );
-        std::for_each ( artist_list_.begin(), artist_list_.end(), [&didl_element] ( didl::DidlContainerArtist & a ) {
+        const size_t returned_ = dao->visitArtists ( start_index_, request_count_, [&didl_element] ( didl::DidlContainerArtist & a ) {
             didl_element->container ( "/music/artist/"+a.cleanName(), "/music/artist", a );
-        } );
+        }, std::map< std::string, std::string >(), std::make_pair ( "name", "asc" ) );
 
-        res_ = std::tuple<size_t, size_t> ( artist_list_.size(), dao->artistsCount() );
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->artistsCount() );
 
 
         /* ----------- Albums by Artist ----------- */
@@ -58,37 +56,34 @@ std::tuple<size_t, size_t> UpnpContentDirectoryMusic::parseNode ( didl::DidlXmlW
 
         std::string artist_name_ = ContentDirectoryModule::item_string ( request );
         std::map< std::string, std::string > filters_ ( { { "artist", artist_name_ }, { "contributor", artist_name_ } } );
-        std::list< didl::DidlContainerAlbum > album_list_ = dao->objects<didl::DidlContainerAlbum> ( start_index_, request_count_, filters_ );
-        std::for_each ( album_list_.begin(), album_list_.end(), [&didl_element] ( didl::DidlContainerAlbum & a ) {
+        const size_t returned_ = dao->visitObjects<didl::DidlContainerAlbum> ( start_index_, request_count_, [&didl_element] ( didl::DidlContainerAlbum & a ) {
             didl_element->container ( "/music/album/{}", "/music/artist/", http_uri ( "albumArtUri/{}.jpg" ), a );
-        } );
+        }, filters_, UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
 
-        res_ = std::tuple<size_t, size_t> ( album_list_.size(), dao->objectsCount ( didl::objectContainerAlbumMusicAlbum, filters_ ) );
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->objectsCount ( didl::objectContainerAlbumMusicAlbum, filters_ ) );
 
         /* ----------- Albums ----------- */
 
     } else if ( request->contains ( upnp::OBJECT_ID ) &&
                 request->getValue ( upnp::OBJECT_ID ) == "/music/album" ) {
 
-        std::list< didl::DidlContainerAlbum > album_list_ = dao->objects<didl::DidlContainerAlbum> ( start_index_, request_count_ );
-        std::for_each ( album_list_.begin(), album_list_.end(), [&] ( didl::DidlContainerAlbum & a ) {
+        const size_t returned_ = dao->visitObjects<didl::DidlContainerAlbum> ( start_index_, request_count_, [&] ( didl::DidlContainerAlbum & a ) {
             didl_element->container ( "/music/album/{}", "/music/album", http_uri ( "albumArtUri/{}.jpg" ), a );
-        } );
-        res_ = std::tuple<size_t, size_t> ( album_list_.size(), dao->objectsCount ( didl::objectContainerAlbumMusicAlbum ) );
+        }, std::map< std::string, std::string >(),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->objectsCount ( didl::objectContainerAlbumMusicAlbum ) );
 
         /* ----------- New Albums ----------- */
 
     } else if ( request->contains ( upnp::OBJECT_ID ) &&
                 request->getValue ( upnp::OBJECT_ID ) == "/music/new" ) {
 
-        std::list< didl::DidlContainerAlbum > album_list_ = dao->objects<didl::DidlContainerAlbum> ( start_index_, request_count_,
-                std::map< std::string, std::string >(),
-                std::make_pair ( "mtime", "desc" ) );
-        std::for_each ( album_list_.begin(), album_list_.end(), [&didl_element] ( didl::DidlContainerAlbum & a ) {
+        const size_t returned_ = dao->visitObjects<didl::DidlContainerAlbum> ( start_index_, request_count_, [&didl_element] ( didl::DidlContainerAlbum & a ) {
             didl_element->container ( "/music/album/{}", "/music/new", http_uri ( "albumArtUri/{}.jpg" ), a );
-        } );
+        }, std::map< std::string, std::string >(),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "mtime", "desc" ) ) );
 
-        res_ = std::tuple<size_t, size_t> ( album_list_.size(), dao->objectsCount ( didl::objectContainerAlbumMusicAlbum ) );
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->objectsCount ( didl::objectContainerAlbumMusicAlbum ) );
 
         /* ----------- Songs ----------- */
 
@@ -96,16 +91,7 @@ std::tuple<size_t, size_t> UpnpContentDirectoryMusic::parseNode ( didl::DidlXmlW
                 ContentDirectoryModule::matchObjectId ( request, "/music/album/" ) ) {
 
         size_t album_id_ = ContentDirectoryModule::item_id ( request );
-        std::list< didl::DidlObject > track_list_ =
-            dao->children<didl::DidlObject> (
-                album_id_, start_index_, request_count_,
-        std::map<std::string, std::string> ( {
-            { "cls", std::to_string ( didl::objectContainer ) + ", " + std::to_string ( didl::objectItemAudioItemMusicTrack ) }
-        } ),
-        std::pair<std::string, std::string > ( "track, cls, title", "asc" )
-            );
-
-        for ( auto object_ : track_list_ ) {
+        const size_t returned_ = dao->visitChildren<didl::DidlObject> ( album_id_, start_index_, request_count_, [&] ( didl::DidlObject & object_ ) {
             if ( object_.cls() == didl::objectItemAudioItemMusicTrack ) {
                 didl_element->write ( "/music/album/{}", "/music/album/{}", http_uri ( "resource/{0}.{1}" ), http_uri ( "albumArtUri/{}.jpg" ),
                                       dao->object<didl::DidlMusicTrack> ( object_.id() ) );
@@ -118,9 +104,13 @@ std::tuple<size_t, size_t> UpnpContentDirectoryMusic::parseNode ( didl::DidlXmlW
                 didl_element->container ( "/music/album/{}", "/music/album/{}",
                                           dao->object<didl::DidlContainer> ( object_.id() ) );
             }
-        }
+        },
+        std::map<std::string, std::string> ( {
+            { "cls", std::to_string ( didl::objectContainer ) + ", " + std::to_string ( didl::objectItemAudioItemMusicTrack ) }
+        } ),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "track, cls, title", "asc" ) ) );
 
-        res_ = std::tuple<size_t, size_t> ( track_list_.size(), dao->childrenCount ( didl::object, album_id_,
+        res_ = std::tuple<size_t, size_t> ( returned_, dao->childrenCount ( didl::object, album_id_,
             std::map<std::string, std::string> ( {
                 { "cls", std::to_string ( didl::objectContainer ) + ", " + std::to_string ( didl::objectItemAudioItemMusicTrack ) }
             })
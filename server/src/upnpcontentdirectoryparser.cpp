@@ -39,20 +39,52 @@ void UpnpContentDirectoryParser::parse ( std::list< std::string > paths ) {
     statistic.clear();
     std::chrono::time_point<std::chrono::system_clock> start, end;
     start = std::chrono::system_clock::now();
-    SquawkServer::instance()->dao()->startTransaction();
+
+    size_t workers_ = SquawkServer::instance()->config()->importWorkers();
+
+    if ( workers_ == 0 ) {
+        workers_ = std::max ( 1U, std::thread::hardware_concurrency() );
+    }
+
+    import_queue imports_ ( QUEUE_SIZE );
+    write_queue writes_ ( QUEUE_SIZE );
+
+    std::thread writer_ ( &UpnpContentDirectoryParser::_write, this, std::ref ( writes_ ) );
+    std::vector< std::thread > worker_threads_;
+
+    for ( size_t i = 0; i < workers_; ++i ) {
+        worker_threads_.push_back ( std::thread ( &UpnpContentDirectoryParser::_work, this, std::ref ( imports_ ), std::ref ( writes_ ) ) );
+    }
 
     for ( auto & path : paths ) {
         if ( boost::filesystem::is_directory ( path ) ) {
-            didl::DidlContainer parent_ ( 0, 0, "ROOT", "/", 0, 0, 0, true );
-            _parse ( parent_, path );
+            directory_ptr parent_ = std::make_shared< Directory > ( nullptr, didl::DidlContainer ( 0, 0, "ROOT", "/", 0, 0, 0, true ), "ROOT", 0 );
+            parent_->saved = true;
+            _walk ( parent_, path, 0, imports_, writes_ );
 
         } else {
             CLOG(ERROR, "upnp") << path << "is not a directory.";
         }
     }
 
+    //drain the pipeline, the workers push to the writer until they are done.
+    imports_.close();
+
+    for ( auto & worker : worker_threads_ ) {
+        worker.join();
+    }
+
+    writes_.close();
+    writer_.join();
+
     SquawkServer::instance()->dao()->sweep ( start_time );
-    SquawkServer::instance()->dao()->endTransaction();
+    SquawkServer::instance()->dao()->flush();
+
+    if ( SquawkServer::instance()->config()->catalogSnapshot() ) {
+        SquawkServer::instance()->dao()->publishSnapshot();
+    }
+
+    SquawkServer::instance()->dao()->maintain();
 
 //TODO    SquawkServer::instance()->dao()->startTransaction();
 
@@ -76,6 +108,7 @@ void UpnpContentDirectoryParser::parse ( std::list< std::string > paths ) {
     }
 
     ss << "Total:\t" << sum << std::endl;
+    ss << "Workers:\t" << workers_ << std::endl;
     ss << "Time:\t" << elapsed_seconds.count() << std::endl;
     CLOG(INFO, "upnp") << ss.str();
 }
@@ -83,9 +116,8 @@ void UpnpContentDirectoryParser::parse ( std::list< std::string > paths ) {
 void UpnpContentDirectoryParser::_import_audio ( const didl::DidlObject object ) {
 }
 
-didl::DidlMusicTrack inline UpnpContentDirectoryParser::_import_track ( const didl::DidlItem & track  ) {
-    //Get the track information
-    commons::media::MediaFile media_file = commons::media::MediaParser::parseFile ( track.path() );
+didl::DidlMusicTrack UpnpContentDirectoryParser::_import_track ( const didl::DidlItem & track, const commons::media::MediaFile & media_file ) {
+    //the track information, the file was probed by the worker.
     std::string album_name_ = media_file.getTag ( commons::media::MediaFile::ALBUM );
     std::string artist_ = "";
 
@@ -100,7 +132,7 @@ didl::DidlMusicTrack inline UpnpContentDirectoryParser::_import_track ( const di
     }
 
     std::string genre_ = media_file.getTag ( commons::media::MediaFile::GENRE );
-    unsigned long year_;
+    unsigned long year_ = 0;
 
     std::string str_year_ = media_file.getTag ( commons::media::MediaFile::YEAR );
 
@@ -169,7 +201,7 @@ void UpnpContentDirectoryParser::_import_movies ( const didl::DidlObject object
 //    }
 }
 
-void UpnpContentDirectoryParser::_import_movie ( const didl::DidlItem & movie ) {
+didl::DidlMovie UpnpContentDirectoryParser::_import_movie ( const didl::DidlItem & movie ) {
     CLOG(TRACE, "upnp") << "import movie:" << movie.path();
 
     commons::media::MediaFile media_file = commons::media::MediaParser::parseFile ( movie.path() );
@@ -189,10 +221,8 @@ void UpnpContentDirectoryParser::_import_movie ( const didl::DidlItem & movie )
     std::string title_;
     _parse_series ( movie.title(), &season_, &episode_, &title_ );
 
-    SquawkServer::instance()->dao()->save (
-        didl::DidlMovie ( movie.id(), movie.parentId(), movie.title(), movie.path(), movie.mtime(), 0,
-                          boost::filesystem::file_size ( file_path_ ), movie.mimeType(), resources_, 0, season_, episode_, title_, true )
-    );
+    return didl::DidlMovie ( movie.id(), movie.parentId(), movie.title(), movie.path(), movie.mtime(), 0,
+                             boost::filesystem::file_size ( file_path_ ), movie.mimeType(), resources_, 0, season_, episode_, title_, true );
 }
 
 void UpnpContentDirectoryParser::_import_images ( const didl::DidlObject /* object */ ) {
@@ -230,7 +260,7 @@ void UpnpContentDirectoryParser::_import_images ( const didl::DidlObject /* obje
 //    }
 }
 
-void UpnpContentDirectoryParser::_import_photo ( const didl::DidlItem & photo ) {
+didl::DidlPhoto UpnpContentDirectoryParser::_import_photo ( const didl::DidlItem & photo ) {
     CLOG(TRACE, "upnp") << "import photo:" << photo.path();
 
     std::list<didl::DidlResource> resources_;
@@ -281,16 +311,15 @@ void UpnpContentDirectoryParser::_import_photo ( const didl::DidlItem & photo )
     } ) )
                          );
 
-    SquawkServer::instance()->dao()->save (
-        didl::DidlPhoto ( photo.id(), photo.parentId(), photo.title(), photo.path(), photo.mtime(),
-                          photo.objectUdpateId(), photo.size(), photo.mimeType(), resources_, true ) );
+    return didl::DidlPhoto ( photo.id(), photo.parentId(), photo.title(), photo.path(), photo.mtime(),
+                             photo.objectUdpateId(), photo.size(), photo.mimeType(), resources_, true );
 }
 
 void UpnpContentDirectoryParser::_import_books () {
     std::list< didl::DidlEBook > book_list_;
 }
 
-void UpnpContentDirectoryParser::_import_ebook ( const didl::DidlItem & ebook ) {
+didl::DidlEBook UpnpContentDirectoryParser::_import_ebook ( const didl::DidlItem & ebook ) {
     CLOG(TRACE, "upnp") << "import book:" << ebook.path();
 
     std::list<didl::DidlResource> resources_;
@@ -301,13 +330,12 @@ void UpnpContentDirectoryParser::_import_ebook ( const didl::DidlItem & ebook )
                                std::map< didl::DidlResource::UPNP_RES_ATTRIBUTES, std::string > () )
                          );
 
-    SquawkServer::instance()->dao()->save (
-        didl::DidlEBook ( ebook.id(), ebook.parentId(), ebook.title(), ebook.path(),
-                          ebook.mtime(), ebook.objectUdpateId(), ebook.size(),
-                          ebook.mimeType(), resources_, PdfParser::parsePdf ( ebook.path() ), true ) );
+    return didl::DidlEBook ( ebook.id(), ebook.parentId(), ebook.title(), ebook.path(),
+                             ebook.mtime(), ebook.objectUdpateId(), ebook.size(),
+                             ebook.mimeType(), resources_, PdfParser::parsePdf ( ebook.path() ), true );
 }
 
-UpnpContentDirectoryParser::DIDL_PARSE_TYPES UpnpContentDirectoryParser::_parse ( didl::DidlContainer & parent, const std::string & path ) {
+void UpnpContentDirectoryParser::_walk ( directory_ptr parent, const std::string & path, const size_t index, import_queue & imports, write_queue & writes ) {
 
     boost::filesystem::path _fs_path ( path );
     std::string container_stem_ = _fs_path.stem().string();
@@ -316,15 +344,11 @@ UpnpContentDirectoryParser::DIDL_PARSE_TYPES UpnpContentDirectoryParser::_parse
     didl::DidlContainer container_ = SquawkServer::instance()->dao()->object<didl::DidlContainer> ( path );
 
     if ( container_.id() == 0 ) {
-        container_ = SquawkServer::instance()->dao()->save ( didl::DidlContainer ( 0, parent.id(), _fs_path.stem().string(), path, 0, 0, 0, true ) );
+        container_ = SquawkServer::instance()->dao()->save ( didl::DidlContainer ( 0, parent->container.id(), _fs_path.stem().string(), path, 0, 0, 0, true ) );
     }
 
-    bool parent_changed_ = false;
-    DIDL_PARSE_TYPES container_type_ = DIDL_PARSE_TYPES::container;
-
-    didl::DidlContainerAlbum album_;
-    didl::DidlContainerPhotoAlbum photo_album_;
-    std::list< didl::DidlAlbumArtUri > albumArtUri_;
+    directory_ptr directory_ = std::make_shared< Directory > ( parent, container_, container_stem_, index );
+    size_t imports_ = 0;
 
     std::list< std::string > child_directories_;
 
@@ -349,106 +373,250 @@ UpnpContentDirectoryParser::DIDL_PARSE_TYPES UpnpContentDirectoryParser::_parse
                     boost::filesystem::last_write_time ( itr->path() ), 0,
                     boost::filesystem::file_size ( itr->path() ), mime_type_, std::list<didl::DidlResource>(), false );
 
-                if ( file_type_ == didl::objectItemAudioItemMusicTrack ) {
-                    //parse and save audiofile
-                    didl::DidlMusicTrack track_ = _import_track ( item_ );
-
-                    if ( ! UpnpContentDirectoryParser::_parse_multidisc ( container_stem_ ) ) {
-                        parent_changed_ = true;
-                        container_type_ = DIDL_PARSE_TYPES::music_album;
-                        album_ = didl::DidlContainerAlbum (
-                                     container_.id(), container_.parentId(), track_.album(),
-                                     container_.path(), container_.mtime(), 0, 0, 0,
-                                     track_.year(), 0, track_.contributor(), track_.artist(),
-                                     track_.genre(), std::list< didl::DidlAlbumArtUri >(), false );
-
-                    } else {
-                        //XXX is multidisc folder
-                        //XXX actual dir is not a album
-                        //XXX change parent to album
-                        parent_changed_ = true;
-                        container_type_ = DIDL_PARSE_TYPES::multidisc;
-                        didl::DidlContainer _multidisc_container = SquawkServer::instance()->dao()->object<didl::DidlContainer> ( container_.parentId() );
-                        album_ =  didl::DidlContainerAlbum ( _multidisc_container.id(), _multidisc_container.parentId(), track_.album(),
-                                                             _multidisc_container.path(), _multidisc_container.mtime(), 0, 0, 0,
-                                                             track_.year(), 0, track_.contributor(), track_.artist(),
-                                                             track_.genre(), std::list< didl::DidlAlbumArtUri >(), false );
-                    }
-
-                } else if ( file_type_ == didl::objectItemImageItemPhoto ) {
-                    _import_photo ( item_ );
-
-                    if ( container_type_ == DIDL_PARSE_TYPES::container ) {
-                        parent_changed_ = true;
-                        container_type_ = DIDL_PARSE_TYPES::photo_album;
-                        photo_album_ = didl::DidlContainerPhotoAlbum ( container_.id(), container_.parentId(), container_stem_, container_.path(),
-                                       container_.mtime(), container_.objectUdpateId(), 0, 0, 0 /*aear*/, 0, "", "",
-                                       "", std::list< didl::DidlAlbumArtUri >(), false );
-                    }
-
-                    if ( _cover ( item_stem_ ) ) {
-                        albumArtUri_.push_back (
-                            didl::DidlAlbumArtUri ( 0, 0,
-                                                    SquawkServer::instance()->config()->tmpDirectory() + "/AlbumArtUri/" + std::to_string ( container_.id() ) + ".jpg", "URI", "JPEG_TN" ) );
-
-                        std::stringstream cover_stream_;
-                        cover_stream_ << SquawkServer::instance()->config()->tmpDirectory() << "/AlbumArtUri/" << container_.id() << ".jpg";
-                        image::Image image ( item_filepath_ );
-                        image.scale ( 160, 160, cover_stream_.str() );
-                    }
-
-                } else if ( file_type_ == didl::objectItemVideoItemMovie ) {
-                    _import_movie ( item_ );
-
-                } else if ( file_type_ == didl::objectItemEBook ) {
-                    _import_ebook ( item_ );
+                if ( file_type_ == didl::objectItem ) {
+                    //nothing to probe, the writer saves the item.
+                    writes.push ( Write { directory_, [item_]() {
+                        SquawkServer::instance()->dao()->save ( item_ );
+                    } } );
 
                 } else {
-                    SquawkServer::instance()->dao()->save ( item_ );
+                    imports.push ( Import { directory_, item_, imports_++ } );
                 }
             }
 
         } else if ( boost::filesystem::is_directory ( itr->status() ) ) {
             child_directories_.push_back ( item_filepath_ );
         }
-    }//end directory iterator (_parent_changed, child_directories)
+    }//end directory iterator (imports, child_directories)
 
-    if ( parent_changed_ ) {
-        if ( container_type_ == DIDL_PARSE_TYPES::music_album ||
-                container_type_ == DIDL_PARSE_TYPES::multidisc ) {
-            SquawkServer::instance()->dao()->save ( didl::DidlContainerAlbum ( album_.id(), album_.parentId(), album_.title(), album_.path(),
-                                                    album_.mtime(), album_.objectUdpateId(), album_.childCount(),
-                                                    album_.rating(), album_.year(), album_.playbackCount(),
-                                                    album_.contributor(), album_.artist(), album_.genre(),
-                                                    albumArtUri_, false ) );
+    //the directory is saved when the writer has written all imports.
+    const size_t children_ = child_directories_.size();
+    writes.push ( Write { directory_, [directory_, imports_, children_]() {
+        directory_->listed = true;
+        directory_->imports = imports_;
+        directory_->children = children_;
+    } } );
 
-        } else if ( container_type_ == DIDL_PARSE_TYPES::photo_album ) {
-            SquawkServer::instance()->dao()->save ( photo_album_ );
+    //continue with children
+    size_t index_ = 0;
 
-        } else {
-            SquawkServer::instance()->dao()->save ( container_ );
+    for ( auto s : child_directories_ ) {
+        _walk ( directory_, s, index_++, imports, writes );
+    }
+}
+
+void UpnpContentDirectoryParser::_work ( import_queue & imports, write_queue & writes ) {
+    Import import_;
+
+    while ( imports.pop ( import_ ) ) {
+        const directory_ptr directory_ = import_.directory;
+        const didl::DidlItem item_ = import_.item;
+        const size_t index_ = import_.index;
+        std::function< void() > write_;
+
+        try {
+            if ( item_.cls() == didl::objectItemAudioItemMusicTrack ) {
+                const commons::media::MediaFile media_file_ = commons::media::MediaParser::parseFile ( item_.path() );
+                write_ = [this, directory_, item_, media_file_, index_]() {
+                    _album ( directory_, _import_track ( item_, media_file_ ), index_ );
+                };
+
+            } else if ( item_.cls() == didl::objectItemImageItemPhoto ) {
+                const didl::DidlPhoto photo_ = _import_photo ( item_ );
+                const bool cover_ = _cover ( item_.title() );
+
+                if ( cover_ ) {
+                    std::stringstream cover_stream_;
+                    cover_stream_ << SquawkServer::instance()->config()->tmpDirectory() << "/AlbumArtUri/" << item_.parentId() << ".jpg";
+                    image::Image image ( item_.path() );
+                    image.scale ( 160, 160, cover_stream_.str() );
+                }
+
+                write_ = [this, directory_, photo_, cover_]() {
+                    SquawkServer::instance()->dao()->save ( photo_ );
+                    _photo_album ( directory_, cover_ );
+                };
+
+            } else if ( item_.cls() == didl::objectItemVideoItemMovie ) {
+                const didl::DidlMovie movie_ = _import_movie ( item_ );
+                write_ = [movie_]() {
+                    SquawkServer::instance()->dao()->save ( movie_ );
+                };
+
+            } else if ( item_.cls() == didl::objectItemEBook ) {
+                const didl::DidlEBook ebook_ = _import_ebook ( item_ );
+                write_ = [ebook_]() {
+                    SquawkServer::instance()->dao()->save ( ebook_ );
+                };
+            }
+
+        } catch ( std::exception & e ) {
+            CLOG(ERROR, "upnp") << "can not import:" << item_.path() << ", " << e.what();
         }
+
+        //count the file also when it failed, the directory is saved after the last file.
+        writes.push ( Write { directory_, [directory_, write_]() {
+            ++directory_->imported;
+
+            if ( write_ ) {
+                write_();
+            }
+        } } );
     }
+}
 
-    //continue with children
-    bool is_multidisc_ = false;
+void UpnpContentDirectoryParser::_write ( write_queue & writes ) {
+    Write write_;
 
-    for ( auto s : child_directories_ ) {
-        DIDL_PARSE_TYPES child_type = _parse ( container_, s );
+    while ( writes.pop ( write_ ) ) {
+        try {
+            write_.write();
+
+        } catch ( std::exception & e ) {
+            CLOG(ERROR, "upnp") << "can not save:" << write_.directory->container.path() << ", " << e.what();
+        }
+
+        try {
+            _finish ( write_.directory );
+
+        } catch ( std::exception & e ) {
+            CLOG(ERROR, "upnp") << "can not save directory:" << write_.directory->container.path() << ", " << e.what();
+        }
+    }
+}
+
+void UpnpContentDirectoryParser::_finish ( directory_ptr directory ) {
+    if ( ! directory->saved ) {
+        if ( ! directory->listed || directory->imported < directory->imports ) {
+            return;
+        }
+
+        //the parent is saved first and the siblings in listing order, a multidisc folder turns its parent into an album.
+        if ( ! directory->parent->saved || directory->parent->saved_children != directory->index ) {
+            directory->parent->waiting[ directory->index ] = directory;
+            return;
+        }
+
+        directory->saved = true;
+        ++directory->parent->saved_children;
+        _save_container ( directory );
+
+        _release ( directory );
+        _release ( directory->parent );
+    }
+
+    if ( directory->listed && ! directory->complete && directory->finished == directory->children ) {
+        directory->complete = true;
+        _save_multidisc ( directory );
+
+        if ( directory->parent ) {
+            if ( directory->type == DIDL_PARSE_TYPES::multidisc ) {
+                directory->parent->multidisc_children = true;
+            }
+
+            ++directory->parent->finished;
+            _finish ( directory->parent );
+        }
+    }
+}
+
+void UpnpContentDirectoryParser::_release ( directory_ptr directory ) {
+    //the loop of the outer call saves the siblings.
+    if ( directory->releasing ) {
+        return;
+    }
+
+    directory->releasing = true;
+
+    while ( ! directory->waiting.empty() && directory->waiting.begin()->first == directory->saved_children ) {
+        directory_ptr child_ = directory->waiting.begin()->second;
+        directory->waiting.erase ( directory->waiting.begin() );
 
-        if ( child_type == DIDL_PARSE_TYPES::multidisc ) {
-            is_multidisc_ = true;
+        try {
+            _finish ( child_ );
+
+        } catch ( std::exception & e ) {
+            CLOG(ERROR, "upnp") << "can not save directory:" << child_->container.path() << ", " << e.what();
         }
     }
 
-    if ( is_multidisc_ && parent_changed_ ) {
-        didl::DidlContainerAlbum album__ = SquawkServer::instance()->dao()->object<didl::DidlContainerAlbum> ( container_.id() );
+    directory->releasing = false;
+}
+
+void UpnpContentDirectoryParser::_album ( directory_ptr directory, const didl::DidlMusicTrack & track, const size_t index ) {
+    directory->parent_changed = true;
+
+    //the last track of the listing names the album, like a sequential import.
+    if ( index + 1 < directory->album_track ) {
+        return;
+    }
+
+    directory->album_track = index + 1;
+
+    if ( ! directory->multidisc ) {
+        directory->type = DIDL_PARSE_TYPES::music_album;
+        directory->album = didl::DidlContainerAlbum (
+                               directory->container.id(), directory->container.parentId(), track.album(),
+                               directory->container.path(), directory->container.mtime(), 0, 0, 0,
+                               track.year(), 0, track.contributor(), track.artist(),
+                               track.genre(), std::list< didl::DidlAlbumArtUri >(), false );
+
+    } else {
+        //the folder is a disc, the parent becomes the album.
+        directory->type = DIDL_PARSE_TYPES::multidisc;
+        const didl::DidlContainer & multidisc_container_ = directory->parent->container;
+        directory->album = didl::DidlContainerAlbum ( multidisc_container_.id(), multidisc_container_.parentId(), track.album(),
+                           multidisc_container_.path(), multidisc_container_.mtime(), 0, 0, 0,
+                           track.year(), 0, track.contributor(), track.artist(),
+                           track.genre(), std::list< didl::DidlAlbumArtUri >(), false );
+    }
+}
+
+void UpnpContentDirectoryParser::_photo_album ( directory_ptr directory, const bool cover ) {
+    if ( directory->type == DIDL_PARSE_TYPES::container ) {
+        directory->parent_changed = true;
+        directory->type = DIDL_PARSE_TYPES::photo_album;
+        directory->photo_album = didl::DidlContainerPhotoAlbum ( directory->container.id(), directory->container.parentId(), directory->stem,
+                                 directory->container.path(), directory->container.mtime(), directory->container.objectUdpateId(),
+                                 0, 0, 0 /*aear*/, 0, "", "", "", std::list< didl::DidlAlbumArtUri >(), false );
+    }
+
+    if ( cover ) {
+        directory->albumArtUri.push_back (
+            didl::DidlAlbumArtUri ( 0, 0,
+                                    SquawkServer::instance()->config()->tmpDirectory() + "/AlbumArtUri/" + std::to_string ( directory->container.id() ) + ".jpg", "URI", "JPEG_TN" ) );
+    }
+}
+
+void UpnpContentDirectoryParser::_save_container ( directory_ptr directory ) {
+    if ( directory->parent_changed ) {
+        if ( directory->type == DIDL_PARSE_TYPES::music_album ||
+                directory->type == DIDL_PARSE_TYPES::multidisc ) {
+            const didl::DidlContainerAlbum & album_ = directory->album;
+            SquawkServer::instance()->dao()->save ( didl::DidlContainerAlbum ( album_.id(), album_.parentId(), album_.title(), album_.path(),
+                                                    album_.mtime(), album_.objectUdpateId(), album_.childCount(),
+                                                    album_.rating(), album_.year(), album_.playbackCount(),
+                                                    album_.contributor(), album_.artist(), album_.genre(),
+                                                    directory->albumArtUri, false ) );
+
+        } else if ( directory->type == DIDL_PARSE_TYPES::photo_album ) {
+            SquawkServer::instance()->dao()->save ( directory->photo_album );
+
+        } else {
+            SquawkServer::instance()->dao()->save ( directory->container );
+        }
+    }
+}
+
+void UpnpContentDirectoryParser::_save_multidisc ( directory_ptr directory ) {
+    if ( directory->multidisc_children && directory->parent_changed ) {
+        didl::DidlContainerAlbum album__ = SquawkServer::instance()->dao()->object<didl::DidlContainerAlbum> ( directory->container.id() );
         SquawkServer::instance()->dao()->save ( didl::DidlContainerAlbum ( album__.id(), album__.parentId(), album__.title(), album__.path(),
                                                 album__.mtime(), album__.objectUdpateId(), album__.childCount(),
                                                 album__.rating(), album__.year(), album__.playbackCount(),
                                                 album__.contributor(), album__.artist(), album__.genre(),
-                                                albumArtUri_, false ) );
-        std::list<didl::DidlContainerPhotoAlbum> photo_album__ = SquawkServer::instance()->dao()->children<didl::DidlContainerPhotoAlbum> ( container_.id(), 0, 0 );
+                                                directory->albumArtUri, false ) );
+        std::list<didl::DidlContainerPhotoAlbum> photo_album__ = SquawkServer::instance()->dao()->children<didl::DidlContainerPhotoAlbum> ( directory->container.id(), 0, 0 );
 
         for ( auto photo : photo_album__ ) {
             SquawkServer::instance()->dao()->save ( didl::DidlContainer ( photo.id(), photo.parentId(), photo.title(), photo.path(),
@@ -456,8 +624,6 @@ UpnpContentDirectoryParser::DIDL_PARSE_TYPES UpnpContentDirectoryParser::_parse
 
         }
     }
-
-    return container_type_;
 }
 
 std::string UpnpContentDirectoryParser::_clean_name ( const std::string & name ) {
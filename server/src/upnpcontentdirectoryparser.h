@@ -1,14 +1,35 @@
 #ifndef UPNPCONTENTDIRECTORYPARSER_H
 #define UPNPCONTENTDIRECTORYPARSER_H
 
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+
 #include "re2/re2.h"
 
 #include "squawk.h"
 #include "squawkserver.h"
 #include "upnpcontentdirectory.h"
+#include "utils/boundedqueue.h"
+
+namespace commons {
+namespace media {
+class MediaFile;
+}
+}
 
 namespace squawk {
 
+/**
+ * @brief Import the media directories in the content directory.
+ *
+ * <p>The import is a pipeline of three stages connected by bounded queues. The calling thread walks
+ * the directories, saves the containers and touches the files. The new and changed files are probed
+ * by the workers (ffmpeg, Imlib2 and Poppler), one per core unless configured. A single writer thread
+ * saves the items, resolves the artists and, when all files and the parent of a directory are written,
+ * turns the directory into an album, a photo album or the disc of a multidisc album.</p>
+ */
 class UpnpContentDirectoryParser {
 public:
     UpnpContentDirectoryParser();
@@ -36,18 +57,85 @@ private:
 
     enum DIDL_PARSE_TYPES { container, music_album, multidisc, photo_album };
 
+    struct Directory;
+    typedef std::shared_ptr< Directory > directory_ptr;
+
+    /* the state of a directory in the import. the walker creates the directory, the other fields are owned by the writer. */
+    struct Directory {
+        Directory ( directory_ptr parent, const didl::DidlContainer & container, const std::string & stem, const size_t index ) :
+            parent ( parent ), container ( container ), stem ( stem ), multidisc ( _parse_multidisc ( stem ) ), index ( index ) {}
+
+        const directory_ptr parent;
+        const didl::DidlContainer container;
+        const std::string stem;
+        const bool multidisc;
+        /* the position in the directory listing of the parent */
+        const size_t index;
+
+        /* the listing is done, the number of files sent to the workers and the number written. */
+        bool listed = false;
+        size_t imports = 0;
+        size_t imported = 0;
+        /* the child directories and the children with a saved subtree */
+        size_t children = 0;
+        size_t finished = 0;
+        /* the container is saved */
+        bool saved = false;
+        /* the container and the subtree are saved */
+        bool complete = false;
+        /* children waiting for this container or their preceding siblings, by listing position */
+        std::map< size_t, directory_ptr > waiting;
+        /* the number of children saved, the children are saved in listing order. */
+        size_t saved_children = 0;
+        bool releasing = false;
+
+        bool parent_changed = false;
+        DIDL_PARSE_TYPES type = DIDL_PARSE_TYPES::container;
+        didl::DidlContainerAlbum album;
+        /* the listing position + 1 of the track which named the album */
+        size_t album_track = 0;
+        didl::DidlContainerPhotoAlbum photo_album;
+        std::list< didl::DidlAlbumArtUri > albumArtUri;
+        bool multidisc_children = false;
+    };
+
+    /* a file for the workers, index is the position in the directory listing. */
+    struct Import {
+        directory_ptr directory;
+        didl::DidlItem item;
+        size_t index;
+    };
+    /* a write of the writer stage in the directory. */
+    struct Write {
+        directory_ptr directory;
+        std::function< void() > write;
+    };
+    typedef commons::concurrent::BoundedQueue< Import > import_queue;
+    typedef commons::concurrent::BoundedQueue< Write > write_queue;
+
+    /* the capacity of the queues between the stages */
+    static const size_t QUEUE_SIZE = 256;
+
+    void _walk ( directory_ptr parent, const std::string & path, const size_t index, import_queue & imports, write_queue & writes );
+    void _work ( import_queue & imports, write_queue & writes );
+    void _write ( write_queue & writes );
+    void _finish ( directory_ptr directory );
+    /* save the waiting children which are next in listing order. */
+    void _release ( directory_ptr directory );
+    void _save_container ( directory_ptr directory );
+    void _save_multidisc ( directory_ptr directory );
 
-    DIDL_PARSE_TYPES _parse( didl::DidlContainer & parent, const std::string & path );
     void _import_audio ( const didl::DidlObject obje );
     void _import_movies ( const didl::DidlObject object );
     void _import_images ( const didl::DidlObject object );
     void _import_books ();
 
-
-    didl::DidlMusicTrack _import_track ( const didl::DidlItem & track );
-    void _import_photo( const didl::DidlItem & photo );
-    void _import_movie( const didl::DidlItem & movie );
-    void _import_ebook( const didl::DidlItem & ebook );
+    didl::DidlMusicTrack _import_track ( const didl::DidlItem & track, const commons::media::MediaFile & media_file );
+    void _album ( directory_ptr directory, const didl::DidlMusicTrack & track, const size_t index );
+    didl::DidlPhoto _import_photo( const didl::DidlItem & photo );
+    void _photo_album ( directory_ptr directory, const bool cover );
+    didl::DidlMovie _import_movie( const didl::DidlItem & movie );
+    didl::DidlEBook _import_ebook( const didl::DidlItem & ebook );
 
     FRIEND_TEST( UpnpContentDirectoryParserTest, ParseSeries );
     static bool _parse_series( const std::string & filename, int * season, int * episode, std::string * name ) {
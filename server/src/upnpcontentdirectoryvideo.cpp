@@ -39,40 +39,29 @@ std::tuple<size_t, size_t> UpnpContentDirectoryVideo::parseNode ( didl::DidlXmlW
 
     auto dao = SquawkServer::instance()->dao();
     if ( ContentDirectoryModule::matchObjectId ( request, "/movies/" ) ) {
-        std::list< didl::DidlMovie > item_list =
-            dao->objects< didl::DidlMovie > ( start_index_, request_count_ );
+        returned_ = dao->visitObjects< didl::DidlMovie > ( start_index_, request_count_, [&] ( didl::DidlMovie & item ) {
+            didl_element->write ( "/movies/{}", "/movies/{}", http_uri ( "resource/{0}.{1}" ), item );
+        }, std::map< std::string, std::string >(),
+        UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
 
-        for ( auto & item : item_list ) {
-            didl_element->write ( "/movies/{}", "/movies/{}", http_uri ( "resource/{0}.{1}" ), dao->object<didl::DidlMovie> ( item.id() ) );
-        }
-
-        returned_ = item_list.size();
         total = dao->objectsCount ( didl::objectItemVideoItemMovie );
 
     } else if ( ContentDirectoryModule::matchObjectId ( request, "/series/" ) ) {
         if ( request->getValue ( "ObjectID" ) == "/series" || request->getValue ( "ObjectID" ) == "/series/" ) {
-            std::list< didl::DidlContainer > item_list =
-                dao->series ( start_index_, request_count_ );
-
-            for ( auto & item : item_list ) {
+            returned_ = dao->visitSeries ( start_index_, request_count_, [&] ( didl::DidlContainer & item ) {
                 didl_element->container ( "/series/" + item.title(), "/series/", item );
-            }
+            } );
 
-            returned_ = item_list.size();
             total = dao->seriesCount ();
 
         } else {
             std::string name_ = request->getValue ( "ObjectID" ).substr ( request->getValue ( "ObjectID" ).rfind ( '/' ) + 1 );
 
-            std::list< didl::DidlMovie > item_list =
-                dao->objects< didl::DidlMovie > (
-                            start_index_, request_count_, std::map<std::string, std::string> ( { { "series_title", name_ } } ) );
-
-            for ( auto & item : item_list ) {
+            returned_ = dao->visitObjects< didl::DidlMovie > ( start_index_, request_count_, [&] ( didl::DidlMovie & item ) {
                 didl_element->write ( "/movies/{}", "/movies/{}", http_uri ( "resource/{0}.{1}" ), item );
-            }
+            }, std::map<std::string, std::string> ( { { "series_title", name_ } } ),
+            UpnpContentDirectoryDao::sortCriteria ( request->getValue ( upnp::SORT_CRITERIA ), std::make_pair ( "title", "asc" ) ) );
 
-            returned_ = item_list.size();
             total = dao->seriesCount ( std::map<std::string, std::string> ( { { "series_title", name_ } } ) );
         }
     }
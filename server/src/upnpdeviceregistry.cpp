@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2016  <etienne> <etienne.knecht@hotmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "upnpdeviceregistry.h"
+
+namespace squawk {
+
+const time_t UpnpDeviceRegistry::DEFAULT_TIMEOUT = 1800;
+
+UpnpDeviceRegistry::UpnpDeviceRegistry ( const time_t now ) :
+    _wheel ( now ), _snapshot ( std::make_shared< const device_map_t >() ) {}
+
+bool UpnpDeviceRegistry::touch ( const std::string & usn, const time_t cache_control, const time_t now ) {
+    std::lock_guard< std::mutex > _guard ( _mutex );
+
+    auto iter_ = _devices.find ( usn );
+
+    if ( iter_ == _devices.end() ) {
+        return false;
+    }
+
+    if ( cache_control > 0 ) {
+        iter_->second.timeout = cache_control;
+    }
+
+    //the timer is re-armed when it fires before the new deadline.
+    iter_->second.deadline = now + iter_->second.timeout;
+    iter_->second.device.touch();
+    iter_->second.device.timeout ( iter_->second.timeout );
+    _touched = true;
+    return true;
+}
+
+void UpnpDeviceRegistry::insert ( const std::string & usn, const upnp::UpnpDevice & device, const time_t cache_control, const time_t now ) {
+    std::lock_guard< std::mutex > _guard ( _mutex );
+
+    const time_t timeout_ = ( cache_control > 0 ? cache_control : DEFAULT_TIMEOUT );
+    DeviceEntry entry_ { device, ++_generation, timeout_, now + timeout_ };
+    entry_.device.touch();
+    entry_.device.timeout ( timeout_ );
+
+    //a replaced device leaves a stale timer, it is dropped by the generation check.
+    _devices[ usn ] = entry_;
+    _wheel.schedule ( timer_key_t ( usn, entry_.generation ), entry_.deadline );
+    _publish();
+}
+
+bool UpnpDeviceRegistry::erase ( const std::string & usn ) {
+    std::lock_guard< std::mutex > _guard ( _mutex );
+
+    if ( _devices.erase ( usn ) > 0 ) {
+        _publish();
+        return true;
+
+    } else { return false; }
+}
+
+std::list< upnp::UpnpDevice > UpnpDeviceRegistry::expire ( const time_t now ) {
+    std::lock_guard< std::mutex > _guard ( _mutex );
+
+    std::list< upnp::UpnpDevice > expired_;
+    _wheel.advance ( now, [this, &expired_] ( const timer_key_t & key, const uint64_t tick ) -> uint64_t {
+        auto iter_ = _devices.find ( key.first );
+
+        if ( iter_ == _devices.end() || iter_->second.generation != key.second ) {
+            return 0; //removed or replaced
+
+        } else if ( static_cast< uint64_t > ( iter_->second.deadline ) > tick ) {
+            return iter_->second.deadline; //touched since scheduled
+
+        } else {
+            expired_.push_back ( iter_->second.device );
+            _devices.erase ( iter_ );
+            return 0;
+        }
+    } );
+
+    if ( ! expired_.empty() || _touched ) {
+        _publish();
+    }
+
+    return expired_;
+}
+
+UpnpDeviceRegistry::device_map_ptr UpnpDeviceRegistry::snapshot() const {
+    return std::atomic_load ( &_snapshot );
+}
+
+size_t UpnpDeviceRegistry::size() const {
+    std::lock_guard< std::mutex > _guard ( _mutex );
+    return _devices.size();
+}
+
+void UpnpDeviceRegistry::_publish() {
+    auto snapshot_ = std::make_shared< device_map_t >();
+
+    for ( auto & entry : _devices ) {
+        snapshot_->insert ( std::make_pair ( entry.first, entry.second.device ) );
+    }
+
+    std::atomic_store ( &_snapshot, device_map_ptr ( snapshot_ ) );
+    _touched = false;
+}
+}//namespace squawk
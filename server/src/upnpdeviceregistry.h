@@ -0,0 +1,125 @@
+/*
+    Copyright (C) 2016  <etienne> <etienne.knecht@hotmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#ifndef UPNPDEVICEREGISTRY_H
+#define UPNPDEVICEREGISTRY_H
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "upnp.h"
+#include "utils/timerwheel.h"
+
+namespace squawk {
+
+/**
+ * @brief Registry of the UPNP devices discovered over SSDP.
+ *
+ * <p>The devices expire after the cache control time of the last announcement. The expiry is
+ * driven by a timer wheel, re-announcements only update the deadline of the device (O(1)). The
+ * timer is re-armed lazily when it fires before the actual deadline.</p>
+ *
+ * <p>Readers get an immutable snapshot of the devices. The snapshot is replaced when devices are
+ * added or removed, readers holding the old snapshot are not affected. The re-announcements are
+ * copied to the snapshot by the next expire.</p>
+ */
+class UpnpDeviceRegistry {
+public:
+    typedef std::map< std::string, upnp::UpnpDevice > device_map_t;
+    typedef std::shared_ptr< const device_map_t > device_map_ptr;
+
+    explicit UpnpDeviceRegistry ( const time_t now = clock() );
+
+    UpnpDeviceRegistry ( const UpnpDeviceRegistry& ) = delete;
+    UpnpDeviceRegistry ( UpnpDeviceRegistry&& ) = delete;
+    UpnpDeviceRegistry& operator= ( const UpnpDeviceRegistry& ) = delete;
+    UpnpDeviceRegistry& operator= ( UpnpDeviceRegistry&& ) = delete;
+    ~UpnpDeviceRegistry() {}
+
+    /**
+     * @brief re-announcement of a known device.
+     * @param usn the root device usn.
+     * @param cache_control the cache control of the announcement, 0 keeps the actual timeout.
+     * @param now the actual time.
+     * @return true when the device is registered.
+     */
+    bool touch ( const std::string & usn, const time_t cache_control, const time_t now = clock() );
+    /**
+     * @brief add or replace a device.
+     * @param usn the root device usn.
+     * @param device the device description.
+     * @param cache_control the cache control of the announcement, 0 for the default timeout.
+     * @param now the actual time.
+     */
+    void insert ( const std::string & usn, const upnp::UpnpDevice & device, const time_t cache_control, const time_t now = clock() );
+    /**
+     * @brief remove a device.
+     * @param usn the root device usn.
+     * @return true when the device was registered.
+     */
+    bool erase ( const std::string & usn );
+    /**
+     * @brief remove the expired devices.
+     * @param now the actual time.
+     * @return the expired devices.
+     */
+    std::list< upnp::UpnpDevice > expire ( const time_t now = clock() );
+    /**
+     * @brief get the actual devices.
+     * <p>The snapshot is immutable and can be used without holding a lock.</p>
+     */
+    device_map_ptr snapshot() const;
+    /** @brief number of registered devices. */
+    size_t size() const;
+
+    /** @brief monotonic clock in seconds. */
+    static time_t clock() {
+        return std::chrono::duration_cast< std::chrono::seconds > (
+                   std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+private:
+    /** the default timeout when no cache control is sent. */
+    static const time_t DEFAULT_TIMEOUT;
+
+    typedef std::pair< std::string, uint64_t > timer_key_t;
+
+    struct DeviceEntry {
+        upnp::UpnpDevice device;
+        uint64_t generation;
+        time_t timeout;
+        time_t deadline;
+    };
+
+    mutable std::mutex _mutex;
+    std::unordered_map< std::string, DeviceEntry > _devices;
+    commons::timer::TimerWheel< timer_key_t > _wheel;
+    uint64_t _generation = 0;
+    bool _touched = false; //devices re-announced since the last snapshot
+    device_map_ptr _snapshot;
+
+    /* publish a new snapshot, called with the lock held. */
+    void _publish();
+};
+}//namespace squawk
+#endif // UPNPDEVICEREGISTRY_H
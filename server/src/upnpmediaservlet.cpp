@@ -110,7 +110,8 @@ void UpnpMediaServlet::_process_file ( http::HttpRequest & request, http::HttpRe
 
         if ( type_ == "resource" ) {
             try {
-                db::db_statement_ptr stmt_resource = SquawkServer::instance()->db()->prepareStatement (
+                db::db_connection_ptr db_ = SquawkServer::instance()->db_reader();
+                db::db_statement_ptr stmt_resource = db_->prepareStatement (
                     "select path, mime_type from tbl_cds_resource where ROWID = ?" );
 
                 stmt_resource->bind_int ( 1, std::stoi ( filename_ ) );
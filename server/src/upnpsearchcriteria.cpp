@@ -0,0 +1,392 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <cctype>
+#include <ctime>
+#include <set>
+
+#include <boost/algorithm/string.hpp>
+
+#include "upnpsearchcriteria.h"
+#include "upnpcontentdirectoryparser.h"
+
+namespace squawk {
+
+namespace {
+const std::set< std::string > RELATIONS { "=", "!=", "<", "<=", ">", ">=", "contains", "doesnotcontain", "derivedfrom", "exists" };
+
+inline bool is_operator ( const char c ) {
+    return c == '=' || c == '!' || c == '<' || c == '>';
+}
+inline bool is_space ( const char c ) {
+    return std::isspace ( static_cast< unsigned char > ( c ) );
+}
+/* the year column stores the local time like ContentDirectoryModule::epoch_time, the date is YYYY[-MM[-DD]]. */
+bool epoch_time ( const std::string & date, int64_t & time ) {
+    std::vector< std::string > parts_;
+    const std::string date_ = date.substr ( 0, date.find_first_not_of ( "0123456789-" ) );
+    boost::split ( parts_, date_, boost::is_any_of ( "-" ) );
+
+    if ( parts_.size() > 3 || parts_[0].size() != 4 ) {
+        return false;
+    }
+
+    for ( auto & part : parts_ ) {
+        if ( part.empty() || part.size() > 4 || part.find_first_not_of ( "0123456789" ) != std::string::npos ) {
+            return false;
+        }
+    }
+
+    struct tm st_date_ = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    st_date_.tm_year = std::stoi ( parts_[0] ) - 1900;
+    st_date_.tm_mon = ( parts_.size() > 1 ? std::stoi ( parts_[1] ) - 1 : 0 );
+    st_date_.tm_mday = ( parts_.size() > 2 ? std::stoi ( parts_[2] ) : 1 );
+    time = mktime ( &st_date_ );
+    return true;
+}
+}
+
+const int UpnpSearchCriteria::INVALID_CRITERIA;
+
+const std::map< std::string, UpnpSearchCriteria::Property > UpnpSearchCriteria::PROPERTIES {
+    { "dc:title", { "title", true, false, false } },
+    { "dc:creator", { "artist", true, false, true } },
+    { "upnp:artist", { "artist", true, false, true } },
+    { "upnp:album", { "album", true, false, false } },
+    { "upnp:genre", { "genre", true, false, false } },
+    { "upnp:author", { "author", true, false, false } },
+    { "dc:publisher", { "publisher", true, false, false } },
+    { "dc:date", { "year", false, true, false } },
+    { "upnp:originalTrackNumber", { "track", false, true, false } },
+    { "@id", { "ROWID", false, true, false } },
+    { "@parentID", { "parent_id", false, true, false } }
+};
+
+UpnpSearchCriteria::UpnpSearchCriteria ( const std::string & criteria ) {
+    const std::string criteria_ = boost::algorithm::trim_copy ( criteria );
+
+    if ( criteria_.empty() || criteria_ == "*" ) {
+        return;
+    }
+
+    std::vector< Token > tokens_ = _tokens ( criteria_ );
+    size_t pos_ = 0;
+    _expression = _or ( tokens_, pos_ );
+
+    if ( pos_ != tokens_.size() ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "unexpected token in search criteria: " + tokens_[pos_].text );
+    }
+}
+
+void UpnpSearchCriteria::where ( db::Sqlite3QueryBuilder & query ) const {
+    query << "( ";
+
+    if ( _expression ) {
+        _where ( query, *_expression );
+
+    } else { query << "1"; }
+
+    query << " )";
+}
+
+std::string UpnpSearchCriteria::capabilities() {
+    std::vector< std::string > properties_ { "upnp:class" };
+
+    for ( auto & property : PROPERTIES ) {
+        properties_.push_back ( property.first );
+    }
+
+    return boost::algorithm::join ( properties_, "," );
+}
+
+std::vector< UpnpSearchCriteria::Token > UpnpSearchCriteria::_tokens ( const std::string & criteria ) {
+    std::vector< Token > tokens_;
+    size_t pos_ = 0;
+
+    while ( pos_ < criteria.size() ) {
+        const char c_ = criteria[pos_];
+
+        if ( is_space ( c_ ) ) {
+            ++pos_;
+
+        } else if ( c_ == '(' || c_ == ')' ) {
+            tokens_.push_back ( Token { false, std::string ( 1, c_ ) } );
+            ++pos_;
+
+        } else if ( c_ == '"' ) {
+            std::string value_;
+            bool closed_ = false;
+
+            for ( ++pos_; pos_ < criteria.size() && ! closed_; ++pos_ ) {
+                if ( criteria[pos_] == '\\' && pos_ + 1 < criteria.size() ) {
+                    value_ += criteria[++pos_];
+
+                } else if ( criteria[pos_] == '"' ) {
+                    closed_ = true;
+
+                } else { value_ += criteria[pos_]; }
+            }
+
+            if ( ! closed_ ) {
+                throw upnp::UpnpException ( INVALID_CRITERIA, "unterminated string in search criteria: " + criteria );
+            }
+
+            tokens_.push_back ( Token { true, value_ } );
+
+        } else {
+            //a property or keyword, the relational operators are split from the property.
+            const bool operator_ = is_operator ( c_ );
+            size_t end_ = pos_;
+
+            while ( end_ < criteria.size() && ! is_space ( criteria[end_] ) && criteria[end_] != '(' &&
+                    criteria[end_] != ')' && criteria[end_] != '"' && is_operator ( criteria[end_] ) == operator_ ) {
+                ++end_;
+            }
+
+            tokens_.push_back ( Token { false, criteria.substr ( pos_, end_ - pos_ ) } );
+            pos_ = end_;
+        }
+    }
+
+    return tokens_;
+}
+
+std::shared_ptr< UpnpSearchCriteria::Expression > UpnpSearchCriteria::_or ( const std::vector< Token > & tokens, size_t & pos ) {
+    std::shared_ptr< Expression > left_ = _and ( tokens, pos );
+
+    while ( pos < tokens.size() && ! tokens[pos].quoted && boost::algorithm::iequals ( tokens[pos].text, "or" ) ) {
+        ++pos;
+        left_ = std::make_shared< Expression > ( Expression { "or", "", "", left_, _and ( tokens, pos ) } );
+    }
+
+    return left_;
+}
+
+std::shared_ptr< UpnpSearchCriteria::Expression > UpnpSearchCriteria::_and ( const std::vector< Token > & tokens, size_t & pos ) {
+    std::shared_ptr< Expression > left_ = _relation ( tokens, pos );
+
+    while ( pos < tokens.size() && ! tokens[pos].quoted && boost::algorithm::iequals ( tokens[pos].text, "and" ) ) {
+        ++pos;
+        left_ = std::make_shared< Expression > ( Expression { "and", "", "", left_, _relation ( tokens, pos ) } );
+    }
+
+    return left_;
+}
+
+std::shared_ptr< UpnpSearchCriteria::Expression > UpnpSearchCriteria::_relation ( const std::vector< Token > & tokens, size_t & pos ) {
+    if ( pos >= tokens.size() ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "unexpected end of search criteria." );
+    }
+
+    if ( ! tokens[pos].quoted && tokens[pos].text == "(" ) {
+        std::shared_ptr< Expression > expression_ = _or ( tokens, ++pos );
+
+        if ( pos >= tokens.size() || tokens[pos].quoted || tokens[pos].text != ")" ) {
+            throw upnp::UpnpException ( INVALID_CRITERIA, "missing closing parenthesis in search criteria." );
+        }
+
+        ++pos;
+        return expression_;
+    }
+
+    if ( pos + 3 > tokens.size() ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "incomplete relation in search criteria: " + tokens[pos].text );
+    }
+
+    const Token & property_ = tokens[pos++];
+    const Token & operator_ = tokens[pos++];
+    const Token & value_ = tokens[pos++];
+    const std::string op_ = boost::algorithm::to_lower_copy ( operator_.text );
+
+    if ( property_.quoted || property_.text == "(" || property_.text == ")" ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "invalid property in search criteria: " + property_.text );
+    }
+
+    if ( operator_.quoted || RELATIONS.find ( op_ ) == RELATIONS.end() ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "invalid operator in search criteria: " + operator_.text );
+    }
+
+    if ( op_ == "exists" ) {
+        const std::string bool_ = boost::algorithm::to_lower_copy ( value_.text );
+
+        if ( value_.quoted || ( bool_ != "true" && bool_ != "false" ) ) {
+            throw upnp::UpnpException ( INVALID_CRITERIA, "invalid value for exists in search criteria: " + value_.text );
+        }
+
+        return std::make_shared< Expression > ( Expression { op_, property_.text, bool_, nullptr, nullptr } );
+    }
+
+    if ( ! value_.quoted ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "value is not quoted in search criteria: " + value_.text );
+    }
+
+    return std::make_shared< Expression > ( Expression { op_, property_.text, value_.text, nullptr, nullptr } );
+}
+
+void UpnpSearchCriteria::_where ( db::Sqlite3QueryBuilder & query, const Expression & expression ) {
+    if ( expression.op == "and" || expression.op == "or" ) {
+        query << "( ";
+        _where ( query, *expression.left );
+        query << " " << expression.op << " ";
+        _where ( query, *expression.right );
+        query << " )";
+
+    } else if ( expression.property == "upnp:class" ) {
+        _class ( query, expression );
+
+    } else {
+        auto property_ = PROPERTIES.find ( expression.property );
+
+        if ( property_ != PROPERTIES.end() ) {
+            _property ( query, expression, property_->second );
+
+        } else if ( expression.op == "exists" ) {
+            query << ( expression.value == "false" ? "1" : "0" );
+
+        } else { query << ( expression.op == "!=" || expression.op == "doesnotcontain" ? "1" : "0" ); }
+    }
+}
+
+void UpnpSearchCriteria::_class ( db::Sqlite3QueryBuilder & query, const Expression & expression ) {
+    if ( expression.op == "exists" ) {
+        query << ( expression.value == "true" ? "1" : "0" );
+        return;
+    }
+
+    std::vector< std::string > classes_;
+
+    for ( size_t i = 0; i < didl::DIDL_CLASS_NAMES.size(); ++i ) {
+        const std::string & name_ = didl::DIDL_CLASS_NAMES[i];
+        bool match_;
+
+        if ( expression.op == "derivedfrom" ) {
+            match_ = ( name_ == expression.value || boost::algorithm::starts_with ( name_, expression.value + "." ) );
+
+        } else if ( expression.op == "=" || expression.op == "!=" ) {
+            match_ = ( name_ == expression.value );
+
+        } else if ( expression.op == "contains" || expression.op == "doesnotcontain" ) {
+            match_ = ( name_.find ( expression.value ) != std::string::npos );
+
+        } else {
+            throw upnp::UpnpException ( INVALID_CRITERIA, "operator not supported for upnp:class: " + expression.op );
+        }
+
+        if ( match_ ) {
+            classes_.push_back ( std::to_string ( i ) );
+        }
+    }
+
+    const bool negate_ = ( expression.op == "!=" || expression.op == "doesnotcontain" );
+
+    if ( classes_.empty() ) {
+        query << ( negate_ ? "1" : "0" );
+
+    } else {
+        query << "cls " << ( negate_ ? "not in" : "in" ) << " ( " << boost::algorithm::join ( classes_, ", " ) << " )";
+    }
+}
+
+void UpnpSearchCriteria::_property ( db::Sqlite3QueryBuilder & query, const Expression & expression, const Property & property ) {
+    const std::string value_ = ( property.clean_name ? UpnpContentDirectoryParser::_clean_name ( expression.value ) : expression.value );
+
+    if ( expression.op == "exists" ) {
+        query << ( expression.value == "true" ? "( " : "not ( " );
+        query.column ( property.column );
+
+        if ( property.integer ) {
+            query << " is not null )";
+
+        } else {
+            query << " is not null and ";
+            query.column ( property.column );
+            query << " != '' )";
+        }
+
+    } else if ( expression.op == "contains" || expression.op == "doesnotcontain" ) {
+        const bool negate_ = ( expression.op == "doesnotcontain" );
+
+        if ( property.fts ) {
+            const std::string match_ = _match ( property.column, value_ );
+
+            if ( match_.empty() ) {
+                query << ( negate_ ? "0" : "1" );
+                return;
+            }
+
+            query << "ROWID " << ( negate_ ? "not in" : "in" ) << " ( select rowid from tbl_cds_search where tbl_cds_search match ";
+            query.value ( match_ );
+            query << " )";
+
+        } else {
+            query << "ifnull( instr( lower( ";
+            query.column ( property.column );
+            query << " ), lower( ";
+            query.value ( value_ );
+            query << " ) ), 0 ) " << ( negate_ ? "= 0" : "> 0" );
+        }
+
+    } else if ( expression.op == "derivedfrom" ) {
+        throw upnp::UpnpException ( INVALID_CRITERIA, "derivedfrom is only supported for upnp:class: " + expression.property );
+
+    } else {
+        query.column ( property.column );
+        query << " " << expression.op << " ";
+
+        int64_t time_ = 0;
+
+        if ( property.column == "year" ) {
+            if ( epoch_time ( value_, time_ ) ) {
+                query.value ( time_ );
+
+            } else { query.value ( value_ ); } //a text is never equal to a number.
+
+        } else if ( property.integer ) {
+            //the object ids are paths ending with the number.
+            const std::string number_ = ( property.column == "ROWID" || property.column == "parent_id" ?
+                                          value_.substr ( value_.rfind ( '/' ) + 1 ) :
+                                          value_.substr ( 0, value_.find_first_not_of ( "0123456789" ) ) );
+
+            if ( ! number_.empty() && number_.size() < 19 && number_.find_first_not_of ( "0123456789" ) == std::string::npos ) {
+                query.value ( std::stoll ( number_ ) );
+
+            } else { query.value ( value_ ); } //a text is never equal to a number.
+
+        } else {
+            query.value ( value_ );
+            query << " collate nocase";
+        }
+    }
+}
+
+std::string UpnpSearchCriteria::_match ( const std::string & column, const std::string & text ) {
+    std::vector< std::string > words_;
+    boost::split ( words_, text, boost::is_any_of ( " \t\r\n" ), boost::token_compress_on );
+    std::string match_;
+
+    for ( auto & word : words_ ) {
+        const std::string word_ = boost::algorithm::erase_all_copy ( word, "\"" );
+
+        if ( word_.empty() ) { continue; }
+
+        if ( ! match_.empty() ) { match_ += " "; }
+
+        match_ += "\"" + word_ + "\"*";
+    }
+
+    return ( match_.empty() ? match_ : column + " : ( " + match_ + " )" );
+}
+}//namespace squawk
@@ -0,0 +1,95 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#ifndef UPNPSEARCHCRITERIA_H
+#define UPNPSEARCHCRITERIA_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/sqlite3querybuilder.h"
+
+namespace squawk {
+
+/**
+ * \brief The SearchCriteria of the ContentDirectory Search action.
+ *
+ * <p>The criteria are parsed when the object is created and compiled to a condition over
+ * tbl_cds_object, the values are bound as parameters. <code>contains</code> and
+ * <code>doesNotContain</code> on the text properties match the beginning of the words in the
+ * full text index, <code>upnp:class</code> is compared with the class numbers.</p>
+ *
+ * <p>Properties which are not stored are never present: <code>exists false</code>,
+ * <code>!=</code> and <code>doesNotContain</code> are true, the other operators false.</p>
+ */
+class UpnpSearchCriteria {
+public:
+    /**
+     * \brief parse the criteria.
+     * \param criteria the SearchCriteria, "*" for all objects.
+     * \throws upnp::UpnpException 708 when the criteria can not be parsed.
+     */
+    explicit UpnpSearchCriteria ( const std::string & criteria );
+
+    /** \brief append the condition in parentheses to the query. */
+    void where ( db::Sqlite3QueryBuilder & query ) const;
+
+    /** \brief the comma separated properties for GetSearchCapabilities. */
+    static std::string capabilities();
+
+    /** error code for invalid search criteria */
+    static const int INVALID_CRITERIA = 708;
+
+private:
+    /* the stored property. */
+    struct Property {
+        std::string column;
+        /* the column is in the full text index. */
+        bool fts;
+        bool integer;
+        /* the column stores the clean name. */
+        bool clean_name;
+    };
+    static const std::map< std::string, Property > PROPERTIES;
+
+    /* node of the parsed criteria, a relation when op is not "and" or "or". */
+    struct Expression {
+        std::string op;
+        std::string property;
+        std::string value;
+        std::shared_ptr< Expression > left, right;
+    };
+    struct Token {
+        bool quoted;
+        std::string text;
+    };
+
+    std::shared_ptr< Expression > _expression;
+
+    static std::vector< Token > _tokens ( const std::string & criteria );
+    static std::shared_ptr< Expression > _or ( const std::vector< Token > & tokens, size_t & pos );
+    static std::shared_ptr< Expression > _and ( const std::vector< Token > & tokens, size_t & pos );
+    static std::shared_ptr< Expression > _relation ( const std::vector< Token > & tokens, size_t & pos );
+
+    static void _where ( db::Sqlite3QueryBuilder & query, const Expression & expression );
+    static void _class ( db::Sqlite3QueryBuilder & query, const Expression & expression );
+    static void _property ( db::Sqlite3QueryBuilder & query, const Expression & expression, const Property & property );
+    /* the fts5 query "column : ( "word"* ... )", empty when the text has no words. */
+    static std::string _match ( const std::string & column, const std::string & text );
+};
+}//namespace squawk
+#endif // UPNPSEARCHCRITERIA_H
@@ -0,0 +1,114 @@
+/*
+    Bounded blocking queue.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace commons {
+namespace concurrent {
+
+/**
+ * @brief Blocking FIFO queue with a fixed capacity.
+ *
+ * <p>push blocks while the queue is full and pop blocks while the queue is empty, a slow
+ * consumer throttles the producers. After close the queue accepts no more elements,
+ * pop returns the remaining elements and then false.</p>
+ */
+template< typename T >
+class BoundedQueue {
+public:
+    explicit BoundedQueue ( const size_t capacity ) : _capacity ( capacity > 0 ? capacity : 1 ) {}
+
+    BoundedQueue ( const BoundedQueue& ) = delete;
+    BoundedQueue& operator= ( const BoundedQueue& ) = delete;
+    ~BoundedQueue() {}
+
+    /**
+     * @brief append an element, blocks while the queue is full.
+     * @return false when the queue is closed, the element is dropped.
+     */
+    bool push ( T value ) {
+        std::unique_lock< std::mutex > lck ( _mtx );
+        _not_full.wait ( lck, [this] { return _queue.size() < _capacity || _closed; } );
+
+        if ( _closed ) {
+            return false;
+        }
+
+        _queue.push_back ( std::move ( value ) );
+        lck.unlock();
+        _not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief take the first element, blocks while the queue is empty.
+     * @return false when the queue is closed and empty.
+     */
+    bool pop ( T & value ) {
+        std::unique_lock< std::mutex > lck ( _mtx );
+        _not_empty.wait ( lck, [this] { return ! _queue.empty() || _closed; } );
+
+        if ( _queue.empty() ) {
+            return false;
+        }
+
+        value = std::move ( _queue.front() );
+        _queue.pop_front();
+        lck.unlock();
+        _not_full.notify_one();
+        return true;
+    }
+
+    /** @brief close the queue and wake up the waiting threads. */
+    void close() {
+        {
+            std::lock_guard< std::mutex > lck ( _mtx );
+            _closed = true;
+        }
+        _not_full.notify_all();
+        _not_empty.notify_all();
+    }
+
+    /** @brief the number of queued elements. */
+    size_t size() {
+        std::lock_guard< std::mutex > lck ( _mtx );
+        return _queue.size();
+    }
+
+    /** @brief the capacity of the queue. */
+    size_t capacity() const {
+        return _capacity;
+    }
+
+private:
+    const size_t _capacity;
+    std::deque< T > _queue;
+    bool _closed = false;
+
+    std::mutex _mtx;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+};
+}//namespace concurrent
+}//namespace commons
+#endif // BOUNDEDQUEUE_H
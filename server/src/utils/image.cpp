@@ -23,10 +23,18 @@
 
 namespace image {
 
+namespace {
+std::recursive_mutex imlib_mutex_;
+}
+
 Image::~Image() {
-	if ( loaded_ ) { imlib_free_image(); }
+	if ( loaded_ && image_ ) {
+		imlib_context_set_image ( image_ );
+		imlib_free_image();
+	}
 }
 void Image::init_() {
+	lock_ = std::unique_lock< std::recursive_mutex > ( imlib_mutex_ );
 	image_ = imlib_load_image ( filename_.c_str() );
 	imlib_context_set_image ( image_ );
 	loaded_ = true;
@@ -18,6 +18,7 @@
 #define IMAGE_H
 
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <httpcpp/mimetypes.h>
 
@@ -26,6 +27,9 @@
 namespace image {
 /**
  * @brief Image class to read and manipulate images.
+ *
+ * <p>Imlib2 keeps the current image and its cache in a global context. A loaded image
+ * holds a process wide lock until it is destroyed, images in other threads wait.</p>
  */
 class Image {
 public:
@@ -81,6 +85,7 @@ private:
 	std::string filename_;
 	bool loaded_;
 	Imlib_Image image_;
+	std::unique_lock< std::recursive_mutex > lock_;
 	void init_();
 };
 }//namespace image
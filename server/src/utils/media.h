@@ -6,6 +6,7 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -694,8 +695,9 @@ public:
      * @param tag
      * @return
      */
-    std::string getTag( TAG tag ) {
-        return tags[tag];
+    std::string getTag( TAG tag ) const {
+        auto itr_tag = tags.find( tag );
+        return ( itr_tag != tags.end() ? itr_tag->second : std::string() );
     }
     /**
      * @brief tagNames
@@ -746,6 +748,11 @@ private:
     friend class MediaParser;
 };
 
+/**
+ * @brief Read the streams and tags of a media file.
+ *
+ * <p>parseFile can be called from several threads, every call opens its own format context.</p>
+ */
 class MediaParser {
 public:
     static MediaFile parseFile( std::string filename ) {
@@ -755,7 +762,14 @@ public:
         AVFormatContext *fmt_ctx = NULL;
         AVCodecContext *input_codec_context = NULL;
 
-        av_register_all();
+        static std::once_flag registered_;
+        std::call_once( registered_, []() {
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT( 58, 9, 100 )
+            //older libavcodec opens the codecs without a lock.
+            av_lockmgr_register( &lock_manager );
+#endif
+            av_register_all();
+        } );
         open_input_file(filename.c_str(), &fmt_ctx );
 	
         /** Make sure that there is only one stream in the input file. */
@@ -939,11 +953,23 @@ public:
 
 private:
     static std::string get_error_text(const int error) {
-        static char error_buffer[255];
+        char error_buffer[255];
         av_strerror(error, error_buffer, sizeof(error_buffer));
         return std::string( error_buffer );
     }
 
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT( 58, 9, 100 )
+    static int lock_manager( void ** mutex, enum AVLockOp op ) {
+        switch( op ) {
+            case AV_LOCK_CREATE: *mutex = new std::mutex(); return 0;
+            case AV_LOCK_OBTAIN: static_cast< std::mutex* >( *mutex )->lock(); return 0;
+            case AV_LOCK_RELEASE: static_cast< std::mutex* >( *mutex )->unlock(); return 0;
+            case AV_LOCK_DESTROY: delete static_cast< std::mutex* >( *mutex ); *mutex = nullptr; return 0;
+        }
+        return 1;
+    }
+#endif
+
     static CODEC convertCodec( const AVCodecID & codec_id ) {
       if( codec_id == AV_CODEC_ID_MP1 )
 	return CODEC::MPEG1; 
@@ -0,0 +1,107 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <array>
+#include <cctype>
+#include <cstring>
+
+#include "sortkey.h"
+
+namespace commons {
+namespace text {
+
+namespace {
+/** width numbers are padded to. */
+const size_t NUMBER_WIDTH = 10;
+
+/** the folded letters for the UTF-8 sequences 0xC3 0x80 - 0xC3 0xBF (U+00C0 - U+00FF). */
+const std::array< const char*, 64 > LATIN1 { {
+        "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+        "d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "ss",
+        "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+        "d", "n", "o", "o", "o", "o", "o", "", "o", "u", "u", "u", "u", "y", "th", "y"
+    }
+};
+
+const std::array< const char*, 6 > ARTICLES { { "the ", "a ", "an ", "der ", "die ", "das " } };
+
+/* case fold and fold the accents. */
+inline std::string fold ( const std::string & name ) {
+    std::string folded_;
+    folded_.reserve ( name.size() );
+
+    for ( size_t i = 0; i < name.size(); ++i ) {
+        const unsigned char c_ = static_cast< unsigned char > ( name[i] );
+
+        if ( c_ == 0xC3 && i + 1 < name.size() && ( static_cast< unsigned char > ( name[i + 1] ) & 0xC0 ) == 0x80 ) {
+            folded_ += LATIN1[ static_cast< unsigned char > ( name[++i] ) & 0x3F ];
+
+        } else if ( c_ < 0x80 ) {
+            folded_ += static_cast< char > ( std::tolower ( c_ ) );
+
+        } else { folded_ += name[i]; }
+    }
+
+    return folded_;
+}
+}//namespace
+
+std::string sort_key ( const std::string & name ) {
+    const std::string folded_ = fold ( name );
+
+    //leading punctuation and spaces.
+    size_t begin_ = 0;
+
+    while ( begin_ < folded_.size() && static_cast< unsigned char > ( folded_[begin_] ) < 0x80 &&
+            ! std::isalnum ( static_cast< unsigned char > ( folded_[begin_] ) ) ) {
+        ++begin_;
+    }
+
+    for ( auto & article : ARTICLES ) {
+        const size_t size_ = std::strlen ( article );
+
+        if ( folded_.size() > begin_ + size_ && folded_.compare ( begin_, size_, article ) == 0 ) {
+            begin_ += size_;
+            break;
+        }
+    }
+
+    std::string key_;
+    key_.reserve ( folded_.size() - begin_ + NUMBER_WIDTH );
+
+    for ( size_t i = begin_; i < folded_.size(); ) {
+        if ( std::isdigit ( static_cast< unsigned char > ( folded_[i] ) ) ) {
+            size_t end_ = i;
+
+            while ( end_ < folded_.size() && std::isdigit ( static_cast< unsigned char > ( folded_[end_] ) ) ) { ++end_; }
+
+            //leading zeros do not count.
+            while ( i + 1 < end_ && folded_[i] == '0' ) { ++i; }
+
+            if ( end_ - i < NUMBER_WIDTH ) {
+                key_.append ( NUMBER_WIDTH - ( end_ - i ), '0' );
+            }
+
+            key_.append ( folded_, i, end_ - i );
+            i = end_;
+
+        } else { key_ += folded_[i++]; }
+    }
+
+    return key_;
+}
+}//namespace text
+}//namespace commons
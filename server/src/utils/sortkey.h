@@ -0,0 +1,39 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef SORTKEY_H
+#define SORTKEY_H
+
+#include <string>
+
+namespace commons {
+namespace text {
+
+/**
+ * @brief create the key to sort names in the order of a listing.
+ *
+ * <p>The key is case folded, the latin accents are folded to the base letter, leading punctuation
+ * and the articles "the", "a", "an", "der", "die" and "das" are removed and numbers are padded with
+ * zeros to sort in natural order ("Track 2" before "Track 10"). The key is meant for order by
+ * clauses only, it is not displayed.</p>
+ * @param name the UTF-8 name.
+ * @return the sort key.
+ */
+std::string sort_key ( const std::string & name );
+
+}//namespace text
+}//namespace commons
+#endif // SORTKEY_H
@@ -0,0 +1,143 @@
+/*
+    Hierarchical timer wheel.
+    Copyright (C) 2016  <etienne> <etienne.knecht@hotmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace commons {
+namespace timer {
+
+/**
+ * @brief Hierarchical timer wheel.
+ *
+ * <p>Three wheels with 64 slots each, the first wheel with one tick per slot,
+ * the second with 64 ticks and the third with 4096 ticks per slot. Scheduling
+ * a timer is O(1), advancing the wheel costs one slot per tick plus the timers
+ * that cascade down or expire. Deadlines beyond the last wheel are parked in the
+ * last slot and rescheduled when the slot cascades.</p>
+ *
+ * <p>The class is not thread safe, the owner has to serialize the access.</p>
+ */
+template< typename K >
+class TimerWheel {
+public:
+    typedef uint64_t tick_t;
+
+    explicit TimerWheel ( const tick_t now ) : _current ( now ) {}
+
+    TimerWheel ( const TimerWheel& ) = delete;
+    TimerWheel& operator= ( const TimerWheel& ) = delete;
+    ~TimerWheel() {}
+
+    /**
+     * @brief schedule a timer.
+     * @param key the timer key, returned in the expired callback.
+     * @param deadline the tick when the timer expires. Deadlines in the past expire with the next tick.
+     */
+    void schedule ( const K & key, const tick_t deadline ) {
+        _insert ( Entry { key, ( deadline > _current ? deadline : _current + 1 ) } );
+    }
+
+    /**
+     * @brief advance the wheel to the given tick.
+     * <p>The callback is called with the key and the deadline of every expired timer.
+     * It returns the new deadline when the timer shall be rescheduled, or 0 to drop it.</p>
+     * @param now the actual tick.
+     * @param expired callback <code>tick_t ( const K & key, tick_t deadline )</code>
+     */
+    template< typename F >
+    void advance ( const tick_t now, F expired ) {
+        while ( _current < now ) {
+            ++_current;
+
+            //cascade the upper wheels, the top wheel first.
+            for ( size_t level = WHEEL_LEVELS - 1; level > 0; --level ) {
+                if ( ( _current & ( ( tick_t ( 1 ) << ( WHEEL_BITS * level ) ) - 1 ) ) == 0 ) {
+                    std::vector< Entry > slot_;
+                    slot_.swap ( _wheels[level][ ( _current >> ( WHEEL_BITS * level ) ) & WHEEL_MASK ] );
+                    _size -= slot_.size();
+
+                    for ( auto & entry : slot_ ) {
+                        _insert ( std::move ( entry ) );
+                    }
+                }
+            }
+
+            std::vector< Entry > slot_;
+            slot_.swap ( _wheels[0][ _current & WHEEL_MASK ] );
+            _size -= slot_.size();
+
+            for ( auto & entry : slot_ ) {
+                if ( entry.deadline > _current ) {
+                    _insert ( std::move ( entry ) );
+
+                } else {
+                    tick_t next_ = expired ( entry.key, entry.deadline );
+
+                    if ( next_ > 0 ) {
+                        schedule ( entry.key, next_ );
+                    }
+                }
+            }
+        }
+    }
+
+    /** @brief the current tick */
+    tick_t current() const { return _current; }
+    /** @brief number of scheduled timers */
+    size_t size() const { return _size; }
+
+private:
+    static const size_t WHEEL_BITS = 6;
+    static const size_t WHEEL_SIZE = 1 << WHEEL_BITS;
+    static const size_t WHEEL_MASK = WHEEL_SIZE - 1;
+    static const size_t WHEEL_LEVELS = 3;
+
+    struct Entry {
+        K key;
+        tick_t deadline;
+    };
+
+    tick_t _current;
+    size_t _size = 0;
+    std::array< std::array< std::vector< Entry >, WHEEL_SIZE >, WHEEL_LEVELS > _wheels;
+
+    void _insert ( Entry && entry ) {
+        const tick_t delta_ = ( entry.deadline > _current ? entry.deadline - _current : 0 );
+        size_t level_ = 0;
+
+        while ( level_ + 1 < WHEEL_LEVELS && delta_ >= ( tick_t ( 1 ) << ( WHEEL_BITS * ( level_ + 1 ) ) ) ) {
+            ++level_;
+        }
+
+        //park deadlines beyond the last wheel in the farthest slot.
+        const tick_t horizon_ = ( tick_t ( 1 ) << ( WHEEL_BITS * WHEEL_LEVELS ) ) - 1;
+        const tick_t slot_tick_ = ( delta_ > horizon_ ? _current + horizon_ : _current + delta_ );
+
+        _wheels[level_][ ( slot_tick_ >> ( WHEEL_BITS * level_ ) ) & WHEEL_MASK ].push_back ( std::move ( entry ) );
+        ++_size;
+    }
+};
+}//namespace timer
+}//namespace commons
+#endif // TIMERWHEEL_H
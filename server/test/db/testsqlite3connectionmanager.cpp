@@ -17,6 +17,9 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <cstdio>
+#include <thread>
+
 #include "../../src/db/sqlite3database.h"
 
 #include <gtest/gtest.h>
@@ -33,3 +36,82 @@ TEST(TestSqlite3ConnectionManager, connection ) {
     }
 }
 
+TEST(TestSqlite3ConnectionManager, PoolReader ) {
+    std::remove( "pool-reader.db" );
+    db::Sqlite3ConnectionPool pool( "pool-reader.db", 2 );
+    pool.writer()->exec( "CREATE TABLE tbl_test( name );" );
+    pool.writer()->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" );
+
+    db::db_connection_ptr reader_ = pool.reader();
+    ASSERT_NE( pool.writer(), reader_ );
+    //nested checkouts on the same thread return the same reader.
+    ASSERT_EQ( reader_, pool.reader() );
+
+    db::db_statement_ptr stmt_ = reader_->prepareStatement( "select count(*) from tbl_test" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( 1, stmt_->get_int( 0 ) );
+    EXPECT_EQ( 1U, pool.stats().checkouts );
+    EXPECT_EQ( 1U, pool.stats().readers );
+}
+TEST(TestSqlite3ConnectionManager, PoolTransaction ) {
+    std::remove( "pool-transaction.db" );
+    db::Sqlite3ConnectionPool pool( "pool-transaction.db", 2 );
+    pool.writer()->exec( "CREATE TABLE tbl_test( name );" );
+
+    pool.begin_transaction();
+    pool.writer()->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" );
+    //the transaction owner reads its own changes.
+    ASSERT_EQ( pool.writer(), pool.reader() );
+
+    //other threads do not see the uncommitted changes and are not blocked.
+    int count_ = -1;
+    std::thread reader_thread_( [&pool, &count_]() {
+        db::db_connection_ptr reader_ = pool.reader();
+        db::db_statement_ptr stmt_ = reader_->prepareStatement( "select count(*) from tbl_test" );
+        if( stmt_->step() ) { count_ = stmt_->get_int( 0 ); }
+    });
+    reader_thread_.join();
+    EXPECT_EQ( 0, count_ );
+
+    pool.end_transaction();
+    db::db_connection_ptr reader_ = pool.reader();
+    ASSERT_NE( pool.writer(), reader_ );
+    db::db_statement_ptr stmt_ = reader_->prepareStatement( "select count(*) from tbl_test" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( 1, stmt_->get_int( 0 ) );
+}
+TEST(TestSqlite3ConnectionManager, PoolWait ) {
+    std::remove( "pool-wait.db" );
+    db::Sqlite3ConnectionPool pool( "pool-wait.db", 1 );
+    db::db_connection_ptr reader_ = pool.reader();
+
+    std::thread reader_thread_( [&pool]() {
+        db::db_connection_ptr reader_ = pool.reader();
+    });
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    reader_.reset();
+    reader_thread_.join();
+
+    db::Sqlite3ConnectionPool::Stats stats_ = pool.stats();
+    EXPECT_EQ( 2U, stats_.checkouts );
+    EXPECT_EQ( 1U, stats_.waits );
+    EXPECT_EQ( 1U, stats_.readers );
+    EXPECT_LT( 0U, stats_.max_wait_us );
+}
+TEST(TestSqlite3ConnectionManager, StatementCache ) {
+    db::Sqlite3Connection connection_( ":memory:" );
+
+    for( size_t i = 0; i < db::Sqlite3Connection::STATEMENT_CACHE_SIZE + 2; ++i ) {
+        connection_.prepareStatement( "select " + std::to_string( i ) )->step();
+    }
+    db::Sqlite3Connection::Stats stats_ = connection_.stats();
+    EXPECT_EQ( db::Sqlite3Connection::STATEMENT_CACHE_SIZE + 2, stats_.misses );
+    EXPECT_EQ( 2U, stats_.evictions );
+
+    //the most recently used statement is cached, the first was evicted.
+    connection_.prepareStatement( "select " + std::to_string( db::Sqlite3Connection::STATEMENT_CACHE_SIZE + 1 ) )->step();
+    connection_.prepareStatement( "select 0" )->step();
+    stats_ = connection_.stats();
+    EXPECT_EQ( 1U, stats_.hits );
+    EXPECT_EQ( db::Sqlite3Connection::STATEMENT_CACHE_SIZE + 3, stats_.misses );
+}
@@ -0,0 +1,108 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../../src/db/sqlite3keysetcache.h"
+
+#include <gtest/gtest.h>
+
+static const std::set< std::string > COLUMNS { "ROWID", "name", "year" };
+
+/* read the page of names with the cache or with limit ?, ? */
+static std::vector< std::string > page ( db::db_connection_ptr db, db::Sqlite3KeysetCache * cache, const std::string & column,
+                                         const std::string & direction, const size_t start_index, const size_t result_count ) {
+    std::vector< std::string > names_;
+    db::Sqlite3QueryBuilder query_( COLUMNS );
+    query_ << "select name";
+
+    if( cache == nullptr ) {
+        query_ << " from tbl_test where year > 0 order by " << column << " " << direction << ", ROWID " << direction;
+        query_.limit( start_index, result_count );
+        db::db_statement_ptr stmt_ = query_.prepare( db );
+        while( stmt_->step() ) { names_.push_back( stmt_->get_string( 0 ) ); }
+
+    } else {
+        db::Sqlite3KeysetCache::select( query_, column, "ROWID", result_count );
+        query_ << " from tbl_test where year > 0";
+        cache->page( db, query_, column, direction, "ROWID", start_index, result_count, [&names_]( db::Sqlite3Statement * stmt ) {
+            names_.push_back( stmt->get_string( 0 ) );
+        } );
+    }
+    return names_;
+}
+
+class TestSqlite3KeysetCache : public ::testing::Test {
+protected:
+    void SetUp() {
+        db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+        db_->exec( "CREATE TABLE tbl_test( name TEXT, year INTEGER );" );
+        //duplicate and NULL sort keys.
+        for( int i = 0; i < 500; ++i ) {
+            db_->exec( "INSERT INTO tbl_test( name, year ) VALUES( " +
+                       ( i % 7 == 0 ? std::string( "NULL" ) : "'name" + std::to_string( i % 50 ) + "'" ) + ", " +
+                       std::to_string( 1990 + i % 30 ) + " );" );
+        }
+    }
+    db::db_connection_ptr db_;
+};
+
+TEST_F(TestSqlite3KeysetCache, Pages ) {
+    for( auto & column : { "name", "year" } ) {
+        for( auto & direction : { "asc", "desc" } ) {
+            db::Sqlite3KeysetCache cache_;
+
+            //sequential pages, then jumps behind the checkpoints.
+            for( size_t start = 0; start < 520; start += 40 ) {
+                EXPECT_EQ( page( db_, nullptr, column, direction, start, 40 ), page( db_, &cache_, column, direction, start, 40 ) )
+                        << column << " " << direction << " " << start;
+            }
+            for( size_t start : { 455, 101, 333, 7 } ) {
+                EXPECT_EQ( page( db_, nullptr, column, direction, start, 25 ), page( db_, &cache_, column, direction, start, 25 ) )
+                        << column << " " << direction << " " << start;
+            }
+            EXPECT_LT( 0U, cache_.stats().seeks );
+        }
+    }
+}
+TEST_F(TestSqlite3KeysetCache, Clear ) {
+    db::Sqlite3KeysetCache cache_;
+    page( db_, &cache_, "year", "asc", 0, 100 );
+    page( db_, &cache_, "year", "asc", 100, 100 );
+    EXPECT_EQ( 1U, cache_.stats().seeks );
+
+    db_->exec( "DELETE FROM tbl_test WHERE year = 1990;" );
+    cache_.clear();
+    EXPECT_EQ( page( db_, nullptr, "year", "asc", 100, 100 ), page( db_, &cache_, "year", "asc", 100, 100 ) );
+    EXPECT_EQ( 1U, cache_.stats().seeks );
+    EXPECT_EQ( 1U, cache_.stats().scans );
+}
+TEST_F(TestSqlite3KeysetCache, Bounds ) {
+    db::Sqlite3KeysetCache cache_( 1, 2 );
+    page( db_, &cache_, "year", "asc", 0, 10 );
+    page( db_, &cache_, "year", "asc", 10, 10 );
+    page( db_, &cache_, "year", "asc", 20, 10 );
+    //the checkpoint at 10 was dropped, 15 reads with the offset.
+    page( db_, &cache_, "year", "asc", 15, 10 );
+    EXPECT_EQ( 1U, cache_.stats().scans );
+
+    //the other query dropped the checkpoints of the first.
+    page( db_, &cache_, "year", "desc", 0, 10 );
+    page( db_, &cache_, "year", "asc", 30, 10 );
+    EXPECT_EQ( 2U, cache_.stats().scans );
+}
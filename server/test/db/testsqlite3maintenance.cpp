@@ -0,0 +1,92 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "../../src/db/sqlite3maintenance.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+db::db_writer_ptr catalog ( const std::string & path ) {
+    std::remove( path.c_str() );
+    std::remove( ( path + "-wal" ).c_str() );
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( path, 2 );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name, value );" );
+    pool_->writer()->exec( "CREATE INDEX IndexTestName ON tbl_test( name );" );
+    db::db_writer_ptr writer_ = std::make_shared< db::Sqlite3Writer >( pool_ );
+
+    //the deleted rows leave free pages.
+    writer_->submit( []( db::db_connection_ptr db ) {
+        db->exec( "WITH RECURSIVE n( i ) AS ( SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 5000 ) "
+                  "INSERT INTO tbl_test SELECT 'name' || ( i % 10 ), zeroblob( 1000 ) FROM n;" );
+        db->exec( "DELETE FROM tbl_test WHERE ROWID > 100;" );
+        return 0;
+    } ).get();
+    writer_->flush().get();
+    return writer_;
+}
+}
+
+TEST(TestSqlite3Maintenance, Run ) {
+    db::db_writer_ptr writer_ = catalog( "maintenance-run.db" );
+    db::Sqlite3Maintenance maintenance_( writer_, { "select value from tbl_test where name = ?" }, std::chrono::minutes( 0 ) );
+
+    db::Sqlite3Maintenance::Report report_ = maintenance_.run( true );
+    EXPECT_TRUE( report_.analyze );
+    EXPECT_FALSE( report_.truncated );
+    EXPECT_TRUE( report_.error.empty() );
+    EXPECT_LT( 1000U, report_.free_pages_before );
+    EXPECT_EQ( 0U, report_.free_pages_after );
+    EXPECT_EQ( report_.pages_before - report_.pages_after, report_.vacuumed_pages );
+    EXPECT_LT( 0U, report_.checkpointed_frames );
+
+    //the statistics exist, the next run has nothing to do.
+    report_ = maintenance_.run( false );
+    EXPECT_EQ( 0U, report_.vacuumed_pages );
+    EXPECT_TRUE( report_.plans.empty() );
+
+    db::Sqlite3Maintenance::Stats stats_ = maintenance_.stats();
+    EXPECT_EQ( 2U, stats_.runs );
+    EXPECT_EQ( report_.pages_after * report_.page_size, stats_.bytes );
+}
+
+TEST(TestSqlite3Maintenance, Budget ) {
+    db::db_writer_ptr writer_ = catalog( "maintenance-budget.db" );
+    db::Sqlite3Maintenance maintenance_( writer_, {}, std::chrono::minutes( 0 ), std::chrono::milliseconds( 0 ) );
+
+    //the statistics are refreshed, the vacuum and the checkpoint are skipped.
+    db::Sqlite3Maintenance::Report report_ = maintenance_.run( true );
+    EXPECT_TRUE( report_.truncated );
+    EXPECT_EQ( 0U, report_.vacuumed_pages );
+    EXPECT_LT( 1000U, report_.free_pages_after );
+    EXPECT_EQ( 1U, maintenance_.stats().truncated_runs );
+}
+
+TEST(TestSqlite3Maintenance, Schedule ) {
+    db::db_writer_ptr writer_ = catalog( "maintenance-schedule.db" );
+    std::promise< db::Sqlite3Maintenance::Report > done_;
+    db::Sqlite3Maintenance maintenance_( writer_, {}, std::chrono::minutes( 0 ), db::Sqlite3Maintenance::DEFAULT_BUDGET,
+    [&done_]( const db::Sqlite3Maintenance::Report & report ) { done_.set_value( report ); } );
+
+    maintenance_.schedule();
+    std::future< db::Sqlite3Maintenance::Report > report_ = done_.get_future();
+    ASSERT_EQ( std::future_status::ready, report_.wait_for( std::chrono::seconds( 10 ) ) );
+    EXPECT_TRUE( report_.get().analyze );
+}
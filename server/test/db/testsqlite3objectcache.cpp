@@ -0,0 +1,111 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/db/sqlite3objectcache.h"
+
+#include <gtest/gtest.h>
+
+TEST(TestSqlite3ObjectCache, FindByType ) {
+    db::Sqlite3ObjectCache cache_;
+
+    EXPECT_FALSE( cache_.find< std::string >( 1 ) );
+    cache_.put( cache_.generation(), 1, std::string( "one" ), 10 );
+    cache_.put( cache_.generation(), 1, 1, 10 );
+
+    ASSERT_TRUE( cache_.find< std::string >( 1 ) != nullptr );
+    EXPECT_EQ( "one", *cache_.find< std::string >( 1 ) );
+    ASSERT_TRUE( cache_.find< int >( 1 ) != nullptr );
+    EXPECT_FALSE( cache_.find< std::string >( 2 ) );
+
+    db::Sqlite3ObjectCache::Stats stats_ = cache_.stats();
+    EXPECT_EQ( 3U, stats_.hits );
+    EXPECT_EQ( 2U, stats_.misses );
+    EXPECT_EQ( 2U, stats_.entries );
+    EXPECT_EQ( 20U, stats_.bytes );
+
+    //all types of the id are dropped.
+    cache_.erase( 1 );
+    EXPECT_FALSE( cache_.find< std::string >( 1 ) );
+    EXPECT_FALSE( cache_.find< int >( 1 ) );
+    EXPECT_EQ( 0U, cache_.stats().bytes );
+}
+
+TEST(TestSqlite3ObjectCache, Generation ) {
+    db::Sqlite3ObjectCache cache_;
+
+    //the object was changed while it was read.
+    const size_t generation_ = cache_.generation();
+    cache_.erase( 1 );
+    cache_.put( generation_, 1, std::string( "old" ), 10 );
+    EXPECT_FALSE( cache_.find< std::string >( 1 ) );
+
+    cache_.put( cache_.generation(), 1, std::string( "new" ), 10 );
+    cache_.clear();
+    EXPECT_FALSE( cache_.find< std::string >( 1 ) );
+    EXPECT_EQ( 0U, cache_.stats().entries );
+}
+
+TEST(TestSqlite3ObjectCache, Evict ) {
+    //one shard with space for four objects.
+    db::Sqlite3ObjectCache cache_( 40, 1 );
+
+    for( int i = 1; i <= 4; ++i ) {
+        cache_.put( cache_.generation(), i, i, 10 );
+    }
+    EXPECT_TRUE( cache_.find< int >( 1 ) );
+    cache_.put( cache_.generation(), 5, 5, 10 );
+
+    //the least recently used object is dropped.
+    EXPECT_FALSE( cache_.find< int >( 2 ) );
+    EXPECT_TRUE( cache_.find< int >( 1 ) );
+    EXPECT_TRUE( cache_.find< int >( 5 ) );
+
+    //objects larger than the shard are not stored.
+    cache_.put( cache_.generation(), 6, 6, 50 );
+    EXPECT_FALSE( cache_.find< int >( 6 ) );
+
+    db::Sqlite3ObjectCache::Stats stats_ = cache_.stats();
+    EXPECT_EQ( 1U, stats_.evictions );
+    EXPECT_EQ( 4U, stats_.entries );
+    EXPECT_EQ( 40U, stats_.bytes );
+}
+
+TEST(TestSqlite3ObjectCache, Threads ) {
+    db::Sqlite3ObjectCache cache_( 1000, 4 );
+    std::vector< std::thread > threads_;
+
+    for( int t = 0; t < 4; ++t ) {
+        threads_.push_back( std::thread( [&cache_, t]() {
+            for( int i = 0; i < 1000; ++i ) {
+                const size_t generation_ = cache_.generation();
+                std::shared_ptr< const int > number_ = cache_.find< int >( i % 50 );
+                if( ! number_ ) {
+                    cache_.put( generation_, i % 50, i % 50, 10 );
+                } else { EXPECT_EQ( i % 50, *number_ ); }
+                if( i % 100 == t ) { cache_.erase( i % 50 ); }
+            }
+        } ) );
+    }
+    for( auto & t : threads_ ) { t.join(); }
+
+    db::Sqlite3ObjectCache::Stats stats_ = cache_.stats();
+    EXPECT_EQ( 4000U, stats_.hits + stats_.misses );
+    EXPECT_GE( 1000U, stats_.bytes );
+}
@@ -0,0 +1,66 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "../../src/db/sqlite3querybuilder.h"
+
+#include <gtest/gtest.h>
+
+static const std::set< std::string > COLUMNS { "ROWID", "name", "artist" };
+
+TEST(TestSqlite3QueryBuilder, Placeholders ) {
+    db::Sqlite3QueryBuilder query_( COLUMNS );
+    query_ << "select name from tbl_test where ";
+    query_.any_of( std::map< std::string, std::string >( { { "artist", "a' or 1=1 --" }, { "name", "b" } } ) );
+    query_.order_by( "artist, name", "DESC" );
+    query_.limit( 0, 10 );
+    EXPECT_EQ( "select name from tbl_test where artist=? or name=? order by artist desc, name desc limit ?, ?", query_.str() );
+}
+TEST(TestSqlite3QueryBuilder, OrderBy ) {
+    db::Sqlite3QueryBuilder query_( COLUMNS );
+    query_.order_by( "artist asc, name, ROWID DESC", "desc" );
+    EXPECT_EQ( " order by artist asc, name desc, ROWID desc", query_.str() );
+    EXPECT_THROW( query_.order_by( "name asc asc", "asc" ), db::DbException );
+    EXPECT_THROW( query_.order_by( "name up", "asc" ), db::DbException );
+}
+TEST(TestSqlite3QueryBuilder, Columns ) {
+    db::Sqlite3QueryBuilder query_( COLUMNS );
+    EXPECT_THROW( query_.any_of( std::map< std::string, std::string >( { { "1=1 or name", "a" } } ) ), db::DbException );
+    EXPECT_THROW( query_.order_by( "(select 1)", "asc" ), db::DbException );
+    EXPECT_THROW( query_.order_by( "name", "asc; drop table tbl_test" ), db::DbException );
+}
+TEST(TestSqlite3QueryBuilder, Bind ) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    db_->exec( "CREATE TABLE tbl_test( name, artist );" );
+    db_->exec( "INSERT INTO tbl_test( name, artist ) VALUES( 'a', 'it''s' );" );
+    db_->exec( "INSERT INTO tbl_test( name, artist ) VALUES( 'b', 'other' );" );
+
+    for( auto & artist : { "it's", "other" } ) {
+        db::Sqlite3QueryBuilder query_( COLUMNS );
+        query_ << "select name from tbl_test where ";
+        query_.any_of( std::map< std::string, std::string >( { { "artist", artist } } ) );
+        db::db_statement_ptr stmt_ = query_.prepare( db_ );
+        ASSERT_TRUE( stmt_->step() );
+        EXPECT_EQ( ( std::string( artist ) == "it's" ? "a" : "b" ), stmt_->get_string( 0 ) );
+        EXPECT_FALSE( stmt_->step() );
+    }
+
+    //the second query used the cached statement.
+    EXPECT_EQ( 1U, db_->stats().hits );
+}
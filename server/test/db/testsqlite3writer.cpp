@@ -0,0 +1,145 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <cstdio>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../../src/db/dbexception.h"
+#include "../../src/db/sqlite3writer.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+int count ( db::db_connection_ptr db ) {
+    db::db_statement_ptr stmt_ = db->prepareStatement( "select count(*) from tbl_test" );
+    return ( stmt_->step() ? stmt_->get_int( 0 ) : -1 );
+}
+}
+
+TEST(TestSqlite3Writer, GroupCommit ) {
+    std::remove( "writer-group.db" );
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( "writer-group.db", 2 );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name );" );
+
+    size_t committed_ = 0;
+    std::set< int64_t > ids_;
+    {
+        db::Sqlite3Writer writer_( pool_, 4, std::chrono::milliseconds( 60000 ), [&committed_]() { ++committed_; } );
+        std::vector< std::thread > threads_;
+        std::mutex mtx_;
+
+        for( int t = 0; t < 4; ++t ) {
+            threads_.push_back( std::thread( [&writer_, &ids_, &mtx_]() {
+                for( int i = 0; i < 10; ++i ) {
+                    int64_t id_ = writer_.submit( []( db::db_connection_ptr db ) {
+                        db->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" );
+                        return static_cast< int64_t >( db->last_insert_rowid() );
+                    } ).get();
+                    std::lock_guard< std::mutex > lck( mtx_ );
+                    ids_.insert( id_ );
+                }
+            } ) );
+        }
+
+        for( auto & t : threads_ ) { t.join(); }
+
+        //the writing thread reads its own changes before the commit.
+        writer_.submit( []( db::db_connection_ptr db ) { db->exec( "INSERT INTO tbl_test( name ) VALUES( 'b' );" ); return 0; } ).get();
+        EXPECT_EQ( 41, count( pool_->reader() ) );
+
+        writer_.flush().get();
+        db::Sqlite3Writer::Stats stats_ = writer_.stats();
+        EXPECT_EQ( 41U, stats_.operations );
+        EXPECT_EQ( 11U, stats_.commits );
+        EXPECT_EQ( 4U, stats_.max_batch );
+        EXPECT_EQ( 0U, stats_.queue_depth );
+        EXPECT_EQ( 11U, committed_ );
+    }
+
+    EXPECT_EQ( 40U, ids_.size() );
+    std::thread reader_thread_( [&pool_]() { EXPECT_EQ( 41, count( pool_->reader() ) ); } );
+    reader_thread_.join();
+}
+
+TEST(TestSqlite3Writer, Interval ) {
+    std::remove( "writer-interval.db" );
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( "writer-interval.db", 2 );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name );" );
+    db::Sqlite3Writer writer_( pool_, 1000, std::chrono::milliseconds( 10 ) );
+
+    writer_.submit( []( db::db_connection_ptr db ) { db->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" ); return 0; } ).get();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    EXPECT_EQ( 1U, writer_.stats().commits );
+}
+
+TEST(TestSqlite3Writer, Exception ) {
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( ":memory:" );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name );" );
+    db::Sqlite3Writer writer_( pool_ );
+
+    std::future< int > failed_ = writer_.submit( []( db::db_connection_ptr db ) {
+        db->prepareStatement( "INSERT INTO tbl_none( name ) VALUES( 'a' );" )->step();
+        return 0;
+    } );
+    EXPECT_THROW( failed_.get(), db::DbException );
+
+    //the following operations are not affected.
+    writer_.submit( []( db::db_connection_ptr db ) { db->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" ); return 0; } ).get();
+    writer_.flush().get();
+    EXPECT_EQ( 1, count( pool_->writer() ) );
+}
+
+TEST(TestSqlite3Writer, Autocommit ) {
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( ":memory:" );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name );" );
+    size_t committed_ = 0;
+    db::Sqlite3Writer writer_( pool_, 1000, std::chrono::milliseconds( 60000 ), [&committed_]() { ++committed_; } );
+
+    writer_.submit( []( db::db_connection_ptr db ) { db->exec( "INSERT INTO tbl_test( name ) VALUES( 'a' );" ); return 0; } ).get();
+    EXPECT_EQ( 0U, committed_ );
+
+    //the open transaction is committed before the operation.
+    int begin_ = writer_.submit( []( db::db_connection_ptr db ) {
+        const int res_ = db->exec( "BEGIN;" );
+        db->exec( "ROLLBACK;" );
+        return res_;
+    }, true ).get();
+    EXPECT_EQ( SQLITE_OK, begin_ );
+    EXPECT_EQ( 1U, committed_ );
+    EXPECT_EQ( 1, count( pool_->writer() ) );
+}
+
+TEST(TestSqlite3Writer, CommitFailed ) {
+    db::db_pool_ptr pool_ = std::make_shared< db::Sqlite3ConnectionPool >( ":memory:" );
+    pool_->writer()->exec( "PRAGMA foreign_keys = ON;" );
+    pool_->writer()->exec( "CREATE TABLE tbl_parent( id INTEGER PRIMARY KEY );" );
+    pool_->writer()->exec( "CREATE TABLE tbl_test( name, parent_id REFERENCES tbl_parent( id ) DEFERRABLE INITIALLY DEFERRED );" );
+    db::Sqlite3Writer writer_( pool_ );
+
+    //the deferred foreign key fails the commit.
+    writer_.submit( []( db::db_connection_ptr db ) { return db->exec( "INSERT INTO tbl_test( name, parent_id ) VALUES( 'a', 1 );" ); } ).get();
+    EXPECT_TRUE( pool_->in_transaction() );
+    EXPECT_THROW( writer_.flush().get(), db::DbException );
+    EXPECT_FALSE( pool_->in_transaction() );
+    EXPECT_EQ( 0, count( pool_->writer() ) );
+
+    //the transaction is rolled back, the following operations are committed.
+    writer_.submit( []( db::db_connection_ptr db ) { return db->exec( "INSERT INTO tbl_test( name ) VALUES( 'b' );" ); } ).get();
+    writer_.flush().get();
+    EXPECT_EQ( 1, count( pool_->writer() ) );
+}
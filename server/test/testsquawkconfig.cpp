@@ -152,6 +152,11 @@ TEST(SquawkParseOptions, TestDefaultOptions) {
     EXPECT_EQ(std::string("127.0.0.1"), config.localListenAddress() );
     EXPECT_EQ(std::string("239.255.255.250"), config.multicastAddress() );
     EXPECT_EQ(1900, config.multicastPort() );
+    EXPECT_EQ(1000U, config.commitBatch() );
+    EXPECT_EQ(500U, config.commitInterval() );
+    EXPECT_FALSE( config.catalogSnapshot() );
+    EXPECT_EQ( 1440U, config.maintenanceInterval() );
+    EXPECT_EQ( 0U, config.importWorkers() );
 }
 
 TEST(SquawkParseOptions, TestMergedOptions) {
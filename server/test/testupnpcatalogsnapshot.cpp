@@ -0,0 +1,143 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include "../src/upnpcatalogsnapshot.h"
+#include "../src/upnpcontentdirectorydao.h"
+
+#include <gtest/gtest.h>
+
+namespace squawk {
+
+namespace {
+db::db_connection_ptr catalog() {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+    //the sort keys are written with the rows.
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, title_sort, mtime ) VALUES( 2, 0, '/album', 'Album', 'album', 30 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, title_sort, mtime, year ) VALUES( 5, 1, '/b.flac', 'b', 'b', 20, 'unknown' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, title_sort, mtime ) VALUES( 6, 1, '/cover.jpg', 'Cover', 'cover', 10 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, title_sort, mtime ) VALUES( 5, 1, '/a.flac', 'A', 'a', 40 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, mtime, artist ) VALUES( 2, 0, '/other', NULL, 30, 'artist' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path, framerate, size ) VALUES( 2, '/b.flac', 23.976, 5000000000 );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 4, '/a.flac' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 2, '/b.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 3, '/deleted.flac' );" );
+    db_->exec( "DELETE FROM tbl_cds_object WHERE ROWID = 3;" );
+    db_->exec( "INSERT INTO tbl_cds_album_art_uri( ref_obj, path, uri, profile ) VALUES( 1, '/cover.jpg', 'cover', 'JPEG_TN' );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name, name_sort, import ) VALUES( 'zappa', 'Zappa', 'zappa', 1 );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name, name_sort, import ) VALUES( 'artist', 'Artist', 'artist', 0 );" );
+    return db_;
+}
+std::vector< int64_t > ids( const UpnpCatalogSnapshot & snapshot, const UpnpCatalogSnapshot::range_t range ) {
+    const std::vector< int > columns_ { 0 };
+    std::vector< int64_t > ids_;
+    for( auto position = range.first; position != range.second; ++position ) {
+        ids_.push_back( snapshot.object( *position, columns_ ).get_int64( 0 ) );
+    }
+    return ids_;
+}
+}
+
+TEST(TestUpnpCatalogSnapshot, Orders) {
+    UpnpCatalogSnapshot snapshot_( catalog(), 7 );
+    EXPECT_EQ( 7U, snapshot_.generation() );
+
+    //children by title, NULL first.
+    EXPECT_EQ( std::vector< int64_t >( { 5, 1 } ), ids( snapshot_, snapshot_.children( 0 ) ) );
+    EXPECT_EQ( std::vector< int64_t >( { 4, 2 } ), ids( snapshot_, snapshot_.children( 1 ) ) );
+    EXPECT_TRUE( ids( snapshot_, snapshot_.children( 2 ) ).empty() );
+
+    EXPECT_EQ( std::vector< int64_t >( { 1, 5 } ), ids( snapshot_, snapshot_.objects( 2, UpnpCatalogSnapshot::ROWID ) ) );
+    EXPECT_EQ( std::vector< int64_t >( { 5, 1 } ), ids( snapshot_, snapshot_.objects( 2, UpnpCatalogSnapshot::TITLE ) ) );
+    EXPECT_EQ( std::vector< int64_t >( { 2, 4 } ), ids( snapshot_, snapshot_.objects( 5, UpnpCatalogSnapshot::MTIME ) ) );
+    EXPECT_TRUE( ids( snapshot_, snapshot_.objects( 6, UpnpCatalogSnapshot::ROWID ) ).empty() );
+
+    EXPECT_EQ( 1U, snapshot_.find( 2 ) );
+    EXPECT_EQ( UpnpCatalogSnapshot::npos, snapshot_.find( 3 ) );
+    EXPECT_EQ( 5, snapshot_.cls( snapshot_.find( 4 ) ) );
+
+    //artists by name with the number of albums.
+    UpnpCatalogSnapshot::range_t artists_ = snapshot_.artists();
+    ASSERT_EQ( 2, artists_.second - artists_.first );
+    EXPECT_EQ( "Artist", snapshot_.artist( artists_.first[ 0 ] ).get_string( 1 ) );
+    EXPECT_EQ( 1, snapshot_.artist( artists_.first[ 0 ] ).get_int( 4 ) );
+    EXPECT_EQ( "zappa", snapshot_.artist( artists_.first[ 1 ] ).get_string( 2 ) );
+    EXPECT_EQ( 0, snapshot_.artist( artists_.first[ 1 ] ).get_int( 4 ) );
+}
+
+TEST(TestUpnpCatalogSnapshot, Values) {
+    db::db_connection_ptr db_ = catalog();
+    UpnpCatalogSnapshot snapshot_( db_, 1 );
+
+    //the rows read the same values as the statement.
+    const std::string select_ = SqlColumns< didl::DidlMusicTrack >::select();
+    const std::vector< int > columns_ = snapshot_.objectColumns( select_ + ", unknown" );
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "select " + select_ + " from tbl_cds_object order by ROWID" );
+    size_t rows_ = 0;
+    while( stmt_->step() ) {
+        UpnpCatalogSnapshot::Row row_ = snapshot_.object( snapshot_.find( stmt_->get_int64( 1 ) ), columns_ );
+        for( int i = 0; i < static_cast< int >( columns_.size() ) - 1; ++i ) {
+            EXPECT_EQ( stmt_->is_null( i ), row_.is_null( i ) ) << i;
+            EXPECT_EQ( stmt_->get_string( i ), row_.get_string( i ) ) << i;
+            EXPECT_EQ( stmt_->get_int64( i ), row_.get_int64( i ) ) << i;
+        }
+        EXPECT_TRUE( row_.is_null( static_cast< int >( columns_.size() ) - 1 ) );
+        ++rows_;
+    }
+    EXPECT_EQ( 4U, rows_ );
+
+    //the resources of deleted objects are not returned.
+    UpnpCatalogSnapshot::rows_t resources_ = snapshot_.resources( snapshot_.find( 2 ) );
+    ASSERT_EQ( 2U, resources_.second - resources_.first );
+    EXPECT_EQ( "/b.flac", snapshot_.resource( resources_.first ).get_string( 3 ) );
+    EXPECT_EQ( "23.976", snapshot_.resource( resources_.first ).get_string( 9 ) );
+    EXPECT_EQ( 5000000000, snapshot_.resource( resources_.first ).get_int64( 14 ) );
+    EXPECT_EQ( "/b.jpg", snapshot_.resource( resources_.first + 1 ).get_string( 3 ) );
+    resources_ = snapshot_.resources( snapshot_.find( 4 ) );
+    ASSERT_EQ( 1U, resources_.second - resources_.first );
+    EXPECT_EQ( "/a.flac", snapshot_.resource( resources_.first ).get_string( 3 ) );
+
+    UpnpCatalogSnapshot::rows_t uris_ = snapshot_.albumArtUris( snapshot_.find( 1 ) );
+    ASSERT_EQ( 1U, uris_.second - uris_.first );
+    EXPECT_EQ( "JPEG_TN", snapshot_.albumArtUri( uris_.first ).get_string( 4 ) );
+    uris_ = snapshot_.albumArtUris( snapshot_.find( 5 ) );
+    EXPECT_EQ( uris_.first, uris_.second );
+
+    UpnpCatalogSnapshot::Stats stats_ = snapshot_.stats();
+    EXPECT_EQ( 4U, stats_.objects );
+    EXPECT_EQ( 4U, stats_.resources );
+    EXPECT_EQ( 1U, stats_.album_art_uris );
+    EXPECT_EQ( 2U, stats_.artists );
+    EXPECT_LT( 0U, stats_.bytes );
+}
+TEST(TestUpnpCatalogSnapshot, Transaction) {
+    db::db_connection_ptr db_ = catalog();
+
+    //the read transaction is closed, a new transaction can be started.
+    { UpnpCatalogSnapshot snapshot_( db_, 1 ); }
+    ASSERT_EQ( SQLITE_OK, db_->exec( "BEGIN;" ) );
+
+    //in an open transaction the snapshot reads the uncommitted rows.
+    ASSERT_EQ( SQLITE_OK, db_->exec( "delete from tbl_cds_object where ROWID = 4;" ) );
+    UpnpCatalogSnapshot snapshot_( db_, 2 );
+    EXPECT_EQ( 3U, snapshot_.stats().objects );
+    EXPECT_EQ( UpnpCatalogSnapshot::npos, snapshot_.find( 4 ) );
+    EXPECT_EQ( SQLITE_OK, db_->exec( "ROLLBACK;" ) );
+}
+}//namespace squawk
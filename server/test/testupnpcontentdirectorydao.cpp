@@ -14,11 +14,17 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <fstream>
 #include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
 
 #include <gtest/gtest.h>
 
 #include "../upnpcontentdirectorydao.h"
+#include "../upnpcontentdirectory.h"
+#include "../db/sqlite3connection.h"
 
 namespace squawk {
 TEST(TestUpnpContentDirectoryDao, ClassType) {
@@ -38,7 +44,7 @@ TEST(TestUpnpContentDirectoryDao, DidlObjectMemberNames) {
 TEST(TestUpnpContentDirectoryDao, DidlContainerMemberNames) {
     std::stringstream ss;
     SqlParameters< didl::DidlContainer>::serialize(ss, true, "");
-    ASSERT_EQ("cls, ROWID, parent_id, title, path, mtime, object_update_id, import", ss.str() );
+    ASSERT_EQ("cls, ROWID, parent_id, title, path, mtime, object_update_id, child_count, import", ss.str() );
 }
 TEST(TestUpnpContentDirectoryDao, DidlContainerMemberNamesUpdate) {
     std::stringstream ss;
@@ -52,7 +58,621 @@ TEST(TestUpnpContentDirectoryDao, DidlContainerPlaceholders) {
     ASSERT_EQ("?, ?, ?, ?, ?, ?, ?", ss.str() );
 }
 
+TEST(TestUpnpContentDirectoryDao, DidlContainerColumns) {
+    std::stringstream select_, update_;
+    SqlParameters< didl::DidlContainer>::serialize(select_, true, "");
+    SqlParameters< didl::DidlContainer>::serialize(update_, false, "=?");
+    ASSERT_EQ( select_.str(), SqlColumns< didl::DidlContainer >::select() );
+    ASSERT_EQ( update_.str(), SqlColumns< didl::DidlContainer >::update() );
+    ASSERT_EQ("cls, parent_id, title, path, mtime, object_update_id, import", SqlColumns< didl::DidlContainer >::insert() );
+    ASSERT_EQ("?, ?, ?, ?, ?, ?, ?", SqlColumns< didl::DidlContainer >::placeholders() );
+    //the lists are created once.
+    ASSERT_EQ( &SqlColumns< didl::DidlContainer >::select(), &SqlColumns< didl::DidlContainer >::select() );
+}
+
+TEST(TestUpnpContentDirectoryDao, BindRoundTrip) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    didl::DidlMusicTrack track_;
+    boost::fusion::at_c< 0 >( track_ ) = didl::objectItemAudioItemMusicTrack; //_cls
+    boost::fusion::at_c< 1 >( track_ ) = 99; //_id, not written
+    boost::fusion::at_c< 3 >( track_ ) = std::string( "Title\0Part", 10 ); //_title
+    boost::fusion::at_c< 7 >( track_ ) = 5000000000U; //_size
+    boost::fusion::at_c< 15 >( track_ ) = "Artist"; //_artist
+
+    db::db_statement_ptr insert_ = db_->prepareStatement( "insert into tbl_cds_object( " + SqlColumns< didl::DidlMusicTrack >::insert() +
+                                                          " ) values( " + SqlColumns< didl::DidlMusicTrack >::placeholders() + " )" );
+    int index_ = 0;
+    DidlBindWrite< didl::DidlMusicTrack >::bind( insert_.get(), index_, track_, track_ );
+    insert_->insert();
+    const size_t id_ = db_->last_insert_rowid();
+
+    db::db_statement_ptr select_ = db_->prepareStatement( "select " + SqlColumns< didl::DidlMusicTrack >::select() +
+                                                          " from tbl_cds_object where ROWID = ?" );
+    select_->bind_int64( 1, id_ );
+    ASSERT_TRUE( select_->step() );
+    didl::DidlMusicTrack result_;
+    index_ = 0;
+    DidlBindRead< didl::DidlMusicTrack >::bind( select_.get(), index_, result_, result_ );
+
+    EXPECT_EQ( id_, result_.id() );
+    EXPECT_EQ( didl::objectItemAudioItemMusicTrack, result_.cls() );
+    EXPECT_EQ( std::string( "Title\0Part", 10 ), result_.title() );
+    EXPECT_EQ( 5000000000U, result_.size() );
+    EXPECT_EQ( "Artist", result_.artist() );
+}
+
+TEST(TestUpnpContentDirectoryDao, Migrate) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    const int version_ = UpnpContentDirectoryDao::migrate( db_ );
+    ASSERT_LT( 0, version_ );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "PRAGMA user_version;" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( version_, stmt_->get_int( 0 ) );
+    stmt_.reset();
+
+    //a second run does not apply anything.
+    EXPECT_EQ( version_, UpnpContentDirectoryDao::migrate( db_ ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, MigrateTypedColumns) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    //the untyped schema with numbers stored as text.
+    db_->exec( "CREATE TABLE tbl_cds_object( cls, parent_id, size, title, path, mime_type, mtime, rating, year, track, disc, isbn, "
+               "playback_count, object_update_id, contributor, artist, author, publisher, genre, album, comment, series_title, "
+               "season, episode, dlna_profile, last_playback_time, import, timestamp );" );
+    db_->exec( "CREATE TABLE tbl_cds_artist( clean_name, name, import );" );
+    db_->exec( "CREATE TABLE tbl_cds_resource( ref_obj, protocol_info, path, bitrate, bits_per_sample, color_depth, dlna_profile, "
+               "duration, framerate, mime_type, nr_audio_channels, resolution, sample_frequency, size );" );
+    db_->exec( "CREATE TABLE tbl_cds_album_art_uri( ref_obj, path, uri, profile);" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, size, title, path, mtime ) VALUES( 42, '5', '7', '5000000000', 'title', '/a.flac', '1420070400' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, bitrate, duration, resolution ) VALUES( '42', '320000', '', '320x200' );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name, import ) VALUES( 'beatles', 'The Beatles', '1' );" );
+    db_->exec( "PRAGMA user_version = 2;" );
+
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement(
+        "select ROWID, typeof(size), size, parent_id from tbl_cds_object where size > ? and cls = 5" );
+    stmt_->bind_int64( 1, 4294967296LL );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( 42, stmt_->get_int64( 0 ) );
+    EXPECT_EQ( "integer", stmt_->get_string( 1 ) );
+    EXPECT_EQ( 5000000000LL, stmt_->get_int64( 2 ) );
+    EXPECT_EQ( 7, stmt_->get_int64( 3 ) );
+    stmt_.reset();
+
+    db::db_statement_ptr stmt_resource_ = db_->prepareStatement(
+        "select typeof(bitrate), typeof(duration), resolution from tbl_cds_resource where ref_obj = 42" );
+    ASSERT_TRUE( stmt_resource_->step() );
+    EXPECT_EQ( "integer", stmt_resource_->get_string( 0 ) );
+    EXPECT_EQ( "null", stmt_resource_->get_string( 1 ) );
+    EXPECT_EQ( "320x200", stmt_resource_->get_string( 2 ) );
+    stmt_resource_.reset();
+
+    //the sort keys of the existing rows, the new rows are written with their keys.
+    db::db_statement_ptr stmt_sort_ = db_->prepareStatement( "select title_sort, ( select name_sort from tbl_cds_artist ), "
+                                                             "( select count(*) from sqlite_master where type = 'trigger' and name like '%Sort%' ) "
+                                                             "from tbl_cds_object where ROWID = 42" );
+    ASSERT_TRUE( stmt_sort_->step() );
+    EXPECT_EQ( "title", stmt_sort_->get_string( 0 ) );
+    EXPECT_EQ( "beatles", stmt_sort_->get_string( 1 ) );
+    EXPECT_EQ( 0, stmt_sort_->get_int( 2 ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, ChildCount) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    auto child_count_ = [&db_]( const int id ) {
+        db::db_statement_ptr stmt_ = db_->prepareStatement( "select child_count from tbl_cds_object where ROWID = ?" );
+        stmt_->bind_int( 1, id );
+        return ( stmt_->step() ? stmt_->get_int( 0 ) : -1 );
+    };
+
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 1, 2, 0, '/album' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 2, 1, 0, '/folder' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 3, 5, 1, '/album/1.flac' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 4, 5, 1, '/album/2.flac' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 5, 6, 1, '/album/cover.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( ROWID, cls, parent_id, path ) VALUES( 6, 6, 2, '/folder/a.jpg' );" );
+
+    //music albums count the music tracks only.
+    EXPECT_EQ( 2, child_count_( 1 ) );
+    EXPECT_EQ( 1, child_count_( 2 ) );
+
+    db_->exec( "DELETE FROM tbl_cds_object WHERE ROWID = 3;" );
+    EXPECT_EQ( 1, child_count_( 1 ) );
+
+    db_->exec( "UPDATE tbl_cds_object SET parent_id = 2 WHERE ROWID = 4;" );
+    EXPECT_EQ( 0, child_count_( 1 ) );
+    EXPECT_EQ( 2, child_count_( 2 ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, SortKeys) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    auto album_ = []( const std::string & title, const std::string & artist, const std::string & path ) {
+        return didl::DidlContainerAlbum( 0, 0, title, path, 0, 0, 0, 0, 0, 0, "", artist, "", std::list< didl::DidlAlbumArtUri >(), false );
+    };
+    UpnpContentDirectoryDao::_upsert( db_, album_( "Help!", "The Beatles", "/a" ) );
+    UpnpContentDirectoryDao::_upsert( db_, album_( "abbey road", "", "/b" ) );
+    UpnpContentDirectoryDao::_upsert( db_, album_( "Album 10", "", "/c" ) );
+    UpnpContentDirectoryDao::_upsert( db_, album_( "Album 9", "", "/d" ) );
+
+    std::vector< std::string > titles_;
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "select title from tbl_cds_object where cls = 2 order by title_sort asc, ROWID asc" );
+    while( stmt_->step() ) { titles_.push_back( stmt_->get_string( 0 ) ); }
+    stmt_.reset();
+    EXPECT_EQ( std::vector< std::string >( { "abbey road", "Album 9", "Album 10", "Help!" } ), titles_ );
+
+    //the update of the upsert writes the new keys.
+    UpnpContentDirectoryDao::_upsert( db_, album_( "Help!", "Die Toten Hosen", "/a" ) );
+    stmt_ = db_->prepareStatement( "select artist_sort from tbl_cds_object where path = '/a'" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( "toten hosen", stmt_->get_string( 0 ) );
+    stmt_.reset();
+}
+
+TEST(TestUpnpContentDirectoryDao, Counters) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path ) VALUES( 1, 0, 'Music', '/music' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path ) VALUES( 2, 1, 'Album', '/music/album' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path, series_title ) VALUES( 7, 0, 'S01E01', '/e1', 'Series' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path, series_title ) VALUES( 7, 0, 'S01E02', '/e2', 'Series' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path, series_title ) VALUES( 7, 0, 'Movie', '/m', '' );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name ) VALUES( 'beatles', 'The Beatles' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path, mime_type ) VALUES( 3, '/e1', 'video/mp4' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 2, '/music/album/cover.jpg' );" );
+
+    //move, rename and delete.
+    db_->exec( "UPDATE tbl_cds_object SET parent_id = 0 WHERE path = '/music/album';" );
+    db_->exec( "UPDATE tbl_cds_object SET series_title = 'Other' WHERE path = '/e2';" );
+    db_->exec( "UPDATE tbl_cds_object SET cls = 8 WHERE path = '/m';" );
+    db_->exec( "UPDATE tbl_cds_resource SET mime_type = 'video/x-matroska' WHERE path = '/e1';" );
+    db_->exec( "DELETE FROM tbl_cds_object WHERE path = '/music';" );
+
+    //the update of an upsert, the counters of the new class and mime type exist.
+    EXPECT_EQ( SQLITE_OK, db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, title, path ) VALUES( 2, 0, 'S01E02', '/e2' ) "
+                                     "ON CONFLICT( path ) DO UPDATE SET cls = excluded.cls;" ) );
+    EXPECT_EQ( SQLITE_OK, db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path, mime_type ) VALUES( 3, '/e1', 'video/mp4' ) "
+                                     "ON CONFLICT( ref_obj, path ) DO UPDATE SET mime_type = excluded.mime_type;" ) );
+
+    std::map< std::string, size_t > expected_;
+    auto count_ = [&db_, &expected_]( const std::string & name, const std::string & query ) {
+        db::db_statement_ptr stmt_ = db_->prepareStatement( query );
+        while( stmt_->step() ) {
+            const std::string key_ = stmt_->get_string( 0 );
+            expected_[ name + key_ ] = stmt_->get_int( 1 );
+        }
+    };
+    count_( "cls:", "select cls, count(*) from tbl_cds_object group by cls" );
+    count_( "root", "select '', count(*) from tbl_cds_object where parent_id = 0" );
+    count_( "artists", "select '', count(*) from tbl_cds_artist" );
+    count_( "series", "select '', count(distinct series_title) from tbl_cds_object where series_title != ''" );
+    count_( "mime:", "select mime_type, count(*) from tbl_cds_resource where mime_type is not null group by mime_type" );
+
+    std::map< std::string, size_t > counters_ = UpnpContentDirectoryDao::_load_counters( db_ );
+    for( auto it = counters_.begin(); it != counters_.end(); ) {
+        if( it->second == 0 ) { it = counters_.erase( it ); } else { ++it; }
+    }
+    EXPECT_EQ( expected_, counters_ );
+    EXPECT_EQ( 4U, counters_[ "root" ] );
+    EXPECT_EQ( 2U, counters_[ "series" ] );
+}
+
+TEST(TestUpnpContentDirectoryDao, Upsert) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    didl::DidlMusicTrack track_;
+    boost::fusion::at_c< 0 >( track_ ) = didl::objectItemAudioItemMusicTrack; //_cls
+    boost::fusion::at_c< 3 >( track_ ) = "Title"; //_title
+    boost::fusion::at_c< 4 >( track_ ) = "/music/track.flac"; //_path
+    boost::fusion::at_c< 19 >( track_ ) = std::list< didl::DidlResource >( { //_item_resource
+        didl::DidlResource( 0, 0, 100, "", "/music/track.flac", "", "", "audio/flac", { { didl::DidlResource::bitrate, "320000" } } ),
+        didl::DidlResource( 0, 0, 10, "", "/music/cover.jpg", "", "", "image/jpeg", {} ) } );
+
+    const size_t id_ = UpnpContentDirectoryDao::_upsert( db_, track_ ).id();
+    EXPECT_LT( 0U, id_ );
+
+    //the second import updates the object and its resources in place.
+    boost::fusion::at_c< 3 >( track_ ) = "New Title";
+    boost::fusion::at_c< 19 >( track_ ) = std::list< didl::DidlResource >( {
+        didl::DidlResource( 0, 0, 200, "", "/music/track.flac", "", "", "audio/flac", {} ) } );
+    EXPECT_EQ( id_, UpnpContentDirectoryDao::_upsert( db_, track_ ).id() );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "select count(*), title, title_sort from tbl_cds_object" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( 1, stmt_->get_int( 0 ) );
+    EXPECT_EQ( "New Title", stmt_->get_string( 1 ) );
+    EXPECT_EQ( "new title", stmt_->get_string( 2 ) );
+    stmt_.reset();
+
+    stmt_ = db_->prepareStatement( "select ref_obj, path, size, bitrate from tbl_cds_resource order by path" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( id_, stmt_->get_int64( 0 ) );
+    EXPECT_EQ( "/music/cover.jpg", stmt_->get_string( 1 ) );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( "/music/track.flac", stmt_->get_string( 1 ) );
+    EXPECT_EQ( 200, stmt_->get_int64( 2 ) );
+    EXPECT_TRUE( stmt_->is_null( 3 ) );
+    EXPECT_FALSE( stmt_->step() );
+}
+
+TEST(TestUpnpContentDirectoryDao, Sweep) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+    boost::filesystem::create_directories( "sweep/Resource" );
+    std::ofstream( "sweep/Resource/tn_1.jpg" ) << "preview";
+    std::ofstream( "sweep/Resource/tn_2.jpg" ) << "shared";
+
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, artist, timestamp ) VALUES( 5, 0, '/old1.flac', 'beatles', 10 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, artist, timestamp ) VALUES( 5, 0, '/old2.flac', 'beatles', 10 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, artist, timestamp ) VALUES( 6, 0, '/old.jpg', '', 10 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, contributor, timestamp ) VALUES( 5, 0, '/new.flac', 'bach', 20 );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name ) VALUES( 'beatles', 'The Beatles' );" );
+    db_->exec( "INSERT INTO tbl_cds_artist( clean_name, name ) VALUES( 'bach', 'Bach' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 1, '/old1.flac' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 3, '/old.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 3, 'sweep/Resource/tn_1.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 3, 'sweep/Resource/tn_2.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 4, 'sweep/Resource/tn_2.jpg' );" );
+    db_->exec( "INSERT INTO tbl_cds_album_art_uri( ref_obj, path ) VALUES( 2, '/cover.jpg' );" );
+
+    UpnpContentDirectoryDao::SweepStats stats_ { 0, 0, 0, 0, 0, 0 };
+    std::list< std::string > files_;
+    const std::vector< std::string > directories_ { "sweep/Resource/" };
+    EXPECT_EQ( 2U, UpnpContentDirectoryDao::_sweep_objects( db_, 15, 2, directories_, stats_, files_ ) );
+    EXPECT_EQ( 1U, UpnpContentDirectoryDao::_sweep_objects( db_, 15, 2, directories_, stats_, files_ ) );
+    EXPECT_EQ( 0U, UpnpContentDirectoryDao::_sweep_objects( db_, 15, 2, directories_, stats_, files_ ) );
+    EXPECT_EQ( 1U, UpnpContentDirectoryDao::_sweep_artists( db_, 2, stats_ ) );
+    UpnpContentDirectoryDao::_remove_files( files_, stats_ );
+
+    EXPECT_EQ( 3U, stats_.objects );
+    EXPECT_EQ( 4U, stats_.resources );
+    EXPECT_EQ( 1U, stats_.album_art_uris );
+    EXPECT_EQ( 1U, stats_.artists );
+    EXPECT_EQ( 1U, stats_.files );
+    EXPECT_EQ( 7U, stats_.bytes );
+    EXPECT_FALSE( boost::filesystem::exists( "sweep/Resource/tn_1.jpg" ) );
+    EXPECT_TRUE( boost::filesystem::exists( "sweep/Resource/tn_2.jpg" ) );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "select ( select count(*) from tbl_cds_object ), ( select count(*) from tbl_cds_resource ), "
+                                                        "( select clean_name from tbl_cds_artist ), ( select value from tbl_cds_counter where name = 'artists' )" );
+    ASSERT_TRUE( stmt_->step() );
+    EXPECT_EQ( 1, stmt_->get_int( 0 ) );
+    EXPECT_EQ( 1, stmt_->get_int( 1 ) );
+    EXPECT_EQ( "bach", stmt_->get_string( 2 ) );
+    EXPECT_EQ( 1, stmt_->get_int( 3 ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, Search) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    EXPECT_EQ( "\"yellow\"* \"sub\"*", UpnpContentDirectoryDao::_search_match( " yellow  \"sub " ) );
+    EXPECT_EQ( "", UpnpContentDirectoryDao::_search_match( " \" " ) );
+
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, album ) VALUES( 5, 0, '/1', 'Yellow Submarine', 'beatles', 'Yellow Submarine' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, album ) VALUES( 5, 0, '/2', 'Submarine', 'beatles', 'Revolver' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, album ) VALUES( 5, 0, '/3', 'Hey Jude', 'beatles', 'Hey Jude' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, album ) VALUES( 5, 0, '/5', 'Taxman', 'harrison', 'Submarine Sessions' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, author, isbn ) VALUES( 8, 0, '/4', 'Kafka am Strand', 'Murakami', '9783442737611' );" );
+
+    auto search_ = [&db_]( const std::string & text, const std::string & cls ) {
+        std::vector< std::string > titles_;
+        db::Sqlite3QueryBuilder query_( std::set< std::string > { "cls" } );
+        if( UpnpContentDirectoryDao::_search_query( query_, text ) ) {
+            query_ << " select title from hits, tbl_cds_object where tbl_cds_object.ROWID = hits.hit" << cls << " order by hits.score, hits.hit";
+            db::db_statement_ptr stmt_ = query_.prepare( db_ );
+            while( stmt_->step() ) { titles_.push_back( stmt_->get_string( 0 ) ); }
+        }
+        return titles_;
+    };
+
+    //prefixes of all words, a match in the title ranks before a match in the album.
+    EXPECT_EQ( std::vector< std::string >( { "Yellow Submarine", "Submarine", "Taxman" } ), search_( "subm", "" ) );
+    EXPECT_EQ( std::vector< std::string >( { "Yellow Submarine" } ), search_( "bea yel", "" ) );
+    EXPECT_EQ( std::vector< std::string >( { "Kafka am Strand" } ), search_( "murakami", "" ) );
+    EXPECT_EQ( std::vector< std::string >( { "Kafka am Strand" } ), search_( "978344", "" ) );
+    EXPECT_EQ( 3U, search_( "beatles", " and cls = 5" ).size() );
+    EXPECT_TRUE( search_( "beatles", " and cls = 8" ).empty() );
+    EXPECT_TRUE( search_( "", "" ).empty() );
+
+    //the index follows the changes of the objects.
+    db_->exec( "UPDATE tbl_cds_object SET title = 'Let it be' WHERE path = '/3';" );
+    db_->exec( "DELETE FROM tbl_cds_object WHERE path = '/2';" );
+    EXPECT_TRUE( search_( "jude", " and title like 'Hey%'" ).empty() );
+    EXPECT_EQ( std::vector< std::string >( { "Let it be" } ), search_( "let", "" ) );
+    EXPECT_EQ( std::vector< std::string >( { "Yellow Submarine", "Taxman" } ), search_( "submarine", "" ) );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "INSERT INTO tbl_cds_search( tbl_cds_search, rank ) VALUES( 'integrity-check', 1 );" );
+    EXPECT_NO_THROW( stmt_->step() );
+}
+
+TEST(TestUpnpContentDirectoryDao, SearchCriteria) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 1, 0, '/music', 'music' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist ) VALUES( 2, 1, '/music/revolver', 'Revolver', 'beatles' );" );
+    //the year is stored as epoch time.
+    const std::string y1966_ = std::to_string( static_cast< int64_t >( ContentDirectoryModule::epoch_time( 1966 ) ) );
+    const std::string y1970_ = std::to_string( static_cast< int64_t >( ContentDirectoryModule::epoch_time( 1970 ) ) );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, year, track ) VALUES( 5, 2, '/music/revolver/1', 'Taxman', 'beatles', " + y1966_ + ", 1 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, year, track ) VALUES( 5, 2, '/music/revolver/2', 'Yellow Submarine', 'beatles', " + y1966_ + ", 6 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, artist, year, track ) VALUES( 5, 0, '/single', 'Submarine', 'harrison', " + y1970_ + ", 1 );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 7, 0, '/movie', 'Help' );" );
+
+    auto search_ = [&db_]( const std::string & criteria, const size_t container ) {
+        std::vector< std::string > paths_;
+        db::Sqlite3QueryBuilder query_( UpnpContentDirectoryDao::OBJECT_COLUMNS );
+        query_ << "select path from tbl_cds_object where ";
+        UpnpContentDirectoryDao::_search_where( query_, UpnpSearchCriteria( criteria ), container );
+        query_ << " order by path";
+        db::db_statement_ptr stmt_ = query_.prepare( db_ );
+        while( stmt_->step() ) { paths_.push_back( stmt_->get_string( 0 ) ); }
+        return paths_;
+    };
+
+    EXPECT_EQ( 6U, search_( "*", 0 ).size() );
+    EXPECT_EQ( std::vector< std::string >( { "/music/revolver/2", "/single" } ),
+               search_( "upnp:class derivedfrom \"object.item.audioItem\" and dc:title contains \"subm\"", 0 ) );
+    EXPECT_EQ( std::vector< std::string >( { "/music/revolver/2" } ),
+               search_( "upnp:class derivedfrom \"object.item.audioItem\" and dc:title contains \"subm\"", 1 ) );
+    EXPECT_EQ( std::vector< std::string >( { "/music/revolver", "/music/revolver/1", "/music/revolver/2" } ),
+               search_( "upnp:artist = \"The Beatles\"", 0 ) );
+    EXPECT_EQ( std::vector< std::string >( { "/music/revolver/1", "/single" } ),
+               search_( "upnp:originalTrackNumber = \"1\" and ( dc:date < \"1967-01-01\" or upnp:artist contains \"harri\" )", 0 ) );
+    EXPECT_EQ( std::vector< std::string >( { "/movie", "/music/revolver/1" } ),
+               search_( "dc:title doesNotContain \"submarine\" and upnp:class != \"object.container\" and @refID exists false "
+                        "and upnp:class != \"object.container.album.musicAlbum\"", 0 ) );
+    EXPECT_EQ( std::vector< std::string >( { "/music/revolver/1", "/music/revolver/2" } ), search_( "@parentID = \"/file/2\"", 0 ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, SortCriteria) {
+    const std::pair< std::string, std::string > fallback_ { "mtime", "desc" };
+
+    EXPECT_EQ( fallback_, UpnpContentDirectoryDao::sortCriteria( "", fallback_ ) );
+    EXPECT_EQ( std::make_pair( std::string( "title" ), std::string( "asc" ) ), UpnpContentDirectoryDao::sortCriteria( "+dc:title", fallback_ ) );
+    EXPECT_EQ( std::make_pair( std::string( "year, track" ), std::string( "desc" ) ),
+               UpnpContentDirectoryDao::sortCriteria( "-dc:date, -upnp:originalTrackNumber", fallback_ ) );
+    EXPECT_EQ( std::make_pair( std::string( "title asc, year desc, track asc" ), std::string( "asc" ) ),
+               UpnpContentDirectoryDao::sortCriteria( "+dc:title,-dc:date,+upnp:originalTrackNumber", fallback_ ) );
+
+    //properties without index are ignored.
+    EXPECT_EQ( std::make_pair( std::string( "artist" ), std::string( "desc" ) ), UpnpContentDirectoryDao::sortCriteria( "+upnp:genre,-upnp:artist", fallback_ ) );
+    EXPECT_EQ( fallback_, UpnpContentDirectoryDao::sortCriteria( "+upnp:genre,+res@size", fallback_ ) );
+
+    EXPECT_EQ( "title_sort asc, year desc", UpnpContentDirectoryDao::_sort_keys( "title asc, year desc", UpnpContentDirectoryDao::OBJECT_SORT_KEYS ) );
+    EXPECT_NE( std::string::npos, UpnpContentDirectoryDao::sortCapabilities().find( "dc:title" ) );
+}
+
+TEST(TestUpnpContentDirectoryDao, Hydrate) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    //more tracks than ids in one hydration query.
+    std::list< didl::DidlMusicTrack > tracks_;
+    for( size_t i = 1; i <= 200; ++i ) {
+        didl::DidlMusicTrack track_;
+        boost::fusion::at_c< 1 >( track_ ) = i; //_id
+        tracks_.push_back( track_ );
+        db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path, bitrate, size ) VALUES( " + std::to_string( i ) + ", '/track.flac', 320000, 5000000000 );" );
+        if( i % 2 == 0 ) {
+            db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( " + std::to_string( i ) + ", '/track.jpg' );" );
+        }
+    }
+
+    UpnpContentDirectoryDao::_hydrate( db_, tracks_.begin(), tracks_.end() );
+
+    for( auto & track : tracks_ ) {
+        std::list< didl::DidlResource > resources_ = track.audioItemRes();
+        ASSERT_EQ( ( track.id() % 2 == 0 ? 2U : 1U ), resources_.size() );
+        EXPECT_EQ( track.id(), resources_.front().refObj() );
+        EXPECT_EQ( "/track.flac", resources_.front().path() );
+        EXPECT_EQ( 5000000000U, resources_.front().size() );
+        EXPECT_EQ( "320000", resources_.front().attributes()[ didl::DidlResource::bitrate ] );
+    }
+
+    didl::DidlContainerAlbum album_;
+    boost::fusion::at_c< 1 >( album_ ) = 7; //_id
+    db_->exec( "INSERT INTO tbl_cds_album_art_uri( ref_obj, path, uri, profile ) VALUES( 7, '/cover.jpg', 'cover', 'JPEG_TN' );" );
+    UpnpContentDirectoryDao::_hydrate( db_, &album_, &album_ + 1 );
+    ASSERT_EQ( 1U, album_.albumArtUri().size() );
+    EXPECT_EQ( "/cover.jpg", album_.albumArtUri().front().path() );
+}
+
+TEST(TestUpnpContentDirectoryDao, RowVisitor) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    for( size_t i = 1; i <= 300; ++i ) {
+        db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 5, 1, '/" + std::to_string( i ) + ".flac', 'track' );" );
+        db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( " + std::to_string( i ) + ", '/" + std::to_string( i ) + ".flac' );" );
+    }
+
+    const size_t batch_ = UpnpContentDirectoryDao::HYDRATE_BATCH;
+    size_t rows_ = 0, visited_ = 0;
+    auto visitor_ = [&]( didl::DidlMusicTrack & track ) {
+        //the objects are handed over while the statement is stepped.
+        EXPECT_GE( visited_ + batch_, rows_ );
+        EXPECT_EQ( ++visited_, track.id() );
+        ASSERT_EQ( 1U, track.audioItemRes().size() );
+        EXPECT_EQ( "/" + std::to_string( track.id() ) + ".flac", track.audioItemRes().front().path() );
+        //the visitor can read from the same connection.
+        db::db_statement_ptr stmt_ = db_->prepareStatement( "select count(*) from tbl_cds_resource where ref_obj = ?" );
+        stmt_->bind_int64( 1, track.id() );
+        ASSERT_TRUE( stmt_->step() );
+        EXPECT_EQ( 1, stmt_->get_int( 0 ) );
+    };
+    UpnpContentDirectoryDao::RowVisitor< didl::DidlMusicTrack, decltype( visitor_ ) > visit_( db_, visitor_ );
+
+    db::db_statement_ptr stmt_ = db_->prepareStatement(
+        "select " + SqlColumns< didl::DidlMusicTrack >::select() + " from tbl_cds_object where parent_id = 1 order by ROWID" );
+    while( stmt_->step() ) {
+        ++rows_;
+        visit_( stmt_.get() );
+    }
+    stmt_.reset();
+
+    EXPECT_EQ( 256U, visited_ );
+    EXPECT_EQ( 300U, visit_.flush() );
+    EXPECT_EQ( 300U, visited_ );
+}
+
+namespace {
+struct SearchVisitor {
+    std::vector< std::string > objects;
+    void operator() ( didl::DidlContainer & container ) { objects.push_back( "container:" + container.title() ); }
+    void operator() ( didl::DidlContainerAlbum & album ) { objects.push_back( "album:" + album.title() ); }
+    void operator() ( didl::DidlMusicTrack & track ) {
+        objects.push_back( "track:" + track.title() + ":" + std::to_string( track.audioItemRes().size() ) );
+    }
+    void operator() ( didl::DidlMovie & movie ) { objects.push_back( "movie:" + movie.title() ); }
+};
+}
+
+TEST(TestUpnpContentDirectoryDao, SearchRows) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 1, 0, '/music', 'a music' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 2, 1, '/music/revolver', 'b revolver' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 3, 0, '/artist/beatles', 'c beatles' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 5, 2, '/music/revolver/1', 'd taxman' );" );
+    db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( 4, '/music/revolver/1.flac' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 8, 0, '/book', 'e book' );" );
+    db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title ) VALUES( 7, 0, '/movie', 'f movie' );" );
+
+    typedef UpnpContentDirectoryDao::SearchRows< SearchVisitor, didl::DidlContainer, didl::DidlContainerAlbum,
+            didl::DidlMusicTrack, didl::DidlMovie > rows_t;
+    const std::vector< didl::DIDL_CLASS > classes_ = UpnpContentDirectoryDao::classes< didl::DidlContainer, didl::DidlContainerAlbum,
+            didl::DidlMusicTrack, didl::DidlMovie >();
+    EXPECT_EQ( std::vector< didl::DIDL_CLASS >( { didl::objectContainer, didl::objectContainerAlbumMusicAlbum,
+                                                  didl::objectItemAudioItemMusicTrack, didl::objectItemVideoItemMovie } ), classes_ );
+
+    //the rows of the other classes are not selected.
+    db::Sqlite3QueryBuilder query_( UpnpContentDirectoryDao::OBJECT_COLUMNS );
+    query_ << "select cls" << rows_t::select() << " from tbl_cds_object where ";
+    UpnpContentDirectoryDao::_search_where( query_, UpnpSearchCriteria( "*" ), 0, classes_ );
+    query_ << " order by title";
+
+    SearchVisitor visitor_;
+    rows_t rows_( visitor_, 1 );
+    std::vector< std::function< void() > > order_;
+    db::db_statement_ptr stmt_ = query_.prepare( db_ );
+    while( stmt_->step() ) {
+        rows_.read( stmt_.get(), stmt_->get_int( 0 ), order_ );
+    }
+    stmt_.reset();
+    rows_.hydrate( db_ );
+    for( auto & visit : order_ ) { visit(); }
 
+    EXPECT_EQ( std::vector< std::string >( { "container:a music", "album:b revolver", "track:d taxman:1", "movie:f movie" } ), visitor_.objects );
+}
+
+TEST(TestUpnpContentDirectoryDao, Snapshot) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    //the titles sort in reverse ROWID order, every fourth child is a photo.
+    for( size_t i = 1; i <= 20; ++i ) {
+        const std::string title_ = ( 20 - i < 10 ? "track 0" : "track " ) + std::to_string( 20 - i );
+        db_->exec( "INSERT INTO tbl_cds_object( cls, parent_id, path, title, title_sort ) VALUES( " + std::string( i % 4 == 0 ? "6" : "5" ) +
+                   ", 100, '/" + std::to_string( i ) + "', '" + title_ + "', '" + commons::text::sort_key( title_ ) + "' );" );
+        db_->exec( "INSERT INTO tbl_cds_resource( ref_obj, path ) VALUES( " + std::to_string( i ) + ", '/" + std::to_string( i ) + ".flac' );" );
+    }
+    UpnpCatalogSnapshot snapshot_( db_, 1 );
+
+    std::vector< didl::DidlMusicTrack > tracks_;
+    auto visitor_ = [&tracks_]( didl::DidlMusicTrack & track ) { tracks_.push_back( track ); };
+    EXPECT_EQ( 5U, UpnpContentDirectoryDao::_visit< didl::DidlMusicTrack >( snapshot_, snapshot_.children( 100 ), true, false, 2, 5, visitor_ ) );
+
+    //the page is the page of the query.
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "select " + SqlColumns< didl::DidlMusicTrack >::select() +
+        " from tbl_cds_object where parent_id = 100 and cls = 5 order by title_sort, ROWID limit 2, 5" );
+    size_t rows_ = 0;
+    while( stmt_->step() ) {
+        didl::DidlMusicTrack track_;
+        int index_ = 0;
+        DidlBindRead< didl::DidlMusicTrack >::bind( stmt_.get(), index_, track_, track_ );
+        ASSERT_LT( rows_, tracks_.size() );
+        EXPECT_EQ( track_.id(), tracks_[ rows_ ].id() );
+        EXPECT_EQ( track_.title(), tracks_[ rows_ ].title() );
+        ASSERT_EQ( 1U, tracks_[ rows_ ].audioItemRes().size() );
+        EXPECT_EQ( "/" + std::to_string( track_.id() ) + ".flac", tracks_[ rows_ ].audioItemRes().front().path() );
+        ++rows_;
+    }
+    stmt_.reset();
+    EXPECT_EQ( 5U, rows_ );
+    EXPECT_EQ( 17U, tracks_.front().id() );
+
+    //without result count all tracks are visited.
+    tracks_.clear();
+    EXPECT_EQ( 15U, UpnpContentDirectoryDao::_visit< didl::DidlMusicTrack >( snapshot_, snapshot_.children( 100 ), true, true, 2, 0, visitor_ ) );
+    EXPECT_EQ( 1U, tracks_.front().id() );
+    EXPECT_EQ( 19U, tracks_.back().id() );
+}
+
+TEST(TestUpnpContentDirectoryDao, QueryPlan) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    UpnpContentDirectoryDao::migrate( db_ );
+
+    const std::vector< std::string > queries_ {
+        "select ROWID, object_update_id from tbl_cds_object where path = ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where ROWID = ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where parent_id = ? order by title_sort asc, ROWID asc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where parent_id = ? and cls = 5 order by title_sort asc, ROWID asc limit ?, ?",
+        "select count(*) from tbl_cds_object where parent_id = ? and cls = 5",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 2 order by title_sort asc, ROWID asc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 2 and ( title_sort, ROWID ) > ( ?, ? ) order by title_sort asc, ROWID asc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 5 order by artist_sort desc, ROWID desc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 5 order by album_sort asc, ROWID asc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 2 order by mtime desc, ROWID desc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 2 order by year desc, ROWID desc limit ?, ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where parent_id = ? order by track asc, ROWID asc limit ?, ?",
+        "select count(*) from tbl_cds_object where cls = ?",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where cls = 2 and mtime > ? order by mtime desc",
+        "select cls, ROWID, parent_id, title from tbl_cds_object where size > ?",
+        "select count(*) from tbl_cds_object where cls=2",
+        "select cls, count(cls) from tbl_cds_object where cls > 0 GROUP BY cls",
+        "select mime_type, count(mime_type) from tbl_cds_resource GROUP BY mime_type",
+        "select ROWID, name, clean_name, import from tbl_cds_artist WHERE 1 order by name_sort asc, ROWID asc limit ?, ?",
+        "select ROWID from tbl_cds_artist where clean_name = ?",
+        "select count(*) from tbl_cds_object where cls=? and (artist = ? or publisher=?)",
+        "select distinct series_title from tbl_cds_object where series_title!='' order by series_title asc limit ?, ?",
+        "select count(*) from tbl_cds_object where series_title = ?",
+        "select count(distinct series_title) from tbl_cds_object",
+        "update tbl_cds_object SET timestamp=? where path=? and mtime=?",
+        "delete from tbl_cds_object where timestamp < ?",
+        "select ROWID, protocol_info, path from tbl_cds_resource where ref_obj = ?",
+        "select ROWID, ref_obj, path, uri, profile from tbl_cds_album_art_uri where ref_obj = ?",
+    };
+
+    //the plans watched by the maintenance.
+    for( auto & query : UpnpContentDirectoryDao::QUERY_PLANS ) {
+        EXPECT_NO_THROW( db_->prepareStatement( "EXPLAIN QUERY PLAN " + query ) ) << query;
+    }
+
+    for( auto & query : queries_ ) {
+        db::db_statement_ptr stmt_ = db_->prepareStatement( "EXPLAIN QUERY PLAN " + query );
+        while( stmt_->step() ) {
+            const std::string detail_ = stmt_->get_string( 3 );
+            //a SCAN without an index reads the whole table.
+            EXPECT_FALSE( detail_.find( "SCAN " ) == 0 && detail_.find( "INDEX" ) == std::string::npos &&
+                          detail_.find( "CONSTANT ROW" ) == std::string::npos ) << query << " -> " << detail_;
+            //the pages are read in index order.
+            EXPECT_EQ( std::string::npos, detail_.find( "TEMP B-TREE FOR ORDER BY" ) ) << query << " -> " << detail_;
+        }
+    }
+}
 
 }//squawk
 
@@ -0,0 +1,140 @@
+/*
+    Test the UPNP device registry.
+    Copyright (C) 2016  <etienne> <etienne.knecht@hotmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string>
+
+#include "../src/upnpdeviceregistry.h"
+#include "../src/utils/timerwheel.h"
+
+#include <gtest/gtest.h>
+
+namespace squawk {
+
+inline upnp::UpnpDevice make_device ( const std::string & name ) {
+    upnp::UpnpDevice device_;
+    device_.friendlyName ( name );
+    return device_;
+}
+
+TEST ( TestUpnpDeviceRegistry, TimerWheelExpire ) {
+    commons::timer::TimerWheel< int > wheel ( 100 );
+    wheel.schedule ( 1, 110 );
+    wheel.schedule ( 2, 100 + 5000 );
+    wheel.schedule ( 3, 100 + 500000 );
+    EXPECT_EQ ( 3U, wheel.size() );
+
+    std::vector< std::pair< int, uint64_t > > expired_;
+    auto collect_ = [&expired_] ( const int & key, const uint64_t deadline ) -> uint64_t {
+        expired_.push_back ( std::make_pair ( key, deadline ) );
+        return 0;
+    };
+
+    wheel.advance ( 109, collect_ );
+    EXPECT_TRUE ( expired_.empty() );
+    wheel.advance ( 110, collect_ );
+    ASSERT_EQ ( 1U, expired_.size() );
+    EXPECT_EQ ( 1, expired_[0].first );
+
+    wheel.advance ( 100 + 4999, collect_ );
+    EXPECT_EQ ( 1U, expired_.size() );
+    wheel.advance ( 100 + 5000, collect_ );
+    ASSERT_EQ ( 2U, expired_.size() );
+    EXPECT_EQ ( 2, expired_[1].first );
+    EXPECT_EQ ( 5100U, expired_[1].second );
+
+    wheel.advance ( 100 + 500000, collect_ );
+    ASSERT_EQ ( 3U, expired_.size() );
+    EXPECT_EQ ( 3, expired_[2].first );
+    EXPECT_EQ ( 500100U, expired_[2].second );
+    EXPECT_EQ ( 0U, wheel.size() );
+}
+
+TEST ( TestUpnpDeviceRegistry, Expire ) {
+    UpnpDeviceRegistry registry ( 1000 );
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 10, 1000 );
+    registry.insert ( "uuid:2", make_device ( "device 2" ), 20, 1000 );
+    EXPECT_EQ ( 2U, registry.size() );
+
+    EXPECT_TRUE ( registry.expire ( 1009 ).empty() );
+    std::list< upnp::UpnpDevice > expired_ = registry.expire ( 1010 );
+    ASSERT_EQ ( 1U, expired_.size() );
+    EXPECT_EQ ( "device 1", expired_.front().friendlyName() );
+    EXPECT_EQ ( 1U, registry.size() );
+
+    expired_ = registry.expire ( 1020 );
+    ASSERT_EQ ( 1U, expired_.size() );
+    EXPECT_EQ ( "device 2", expired_.front().friendlyName() );
+    EXPECT_EQ ( 0U, registry.size() );
+}
+
+TEST ( TestUpnpDeviceRegistry, TouchExtendsDeadline ) {
+    UpnpDeviceRegistry registry ( 1000 );
+    EXPECT_FALSE ( registry.touch ( "uuid:1", 10, 1000 ) );
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 10, 1000 );
+
+    EXPECT_TRUE ( registry.touch ( "uuid:1", 10, 1005 ) );
+    EXPECT_TRUE ( registry.expire ( 1014 ).empty() );
+    EXPECT_EQ ( 1U, registry.size() );
+    EXPECT_EQ ( 1U, registry.expire ( 1015 ).size() );
+    EXPECT_EQ ( 0U, registry.size() );
+
+    //without cache control the timeout of the last announcement is kept.
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 20, 2000 );
+    EXPECT_TRUE ( registry.touch ( "uuid:1", 0, 2010 ) );
+    EXPECT_TRUE ( registry.expire ( 2029 ).empty() );
+    EXPECT_EQ ( 1U, registry.expire ( 2030 ).size() );
+}
+
+TEST ( TestUpnpDeviceRegistry, EraseAndInsert ) {
+    UpnpDeviceRegistry registry ( 1000 );
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 10, 1000 );
+    EXPECT_TRUE ( registry.erase ( "uuid:1" ) );
+    EXPECT_FALSE ( registry.erase ( "uuid:1" ) );
+
+    //the timer of the removed device must not expire the new one.
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 30, 1005 );
+    EXPECT_TRUE ( registry.expire ( 1010 ).empty() );
+    EXPECT_EQ ( 1U, registry.size() );
+    EXPECT_EQ ( 1U, registry.expire ( 1035 ).size() );
+}
+
+TEST ( TestUpnpDeviceRegistry, Snapshot ) {
+    UpnpDeviceRegistry registry ( 1000 );
+    UpnpDeviceRegistry::device_map_ptr empty_ = registry.snapshot();
+    registry.insert ( "uuid:1", make_device ( "device 1" ), 10, 1000 );
+    UpnpDeviceRegistry::device_map_ptr devices_ = registry.snapshot();
+
+    EXPECT_EQ ( 0U, empty_->size() );
+    ASSERT_EQ ( 1U, devices_->size() );
+    EXPECT_EQ ( "device 1", devices_->at ( "uuid:1" ).friendlyName() );
+
+    //re-announcements do not replace the snapshot, the next expire copies the touched device.
+    registry.touch ( "uuid:1", 10, 1005 );
+    EXPECT_EQ ( devices_, registry.snapshot() );
+    EXPECT_TRUE ( registry.expire ( 1006 ).empty() );
+    EXPECT_NE ( devices_, registry.snapshot() );
+    upnp::UpnpDevice announced_ = devices_->at ( "uuid:1" ), touched_ = registry.snapshot()->at ( "uuid:1" );
+    EXPECT_LE ( announced_.timestamp(), touched_.timestamp() );
+    devices_ = registry.snapshot();
+
+    registry.erase ( "uuid:1" );
+    EXPECT_EQ ( 1U, devices_->size() );
+    EXPECT_EQ ( 0U, registry.snapshot()->size() );
+}
+}//namespace squawk
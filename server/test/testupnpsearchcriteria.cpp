@@ -0,0 +1,146 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/upnpsearchcriteria.h"
+#include "../src/upnpcontentdirectory.h"
+#include "../src/upnp/upnp.h"
+
+#include <gtest/gtest.h>
+
+namespace squawk {
+
+namespace {
+const std::set< std::string > COLUMNS { "ROWID", "parent_id", "title", "artist", "album", "genre", "author", "publisher", "year", "track" };
+
+std::string where ( const std::string & criteria ) {
+    db::Sqlite3QueryBuilder query_ ( COLUMNS );
+    UpnpSearchCriteria ( criteria ).where ( query_ );
+    return query_.str();
+}
+std::string titles ( db::db_connection_ptr db, const std::string & criteria ) {
+    db::Sqlite3QueryBuilder query_ ( COLUMNS );
+    query_ << "select title from tbl_test where ";
+    UpnpSearchCriteria ( criteria ).where ( query_ );
+    query_ << " order by title";
+    db::db_statement_ptr stmt_ = query_.prepare ( db );
+    std::string titles_;
+    while ( stmt_->step() ) {
+        titles_ += ( titles_.empty() ? "" : "," ) + stmt_->get_string ( 0 );
+    }
+    return titles_;
+}
+}
+
+TEST(UpnpSearchCriteriaTest, Compile) {
+    EXPECT_EQ( "( 1 )", where( "*" ) );
+    EXPECT_EQ( "( cls in ( 5 ) )", where( "upnp:class derivedfrom \"object.item.audioItem\"" ) );
+    EXPECT_EQ( "( cls in ( 1, 2, 3, 9 ) )", where( "upnp:class derivedfrom \"object.container\"" ) );
+    EXPECT_EQ( "( cls not in ( 6 ) )", where( "upnp:class != \"object.item.imageItem.photo\"" ) );
+    EXPECT_EQ( "( 0 )", where( "upnp:class = \"object.item.audioItem\"" ) );
+
+    //and binds before or, the values are parameters.
+    EXPECT_EQ( "( ( ( cls in ( 5 ) and ROWID in ( select rowid from tbl_cds_search where tbl_cds_search match ? ) ) "
+               "or album = ? collate nocase ) )",
+               where( "upnp:class derivedfrom \"object.item.audioItem\" and dc:title contains \"yellow sub\" or upnp:album=\"Revolver\"" ) );
+    EXPECT_EQ( "( ( cls in ( 5 ) and ( ROWID not in ( select rowid from tbl_cds_search where tbl_cds_search match ? ) "
+               "or ifnull( instr( lower( track ), lower( ? ) ), 0 ) > 0 ) ) )",
+               where( "upnp:class derivedfrom \"object.item.audioItem\" and (dc:title doesNotContain \"a\" or upnp:originalTrackNumber contains \"1\")" ) );
+
+    //properties which are not stored are never present.
+    EXPECT_EQ( "( ( 1 and 0 ) )", where( "@refID exists false and res@size > \"100\"" ) );
+    EXPECT_EQ( "( 1 )", where( "dc:title contains \" \\\" \"" ) );
+}
+
+TEST(UpnpSearchCriteriaTest, Date) {
+    db::db_connection_ptr db_ = std::make_shared< db::Sqlite3Connection >( ":memory:" );
+    db_->exec( "CREATE TABLE tbl_test( title, genre, year );" );
+    db::db_statement_ptr stmt_ = db_->prepareStatement( "INSERT INTO tbl_test( title, genre, year ) VALUES( ?, ?, ? )" );
+    const std::vector< std::tuple< std::string, std::string, size_t > > rows_ {
+        std::make_tuple( "Help", "Rock", 1965 ), std::make_tuple( "Revolver", "", 1966 ), std::make_tuple( "Sgt. Pepper", "", 1967 ) };
+    for( auto & row : rows_ ) {
+        stmt_->bind_text( 1, std::get< 0 >( row ) );
+        stmt_->bind_text( 2, std::get< 1 >( row ) );
+        stmt_->bind_int64( 3, static_cast< int64_t >( ContentDirectoryModule::epoch_time( std::get< 2 >( row ) ) ) );
+        stmt_->insert();
+        stmt_->reset();
+    }
+
+    //the year is stored as epoch time.
+    EXPECT_EQ( "Revolver,Sgt. Pepper", titles( db_, "upnp:genre exists false and dc:date >= \"1966-01-01\"" ) );
+    EXPECT_EQ( "Revolver", titles( db_, "dc:date = \"1966\"" ) );
+    EXPECT_EQ( "Help,Revolver", titles( db_, "dc:date < \"1966-05-01\"" ) );
+    EXPECT_EQ( "Help", titles( db_, "dc:date < \"1966\"" ) );
+    EXPECT_EQ( "", titles( db_, "dc:date = \"unknown\"" ) );
+}
+
+TEST(UpnpSearchCriteriaTest, Invalid) {
+    EXPECT_THROW( UpnpSearchCriteria( "dc:title contains" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "dc:title contains yellow" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "dc:title like \"yellow\"" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "( dc:title contains \"yellow\"" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "dc:title contains \"yellow" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "dc:title contains \"yellow\" dc:title" ), upnp::UpnpException );
+    EXPECT_THROW( UpnpSearchCriteria( "upnp:genre exists \"true\"" ), upnp::UpnpException );
+    EXPECT_THROW( where( "dc:title derivedfrom \"object\"" ), upnp::UpnpException );
+
+    try {
+        UpnpSearchCriteria( "dc:title = " );
+        FAIL();
+    } catch( upnp::UpnpException & ex ) {
+        EXPECT_EQ( UpnpSearchCriteria::INVALID_CRITERIA, ex.code() );
+    }
+}
+
+TEST(UpnpSearchCriteriaTest, Fault) {
+    commons::xml::XMLWriter xmlWriter;
+    try {
+        UpnpSearchCriteria( "dc:title = " );
+        FAIL();
+    } catch( upnp::UpnpException & ex ) {
+        upnp::fault( &xmlWriter, ex.code(), ex.what() );
+    }
+
+    //the UPnPError is in the detail of the SOAP fault.
+    commons::xml::XMLReader reader_( xmlWriter.str() );
+    std::vector< commons::xml::Node > faults_ = reader_.getElementsByName( upnp::XML_NS_SOAP, "Fault" );
+    ASSERT_EQ( 1U, faults_.size() );
+    std::vector< commons::xml::Node > fault_ = faults_[0].children();
+    ASSERT_EQ( 3U, fault_.size() );
+    EXPECT_EQ( "s:Client", fault_[0].content() );
+    EXPECT_EQ( "UPnPError", fault_[1].content() );
+
+    std::vector< commons::xml::Node > errors_ = reader_.getElementsByName( upnp::XML_NS_UPNP_CONTROL, "UPnPError" );
+    ASSERT_EQ( 1U, errors_.size() );
+    std::vector< commons::xml::Node > error_ = errors_[0].children();
+    ASSERT_EQ( 2U, error_.size() );
+    EXPECT_EQ( "errorCode", error_[0].name() );
+    EXPECT_EQ( "708", error_[0].content() );
+    EXPECT_EQ( "errorDescription", error_[1].name() );
+    EXPECT_FALSE( error_[1].content().empty() );
+}
+
+TEST(UpnpSearchCriteriaTest, Capabilities) {
+    const std::string capabilities_ = UpnpSearchCriteria::capabilities();
+    EXPECT_NE( std::string::npos, capabilities_.find( "upnp:class" ) );
+    EXPECT_NE( std::string::npos, capabilities_.find( "dc:title" ) );
+    EXPECT_EQ( std::string::npos, capabilities_.find( " " ) );
+}
+}//namespace squawk
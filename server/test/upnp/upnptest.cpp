@@ -128,6 +128,18 @@ TEST( UpnpTest, ParseRequest3 ) {
     out << command;
     EXPECT_EQ( std::string( response ), out.str() );
 }
+TEST( UpnpTest, ParseSearchRequest ) {
+
+    const char * request = "<?xml version=\"1.0\" encoding=\"utf-8\"?><s:Envelope s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\" xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\"><s:Body><u:Search xmlns:u=\"urn:schemas-upnp-org:service:ContentDirectory:1\"><ContainerID>0</ContainerID><SearchCriteria>upnp:class derivedfrom &quot;object.item.audioItem&quot; and dc:title contains &quot;yellow&quot;</SearchCriteria><Filter>*</Filter><StartingIndex>0</StartingIndex><RequestedCount>10</RequestedCount><SortCriteria></SortCriteria></u:Search></s:Body></s:Envelope>";
+    UpnpContentDirectoryRequest command = parseRequest( request );
+    EXPECT_EQ( UpnpContentDirectoryRequest::SEARCH, command.type );
+    EXPECT_EQ( "0", command.getValue( CONTAINER_ID ) );
+    EXPECT_EQ( "upnp:class derivedfrom \"object.item.audioItem\" and dc:title contains \"yellow\"", command.getValue( SEARCH_CRITERIA ) );
+    EXPECT_EQ( "10", command.getValue( REQUESTED_COUNT ) );
+
+    const char * capabilities = "<?xml version=\"1.0\" encoding=\"utf-8\"?><s:Envelope s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\" xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\"><s:Body><u:GetSearchCapabilities xmlns:u=\"urn:schemas-upnp-org:service:ContentDirectory:1\"></u:GetSearchCapabilities></s:Body></s:Envelope>";
+    EXPECT_EQ( UpnpContentDirectoryRequest::SEARCH_CAPABILITIES, parseRequest( capabilities ).type );
+}
 #define DESCRIPTION "<?xml version=\"1.0\"?>"\
     "<root xmlns=\"urn:schemas-upnp-org:device-1-0\">"\
     "<specVersion>"\
@@ -0,0 +1,99 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../src/utils/boundedqueue.h"
+
+#include <gtest/gtest.h>
+
+TEST(TestBoundedQueue, Fifo) {
+    commons::concurrent::BoundedQueue< int > queue_( 3 );
+    EXPECT_TRUE( queue_.push( 1 ) );
+    EXPECT_TRUE( queue_.push( 2 ) );
+    EXPECT_TRUE( queue_.push( 3 ) );
+    EXPECT_EQ( 3U, queue_.size() );
+
+    int value_ = 0;
+    EXPECT_TRUE( queue_.pop( value_ ) );
+    EXPECT_EQ( 1, value_ );
+
+    //closed, the remaining elements are returned.
+    queue_.close();
+    EXPECT_FALSE( queue_.push( 4 ) );
+    EXPECT_TRUE( queue_.pop( value_ ) );
+    EXPECT_EQ( 2, value_ );
+    EXPECT_TRUE( queue_.pop( value_ ) );
+    EXPECT_EQ( 3, value_ );
+    EXPECT_FALSE( queue_.pop( value_ ) );
+}
+TEST(TestBoundedQueue, Capacity) {
+    commons::concurrent::BoundedQueue< int > queue_( 2 );
+    std::atomic< int > pushed_( 0 );
+
+    std::thread producer_( [&queue_, &pushed_]() {
+        for( int i = 0; i < 100; ++i ) {
+            queue_.push( i );
+            ++pushed_;
+        }
+        queue_.close();
+    } );
+
+    //the producer blocks when the queue is full.
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    EXPECT_EQ( 2, pushed_ );
+    EXPECT_EQ( 2U, queue_.size() );
+
+    std::vector< int > values_;
+    int value_;
+    while( queue_.pop( value_ ) ) {
+        EXPECT_GE( queue_.capacity(), queue_.size() );
+        values_.push_back( value_ );
+    }
+    producer_.join();
+
+    ASSERT_EQ( 100U, values_.size() );
+    for( int i = 0; i < 100; ++i ) {
+        EXPECT_EQ( i, values_[i] );
+    }
+}
+TEST(TestBoundedQueue, Consumers) {
+    commons::concurrent::BoundedQueue< int > queue_( 4 );
+    std::atomic< int > sum_( 0 );
+    std::vector< std::thread > consumers_;
+
+    for( int i = 0; i < 4; ++i ) {
+        consumers_.push_back( std::thread( [&queue_, &sum_]() {
+            int value_;
+            while( queue_.pop( value_ ) ) {
+                sum_ += value_;
+            }
+        } ) );
+    }
+
+    for( int i = 1; i <= 1000; ++i ) {
+        queue_.push( i );
+    }
+    queue_.close();
+
+    for( auto & consumer : consumers_ ) {
+        consumer.join();
+    }
+    EXPECT_EQ( 500500, sum_ );
+}
@@ -0,0 +1,47 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../../src/utils/sortkey.h"
+
+#include <gtest/gtest.h>
+
+TEST(TestSortKey, Fold) {
+    EXPECT_EQ( "beatles", commons::text::sort_key( "The Beatles" ) );
+    EXPECT_EQ( "beatles", commons::text::sort_key( "the beatles" ) );
+    EXPECT_EQ( "tribe called quest", commons::text::sort_key( "A Tribe Called Quest" ) );
+    EXPECT_EQ( "toten hosen", commons::text::sort_key( "Die Toten Hosen" ) );
+    EXPECT_EQ( "the", commons::text::sort_key( "The" ) );
+    EXPECT_EQ( "theatre", commons::text::sort_key( "Theatre" ) );
+    EXPECT_EQ( "bjork", commons::text::sort_key( "Bj\xC3\xB6rk" ) );
+    EXPECT_EQ( "emigre", commons::text::sort_key( "\xC3\x89migr\xC3\xA9" ) );
+    EXPECT_EQ( "strasse", commons::text::sort_key( "Stra\xC3\x9F" "e" ) );
+    EXPECT_EQ( "best of", commons::text::sort_key( "(Best Of" ) );
+}
+TEST(TestSortKey, Numbers) {
+    EXPECT_EQ( "track 0000000002", commons::text::sort_key( "Track 2" ) );
+    EXPECT_EQ( "track 0000000002", commons::text::sort_key( "Track 002" ) );
+    EXPECT_EQ( "0000000000", commons::text::sort_key( "000" ) );
+
+    std::vector< std::string > names_ { "Track 10", "track 2", "The Track 1", "Track 1b" };
+    std::sort( names_.begin(), names_.end(), []( const std::string & a, const std::string & b ) {
+        return commons::text::sort_key( a ) < commons::text::sort_key( b );
+    } );
+    EXPECT_EQ( std::vector< std::string >( { "The Track 1", "Track 1b", "track 2", "Track 10" } ), names_ );
+}
@@ -0,0 +1,283 @@
+/*
+    SSDP traffic replay benchmark.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "http.h"
+
+#include "../src/ssdpserverimpl.h"
+#include "../src/ssdpduplicatecache.h"
+
+/*
+ * Usage: bench_ssdp [--loopback [--port PORT]] [--iterations N] [corpus]
+ *
+ * The direct mode replays the corpus through the duplicate filter, the request parser and
+ * SSDPServerImpl::handle_receive, like SSDPServerConnection does for a received datagram.
+ * The server listens on a port chosen by the system and has no namespaces, it receives no
+ * other traffic and answers no M-SEARCH. The loopback mode sends the corpus to the multicast
+ * group and counts the events fired by a listening SSDPServerImpl.
+ */
+
+//the allocations are counted per thread, the threads of the server are not measured.
+static thread_local size_t allocations = 0;
+
+void * operator new ( size_t size ) {
+    ++allocations;
+
+    if ( void * ptr = std::malloc ( size == 0 ? 1 : size ) ) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+void operator delete ( void * ptr ) noexcept {
+    std::free ( ptr );
+}
+void operator delete ( void * ptr, size_t ) noexcept {
+    std::free ( ptr );
+}
+
+namespace ssdp {
+namespace bench {
+
+struct Datagram {
+    std::string remote_ip;
+    std::string data;
+};
+
+/* load the corpus, see ssdp_traffic.txt for the format. */
+inline std::vector< Datagram > load_corpus ( const std::string & path ) {
+    std::vector< Datagram > corpus_;
+    std::ifstream in_ ( path );
+
+    if ( ! in_ ) {
+        std::cerr << "can not open corpus: " << path << std::endl;
+        std::exit ( 1 );
+    }
+
+    std::string line_, remote_ip_ = "127.0.0.1", data_;
+    size_t count_ = 1;
+
+    auto flush_ = [&]() {
+        if ( ! data_.empty() ) {
+            data_ += "\r\n";
+
+            for ( size_t i = 0; i < count_; ++i ) {
+                corpus_.push_back ( Datagram { remote_ip_, data_ } );
+            }
+        }
+
+        data_.clear();
+        count_ = 1;
+    };
+
+    while ( std::getline ( in_, line_ ) ) {
+        if ( line_.empty() ) {
+            flush_();
+
+        } else if ( line_[0] == '#' ) {
+            continue;
+
+        } else if ( line_[0] == '@' ) {
+            size_t pos_ = line_.find ( " x" );
+            remote_ip_ = line_.substr ( 1, pos_ == std::string::npos ? std::string::npos : pos_ - 1 );
+            count_ = ( pos_ == std::string::npos ? 1 : std::stoul ( line_.substr ( pos_ + 2 ) ) );
+
+        } else { data_ += line_ + "\r\n"; }
+    }
+
+    flush_();
+    return corpus_;
+}
+
+inline double percentile ( std::vector< double > & values, const double p ) {
+    if ( values.empty() ) { return 0; }
+
+    size_t index_ = std::min ( values.size() - 1, static_cast< size_t > ( p * values.size() ) );
+    std::nth_element ( values.begin(), values.begin() + index_, values.end() );
+    return values[ index_ ];
+}
+
+inline void direct ( const std::vector< Datagram > & corpus, const size_t iterations ) {
+    std::atomic< size_t > events_ { 0 };
+    SSDPServerImpl server_ ( "00000000-0000-0000-0000-000000000000", "239.255.255.250", 0, std::map< std::string, std::string >() );
+    server_.subscribe ( [&events_] ( SSDP_EVENT_TYPE, std::string, SsdpEvent ) { ++events_; } );
+
+    SsdpDuplicateCache duplicates_;
+    http::HttpRequestParser parser_;
+    std::array< char, http::BUFFER_SIZE > buffer_;
+    std::vector< double > latency_;
+    latency_.reserve ( corpus.size() * iterations );
+
+    size_t messages_ = 0, allocations_ = 0;
+    auto start_ = std::chrono::steady_clock::now();
+
+    for ( size_t i = 0; i < iterations; ++i ) {
+        //every iteration is a new wave of announcements for the duplicate filter.
+        const time_t now_ = static_cast< time_t > ( i ) * ( SsdpDuplicateCache::DEFAULT_TTL + 1 );
+
+        for ( auto & datagram : corpus ) {
+            std::copy ( datagram.data.begin(), datagram.data.end(), buffer_.begin() );
+            const size_t allocations_before_ = allocations;
+            auto message_start_ = std::chrono::steady_clock::now();
+
+            if ( ! duplicates_.duplicate ( buffer_.data(), datagram.data.size(), now_ ) ) {
+                http::HttpRequest request_;
+                request_.remoteIp ( datagram.remote_ip );
+                parser_.parse_http_request ( &request_, buffer_, datagram.data.size() );
+                server_.handle_receive ( request_ );
+                parser_.reset();
+            }
+
+            latency_.push_back ( std::chrono::duration< double, std::nano > (
+                                     std::chrono::steady_clock::now() - message_start_ ).count() );
+            allocations_ += allocations - allocations_before_;
+            ++messages_;
+        }
+    }
+
+    const double seconds_ = std::chrono::duration< double > ( std::chrono::steady_clock::now() - start_ ).count();
+    SsdpDuplicateCache::Stats stats_ = duplicates_.stats();
+
+    double mean_ = 0;
+
+    for ( auto & l : latency_ ) { mean_ += l; }
+
+    mean_ = ( latency_.empty() ? 0 : mean_ / latency_.size() );
+
+    std::cout << "mode:              direct" << "\n"
+              << "messages:          " << messages_ << "\n"
+              << "events:            " << events_.load() << "\n"
+              << "duplicates:        " << stats_.drops << " (" << stats_.lookups << " lookups, " << stats_.hits << " hits)\n"
+              << "messages/sec:      " << static_cast< size_t > ( messages_ / seconds_ ) << "\n"
+              << "latency mean (ns): " << static_cast< size_t > ( mean_ ) << "\n"
+              << "latency p50 (ns):  " << static_cast< size_t > ( percentile ( latency_, 0.50 ) ) << "\n"
+              << "latency p99 (ns):  " << static_cast< size_t > ( percentile ( latency_, 0.99 ) ) << "\n"
+              << "latency max (ns):  " << static_cast< size_t > ( percentile ( latency_, 1.0 ) ) << "\n"
+              << "allocations/msg:   " << ( messages_ == 0 ? 0.0 : static_cast< double > ( allocations_ ) / messages_ ) << std::endl;
+}
+
+inline void loopback ( const std::vector< Datagram > & corpus, const size_t iterations, const int port ) {
+    //the counters are declared before the server, the receive thread is stopped before they are destroyed.
+    std::atomic< size_t > events_ { 0 };
+    //the receive time and the allocations of the receiving thread at the first and the last event.
+    std::atomic< int64_t > first_ns_ { 0 }, last_ns_ { 0 };
+    std::atomic< size_t > first_allocations_ { 0 }, last_allocations_ { 0 };
+    SSDPServerImpl server_ ( "00000000-0000-0000-0000-000000000000", "239.255.255.250", port, std::map< std::string, std::string >() );
+    server_.subscribe ( [&] ( SSDP_EVENT_TYPE, std::string, SsdpEvent ) {
+        const int64_t now_ = std::chrono::duration_cast< std::chrono::nanoseconds > (
+                                 std::chrono::steady_clock::now().time_since_epoch() ).count();
+
+        if ( events_++ == 0 ) {
+            first_ns_ = now_;
+            first_allocations_ = allocations;
+        }
+
+        last_ns_ = now_;
+        last_allocations_ = allocations;
+    } );
+
+    asio::io_service io_service_;
+    asio::ip::udp::endpoint endpoint_ ( asio::ip::address::from_string ( "239.255.255.250" ), port );
+    asio::ip::udp::socket socket_ ( io_service_, endpoint_.protocol() );
+    socket_.set_option ( asio::ip::multicast::enable_loopback ( true ) );
+
+    size_t messages_ = 0;
+    auto start_ = std::chrono::steady_clock::now();
+
+    for ( size_t i = 0; i < iterations; ++i ) {
+        for ( auto & datagram : corpus ) {
+            socket_.send_to ( asio::buffer ( datagram.data ), endpoint_ );
+            ++messages_;
+        }
+    }
+
+    auto sent_ = std::chrono::steady_clock::now();
+
+    //wait until the receiver is idle, the idle time is not measured.
+    size_t last_events_;
+
+    do {
+        last_events_ = events_.load();
+        std::this_thread::sleep_for ( std::chrono::milliseconds ( 500 ) );
+    } while ( last_events_ != events_.load() );
+
+    auto to_seconds_ = [] ( const int64_t from, const int64_t to ) { return std::max< int64_t > ( 0, to - from ) / 1e9; };
+    const int64_t start_ns_ = std::chrono::duration_cast< std::chrono::nanoseconds > ( start_.time_since_epoch() ).count();
+    const int64_t sent_ns_ = std::chrono::duration_cast< std::chrono::nanoseconds > ( sent_.time_since_epoch() ).count();
+    const size_t events_total_ = events_.load();
+    //the span from the first send to the last datagram delivered to the listener.
+    const double seconds_ = to_seconds_ ( start_ns_, last_ns_ );
+    SsdpDuplicateCache::Stats stats_ = server_.duplicate_stats();
+
+    std::cout << "mode:              loopback" << "\n"
+              << "messages sent:     " << messages_ << "\n"
+              << "messages checked:  " << stats_.lookups << "\n"
+              << "events:            " << events_total_ << "\n"
+              << "duplicates:        " << stats_.drops << " (" << stats_.hits << " hits)\n"
+              << "messages/sec:      " << static_cast< size_t > ( seconds_ == 0 ? 0 : stats_.lookups / seconds_ ) << "\n"
+              << "first event (us):  " << static_cast< size_t > ( to_seconds_ ( start_ns_, first_ns_ ) * 1e6 ) << "\n"
+              << "drain (us):        " << static_cast< size_t > ( to_seconds_ ( sent_ns_, last_ns_ ) * 1e6 ) << "\n"
+              << "allocations/event: " << ( events_total_ < 2 ? 0.0 :
+                                            static_cast< double > ( last_allocations_ - first_allocations_ ) / ( events_total_ - 1 ) ) << std::endl;
+}
+}//namespace bench
+}//namespace ssdp
+
+int main ( int argc, char **argv ) {
+    std::string corpus_ = std::string ( CMAKE_SOURCE_DIR ) + "ssdpcpp/bench/ssdp_traffic.txt";
+    size_t iterations_ = 100;
+    int port_ = 19000;
+    bool loopback_ = false;
+
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg_ = argv[i];
+
+        if ( arg_ == "--loopback" ) {
+            loopback_ = true;
+
+        } else if ( arg_ == "--iterations" && i + 1 < argc ) {
+            iterations_ = std::stoul ( argv[++i] );
+
+        } else if ( arg_ == "--port" && i + 1 < argc ) {
+            port_ = std::stoi ( argv[++i] );
+
+        } else { corpus_ = arg_; }
+    }
+
+    std::vector< ssdp::bench::Datagram > corpus = ssdp::bench::load_corpus ( corpus_ );
+    std::cout << "corpus:            " << corpus_ << " (" << corpus.size() << " datagrams)" << std::endl;
+
+    if ( loopback_ ) {
+        ssdp::bench::loopback ( corpus, iterations_, port_ );
+
+    } else { ssdp::bench::direct ( corpus, iterations_ ); }
+
+    return 0;
+}
@@ -24,9 +24,10 @@ namespace ssdp {
 inline namespace asio_impl {
 
 SSDPServerConnection::SSDPServerConnection ( const std::string & multicast_address,
-        const int & multicast_port, std::function< void ( http::HttpRequest& ) > handler ) :
+        const int & multicast_port, std::function< void ( http::HttpRequest& ) > handler,
+        std::function< bool ( const char*, size_t ) > filter ) :
     io_service(), strand_ ( io_service ), socket ( io_service ), multicast_address ( multicast_address ),
-    multicast_port ( multicast_port ), _handler ( handler ) {
+    multicast_port ( multicast_port ), _handler ( handler ), _filter ( filter ) {
 
 	asio::ip::address _multicast_address = asio::ip::address::from_string ( multicast_address );
 	asio::ip::address _listen_address = asio::ip::address::from_string ( "0.0.0.0" );
@@ -73,11 +74,13 @@ void SSDPServerConnection::send ( Response response ) {
 
 void SSDPServerConnection::handle_receive_from ( const asio::error_code & error, size_t bytes_recvd ) {
 	if ( !error ) {
-		http::HttpRequest request;
-        request.remoteIp ( sender_endpoint.address().to_string() );
-        http_parser.parse_http_request ( &request, data, bytes_recvd );
-        _handler ( request );
-        http_parser.reset();
+        if ( !_filter || !_filter ( data.data(), bytes_recvd ) ) {
+            http::HttpRequest request;
+            request.remoteIp ( sender_endpoint.address().to_string() );
+            http_parser.parse_http_request ( &request, data, bytes_recvd );
+            _handler ( request );
+            http_parser.reset();
+        }
 
         using namespace std::placeholders;
         socket.async_receive_from ( asio::buffer ( data, max_length ), sender_endpoint,
@@ -37,9 +37,11 @@ class SSDPServerConnection {
 public:
 	/**
 	 * Create a new SSDPAsioConnection.
+	 * The optional filter is called with the raw datagram, messages are dropped without parsing when it returns true.
 	 */
     SSDPServerConnection ( const std::string & multicast_address, const int & port,
-                           std::function< void ( http::HttpRequest& ) > handler );
+                           std::function< void ( http::HttpRequest& ) > handler,
+                           std::function< bool ( const char*, size_t ) > filter = nullptr );
     virtual ~SSDPServerConnection();
 
 	/**
@@ -64,6 +66,7 @@ private:
 
 	/* local variables */
     std::function< void ( http::HttpRequest& ) > _handler;
+    std::function< bool ( const char*, size_t ) > _filter;
 
     enum { max_length = http::BUFFER_SIZE };
 	std::array< char, max_length > data;
@@ -0,0 +1,129 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <cstring>
+#include <strings.h>
+
+#include "ssdpduplicatecache.h"
+
+namespace ssdp {
+
+const time_t SsdpDuplicateCache::DEFAULT_TTL = 10;
+
+namespace {
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline uint64_t fnv1a ( const char * data, const size_t size ) {
+    uint64_t hash_ = FNV_OFFSET;
+
+    for ( size_t i = 0; i < size; ++i ) {
+        hash_ ^= static_cast< unsigned char > ( data[i] );
+        hash_ *= FNV_PRIME;
+    }
+
+    return hash_;
+}
+
+inline bool header_name ( const char * line, const size_t size, const char * name ) {
+    const size_t name_size_ = std::strlen ( name );
+    return size == name_size_ && strncasecmp ( line, name, size ) == 0;
+}
+}//namespace
+
+bool SsdpDuplicateCache::duplicate ( const char * data, const size_t size, const time_t now ) {
+    uint64_t usn_, state_;
+
+    if ( ! scan ( data, size, usn_, state_ ) ) {
+        return false;
+    }
+
+    ++_lookups;
+    Slot & slot_ = _slots[ usn_ % CACHE_SIZE ];
+
+    if ( slot_.usn == usn_ && slot_.expires > now ) {
+        ++_hits;
+
+        if ( slot_.state == state_ ) {
+            ++_drops;
+            return true;
+        }
+    }
+
+    //new USN, new state or expired. the expiry is not extended by duplicates.
+    slot_.usn = usn_;
+    slot_.state = state_;
+    slot_.expires = now + _ttl;
+    return false;
+}
+
+bool SsdpDuplicateCache::scan ( const char * data, const size_t size, uint64_t & usn, uint64_t & state ) {
+    static const char NOTIFY[] = "NOTIFY ";
+
+    if ( size < sizeof ( NOTIFY ) - 1 || std::strncmp ( data, NOTIFY, sizeof ( NOTIFY ) - 1 ) != 0 ) {
+        return false;
+    }
+
+    bool usn_found_ = false;
+    uint64_t nts_ = 0, bootid_ = 0;
+    const char * end_ = data + size;
+    const char * line_ = data;
+
+    while ( line_ < end_ ) {
+        const char * eol_ = static_cast< const char * > ( std::memchr ( line_, '\n', end_ - line_ ) );
+
+        if ( eol_ == nullptr ) { eol_ = end_; }
+
+        const char * value_end_ = ( eol_ > line_ && * ( eol_ - 1 ) == '\r' ? eol_ - 1 : eol_ );
+
+        if ( value_end_ == line_ ) {
+            break; //end of the headers
+        }
+
+        const char * colon_ = static_cast< const char * > ( std::memchr ( line_, ':', value_end_ - line_ ) );
+
+        if ( colon_ != nullptr ) {
+            const char * name_end_ = colon_;
+
+            while ( name_end_ > line_ && * ( name_end_ - 1 ) == ' ' ) { --name_end_; }
+
+            const char * value_ = colon_ + 1;
+
+            while ( value_ < value_end_ && *value_ == ' ' ) { ++value_; }
+
+            while ( value_end_ > value_ && * ( value_end_ - 1 ) == ' ' ) { --value_end_; }
+
+            const size_t name_size_ = name_end_ - line_;
+
+            if ( header_name ( line_, name_size_, "USN" ) ) {
+                usn = fnv1a ( value_, value_end_ - value_ );
+                usn_found_ = true;
+
+            } else if ( header_name ( line_, name_size_, "NTS" ) ) {
+                nts_ = fnv1a ( value_, value_end_ - value_ );
+
+            } else if ( header_name ( line_, name_size_, "BOOTID.UPNP.ORG" ) ) {
+                bootid_ = fnv1a ( value_, value_end_ - value_ );
+            }
+        }
+
+        line_ = eol_ + 1;
+    }
+
+    state = nts_ ^ ( bootid_ * FNV_PRIME );
+    return usn_found_;
+}
+}//namespace ssdp
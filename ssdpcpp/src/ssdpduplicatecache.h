@@ -0,0 +1,95 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#ifndef SSDPDUPLICATECACHE_H
+#define SSDPDUPLICATECACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#include "gtest/gtest_prod.h"
+
+namespace ssdp {
+
+/**
+ * @brief Duplicate suppression for SSDP NOTIFY messages.
+ *
+ * <p>Devices send every NOTIFY several times for every NT. The cache keeps the last
+ * (NTS, BOOTID.UPNP.ORG) state per USN in a fixed size table. A message with the same
+ * state within the time to live is a duplicate and can be dropped before the
+ * message is parsed.</p>
+ *
+ * <p>The filter is called from the receive thread only, the statistics can be read from any thread.</p>
+ */
+class SsdpDuplicateCache {
+public:
+    /** @brief the cache statistics */
+    struct Stats {
+        /** NOTIFY messages checked */
+        size_t lookups;
+        /** USN found in the cache */
+        size_t hits;
+        /** duplicates dropped */
+        size_t drops;
+    };
+
+    /**
+     * @brief create the cache.
+     * @param ttl time in seconds a state is considered a duplicate.
+     */
+    explicit SsdpDuplicateCache ( const time_t ttl = DEFAULT_TTL ) : _ttl ( ttl ) {}
+
+    SsdpDuplicateCache ( const SsdpDuplicateCache& ) = delete;
+    SsdpDuplicateCache ( SsdpDuplicateCache&& ) = delete;
+    SsdpDuplicateCache& operator= ( const SsdpDuplicateCache& ) = delete;
+    SsdpDuplicateCache& operator= ( SsdpDuplicateCache&& ) = delete;
+    ~SsdpDuplicateCache() {}
+
+    /**
+     * @brief check the raw message.
+     * @param data the datagram.
+     * @param size size of the datagram.
+     * @param now the actual time.
+     * @return true when the message is a duplicate and shall be dropped.
+     */
+    bool duplicate ( const char * data, const size_t size, const time_t now = std::time ( 0 ) );
+    /** @brief get the statistics. */
+    Stats stats() const {
+        return Stats { _lookups.load(), _hits.load(), _drops.load() };
+    }
+
+    /** default time to live in seconds. */
+    static const time_t DEFAULT_TTL;
+
+private:
+    static const size_t CACHE_SIZE = 256;
+
+    struct Slot {
+        uint64_t usn = 0;
+        uint64_t state = 0;
+        time_t expires = 0;
+    };
+
+    const time_t _ttl;
+    std::array< Slot, CACHE_SIZE > _slots;
+    std::atomic< size_t > _lookups { 0 }, _hits { 0 }, _drops { 0 };
+
+    FRIEND_TEST ( DuplicateCacheTest, ScanHeaders );
+    static bool scan ( const char * data, const size_t size, uint64_t & usn, uint64_t & state );
+};
+}//namespace ssdp
+#endif // SSDPDUPLICATECACHE_H
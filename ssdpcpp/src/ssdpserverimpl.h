@@ -21,6 +21,7 @@
 #include "gtest/gtest_prod.h"
 
 #include "ssdp.h"
+#include "ssdpduplicatecache.h"
 #include "asio/ssdpserverconnection.h"
 #include "asio/ssdpclientconnection.h"
 
@@ -78,6 +79,12 @@ public:
         void subscribe ( event_callback_t listener ) {
                 listeners.push_back ( listener );
         }
+        /**
+         * \brief Statistics of the NOTIFY duplicate suppression.
+         */
+        SsdpDuplicateCache::Stats duplicate_stats() const {
+                return duplicates.stats();
+        }
 
 private:
         /** thread sleep time. */
@@ -94,6 +101,7 @@ private:
 
         std::string uuid, local_listen_address, multicast_address;
         int multicast_port;
+        SsdpDuplicateCache duplicates; //drop repeated NOTIFY messages, used by the receive thread of the connection
         std::unique_ptr<SSDPServerConnection> connection;
         std::map< std::string, std::string > namespaces; //the namespaces for this server
         std::vector< event_callback_t > listeners;
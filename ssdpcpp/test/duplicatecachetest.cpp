@@ -0,0 +1,88 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string>
+
+#include "../src/ssdpduplicatecache.h"
+
+#include <gtest/gtest.h>
+
+namespace ssdp {
+
+inline std::string notify ( const std::string & usn, const std::string & nts, const std::string & bootid = "1" ) {
+    return "NOTIFY * HTTP/1.1\r\n"
+           "HOST: 239.255.255.250:1900\r\n"
+           "CACHE-CONTROL: max-age=1800\r\n"
+           "LOCATION: http://192.168.0.13:8080/rootDesc.xml\r\n"
+           "NT: upnp:rootdevice\r\n"
+           "NTS: " + nts + "\r\n"
+           "USN: " + usn + "\r\n"
+           "BOOTID.UPNP.ORG: " + bootid + "\r\n"
+           "\r\n";
+}
+
+TEST( DuplicateCacheTest, ScanHeaders ) {
+    uint64_t usn_1, state_1, usn_2, state_2;
+    std::string message_1 = notify ( "uuid:1::upnp:rootdevice", "ssdp:alive" );
+    std::string message_2 = "NOTIFY * HTTP/1.1\r\nusn:uuid:1::upnp:rootdevice \r\nbootid.upnp.org:1\r\nnts:  ssdp:alive\r\n\r\n";
+    ASSERT_TRUE( SsdpDuplicateCache::scan ( message_1.c_str(), message_1.size(), usn_1, state_1 ) );
+    ASSERT_TRUE( SsdpDuplicateCache::scan ( message_2.c_str(), message_2.size(), usn_2, state_2 ) );
+    EXPECT_EQ( usn_1, usn_2 );
+    EXPECT_EQ( state_1, state_2 );
+
+    std::string search = "M-SEARCH * HTTP/1.1\r\nST: ssdp:all\r\n\r\n";
+    EXPECT_FALSE( SsdpDuplicateCache::scan ( search.c_str(), search.size(), usn_1, state_1 ) );
+    std::string no_usn = "NOTIFY * HTTP/1.1\r\nNTS: ssdp:alive\r\n\r\n";
+    EXPECT_FALSE( SsdpDuplicateCache::scan ( no_usn.c_str(), no_usn.size(), usn_1, state_1 ) );
+}
+
+TEST( DuplicateCacheTest, DropDuplicates ) {
+    SsdpDuplicateCache cache ( 10 );
+    std::string alive = notify ( "uuid:1::upnp:rootdevice", "ssdp:alive" );
+    std::string other = notify ( "uuid:1::urn:schemas-upnp-org:device:MediaServer:1", "ssdp:alive" );
+
+    EXPECT_FALSE( cache.duplicate ( alive.c_str(), alive.size(), 1000 ) );
+    EXPECT_TRUE( cache.duplicate ( alive.c_str(), alive.size(), 1000 ) );
+    EXPECT_TRUE( cache.duplicate ( alive.c_str(), alive.size(), 1009 ) );
+    EXPECT_FALSE( cache.duplicate ( other.c_str(), other.size(), 1000 ) );
+
+    //expired
+    EXPECT_FALSE( cache.duplicate ( alive.c_str(), alive.size(), 1010 ) );
+
+    SsdpDuplicateCache::Stats stats = cache.stats();
+    EXPECT_EQ( 5U, stats.lookups );
+    EXPECT_EQ( 2U, stats.hits );
+    EXPECT_EQ( 2U, stats.drops );
+}
+
+TEST( DuplicateCacheTest, StateChange ) {
+    SsdpDuplicateCache cache ( 10 );
+    std::string alive = notify ( "uuid:1::upnp:rootdevice", "ssdp:alive" );
+    std::string bye = notify ( "uuid:1::upnp:rootdevice", "ssdp:byebye" );
+    std::string reboot = notify ( "uuid:1::upnp:rootdevice", "ssdp:alive", "2" );
+
+    EXPECT_FALSE( cache.duplicate ( alive.c_str(), alive.size(), 1000 ) );
+    EXPECT_FALSE( cache.duplicate ( bye.c_str(), bye.size(), 1001 ) );
+    EXPECT_TRUE( cache.duplicate ( bye.c_str(), bye.size(), 1001 ) );
+    EXPECT_FALSE( cache.duplicate ( alive.c_str(), alive.size(), 1002 ) );
+    EXPECT_FALSE( cache.duplicate ( reboot.c_str(), reboot.size(), 1003 ) );
+
+    SsdpDuplicateCache::Stats stats = cache.stats();
+    EXPECT_EQ( 5U, stats.lookups );
+    EXPECT_EQ( 4U, stats.hits );
+    EXPECT_EQ( 1U, stats.drops );
+}
+}//namespace ssdp